@@ -1476,7 +1476,8 @@ cli_cmd_volume_heal_cbk (struct cli_state *state, struct cli_cmd_word *word,
         int                     ret = -1;
         rpc_clnt_procedure_t    *proc = NULL;
         call_frame_t            *frame = NULL;
-        gf1_cli_heal_vol_req    req = {0,};
+        dict_t                  *dict = NULL;
+        int                     heal_op = GF_AFR_OP_HEAL_INDEX;
         int                     sent = 0;
         int                     parse_error = 0;
 
@@ -1484,23 +1485,45 @@ cli_cmd_volume_heal_cbk (struct cli_state *state, struct cli_cmd_word *word,
         if (!frame)
                 goto out;
 
-        if (wordcount != 3) {
+        if ((wordcount != 3) && (wordcount != 4)) {
                cli_usage_out (word->pattern);
                 parse_error = 1;
                goto out;
         }
 
-        req.volname = (char *)words[2];
-        if (!req.volname)
+        if (wordcount == 4) {
+                if (!strcmp (words[3], "full")) {
+                        heal_op = GF_AFR_OP_HEAL_FULL;
+                } else if (!strcmp (words[3], "info")) {
+                        heal_op = GF_AFR_OP_INDEX_SUMMARY;
+                } else {
+                        cli_usage_out (word->pattern);
+                        parse_error = 1;
+                        goto out;
+                }
+        }
+
+        dict = dict_new ();
+        if (!dict)
+                goto out;
+
+        ret = dict_set_str (dict, "volname", (char *)words[2]);
+        if (ret)
+                goto out;
+
+        ret = dict_set_int32 (dict, "heal-op", heal_op);
+        if (ret)
                 goto out;
 
         proc = &cli_rpc_prog->proctable[GLUSTER_CLI_HEAL_VOLUME];
 
         if (proc->fn) {
-                ret = proc->fn (frame, THIS, &req);
+                ret = proc->fn (frame, THIS, dict);
         }
 
 out:
+        if (dict)
+                dict_unref (dict);
         if (ret) {
                 cli_cmd_sent_status_get (&sent);
                 if ((sent == 0) && (parse_error == 0))
@@ -1678,9 +1701,10 @@ struct cli_cmd volume_cmds[] = {
           cli_cmd_volume_status_cbk,
          "display status of specified volume"},
 
-        { "volume heal <VOLNAME>",
+        { "volume heal <VOLNAME> [{full | info}]",
           cli_cmd_volume_heal_cbk,
-          "Start healing of volume specified by <VOLNAME>"},
+          "Start healing of volume specified by <VOLNAME>, or list the "
+          "entries pending heal on each brick"},
 
         {"volume statedump <VOLNAME> [all|mem|iobuf|callpool|priv|fd|inode]...",
          cli_cmd_volume_statedump_cbk,
@@ -910,6 +910,9 @@ gf_cli3_1_defrag_volume_cbk (struct rpc_req *req, struct iovec *iov,
                                  " files of size %"PRId64" (total files"
                                  " scanned %"PRId64")", status,
                                  rsp.files, rsp.size, rsp.lookedup_files);
+                        /* the run time and rates, from newer glusterds */
+                        if (strcmp (rsp.op_errstr, ""))
+                                cli_out ("%s", rsp.op_errstr);
                         goto done;
                 }
 
@@ -3926,6 +3929,60 @@ gf_cli3_1_umount (call_frame_t *frame, xlator_t *this, void *data)
         return ret;
 }
 
+static void
+cli_print_heal_info (dict_t *dict)
+{
+        char            key[256] = {0,};
+        char            *brick = NULL;
+        char            *status = NULL;
+        char            *path = NULL;
+        int32_t         brick_count = 0;
+        int32_t         count = 0;
+        int32_t         listed = 0;
+        int             i = 0;
+        int             j = 0;
+        int             ret = 0;
+
+        ret = dict_get_int32 (dict, "brick-count", &brick_count);
+        if (ret)
+                return;
+
+        for (i = 0; i < brick_count; i++) {
+                snprintf (key, sizeof (key), "%d-brick", i);
+                ret = dict_get_str (dict, key, &brick);
+                if (ret)
+                        continue;
+                cli_out ("\nBrick %s", brick);
+
+                snprintf (key, sizeof (key), "%d-status", i);
+                ret = dict_get_str (dict, key, &status);
+                if (!ret && status && strcmp (status, "")) {
+                        cli_out ("Status: %s", status);
+                        continue;
+                }
+
+                snprintf (key, sizeof (key), "%d-count", i);
+                ret = dict_get_int32 (dict, key, &count);
+                if (ret)
+                        continue;
+                cli_out ("Number of entries: %d", count);
+
+                snprintf (key, sizeof (key), "%d-listed", i);
+                ret = dict_get_int32 (dict, key, &listed);
+                if (ret)
+                        listed = 0;
+                for (j = 0; j < listed; j++) {
+                        snprintf (key, sizeof (key), "%d-entry-%d", i, j);
+                        ret = dict_get_str (dict, key, &path);
+                        if (ret)
+                                continue;
+                        cli_out ("%s", path);
+                }
+                if (listed < count)
+                        cli_out ("... %d more", count - listed);
+        }
+}
+
 int
 gf_cli3_1_heal_volume_cbk (struct rpc_req *req, struct iovec *iov,
                              int count, void *myframe)
@@ -3935,6 +3992,8 @@ gf_cli3_1_heal_volume_cbk (struct rpc_req *req, struct iovec *iov,
         cli_local_t             *local = NULL;
         char                    *volname = NULL;
         call_frame_t            *frame = NULL;
+        dict_t                  *dict = NULL;
+        int                     heal_op = GF_AFR_OP_HEAL_INDEX;
 
         if (-1 == req->rpc_status) {
                 goto out;
@@ -3953,18 +4012,40 @@ gf_cli3_1_heal_volume_cbk (struct rpc_req *req, struct iovec *iov,
                 frame->local = NULL;
         }
 
-        if (local)
+        if (local) {
                 volname = local->u.heal_vol.volname;
+                heal_op = local->u.heal_vol.heal_op;
+        }
 
         gf_log ("cli", GF_LOG_INFO, "Received resp to heal volume");
 
         if (rsp.op_ret && strcmp (rsp.op_errstr, ""))
                 cli_out ("%s", rsp.op_errstr);
+        else if (heal_op == GF_AFR_OP_INDEX_SUMMARY)
+                cli_out ("Heal operation on volume %s has been %s", volname,
+                        (rsp.op_ret) ? "unsuccessful": "successful");
         else
                 cli_out ("Starting heal on volume %s has been %s", volname,
                         (rsp.op_ret) ? "unsuccessful": "successful");
 
         ret = rsp.op_ret;
+        if (ret || (heal_op != GF_AFR_OP_INDEX_SUMMARY))
+                goto out;
+
+        dict = dict_new ();
+        if (!dict) {
+                ret = -1;
+                goto out;
+        }
+
+        ret = dict_unserialize (rsp.dict.dict_val, rsp.dict.dict_len, &dict);
+        if (ret) {
+                gf_log ("", GF_LOG_ERROR,
+                        "Unable to allocate memory");
+                goto out;
+        }
+
+        cli_print_heal_info (dict);
 
 out:
         cli_cmd_broadcast_response (ret);
@@ -3974,6 +4055,10 @@ out:
                 free (rsp.volname);
         if (rsp.op_errstr)
                 free (rsp.op_errstr);
+        if (rsp.dict.dict_val)
+                free (rsp.dict.dict_val);
+        if (dict)
+                dict_unref (dict);
         return ret;
 }
 
@@ -3981,29 +4066,54 @@ int32_t
 gf_cli3_1_heal_volume (call_frame_t *frame, xlator_t *this,
                          void *data)
 {
-        gf1_cli_heal_vol_req   *req = NULL;
+        gf2_cli_heal_vol_req    req = {0,};
         int                     ret = 0;
+        int32_t                 heal_op = GF_AFR_OP_HEAL_INDEX;
         cli_local_t             *local = NULL;
+        dict_t                  *dict = NULL;
 
         if (!frame || !this ||  !data) {
                 ret = -1;
                 goto out;
         }
 
-        req = data;
+        dict = data;
+
+        ret = dict_get_str (dict, "volname", &req.volname);
+        if (ret)
+                goto out;
+
+        ret = dict_get_int32 (dict, "heal-op", &heal_op);
+        if (ret)
+                goto out;
+
+        /* the heal op goes in the dict: older glusterds take the request
+           for a gf1_cli_heal_vol_req and ignore it */
+        ret = dict_allocate_and_serialize (dict,
+                                           &req.dict.dict_val,
+                                           (size_t *)&req.dict.dict_len);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "failed to get serialized length of dict");
+                goto out;
+        }
+
         local = cli_local_get ();
 
         if (local) {
-                local->u.heal_vol.volname = req->volname;
+                local->u.heal_vol.volname = req.volname;
+                local->u.heal_vol.heal_op = heal_op;
                 frame->local = local;
         }
 
-        ret = cli_cmd_submit (req, frame, cli_rpc_prog,
+        ret = cli_cmd_submit (&req, frame, cli_rpc_prog,
                               GLUSTER_CLI_HEAL_VOLUME, NULL,
                               this, gf_cli3_1_heal_volume_cbk,
-                              (xdrproc_t) xdr_gf1_cli_heal_vol_req);
+                              (xdrproc_t) xdr_gf2_cli_heal_vol_req);
 
 out:
+        if (req.dict.dict_val)
+                GF_FREE (req.dict.dict_val);
         gf_log ("cli", GF_LOG_DEBUG, "Returning %d", ret);
 
         return ret;
@@ -152,6 +152,7 @@ struct cli_local {
 
                 struct {
                         char    *volname;
+                        int      heal_op;
                 }heal_vol;
         } u;
 };
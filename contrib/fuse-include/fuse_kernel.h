@@ -259,6 +259,7 @@ enum fuse_opcode {
 	FUSE_DESTROY       = 38,
 	FUSE_IOCTL         = 39,
 	FUSE_POLL          = 40,
+	FUSE_FALLOCATE     = 43, /* 7.19 */
 
 	/* CUSE specific operations */
 	CUSE_INIT          = 4096,
@@ -418,6 +419,14 @@ struct fuse_fsync_in {
 	__u32	padding;
 };
 
+struct fuse_fallocate_in {
+	__u64	fh;
+	__u64	offset;
+	__u64	length;
+	__u32	mode;
+	__u32	padding;
+};
+
 struct fuse_setxattr_in {
 	__u32	size;
 	__u32	flags;
@@ -0,0 +1,241 @@
+/*
+  Copyright (c) 2008-2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+/* dht-layout-bm: compares the linear scan of the layout list that
+   dht_layout_search () used to do with the bisection of the sorted starts
+   it does now, for a directory spread over a given number of subvolumes */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/time.h>
+#include <argp.h>
+
+uint32_t gf_dm_hashfn (const char *msg, int len);
+
+struct bm_entry {
+        int        err;
+        uint32_t   start;
+        uint32_t   stop;
+        void      *xlator;
+};
+
+struct bm_config {
+        long              subvols;
+        long              names;
+        long              iters;
+        struct bm_entry  *list;
+        void            **search_xlator;
+        uint32_t         *search_start;
+        uint32_t         *search_stop;
+        uint32_t         *hashes;
+};
+static struct bm_config bm_config = {
+        .subvols = 300,
+        .names   = 65536,
+        .iters   = 10000000,
+};
+
+static error_t
+bm_parse_opts (int key, char *arg, struct argp_state *_state)
+{
+        char *tmp = NULL;
+        long  val = 0;
+
+        switch (key) {
+        case 's':
+        case 'n':
+        case 'r':
+                val = strtol (arg, &tmp, 10);
+                if ((val <= 0) || (val == LONG_MAX) || (tmp && *tmp)) {
+                        fprintf (stderr, "invalid argument (%s)\n", arg);
+                        return -1;
+                }
+                if (key == 's')
+                        bm_config.subvols = val;
+                else if (key == 'n')
+                        bm_config.names = val;
+                else
+                        bm_config.iters = val;
+                break;
+
+        case ARGP_KEY_NO_ARGS:
+        case ARGP_KEY_ARG:
+        case ARGP_KEY_END:
+                break;
+        }
+
+        return 0;
+}
+
+static struct argp_option bm_options[] = {
+        {"subvols", 's', "COUNT", 0,
+         "number of subvolumes in the layout (defaults to 300)"},
+        {"names", 'n', "COUNT", 0,
+         "number of distinct file names hashed (defaults to 65536)"},
+        {"iters", 'r', "ITERS", 0,
+         "number of searches per method (defaults to 10000000)"},
+        {0, 0, 0, 0, 0}
+};
+
+static struct argp argp = {
+  bm_options,
+  bm_parse_opts,
+  "",
+  "dht-layout-bm - time the search of a DHT layout by hash"
+};
+
+/* ranges as dht_selfheal_layout_new_directory () hands them out, in the
+   order of the subvolume names rather than of the starts */
+static int
+bm_layout_init (void)
+{
+        uint32_t chunk = 0;
+        long     cnt   = bm_config.subvols;
+        long     i     = 0;
+        long     j     = 0;
+        char     name[64];
+
+        bm_config.list = calloc (cnt, sizeof (*bm_config.list));
+        bm_config.search_xlator = calloc (cnt, sizeof (void *));
+        bm_config.search_start = calloc (cnt, sizeof (uint32_t));
+        bm_config.search_stop = calloc (cnt, sizeof (uint32_t));
+        bm_config.hashes = calloc (bm_config.names, sizeof (uint32_t));
+        if (!bm_config.list || !bm_config.search_xlator ||
+            !bm_config.search_start || !bm_config.search_stop ||
+            !bm_config.hashes)
+                return -1;
+
+        chunk = 0xffffffffUL / cnt;
+        for (i = 0; i < cnt; i++) {
+                j = (i * 7919) % cnt;   /* a fixed shuffle of the slots */
+                bm_config.list[j].start = i * chunk;
+                bm_config.list[j].stop  = (i == cnt - 1) ? 0xffffffff
+                                                         : (i + 1) * chunk - 1;
+                bm_config.list[j].xlator = &bm_config.list[j];
+        }
+
+        for (i = 0; i < cnt; i++) {
+                j = bm_config.list[i].start / chunk;
+                if (j >= cnt)
+                        j = cnt - 1;
+                bm_config.search_start[j]  = bm_config.list[i].start;
+                bm_config.search_stop[j]   = bm_config.list[i].stop;
+                bm_config.search_xlator[j] = bm_config.list[i].xlator;
+        }
+
+        for (i = 0; i < bm_config.names; i++) {
+                snprintf (name, sizeof (name), "file-%ld.dat", i);
+                bm_config.hashes[i] = gf_dm_hashfn (name, strlen (name));
+        }
+
+        return 0;
+}
+
+static void *
+bm_search_linear (uint32_t hash)
+{
+        long i = 0;
+
+        for (i = 0; i < bm_config.subvols; i++) {
+                if (bm_config.list[i].start <= hash
+                    && bm_config.list[i].stop >= hash)
+                        return bm_config.list[i].xlator;
+        }
+
+        return NULL;
+}
+
+static void *
+bm_search_bisect (uint32_t hash)
+{
+        uint32_t *starts = bm_config.search_start;
+        long      base   = 0;
+        long      half   = 0;
+        long      n      = bm_config.subvols;
+
+        while (n > 1) {
+                half = n / 2;
+                base = (starts[base + half] <= hash) ? base + half : base;
+                n -= half;
+        }
+
+        if ((starts[base] <= hash) && (bm_config.search_stop[base] >= hash))
+                return bm_config.search_xlator[base];
+
+        return NULL;
+}
+
+static double
+bm_run (void *(*search) (uint32_t), const char *what)
+{
+        struct timeval start;
+        struct timeval end;
+        unsigned long  found = 0;
+        double         ns    = 0;
+        long           i     = 0;
+
+        gettimeofday (&start, NULL);
+        for (i = 0; i < bm_config.iters; i++) {
+                if (search (bm_config.hashes[i % bm_config.names]))
+                        found++;
+        }
+        gettimeofday (&end, NULL);
+
+        ns = ((end.tv_sec - start.tv_sec) * 1e9 +
+              (end.tv_usec - start.tv_usec) * 1e3) / bm_config.iters;
+
+        printf ("%-8s %8.1f ns/search (%lu of %ld found)\n", what, ns, found,
+                bm_config.iters);
+        return ns;
+}
+
+int
+main (int argc, char *argv[])
+{
+        long i = 0;
+
+        if (argp_parse (&argp, argc, argv, 0, 0, NULL) != 0) {
+                fprintf (stderr, "%s: argp_parse() failed\n", argv[0]);
+                return 1;
+        }
+
+        if (bm_layout_init () != 0) {
+                fprintf (stderr, "%s: out of memory\n", argv[0]);
+                return 1;
+        }
+
+        for (i = 0; i < bm_config.names; i++) {
+                if (bm_search_linear (bm_config.hashes[i]) !=
+                    bm_search_bisect (bm_config.hashes[i])) {
+                        fprintf (stderr, "%s: methods disagree on %u\n",
+                                 argv[0], bm_config.hashes[i]);
+                        return 1;
+                }
+        }
+
+        printf ("%ld subvolumes, %ld names\n", bm_config.subvols,
+                bm_config.names);
+        bm_run (bm_search_linear, "linear");
+        bm_run (bm_search_bisect, "bisect");
+
+        return 0;
+}
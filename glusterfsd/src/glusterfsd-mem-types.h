@@ -31,6 +31,7 @@ enum gfd_mem_types_ {
         gfd_mt_char,
         gfd_mt_call_pool_t,
         gfd_mt_vol_top_priv_t,
+        gfd_mt_heal_priv_t,
         gfd_mt_end
 
 };
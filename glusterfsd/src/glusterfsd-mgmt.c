@@ -649,33 +649,101 @@ out:
         return NULL;
 }
 
-int
-glusterfs_handle_translator_heal (rpcsvc_request_t *req)
+static int
+glusterfs_translator_heal_notify (dict_t *dict, int event, dict_t *output,
+                                  char *msg, size_t len)
 {
-        int32_t                  ret     = -1;
-        gd1_mgmt_brick_op_req    xlator_req = {0,};
-        dict_t                   *dict    = NULL;
+        int                      ret = -1;
         xlator_t                 *xlator = NULL;
         xlator_t                 *any = NULL;
-        dict_t                   *output = NULL;
-        char                     msg[2048] = {0};
         char                     key[2048] = {0};
         char                    *xname = NULL;
         glusterfs_ctx_t          *ctx = NULL;
         glusterfs_graph_t        *active = NULL;
-        xlator_t                 *this = NULL;
         int                      i = 0;
         int                      count = 0;
 
-        GF_ASSERT (req);
-        this = THIS;
-        GF_ASSERT (this);
-
         ctx = glusterfs_ctx_get ();
         GF_ASSERT (ctx);
 
         active = ctx->active;
         any = active->first;
+
+        ret = dict_get_int32 (dict, "count", &count);
+        i = 0;
+        while (i < count)  {
+                snprintf (key, sizeof (key), "heal-%d", i);
+                ret = dict_get_str (dict, key, &xname);
+                if (ret) {
+                        gf_log (THIS->name, GF_LOG_ERROR, "Couldn't get "
+                                "replicate xlator %s to trigger "
+                                "self-heal", key);
+                        goto out;
+                }
+                xlator = xlator_search_by_name (any, xname);
+                if (!xlator) {
+                        snprintf (msg, len, "xlator %s is not loaded", xname);
+                        ret = -1;
+                        goto out;
+                }
+
+                ret = xlator_notify (xlator, event, dict, output);
+                i++;
+        }
+out:
+        return ret;
+}
+
+/* Reading the indices of the bricks blocks on syncops, which must not
+ * happen in the thread the management rpc is served from. */
+static void *
+glusterfs_translator_heal_info (void *args)
+{
+        gfd_heal_priv_t          *priv = args;
+        dict_t                   *output = NULL;
+        char                     msg[2048] = {0};
+        int                      ret = -1;
+
+        output = dict_new ();
+        if (!output) {
+                gf_log (THIS->name, GF_LOG_ERROR, "failed to allocate "
+                        "the heal info dictionary");
+                goto out;
+        }
+
+        ret = glusterfs_translator_heal_notify (priv->dict,
+                                                GF_EVENT_TRANSLATOR_INFO,
+                                                output, msg, sizeof (msg));
+        glusterfs_translator_heal_response_send (priv->req, ret, msg, output);
+        dict_unref (output);
+out:
+        /* values of the dict point into the xdr input buffer */
+        dict_unref (priv->dict);
+        if (priv->xlator_req.input.input_val)
+                free (priv->xlator_req.input.input_val);
+        if (priv->xlator_req.name)
+                free (priv->xlator_req.name);
+        GF_FREE (priv);
+        return NULL;
+}
+
+int
+glusterfs_handle_translator_heal (rpcsvc_request_t *req)
+{
+        int32_t                  ret     = -1;
+        gd1_mgmt_brick_op_req    xlator_req = {0,};
+        dict_t                   *dict    = NULL;
+        dict_t                   *output = NULL;
+        char                     msg[2048] = {0};
+        xlator_t                 *this = NULL;
+        int32_t                  heal_op = GF_AFR_OP_HEAL_INDEX;
+        gfd_heal_priv_t          *priv = NULL;
+        pthread_t                tid;
+
+        GF_ASSERT (req);
+        this = THIS;
+        GF_ASSERT (this);
+
         if (!xdr_to_generic (req->msg[0], &xlator_req,
                              (xdrproc_t)xdr_gd1_mgmt_brick_op_req)) {
                 //failed to decode msg;
@@ -694,28 +762,35 @@ glusterfs_handle_translator_heal (rpcsvc_request_t *req)
                 goto out;
         }
 
-        ret = dict_get_int32 (dict, "count", &count);
-        i = 0;
-        while (i < count)  {
-                snprintf (key, sizeof (key), "heal-%d", i);
-                ret = dict_get_str (dict, key, &xname);
-                if (ret) {
-                        gf_log (this->name, GF_LOG_ERROR, "Couldn't get "
-                                "replicate xlator %s to trigger "
-                                "self-heal", xname);
+        ret = dict_get_int32 (dict, "heal-op", &heal_op);
+        if (ret)
+                heal_op = GF_AFR_OP_HEAL_INDEX;
+
+        if (heal_op == GF_AFR_OP_INDEX_SUMMARY) {
+                priv = GF_CALLOC (1, sizeof (*priv), gfd_mt_heal_priv_t);
+                if (!priv) {
+                        ret = -1;
                         goto out;
                 }
-                xlator = xlator_search_by_name (any, xname);
-                if (!xlator) {
-                        snprintf (msg, sizeof (msg), "xlator %s is not loaded",
-                                  xlator_req.name);
+                priv->req = req;
+                priv->dict = dict;
+                priv->xlator_req = xlator_req;
+                ret = pthread_create (&tid, NULL,
+                                      glusterfs_translator_heal_info, priv);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "Thread create failed");
+                        GF_FREE (priv);
                         ret = -1;
                         goto out;
                 }
-
-                ret = xlator_notify (xlator, GF_EVENT_TRIGGER_HEAL, dict, NULL);
-                i++;
+                pthread_detach (tid);
+                /* the thread owns the request now and replies to it */
+                return 0;
         }
+
+        ret = glusterfs_translator_heal_notify (dict, GF_EVENT_TRIGGER_HEAL,
+                                                NULL, msg, sizeof (msg));
         output = dict_new ();
         if (!output)
                 goto out;
@@ -93,6 +93,13 @@ struct _gfd_vol_top_priv_t {
 };
 typedef struct _gfd_vol_top_priv_t gfd_vol_top_priv_t;
 
+struct _gfd_heal_priv_t {
+        rpcsvc_request_t        *req;
+        gd1_mgmt_brick_op_req   xlator_req;
+        dict_t                  *dict;
+};
+typedef struct _gfd_heal_priv_t gfd_heal_priv_t;
+
 int glusterfs_mgmt_pmap_signout (glusterfs_ctx_t *ctx);
 int glusterfs_mgmt_pmap_signin (glusterfs_ctx_t *ctx);
 int glusterfs_volfile_fetch (glusterfs_ctx_t *ctx);
@@ -25,6 +25,7 @@
 #include <inttypes.h>
 
 #include "md5.h"
+#include "checksum.h"
 #include "call-stub.h"
 #include "mem-types.h"
 
@@ -2094,6 +2095,284 @@ out:
         return stub;
 }
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame,
+                    fop_fallocate_t fn,
+                    fd_t *fd,
+                    int32_t mode,
+                    off_t offset,
+                    size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.fallocate.fn = fn;
+
+        if (fd)
+                stub->args.fallocate.fd = fd_ref (fd);
+
+        stub->args.fallocate.mode = mode;
+        stub->args.fallocate.offset = offset;
+        stub->args.fallocate.len = len;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame,
+                        fop_fallocate_cbk_t fn,
+                        int32_t op_ret,
+                        int32_t op_errno,
+                        struct iatt *statpre,
+                        struct iatt *statpost)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_FALLOCATE);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.fallocate_cbk.fn = fn;
+
+        stub->args.fallocate_cbk.op_ret = op_ret;
+        stub->args.fallocate_cbk.op_errno = op_errno;
+
+        if (statpre)
+                stub->args.fallocate_cbk.statpre = *statpre;
+        if (statpost)
+                stub->args.fallocate_cbk.statpost = *statpost;
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame,
+                  fop_discard_t fn,
+                  fd_t *fd,
+                  off_t offset,
+                  size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.discard.fn = fn;
+
+        if (fd)
+                stub->args.discard.fd = fd_ref (fd);
+
+        stub->args.discard.offset = offset;
+        stub->args.discard.len = len;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame,
+                      fop_discard_cbk_t fn,
+                      int32_t op_ret,
+                      int32_t op_errno,
+                      struct iatt *statpre,
+                      struct iatt *statpost)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_DISCARD);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.discard_cbk.fn = fn;
+
+        stub->args.discard_cbk.op_ret = op_ret;
+        stub->args.discard_cbk.op_errno = op_errno;
+
+        if (statpre)
+                stub->args.discard_cbk.statpre = *statpre;
+        if (statpost)
+                stub->args.discard_cbk.statpost = *statpost;
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame,
+                   fop_zerofill_t fn,
+                   fd_t *fd,
+                   off_t offset,
+                   size_t len)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.zerofill.fn = fn;
+
+        if (fd)
+                stub->args.zerofill.fd = fd_ref (fd);
+
+        stub->args.zerofill.offset = offset;
+        stub->args.zerofill.len = len;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame,
+                       fop_zerofill_cbk_t fn,
+                       int32_t op_ret,
+                       int32_t op_errno,
+                       struct iatt *statpre,
+                       struct iatt *statpost)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_ZEROFILL);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.zerofill_cbk.fn = fn;
+
+        stub->args.zerofill_cbk.op_ret = op_ret;
+        stub->args.zerofill_cbk.op_errno = op_errno;
+
+        if (statpre)
+                stub->args.zerofill_cbk.statpre = *statpre;
+        if (statpost)
+                stub->args.zerofill_cbk.statpost = *statpost;
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_seek_stub (call_frame_t *frame,
+               fop_seek_t fn,
+               fd_t *fd,
+               off_t offset,
+               gf_seek_what_t what)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_SEEK);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.seek.fn = fn;
+
+        if (fd)
+                stub->args.seek.fd = fd_ref (fd);
+
+        stub->args.seek.offset = offset;
+        stub->args.seek.what = what;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_seek_cbk_stub (call_frame_t *frame,
+                   fop_seek_cbk_t fn,
+                   int32_t op_ret,
+                   int32_t op_errno,
+                   off_t offset)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_SEEK);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.seek_cbk.fn = fn;
+
+        stub->args.seek_cbk.op_ret = op_ret;
+        stub->args.seek_cbk.op_errno = op_errno;
+        stub->args.seek_cbk.offset = offset;
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_rchecksumv_stub (call_frame_t *frame,
+                     fop_rchecksumv_t fn,
+                     fd_t *fd,
+                     off_t offset,
+                     int32_t block_size,
+                     int32_t count,
+                     int32_t algo)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+        GF_VALIDATE_OR_GOTO ("call-stub", fn, out);
+
+        stub = stub_new (frame, 1, GF_FOP_RCHECKSUMV);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.rchecksumv.fn = fn;
+
+        if (fd)
+                stub->args.rchecksumv.fd = fd_ref (fd);
+
+        stub->args.rchecksumv.offset = offset;
+        stub->args.rchecksumv.block_size = block_size;
+        stub->args.rchecksumv.count = count;
+        stub->args.rchecksumv.algo = algo;
+
+out:
+        return stub;
+}
+
+call_stub_t *
+fop_rchecksumv_cbk_stub (call_frame_t *frame,
+                         fop_rchecksumv_cbk_t fn,
+                         int32_t op_ret,
+                         int32_t op_errno,
+                         int32_t algo,
+                         int32_t count,
+                         uint8_t *strong_checksums)
+{
+        call_stub_t *stub = NULL;
+
+        GF_VALIDATE_OR_GOTO ("call-stub", frame, out);
+
+        stub = stub_new (frame, 0, GF_FOP_RCHECKSUMV);
+        GF_VALIDATE_OR_GOTO ("call-stub", stub, out);
+
+        stub->args.rchecksumv_cbk.fn = fn;
+        stub->args.rchecksumv_cbk.op_ret = op_ret;
+        stub->args.rchecksumv_cbk.op_errno = op_errno;
+
+        if ((op_ret >= 0) && (count > 0) && strong_checksums) {
+                stub->args.rchecksumv_cbk.algo = algo;
+                stub->args.rchecksumv_cbk.count = count;
+                stub->args.rchecksumv_cbk.strong_checksums =
+                        memdup (strong_checksums, count * GF_RCHECKSUM_LEN);
+        }
+out:
+        return stub;
+}
+
 static void
 call_resume_wind (call_stub_t *stub)
 {
@@ -2480,6 +2759,54 @@ call_resume_wind (call_stub_t *stub)
                                         stub->args.fsetattr.valid);
                 break;
         }
+        case GF_FOP_FALLOCATE:
+        {
+                stub->args.fallocate.fn (stub->frame,
+                                         stub->frame->this,
+                                         stub->args.fallocate.fd,
+                                         stub->args.fallocate.mode,
+                                         stub->args.fallocate.offset,
+                                         stub->args.fallocate.len);
+                break;
+        }
+        case GF_FOP_DISCARD:
+        {
+                stub->args.discard.fn (stub->frame,
+                                       stub->frame->this,
+                                       stub->args.discard.fd,
+                                       stub->args.discard.offset,
+                                       stub->args.discard.len);
+                break;
+        }
+        case GF_FOP_ZEROFILL:
+        {
+                stub->args.zerofill.fn (stub->frame,
+                                        stub->frame->this,
+                                        stub->args.zerofill.fd,
+                                        stub->args.zerofill.offset,
+                                        stub->args.zerofill.len);
+                break;
+        }
+        case GF_FOP_SEEK:
+        {
+                stub->args.seek.fn (stub->frame,
+                                    stub->frame->this,
+                                    stub->args.seek.fd,
+                                    stub->args.seek.offset,
+                                    stub->args.seek.what);
+                break;
+        }
+        case GF_FOP_RCHECKSUMV:
+        {
+                stub->args.rchecksumv.fn (stub->frame,
+                                          stub->frame->this,
+                                          stub->args.rchecksumv.fd,
+                                          stub->args.rchecksumv.offset,
+                                          stub->args.rchecksumv.block_size,
+                                          stub->args.rchecksumv.count,
+                                          stub->args.rchecksumv.algo);
+                break;
+        }
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -3274,6 +3601,101 @@ call_resume_unwind (call_stub_t *stub)
                                 &stub->args.fsetattr_cbk.statpost);
                 break;
         }
+        case GF_FOP_FALLOCATE:
+        {
+                if (!stub->args.fallocate_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.fallocate_cbk.op_ret,
+                                      stub->args.fallocate_cbk.op_errno,
+                                      &stub->args.fallocate_cbk.statpre,
+                                      &stub->args.fallocate_cbk.statpost);
+                else
+                        stub->args.fallocate_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.fallocate_cbk.op_ret,
+                                stub->args.fallocate_cbk.op_errno,
+                                &stub->args.fallocate_cbk.statpre,
+                                &stub->args.fallocate_cbk.statpost);
+                break;
+        }
+        case GF_FOP_DISCARD:
+        {
+                if (!stub->args.discard_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.discard_cbk.op_ret,
+                                      stub->args.discard_cbk.op_errno,
+                                      &stub->args.discard_cbk.statpre,
+                                      &stub->args.discard_cbk.statpost);
+                else
+                        stub->args.discard_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.discard_cbk.op_ret,
+                                stub->args.discard_cbk.op_errno,
+                                &stub->args.discard_cbk.statpre,
+                                &stub->args.discard_cbk.statpost);
+                break;
+        }
+        case GF_FOP_ZEROFILL:
+        {
+                if (!stub->args.zerofill_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.zerofill_cbk.op_ret,
+                                      stub->args.zerofill_cbk.op_errno,
+                                      &stub->args.zerofill_cbk.statpre,
+                                      &stub->args.zerofill_cbk.statpost);
+                else
+                        stub->args.zerofill_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.zerofill_cbk.op_ret,
+                                stub->args.zerofill_cbk.op_errno,
+                                &stub->args.zerofill_cbk.statpre,
+                                &stub->args.zerofill_cbk.statpost);
+                break;
+        }
+        case GF_FOP_SEEK:
+        {
+                if (!stub->args.seek_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.seek_cbk.op_ret,
+                                      stub->args.seek_cbk.op_errno,
+                                      stub->args.seek_cbk.offset);
+                else
+                        stub->args.seek_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.seek_cbk.op_ret,
+                                stub->args.seek_cbk.op_errno,
+                                stub->args.seek_cbk.offset);
+                break;
+        }
+        case GF_FOP_RCHECKSUMV:
+        {
+                if (!stub->args.rchecksumv_cbk.fn)
+                        STACK_UNWIND (stub->frame,
+                                      stub->args.rchecksumv_cbk.op_ret,
+                                      stub->args.rchecksumv_cbk.op_errno,
+                                      stub->args.rchecksumv_cbk.algo,
+                                      stub->args.rchecksumv_cbk.count,
+                                      stub->args.rchecksumv_cbk.strong_checksums);
+                else
+                        stub->args.rchecksumv_cbk.fn (
+                                stub->frame,
+                                stub->frame->cookie,
+                                stub->frame->this,
+                                stub->args.rchecksumv_cbk.op_ret,
+                                stub->args.rchecksumv_cbk.op_errno,
+                                stub->args.rchecksumv_cbk.algo,
+                                stub->args.rchecksumv_cbk.count,
+                                stub->args.rchecksumv_cbk.strong_checksums);
+                break;
+        }
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -3586,6 +4008,36 @@ call_stub_destroy_wind (call_stub_t *stub)
                         fd_unref (stub->args.fsetattr.fd);
                 break;
         }
+        case GF_FOP_FALLOCATE:
+        {
+                if (stub->args.fallocate.fd)
+                        fd_unref (stub->args.fallocate.fd);
+                break;
+        }
+        case GF_FOP_DISCARD:
+        {
+                if (stub->args.discard.fd)
+                        fd_unref (stub->args.discard.fd);
+                break;
+        }
+        case GF_FOP_ZEROFILL:
+        {
+                if (stub->args.zerofill.fd)
+                        fd_unref (stub->args.zerofill.fd);
+                break;
+        }
+        case GF_FOP_SEEK:
+        {
+                if (stub->args.seek.fd)
+                        fd_unref (stub->args.seek.fd);
+                break;
+        }
+        case GF_FOP_RCHECKSUMV:
+        {
+                if (stub->args.rchecksumv.fd)
+                        fd_unref (stub->args.rchecksumv.fd);
+                break;
+        }
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
@@ -3808,6 +4260,33 @@ call_stub_destroy_unwind (call_stub_t *stub)
                 break;
         }
 
+        case GF_FOP_FALLOCATE:
+        {
+                break;
+        }
+
+        case GF_FOP_DISCARD:
+        {
+                break;
+        }
+
+        case GF_FOP_ZEROFILL:
+        {
+                break;
+        }
+
+        case GF_FOP_SEEK:
+        {
+                break;
+        }
+
+        case GF_FOP_RCHECKSUMV:
+        {
+                if (stub->args.rchecksumv_cbk.strong_checksums)
+                        GF_FREE (stub->args.rchecksumv_cbk.strong_checksums);
+                break;
+        }
+
         default:
         {
                 gf_log_callingfn ("call-stub", GF_LOG_ERROR,
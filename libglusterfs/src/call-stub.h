@@ -581,6 +581,84 @@ typedef struct {
                         struct iatt statpost;
                 } fsetattr_cbk;
 
+                /* fallocate */
+                struct {
+                        fop_fallocate_t fn;
+                        fd_t *fd;
+                        int32_t mode;
+                        off_t offset;
+                        size_t len;
+                } fallocate;
+                struct {
+                        fop_fallocate_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        struct iatt statpre;
+                        struct iatt statpost;
+                } fallocate_cbk;
+
+                /* discard */
+                struct {
+                        fop_discard_t fn;
+                        fd_t *fd;
+                        off_t offset;
+                        size_t len;
+                } discard;
+                struct {
+                        fop_discard_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        struct iatt statpre;
+                        struct iatt statpost;
+                } discard_cbk;
+
+                /* zerofill */
+                struct {
+                        fop_zerofill_t fn;
+                        fd_t *fd;
+                        off_t offset;
+                        size_t len;
+                } zerofill;
+                struct {
+                        fop_zerofill_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        struct iatt statpre;
+                        struct iatt statpost;
+                } zerofill_cbk;
+
+                /* seek */
+                struct {
+                        fop_seek_t fn;
+                        fd_t *fd;
+                        off_t offset;
+                        gf_seek_what_t what;
+                } seek;
+                struct {
+                        fop_seek_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        off_t offset;
+                } seek_cbk;
+
+                /* rchecksumv */
+                struct {
+                        fop_rchecksumv_t fn;
+                        fd_t *fd;
+                        off_t offset;
+                        int32_t block_size;
+                        int32_t count;
+                        int32_t algo;
+                } rchecksumv;
+                struct {
+                        fop_rchecksumv_cbk_t fn;
+                        int32_t op_ret;
+                        int32_t op_errno;
+                        int32_t algo;
+                        int32_t count;
+                        uint8_t *strong_checksums;
+                } rchecksumv_cbk;
+
 	} args;
 } call_stub_t;
 
@@ -1111,6 +1189,84 @@ fop_fsetattr_cbk_stub (call_frame_t *frame,
                        struct iatt *statpre,
                        struct iatt *statpost);
 
+call_stub_t *
+fop_fallocate_stub (call_frame_t *frame,
+                    fop_fallocate_t fn,
+                    fd_t *fd,
+                    int32_t mode,
+                    off_t offset,
+                    size_t len);
+
+call_stub_t *
+fop_fallocate_cbk_stub (call_frame_t *frame,
+                        fop_fallocate_cbk_t fn,
+                        int32_t op_ret,
+                        int32_t op_errno,
+                        struct iatt *statpre,
+                        struct iatt *statpost);
+
+call_stub_t *
+fop_discard_stub (call_frame_t *frame,
+                  fop_discard_t fn,
+                  fd_t *fd,
+                  off_t offset,
+                  size_t len);
+
+call_stub_t *
+fop_discard_cbk_stub (call_frame_t *frame,
+                      fop_discard_cbk_t fn,
+                      int32_t op_ret,
+                      int32_t op_errno,
+                      struct iatt *statpre,
+                      struct iatt *statpost);
+
+call_stub_t *
+fop_zerofill_stub (call_frame_t *frame,
+                   fop_zerofill_t fn,
+                   fd_t *fd,
+                   off_t offset,
+                   size_t len);
+
+call_stub_t *
+fop_zerofill_cbk_stub (call_frame_t *frame,
+                       fop_zerofill_cbk_t fn,
+                       int32_t op_ret,
+                       int32_t op_errno,
+                       struct iatt *statpre,
+                       struct iatt *statpost);
+
+call_stub_t *
+fop_seek_stub (call_frame_t *frame,
+               fop_seek_t fn,
+               fd_t *fd,
+               off_t offset,
+               gf_seek_what_t what);
+
+call_stub_t *
+fop_seek_cbk_stub (call_frame_t *frame,
+                   fop_seek_cbk_t fn,
+                   int32_t op_ret,
+                   int32_t op_errno,
+                   off_t offset);
+
+call_stub_t *
+fop_rchecksumv_stub (call_frame_t *frame,
+                     fop_rchecksumv_t fn,
+                     fd_t *fd,
+                     off_t offset,
+                     int32_t block_size,
+                     int32_t count,
+                     int32_t algo);
+
+call_stub_t *
+fop_rchecksumv_cbk_stub (call_frame_t *frame,
+                         fop_rchecksumv_cbk_t fn,
+                         int32_t op_ret,
+                         int32_t op_errno,
+                         int32_t algo,
+                         int32_t count,
+                         uint8_t *strong_checksums);
+
 void call_resume (call_stub_t *stub);
 void call_stub_destroy (call_stub_t *stub);
 #endif
@@ -76,3 +76,160 @@ gf_rsync_strong_checksum (char *buf, int32_t len, uint8_t *sum)
 
         return;
 }
+
+
+/*
+ * xxhash (XXH64) by Yann Collet, a non-cryptographic hash which runs at
+ * memory speed on the four independent lanes below. It is used instead of
+ * MD5 when comparing blocks for self-heal, where only accidental
+ * collisions matter. Input is always read as little endian, so that bricks
+ * of different byte order produce the same sums.
+ */
+
+#define XXH_PRIME64_1 11400714785074694791ULL
+#define XXH_PRIME64_2 14029467366897019727ULL
+#define XXH_PRIME64_3  1609587929392839161ULL
+#define XXH_PRIME64_4  9650029242287828579ULL
+#define XXH_PRIME64_5  2870177450012600261ULL
+
+#define XXH_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static inline uint64_t
+xxh_read64 (const uint8_t *p)
+{
+        return ((uint64_t) p[0])       | ((uint64_t) p[1] << 8)  |
+               ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24) |
+               ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) |
+               ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+static inline uint32_t
+xxh_read32 (const uint8_t *p)
+{
+        return ((uint32_t) p[0])       | ((uint32_t) p[1] << 8)  |
+               ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline uint64_t
+xxh64_round (uint64_t acc, uint64_t input)
+{
+        acc += input * XXH_PRIME64_2;
+        acc  = XXH_ROTL64 (acc, 31);
+        acc *= XXH_PRIME64_1;
+        return acc;
+}
+
+static inline uint64_t
+xxh64_merge_round (uint64_t acc, uint64_t val)
+{
+        val  = xxh64_round (0, val);
+        acc ^= val;
+        acc  = acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+        return acc;
+}
+
+static uint64_t
+gf_xxh64 (const uint8_t *p, size_t len, uint64_t seed)
+{
+        const uint8_t *end   = p + len;
+        const uint8_t *limit = NULL;
+        uint64_t       v1    = 0;
+        uint64_t       v2    = 0;
+        uint64_t       v3    = 0;
+        uint64_t       v4    = 0;
+        uint64_t       h64   = 0;
+
+        if (len >= 32) {
+                limit = end - 32;
+                v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+                v2 = seed + XXH_PRIME64_2;
+                v3 = seed;
+                v4 = seed - XXH_PRIME64_1;
+
+                do {
+                        v1 = xxh64_round (v1, xxh_read64 (p));
+                        v2 = xxh64_round (v2, xxh_read64 (p + 8));
+                        v3 = xxh64_round (v3, xxh_read64 (p + 16));
+                        v4 = xxh64_round (v4, xxh_read64 (p + 24));
+                        p += 32;
+                } while (p <= limit);
+
+                h64 = XXH_ROTL64 (v1, 1) + XXH_ROTL64 (v2, 7) +
+                      XXH_ROTL64 (v3, 12) + XXH_ROTL64 (v4, 18);
+                h64 = xxh64_merge_round (h64, v1);
+                h64 = xxh64_merge_round (h64, v2);
+                h64 = xxh64_merge_round (h64, v3);
+                h64 = xxh64_merge_round (h64, v4);
+        } else {
+                h64 = seed + XXH_PRIME64_5;
+        }
+
+        h64 += (uint64_t) len;
+
+        while ((p + 8) <= end) {
+                h64 ^= xxh64_round (0, xxh_read64 (p));
+                h64  = XXH_ROTL64 (h64, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+                p += 8;
+        }
+
+        if ((p + 4) <= end) {
+                h64 ^= (uint64_t) xxh_read32 (p) * XXH_PRIME64_1;
+                h64  = XXH_ROTL64 (h64, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+                p += 4;
+        }
+
+        while (p < end) {
+                h64 ^= (*p) * XXH_PRIME64_5;
+                h64  = XXH_ROTL64 (h64, 11) * XXH_PRIME64_1;
+                p++;
+        }
+
+        h64 ^= h64 >> 33;
+        h64 *= XXH_PRIME64_2;
+        h64 ^= h64 >> 29;
+        h64 *= XXH_PRIME64_3;
+        h64 ^= h64 >> 32;
+
+        return h64;
+}
+
+
+void
+gf_rsync_xxhash_checksum (char *buf, int32_t len, uint8_t *sum)
+{
+        uint64_t h1 = 0;
+        uint64_t h2 = 0;
+        int      i  = 0;
+
+        h1 = gf_xxh64 ((uint8_t *) buf, len, 0);
+        h2 = gf_xxh64 ((uint8_t *) buf, len, XXH_PRIME64_3);
+
+        for (i = 0; i < 8; i++) {
+                sum[i]     = (uint8_t) (h1 >> (8 * i));
+                sum[i + 8] = (uint8_t) (h2 >> (8 * i));
+        }
+
+        return;
+}
+
+
+/*
+ * Compute the strong checksum of 'buf' with 'algo'. Returns the algorithm
+ * actually used, MD5 when 'algo' is not known to this version.
+ */
+
+int
+gf_rchecksum_compute (int32_t algo, char *buf, int32_t len, uint8_t *sum)
+{
+        switch (algo) {
+        case GF_RCHECKSUM_XXHASH:
+                gf_rsync_xxhash_checksum (buf, len, sum);
+                break;
+        default:
+                algo = GF_RCHECKSUM_MD5;
+                gf_rsync_strong_checksum (buf, len, sum);
+                break;
+        }
+
+        return algo;
+}
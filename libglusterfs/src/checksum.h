@@ -24,4 +24,18 @@ uint32_t gf_rsync_weak_checksum (char *buf, int32_t len);
 
 void gf_rsync_strong_checksum (char *buf, int32_t len, uint8_t *sum);
 
+/* strong checksums of the batched rchecksumv fop, all GF_RCHECKSUM_LEN long */
+#define GF_RCHECKSUM_LEN         16
+#define GF_RCHECKSUM_MAX_BLOCKS  64
+
+typedef enum {
+        GF_RCHECKSUM_MD5 = 0,
+        GF_RCHECKSUM_XXHASH,     /* two seeded 64 bit xxhash sums */
+        GF_RCHECKSUM_ALGO_MAX,
+} gf_rchecksum_algo_t;
+
+void gf_rsync_xxhash_checksum (char *buf, int32_t len, uint8_t *sum);
+
+int gf_rchecksum_compute (int32_t algo, char *buf, int32_t len, uint8_t *sum);
+
 #endif /* __CHECKSUM_H__ */
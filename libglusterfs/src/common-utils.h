@@ -186,6 +186,22 @@ union gf_sock_union {
 
 #define GF_HIDDEN_PATH ".glusterfs"
 
+/* kept by storage/posix at the root of a brick, see posix.h */
+#define GF_RECLAIM_DIR       ".reclaim"
+#define GF_XATTROP_JOURNAL   ".xattrop-journal"
+
+/* names at the root of a brick that belong to the brick itself, not to
+   the volume; whatever walks a brick directly must not take them for
+   files of the volume */
+static inline int
+gf_is_brick_private_name (const char *name)
+{
+        return (!strcmp (name, GF_HIDDEN_PATH) ||
+                !strcmp (name, GF_REPLICATE_TRASH_DIR) ||
+                !strcmp (name, GF_RECLAIM_DIR) ||
+                !strcmp (name, GF_XATTROP_JOURNAL));
+}
+
 static inline void
 iov_free (struct iovec *vector, int count)
 {
@@ -55,8 +55,25 @@
 #define lsetxattr(path,key,value,size,flags) setxattr(path,key,value,size,flags)
 
 #endif /* HAVE_LLISTXATTR */
+
+#ifdef HAVE_LINUX_FALLOC_H
+#include <linux/falloc.h>
+#endif
 #endif /* GF_LINUX_HOST_OS */
 
+/* fallocate(2) modes, as understood by FUSE and storage/posix. Defined here
+ * for hosts (and older kernel headers) which do not provide them.
+ */
+#ifndef FALLOC_FL_KEEP_SIZE
+#define FALLOC_FL_KEEP_SIZE     0x01
+#endif
+#ifndef FALLOC_FL_PUNCH_HOLE
+#define FALLOC_FL_PUNCH_HOLE    0x02
+#endif
+#ifndef FALLOC_FL_ZERO_RANGE
+#define FALLOC_FL_ZERO_RANGE    0x10
+#endif
+
 #ifdef GF_BSD_HOST_OS
 /* In case of FreeBSD and NetBSD */
 
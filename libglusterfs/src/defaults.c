@@ -425,6 +425,51 @@ default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
 }
 
+int32_t
+default_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                       struct iatt *post)
+{
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, pre, post);
+        return 0;
+}
+
+int32_t
+default_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                     struct iatt *post)
+{
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, pre, post);
+        return 0;
+}
+
+int32_t
+default_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                      struct iatt *post)
+{
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, pre, post);
+        return 0;
+}
+
+int32_t
+default_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset);
+        return 0;
+}
+
+int32_t
+default_rchecksumv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, int32_t algo,
+                        int32_t count, uint8_t *strong_checksums)
+{
+        STACK_UNWIND_STRICT (rchecksumv, frame, op_ret, op_errno, algo, count,
+                             strong_checksums);
+        return 0;
+}
+
 /* RESUME */
 
 int32_t
@@ -801,6 +846,54 @@ default_fsetattr_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
         return 0;
 }
 
+int32_t
+default_fallocate_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                          int32_t keep_size, off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, keep_size, offset,
+                    len);
+        return 0;
+}
+
+int32_t
+default_discard_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_zerofill_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_seek_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset, gf_seek_what_t what)
+{
+        STACK_WIND (frame, default_seek_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->seek, fd, offset, what);
+        return 0;
+}
+
+int32_t
+default_rchecksumv_resume (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                           off_t offset, int32_t block_size, int32_t count,
+                           int32_t algo)
+{
+        STACK_WIND (frame, default_rchecksumv_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->rchecksumv, fd, offset,
+                    block_size, count, algo);
+        return 0;
+}
+
 /* FOPS */
 
 int32_t
@@ -1167,6 +1260,54 @@ default_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
         return 0;
 }
 
+int32_t
+default_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   int32_t keep_size, off_t offset, size_t len)
+{
+        STACK_WIND (frame, default_fallocate_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->fallocate, fd, keep_size, offset,
+                    len);
+        return 0;
+}
+
+int32_t
+default_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                 size_t len)
+{
+        STACK_WIND (frame, default_discard_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->discard, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                  size_t len)
+{
+        STACK_WIND (frame, default_zerofill_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->zerofill, fd, offset, len);
+        return 0;
+}
+
+int32_t
+default_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              gf_seek_what_t what)
+{
+        STACK_WIND (frame, default_seek_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->seek, fd, offset, what);
+        return 0;
+}
+
+int32_t
+default_rchecksumv (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                    off_t offset, int32_t block_size, int32_t count,
+                    int32_t algo)
+{
+        STACK_WIND (frame, default_rchecksumv_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->rchecksumv, fd, offset,
+                    block_size, count, algo);
+        return 0;
+}
+
 
 int32_t
 default_forget (xlator_t *this, inode_t *inode)
@@ -246,6 +246,39 @@ int32_t default_fsetattr (call_frame_t *frame,
                           struct iatt *stbuf,
                           int32_t valid);
 
+int32_t default_fallocate (call_frame_t *frame,
+                           xlator_t *this,
+                           fd_t *fd,
+                           int32_t keep_size,
+                           off_t offset,
+                           size_t len);
+
+int32_t default_discard (call_frame_t *frame,
+                         xlator_t *this,
+                         fd_t *fd,
+                         off_t offset,
+                         size_t len);
+
+int32_t default_zerofill (call_frame_t *frame,
+                          xlator_t *this,
+                          fd_t *fd,
+                          off_t offset,
+                          size_t len);
+
+int32_t default_seek (call_frame_t *frame,
+                      xlator_t *this,
+                      fd_t *fd,
+                      off_t offset,
+                      gf_seek_what_t what);
+
+int32_t default_rchecksumv (call_frame_t *frame,
+                            xlator_t *this,
+                            fd_t *fd,
+                            off_t offset,
+                            int32_t block_size,
+                            int32_t count,
+                            int32_t algo);
+
 /* Resume */
 int32_t default_getspec (call_frame_t *frame,
                          xlator_t *this,
@@ -464,6 +497,39 @@ int32_t default_fsetattr_resume (call_frame_t *frame,
                           struct iatt *stbuf,
                           int32_t valid);
 
+int32_t default_fallocate_resume (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  int32_t keep_size,
+                                  off_t offset,
+                                  size_t len);
+
+int32_t default_discard_resume (call_frame_t *frame,
+                                xlator_t *this,
+                                fd_t *fd,
+                                off_t offset,
+                                size_t len);
+
+int32_t default_zerofill_resume (call_frame_t *frame,
+                                 xlator_t *this,
+                                 fd_t *fd,
+                                 off_t offset,
+                                 size_t len);
+
+int32_t default_seek_resume (call_frame_t *frame,
+                             xlator_t *this,
+                             fd_t *fd,
+                             off_t offset,
+                             gf_seek_what_t what);
+
+int32_t default_rchecksumv_resume (call_frame_t *frame,
+                                   xlator_t *this,
+                                   fd_t *fd,
+                                   off_t offset,
+                                   int32_t block_size,
+                                   int32_t count,
+                                   int32_t algo);
+
 /* _cbk */
 
 int32_t
@@ -674,6 +740,30 @@ int32_t
 default_getspec_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, char *spec_data);
 
+int32_t
+default_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                       struct iatt *post);
+
+int32_t
+default_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                     struct iatt *post);
+
+int32_t
+default_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                      struct iatt *post);
+
+int32_t
+default_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, off_t offset);
+
+int32_t
+default_rchecksumv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, int32_t algo,
+                        int32_t count, uint8_t *strong_checksums);
+
 int32_t
 default_mem_acct_init (xlator_t *this);
 
@@ -84,6 +84,11 @@ gf_op_list_init()
         gf_fop_list[GF_FOP_FORGET]      = "FORGET";
         gf_fop_list[GF_FOP_RELEASE]     = "RELEASE";
         gf_fop_list[GF_FOP_RELEASEDIR]  = "RELEASEDIR";
+        gf_fop_list[GF_FOP_FALLOCATE]   = "FALLOCATE";
+        gf_fop_list[GF_FOP_DISCARD]     = "DISCARD";
+        gf_fop_list[GF_FOP_ZEROFILL]    = "ZEROFILL";
+        gf_fop_list[GF_FOP_SEEK]        = "SEEK";
+        gf_fop_list[GF_FOP_RCHECKSUMV]  = "RCHECKSUMV";
 
         gf_fop_list[GF_MGMT_NULL]  = "NULL";
         return;
@@ -91,6 +91,17 @@
 #define GLUSTERFS_INODELK_COUNT "glusterfs.inodelk-count"
 #define GLUSTERFS_ENTRYLK_COUNT "glusterfs.entrylk-count"
 #define GLUSTERFS_POSIXLK_COUNT "glusterfs.posixlk-count"
+
+/* pending-changelog index kept by features/index on the bricks.
+   getxattr of GF_XATTROP_INDEX_KEY (optionally suffixed with
+   ".<offset>" to resume) returns a batch of entries. */
+#define GF_XATTROP_INDEX_KEY       "glusterfs.xattrop-index"
+#define GF_XATTROP_INDEX_CHECK_KEY "glusterfs.xattrop-index-check"
+#define GF_INDEX_COUNT_KEY         "index-count"
+#define GF_INDEX_OFFSET_KEY        "index-offset"
+#define GF_INDEX_EOF_KEY           "index-eof"
+#define GF_INDEX_GFID_KEY          "index-gfid"
+#define GF_INDEX_PATH_KEY          "index-path"
 #define QUOTA_SIZE_KEY "trusted.glusterfs.quota.size"
 
 #define GLUSTERFS_RDMA_INLINE_THRESHOLD       (2048)
@@ -154,9 +165,20 @@ typedef enum {
         GF_FOP_RELEASE,
         GF_FOP_RELEASEDIR,
         GF_FOP_GETSPEC,
+        GF_FOP_FALLOCATE,
+        GF_FOP_DISCARD,
+        GF_FOP_ZEROFILL,
+        GF_FOP_SEEK,
+        GF_FOP_RCHECKSUMV,
         GF_FOP_MAXVALUE,
 } glusterfs_fop_t;
 
+/* what to look for in a seek fop, lseek(2) SEEK_DATA/SEEK_HOLE semantics */
+typedef enum {
+        GF_SEEK_DATA,
+        GF_SEEK_HOLE,
+} gf_seek_what_t;
+
 
 typedef enum {
         GF_MGMT_NULL = 0,
@@ -210,6 +232,14 @@ typedef enum {
         GF_LOCK_INTERNAL
 } gf_lk_domain_t;
 
+/* operations of 'volume heal', carried as "heal-op" to the self-heal
+   daemon */
+typedef enum {
+        GF_AFR_OP_HEAL_INDEX = 0,
+        GF_AFR_OP_HEAL_FULL,
+        GF_AFR_OP_INDEX_SUMMARY,
+} gf_xl_afr_op_t;
+
 
 typedef enum {
 	ENTRYLK_LOCK,
@@ -226,7 +256,8 @@ typedef enum {
 
 typedef enum {
 	GF_XATTROP_ADD_ARRAY,
-        GF_XATTROP_ADD_ARRAY64
+        GF_XATTROP_ADD_ARRAY64,
+        GF_XATTROP_OR_ARRAY
 } gf_xattrop_flags_t;
 
 
@@ -28,6 +28,7 @@
 #include <sys/types.h>
 #include <utime.h>
 #include <sys/time.h>
+#include <fcntl.h>
 
 int
 sys_lstat (const char *path, struct stat *buf)
@@ -245,6 +246,23 @@ sys_close (int fd)
 }
 
 
+int
+sys_fallocate (int fd, int mode, off_t offset, off_t len)
+{
+#ifdef HAVE_FALLOCATE
+        return fallocate (fd, mode, offset, len);
+#else
+        if (mode) {
+                errno = EOPNOTSUPP;
+                return -1;
+        }
+
+        errno = posix_fallocate (fd, offset, len);
+        return errno ? -1 : 0;
+#endif
+}
+
+
 int
 sys_fsync (int fd)
 {
@@ -110,6 +110,9 @@ sys_statvfs (const char *path, struct statvfs *buf);
 int
 sys_close (int fd);
 
+int
+sys_fallocate (int fd, int mode, off_t offset, off_t len);
+
 int
 sys_fsync (int fd);
 
@@ -422,6 +422,46 @@ typedef int32_t (*fop_fsetattr_cbk_t) (call_frame_t *frame,
                                        struct iatt *preop_stbuf,
                                        struct iatt *postop_stbuf);
 
+typedef int32_t (*fop_fallocate_cbk_t) (call_frame_t *frame,
+                                        void *cookie,
+                                        xlator_t *this,
+                                        int32_t op_ret,
+                                        int32_t op_errno,
+                                        struct iatt *preop_stbuf,
+                                        struct iatt *postop_stbuf);
+
+typedef int32_t (*fop_discard_cbk_t) (call_frame_t *frame,
+                                      void *cookie,
+                                      xlator_t *this,
+                                      int32_t op_ret,
+                                      int32_t op_errno,
+                                      struct iatt *preop_stbuf,
+                                      struct iatt *postop_stbuf);
+
+typedef int32_t (*fop_zerofill_cbk_t) (call_frame_t *frame,
+                                       void *cookie,
+                                       xlator_t *this,
+                                       int32_t op_ret,
+                                       int32_t op_errno,
+                                       struct iatt *preop_stbuf,
+                                       struct iatt *postop_stbuf);
+
+typedef int32_t (*fop_seek_cbk_t) (call_frame_t *frame,
+                                   void *cookie,
+                                   xlator_t *this,
+                                   int32_t op_ret,
+                                   int32_t op_errno,
+                                   off_t offset);
+
+typedef int32_t (*fop_rchecksumv_cbk_t) (call_frame_t *frame,
+                                         void *cookie,
+                                         xlator_t *this,
+                                         int32_t op_ret,
+                                         int32_t op_errno,
+                                         int32_t algo,
+                                         int32_t count,
+                                         uint8_t *strong_checksums);
+
 typedef int32_t (*fop_lookup_t) (call_frame_t *frame,
                                  xlator_t *this,
                                  loc_t *loc,
@@ -635,6 +675,39 @@ typedef int32_t (*fop_fsetattr_t) (call_frame_t *frame,
                                    struct iatt *stbuf,
                                    int32_t valid);
 
+typedef int32_t (*fop_fallocate_t) (call_frame_t *frame,
+                                    xlator_t *this,
+                                    fd_t *fd,
+                                    int32_t keep_size,
+                                    off_t offset,
+                                    size_t len);
+
+typedef int32_t (*fop_discard_t) (call_frame_t *frame,
+                                  xlator_t *this,
+                                  fd_t *fd,
+                                  off_t offset,
+                                  size_t len);
+
+typedef int32_t (*fop_zerofill_t) (call_frame_t *frame,
+                                   xlator_t *this,
+                                   fd_t *fd,
+                                   off_t offset,
+                                   size_t len);
+
+typedef int32_t (*fop_seek_t) (call_frame_t *frame,
+                               xlator_t *this,
+                               fd_t *fd,
+                               off_t offset,
+                               gf_seek_what_t what);
+
+typedef int32_t (*fop_rchecksumv_t) (call_frame_t *frame,
+                                     xlator_t *this,
+                                     fd_t *fd,
+                                     off_t offset,
+                                     int32_t block_size,
+                                     int32_t count,
+                                     int32_t algo);
+
 
 struct xlator_fops {
         fop_lookup_t         lookup;
@@ -678,6 +751,11 @@ struct xlator_fops {
         fop_setattr_t        setattr;
         fop_fsetattr_t       fsetattr;
         fop_getspec_t        getspec;
+        fop_fallocate_t      fallocate;
+        fop_discard_t        discard;
+        fop_zerofill_t       zerofill;
+        fop_seek_t           seek;
+        fop_rchecksumv_t     rchecksumv;
 
         /* these entries are used for a typechecking hack in STACK_WIND _only_ */
         fop_lookup_cbk_t         lookup_cbk;
@@ -721,6 +799,11 @@ struct xlator_fops {
         fop_setattr_cbk_t        setattr_cbk;
         fop_fsetattr_cbk_t       fsetattr_cbk;
         fop_getspec_cbk_t        getspec_cbk;
+        fop_fallocate_cbk_t      fallocate_cbk;
+        fop_discard_cbk_t        discard_cbk;
+        fop_zerofill_cbk_t       zerofill_cbk;
+        fop_seek_cbk_t           seek_cbk;
+        fop_rchecksumv_cbk_t     rchecksumv_cbk;
 };
 
 typedef int32_t (*cbk_forget_t) (xlator_t *this,
@@ -628,6 +628,15 @@ struct gf1_cli_heal_vol_req {
 };
 typedef struct gf1_cli_heal_vol_req gf1_cli_heal_vol_req;
 
+struct gf2_cli_heal_vol_req {
+	char *volname;
+	struct {
+		u_int dict_len;
+		char *dict_val;
+	} dict;
+};
+typedef struct gf2_cli_heal_vol_req gf2_cli_heal_vol_req;
+
 struct gf1_cli_heal_vol_rsp {
 	int op_ret;
 	int op_errno;
@@ -733,6 +742,7 @@ extern  bool_t xdr_gf1_cli_mount_rsp (XDR *, gf1_cli_mount_rsp*);
 extern  bool_t xdr_gf1_cli_umount_req (XDR *, gf1_cli_umount_req*);
 extern  bool_t xdr_gf1_cli_umount_rsp (XDR *, gf1_cli_umount_rsp*);
 extern  bool_t xdr_gf1_cli_heal_vol_req (XDR *, gf1_cli_heal_vol_req*);
+extern  bool_t xdr_gf2_cli_heal_vol_req (XDR *, gf2_cli_heal_vol_req*);
 extern  bool_t xdr_gf1_cli_heal_vol_rsp (XDR *, gf1_cli_heal_vol_rsp*);
 extern  bool_t xdr_gf1_cli_statedump_vol_req (XDR *, gf1_cli_statedump_vol_req*);
 extern  bool_t xdr_gf1_cli_statedump_vol_rsp (XDR *, gf1_cli_statedump_vol_rsp*);
@@ -809,6 +819,7 @@ extern bool_t xdr_gf1_cli_mount_rsp ();
 extern bool_t xdr_gf1_cli_umount_req ();
 extern bool_t xdr_gf1_cli_umount_rsp ();
 extern bool_t xdr_gf1_cli_heal_vol_req ();
+extern bool_t xdr_gf2_cli_heal_vol_req ();
 extern bool_t xdr_gf1_cli_heal_vol_rsp ();
 extern bool_t xdr_gf1_cli_statedump_vol_req ();
 extern bool_t xdr_gf1_cli_statedump_vol_rsp ();
@@ -462,6 +462,13 @@ struct gf1_cli_heal_vol_req {
        string volname<>;
 }  ;
 
+/* gf1_cli_heal_vol_req followed by a dict; older glusterds decode it as
+   the former and ignore the dict */
+struct gf2_cli_heal_vol_req {
+       string volname<>;
+       opaque dict<>;
+}  ;
+
 struct gf1_cli_heal_vol_rsp {
        int     op_ret;
        int     op_errno;
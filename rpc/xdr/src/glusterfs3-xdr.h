@@ -785,6 +785,91 @@ struct gfs3_readdirp_rsp {
 };
 typedef struct gfs3_readdirp_rsp gfs3_readdirp_rsp;
 
+struct gfs3_fallocate_req {
+	char gfid[16];
+	quad_t fd;
+	u_int flags;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_fallocate_req gfs3_fallocate_req;
+
+struct gfs3_fallocate_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_fallocate_rsp gfs3_fallocate_rsp;
+
+struct gfs3_discard_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_discard_req gfs3_discard_req;
+
+struct gfs3_discard_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_discard_rsp gfs3_discard_rsp;
+
+struct gfs3_zerofill_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	u_quad_t size;
+};
+typedef struct gfs3_zerofill_req gfs3_zerofill_req;
+
+struct gfs3_zerofill_rsp {
+	int op_ret;
+	int op_errno;
+	struct gf_iatt statpre;
+	struct gf_iatt statpost;
+};
+typedef struct gfs3_zerofill_rsp gfs3_zerofill_rsp;
+
+struct gfs3_seek_req {
+	char gfid[16];
+	quad_t fd;
+	u_quad_t offset;
+	int what;
+};
+typedef struct gfs3_seek_req gfs3_seek_req;
+
+struct gfs3_seek_rsp {
+	int op_ret;
+	int op_errno;
+	u_quad_t offset;
+};
+typedef struct gfs3_seek_rsp gfs3_seek_rsp;
+
+struct gfs3_rchecksumv_req {
+	quad_t fd;
+	u_quad_t offset;
+	u_int block_size;
+	u_int count;
+	int algo;
+};
+typedef struct gfs3_rchecksumv_req gfs3_rchecksumv_req;
+
+struct gfs3_rchecksumv_rsp {
+	int op_ret;
+	int op_errno;
+	int algo;
+	u_int count;
+	struct {
+		u_int strong_checksums_len;
+		char *strong_checksums_val;
+	} strong_checksums;
+};
+typedef struct gfs3_rchecksumv_rsp gfs3_rchecksumv_rsp;
+
 /* the xdr functions */
 
 #if defined(__STDC__) || defined(__cplusplus)
@@ -873,6 +958,16 @@ extern  bool_t xdr_gfs3_dirlist (XDR *, gfs3_dirlist*);
 extern  bool_t xdr_gfs3_readdir_rsp (XDR *, gfs3_readdir_rsp*);
 extern  bool_t xdr_gfs3_dirplist (XDR *, gfs3_dirplist*);
 extern  bool_t xdr_gfs3_readdirp_rsp (XDR *, gfs3_readdirp_rsp*);
+extern  bool_t xdr_gfs3_fallocate_req (XDR *, gfs3_fallocate_req*);
+extern  bool_t xdr_gfs3_fallocate_rsp (XDR *, gfs3_fallocate_rsp*);
+extern  bool_t xdr_gfs3_discard_req (XDR *, gfs3_discard_req*);
+extern  bool_t xdr_gfs3_discard_rsp (XDR *, gfs3_discard_rsp*);
+extern  bool_t xdr_gfs3_zerofill_req (XDR *, gfs3_zerofill_req*);
+extern  bool_t xdr_gfs3_zerofill_rsp (XDR *, gfs3_zerofill_rsp*);
+extern  bool_t xdr_gfs3_seek_req (XDR *, gfs3_seek_req*);
+extern  bool_t xdr_gfs3_seek_rsp (XDR *, gfs3_seek_rsp*);
+extern  bool_t xdr_gfs3_rchecksumv_req (XDR *, gfs3_rchecksumv_req*);
+extern  bool_t xdr_gfs3_rchecksumv_rsp (XDR *, gfs3_rchecksumv_rsp*);
 
 #else /* K&R C */
 extern bool_t xdr_gf_statfs ();
@@ -960,6 +1055,16 @@ extern bool_t xdr_gfs3_dirlist ();
 extern bool_t xdr_gfs3_readdir_rsp ();
 extern bool_t xdr_gfs3_dirplist ();
 extern bool_t xdr_gfs3_readdirp_rsp ();
+extern bool_t xdr_gfs3_fallocate_req ();
+extern bool_t xdr_gfs3_fallocate_rsp ();
+extern bool_t xdr_gfs3_discard_req ();
+extern bool_t xdr_gfs3_discard_rsp ();
+extern bool_t xdr_gfs3_zerofill_req ();
+extern bool_t xdr_gfs3_zerofill_rsp ();
+extern bool_t xdr_gfs3_seek_req ();
+extern bool_t xdr_gfs3_seek_rsp ();
+extern bool_t xdr_gfs3_rchecksumv_req ();
+extern bool_t xdr_gfs3_rchecksumv_rsp ();
 
 #endif /* K&R C */
 
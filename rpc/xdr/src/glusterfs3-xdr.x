@@ -614,3 +614,74 @@ struct gfs3_readdirp_rsp {
        struct gfs3_dirplist *reply;
 };
 
+struct gfs3_fallocate_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned int flags;
+        unsigned hyper offset;
+        unsigned hyper size;
+};
+
+struct gfs3_fallocate_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gf_iatt statpre;
+        struct gf_iatt statpost;
+};
+
+struct gfs3_discard_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned hyper offset;
+        unsigned hyper size;
+};
+
+struct gfs3_discard_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gf_iatt statpre;
+        struct gf_iatt statpost;
+};
+
+struct gfs3_zerofill_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned hyper offset;
+        unsigned hyper size;
+};
+
+struct gfs3_zerofill_rsp {
+        int    op_ret;
+        int    op_errno;
+        struct gf_iatt statpre;
+        struct gf_iatt statpost;
+};
+
+struct gfs3_seek_req {
+        opaque gfid[16];
+        hyper  fd;
+        unsigned hyper offset;
+        int    what;
+};
+
+struct gfs3_seek_rsp {
+        int    op_ret;
+        int    op_errno;
+        unsigned hyper offset;
+};
+
+struct gfs3_rchecksumv_req {
+        hyper  fd;
+        unsigned hyper offset;
+        unsigned int block_size;
+        unsigned int count;
+        int    algo;
+};
+
+struct gfs3_rchecksumv_rsp {
+        int    op_ret;
+        int    op_errno;
+        int    algo;
+        unsigned int count;
+        opaque strong_checksums<>;
+};
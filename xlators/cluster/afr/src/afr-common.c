@@ -64,6 +64,8 @@
 int
 afr_lookup_done_success_action (call_frame_t *frame, xlator_t *this,
                                 gf_boolean_t fail_conflict);
+static gf_boolean_t
+afr_lookup_is_cached_clean (xlator_t *this, afr_local_t *local, loc_t *loc);
 void
 afr_children_copy (int32_t *dst, int32_t *src, unsigned int child_count)
 {
@@ -108,7 +110,20 @@ afr_lookup_xattr_req_prepare (afr_local_t *local, xlator_t *this,
         if (xattr_req)
                 dict_copy (xattr_req, local->xattr_req);
 
-        afr_xattr_req_prepare (this, local->xattr_req, loc->path);
+        if (dict_get (local->xattr_req, AFR_LOOKUP_NO_HEAL_KEY)) {
+                local->cont.lookup.no_heal = _gf_true;
+                dict_del (local->xattr_req, AFR_LOOKUP_NO_HEAL_KEY);
+        }
+        if (dict_get (local->xattr_req, AFR_LOOKUP_FG_HEAL_KEY)) {
+                local->cont.lookup.foreground_heal = _gf_true;
+                dict_del (local->xattr_req, AFR_LOOKUP_FG_HEAL_KEY);
+        }
+
+        local->cont.lookup.cached_clean = afr_lookup_is_cached_clean (this,
+                                                                      local,
+                                                                      loc);
+        if (!local->cont.lookup.cached_clean)
+                afr_xattr_req_prepare (this, local->xattr_req, loc->path);
         ret = dict_set_uint64 (local->xattr_req, GLUSTERFS_INODELK_COUNT, 0);
         if (ret < 0) {
                 gf_log (this->name, GF_LOG_WARNING,
@@ -274,6 +289,9 @@ afr_inode_get_ctx (xlator_t *this, inode_t *inode, afr_inode_params_t *params)
                                 params->u.value = _gf_true;
                         ;
                         break;
+                case AFR_INODE_GET_CLEAN_GEN:
+                        params->u.gen = ctx->clean_gen;
+                        break;
                 default:
                         GF_ASSERT (0);
                         break;
@@ -350,6 +368,7 @@ afr_inode_ctx_rm_stale_children (afr_inode_ctx_t *ctx, int32_t read_child,
 
         GF_ASSERT (stale_children);
         afr_inode_ctx_set_read_child (ctx, read_child);
+        ctx->clean_gen = 0;
         for (i = 0; i < child_count; i++) {
                 if ((ctx->fresh_children[i] == -1) || (stale_children[i] == -1))
                         break;
@@ -379,6 +398,7 @@ afr_inode_ctx_set_splitbrain (afr_inode_ctx_t *ctx, gf_boolean_t set)
                 remaining_mask = (~AFR_ICTX_SPLIT_BRAIN_MASK & ctx->masks);
                 mask = (0xFFFFFFFFFFFFFFFFULL & AFR_ICTX_SPLIT_BRAIN_MASK);
                 ctx->masks = remaining_mask | mask;
+                ctx->clean_gen = 0;
         } else {
                 ctx->masks = (~AFR_ICTX_SPLIT_BRAIN_MASK & ctx->masks);
         }
@@ -430,6 +450,9 @@ afr_inode_set_ctx (xlator_t *this, inode_t *inode, afr_inode_params_t *params)
                         set = params->u.value;
                         afr_inode_ctx_set_splitbrain (ctx, set);
                         break;
+                case AFR_INODE_SET_CLEAN_GEN:
+                        ctx->clean_gen = params->u.gen;
+                        break;
                 default:
                         GF_ASSERT (0);
                         break;
@@ -455,6 +478,57 @@ afr_set_split_brain (xlator_t *this, inode_t *inode, gf_boolean_t set)
         afr_inode_set_ctx (this, inode, &params);
 }
 
+/* changes whenever a child comes up or goes down, never 0 */
+static uint64_t
+afr_event_gen (afr_private_t *priv)
+{
+        return priv->up_count + priv->down_count + 1;
+}
+
+static uint64_t
+afr_inode_get_clean_gen (xlator_t *this, inode_t *inode)
+{
+        afr_inode_params_t params = {0};
+
+        params.op = AFR_INODE_GET_CLEAN_GEN;
+        afr_inode_get_ctx (this, inode, &params);
+        return params.u.gen;
+}
+
+static void
+afr_inode_set_clean_gen (xlator_t *this, inode_t *inode, uint64_t gen)
+{
+        afr_inode_params_t params = {0};
+
+        params.op = AFR_INODE_SET_CLEAN_GEN;
+        params.u.gen = gen;
+        afr_inode_set_ctx (this, inode, &params);
+}
+
+/* the next lookup of @inode fetches the changelog again. Unlike
+   afr_inode_set_ctx this does not create a ctx, which would make the
+   next lookup of a new inode look like a revalidate */
+void
+afr_inode_clear_clean_gen (xlator_t *this, inode_t *inode)
+{
+        afr_inode_ctx_t *ctx      = NULL;
+        uint64_t        ctx_addr  = 0;
+        int             ret       = 0;
+
+        if (!inode)
+                return;
+
+        LOCK (&inode->lock);
+        {
+                ret = __inode_ctx_get (inode, this, &ctx_addr);
+                if ((ret == 0) && ctx_addr) {
+                        ctx = (afr_inode_ctx_t *) (long) ctx_addr;
+                        ctx->clean_gen = 0;
+                }
+        }
+        UNLOCK (&inode->lock);
+}
+
 void
 afr_set_opendir_done (xlator_t *this, inode_t *inode)
 {
@@ -645,6 +719,281 @@ out:
         return next_call_child;
 }
 
+afr_read_policy_t
+afr_read_policy_get (const char *str)
+{
+        afr_read_policy_t       policy = AFR_READ_POLICY_INODE;
+
+        if (!str)
+                goto out;
+        if (!strcmp (str, "gfid-hash"))
+                policy = AFR_READ_POLICY_GFID_HASH;
+        else if (!strcmp (str, "round-robin"))
+                policy = AFR_READ_POLICY_ROUND_ROBIN;
+        else if (!strcmp (str, "least-outstanding"))
+                policy = AFR_READ_POLICY_LEAST_PENDING;
+        else if (!strcmp (str, "latency"))
+                policy = AFR_READ_POLICY_LATENCY;
+out:
+        return policy;
+}
+
+static gf_boolean_t
+afr_read_policy_needs_stats (afr_private_t *priv)
+{
+        return (priv->child_stats &&
+                ((priv->read_policy == AFR_READ_POLICY_LEAST_PENDING) ||
+                 (priv->read_policy == AFR_READ_POLICY_LATENCY)));
+}
+
+/* Accounts a read wound to @child. @stats_child remembers whether it
+ * was accounted, the policy may change before the read returns.
+ */
+void
+afr_read_stats_begin (xlator_t *this, int32_t child, int32_t *stats_child,
+                      struct timeval *start)
+{
+        afr_private_t   *priv = NULL;
+
+        priv = this->private;
+        *stats_child = -1;
+        if (!afr_read_policy_needs_stats (priv))
+                return;
+
+        LOCK (&priv->read_child_lock);
+        {
+                priv->child_stats[child].pending++;
+        }
+        UNLOCK (&priv->read_child_lock);
+
+        *stats_child = child;
+        gettimeofday (start, NULL);
+}
+
+void
+afr_read_stats_end (xlator_t *this, int32_t *stats_child,
+                    struct timeval *start)
+{
+        afr_private_t     *priv = NULL;
+        afr_child_stats_t *stats = NULL;
+        struct timeval    now = {0,};
+        int64_t           took = 0;
+
+        priv = this->private;
+        if (*stats_child < 0)
+                return;
+
+        gettimeofday (&now, NULL);
+        took = (now.tv_sec - start->tv_sec) * 1000000 +
+               (now.tv_usec - start->tv_usec);
+        if (took < 1)
+                took = 1;
+
+        LOCK (&priv->read_child_lock);
+        {
+                stats = &priv->child_stats[*stats_child];
+                if (stats->pending)
+                        stats->pending--;
+                if (stats->latency)
+                        stats->latency = (stats->latency * 7 + took) / 8;
+                else
+                        stats->latency = took;
+        }
+        UNLOCK (&priv->read_child_lock);
+
+        *stats_child = -1;
+}
+
+/* Fills @candidates with the fresh children that are up and have @fd
+ * open, in the order of @fresh_children, and returns how many there are.
+ */
+int
+afr_read_candidates (xlator_t *this, fd_t *fd, unsigned char *child_up,
+                     int32_t *fresh_children, int32_t *candidates)
+{
+        afr_private_t *priv   = NULL;
+        afr_fd_ctx_t  *fd_ctx = NULL;
+        int            count  = 0;
+        int            i      = 0;
+        int            j      = 0;
+
+        priv = this->private;
+
+        fd_ctx = afr_fd_ctx_get (fd, this);
+        if (!fd_ctx)
+                goto out;
+
+        for (i = 0; i < priv->child_count; i++) {
+                j = fresh_children[i];
+                if (j == -1)
+                        break;
+                if (child_up[j] && (fd_ctx->opened_on[j] == AFR_FD_OPENED))
+                        candidates[count++] = j;
+        }
+out:
+        return count;
+}
+
+/* every so many reads the latency policy tries the children in turn,
+   so that the average of one that was slow once gets refreshed */
+#define AFR_READ_LATENCY_PROBE 64
+
+/* Picks the child a readv on @fd goes to, among the fresh children that
+ * are up and have @fd open, for the policies which decide per read.
+ * Returns -1 for the others and when read-subvolume is set, which takes
+ * precedence.
+ */
+int32_t
+afr_read_policy_child (xlator_t *this, fd_t *fd, unsigned char *child_up,
+                       int32_t *fresh_children)
+{
+        afr_private_t     *priv = NULL;
+        afr_child_stats_t *stats = NULL;
+        int32_t           *candidates = NULL;
+        int32_t           child = -1;
+        uint64_t          cost = 0;
+        uint64_t          best = 0;
+        unsigned int      rr = 0;
+        int               count = 0;
+        int               i = 0;
+        int               j = 0;
+
+        priv = this->private;
+        if (priv->read_child >= 0)
+                goto out;
+
+        switch (priv->read_policy) {
+        case AFR_READ_POLICY_ROUND_ROBIN:
+        case AFR_READ_POLICY_LEAST_PENDING:
+        case AFR_READ_POLICY_LATENCY:
+                break;
+        default:
+                goto out;
+        }
+
+        candidates = alloca (priv->child_count * sizeof (*candidates));
+        count = afr_read_candidates (this, fd, child_up, fresh_children,
+                                     candidates);
+        if (!count)
+                goto out;
+
+        LOCK (&priv->read_child_lock);
+        {
+                rr = priv->read_child_rr++;
+                child = candidates[rr % count];
+                if ((priv->read_policy == AFR_READ_POLICY_ROUND_ROBIN) ||
+                    !priv->child_stats)
+                        goto unlock;
+                if ((priv->read_policy == AFR_READ_POLICY_LATENCY) &&
+                    !(rr % AFR_READ_LATENCY_PROBE))
+                        goto unlock;
+
+                /* start at the round-robin one so that ties rotate */
+                for (i = 0; i < count; i++) {
+                        j = candidates[(rr + i) % count];
+                        stats = &priv->child_stats[j];
+                        if (priv->read_policy == AFR_READ_POLICY_LATENCY)
+                                cost = stats->latency * (stats->pending + 1);
+                        else
+                                cost = stats->pending;
+                        if (!i || (cost < best)) {
+                                best = cost;
+                                child = j;
+                        }
+                }
+        }
+unlock:
+        UNLOCK (&priv->read_child_lock);
+out:
+        return child;
+}
+
+/* whether @children, up or successful ones, make a client quorum. With
+   "auto" exactly half of them do when the first child is among them, so
+   that a replica pair split in two keeps one writable side. */
+gf_boolean_t
+afr_have_quorum (xlator_t *this, unsigned char *children)
+{
+        afr_private_t *priv  = NULL;
+        unsigned int   count = 0;
+        int            i     = 0;
+
+        priv = this->private;
+
+        if (!priv->quorum_count)
+                return _gf_true;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (children[i])
+                        count++;
+        }
+
+        if (priv->quorum_count != AFR_QUORUM_AUTO)
+                return (count >= priv->quorum_count);
+
+        if (count * 2 > priv->child_count)
+                return _gf_true;
+
+        return ((count * 2 == priv->child_count) && children[0]);
+}
+
+/* a len of 0 stands for everything from start on, as in the
+   transaction's lock */
+static gf_boolean_t
+afr_dirty_regions_span (off_t start, off_t len, uint64_t *first,
+                        uint64_t *last)
+{
+        if ((start < 0) || (len <= 0))
+                return _gf_false;
+
+        *first = start / AFR_DIRTY_REGION_SIZE;
+        *last  = (start + len - 1) / AFR_DIRTY_REGION_SIZE;
+
+        return ((*last - *first) < AFR_DIRTY_REGION_BITS);
+}
+
+void
+afr_dirty_regions_mark (unsigned char *regions, off_t start, off_t len)
+{
+        uint64_t first = 0;
+        uint64_t last  = 0;
+        uint64_t r     = 0;
+        int      bit   = 0;
+
+        if (!afr_dirty_regions_span (start, len, &first, &last)) {
+                memset (regions, 0xff, AFR_DIRTY_REGIONS_SIZE);
+                return;
+        }
+
+        for (r = first; r <= last; r++) {
+                bit = r % AFR_DIRTY_REGION_BITS;
+                regions[bit / 8] |= (1 << (bit % 8));
+        }
+}
+
+gf_boolean_t
+afr_dirty_regions_test (unsigned char *regions, off_t start, off_t len)
+{
+        uint64_t first = 0;
+        uint64_t last  = 0;
+        uint64_t r     = 0;
+        int      bit   = 0;
+
+        if (!regions)
+                return _gf_true;
+
+        if (!afr_dirty_regions_span (start, len, &first, &last))
+                return _gf_true;
+
+        for (r = first; r <= last; r++) {
+                bit = r % AFR_DIRTY_REGION_BITS;
+                if (regions[bit / 8] & (1 << (bit % 8)))
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
  /* This function should not be called with the inode's read_children array.
  * The fop's handler should make a copy of the inode's read_children,
  * preferred read_child into the local vars, because while this function is
@@ -788,6 +1137,9 @@ afr_local_sh_cleanup (afr_local_t *local, xlator_t *this)
 
         if (sh->write_needed)
                 GF_FREE (sh->write_needed);
+
+        if (sh->dirty_regions)
+                GF_FREE (sh->dirty_regions);
         if (sh->healing_fd)
                 fd_unref (sh->healing_fd);
 }
@@ -837,7 +1189,9 @@ afr_local_transaction_cleanup (afr_local_t *local, xlator_t *this)
 void
 afr_local_cleanup (afr_local_t *local, xlator_t *this)
 {
-        afr_private_t * priv = NULL;
+        afr_private_t     *priv   = NULL;
+        afr_read_stripe_t *stripe = NULL;
+        int                i      = 0;
 
         if (!local)
                 return;
@@ -866,6 +1220,18 @@ afr_local_cleanup (afr_local_t *local, xlator_t *this)
         if (local->fd_open_on)
                 GF_FREE (local->fd_open_on);
 
+        if (local->cont.readv.stripes) {
+                for (i = 0; i < local->cont.readv.stripe_count; i++) {
+                        stripe = &local->cont.readv.stripes[i];
+                        if (stripe->vector)
+                                GF_FREE (stripe->vector);
+                        if (stripe->iobref)
+                                iobref_unref (stripe->iobref);
+                }
+                GF_FREE (local->cont.readv.stripes);
+                GF_FREE (local->cont.readv.candidates);
+        }
+
         { /* lookup */
                 if (local->cont.lookup.xattrs) {
                         afr_reset_xattr (local->cont.lookup.xattrs,
@@ -1019,6 +1385,33 @@ afr_is_fresh_lookup (loc_t *loc, xlator_t *this)
         return _gf_true;
 }
 
+/*
+ * With lookup-cached-changelog, a revalidate of an inode an earlier
+ * lookup found clean skips fetching the changelog and is answered as
+ * soon as the read child replies, provided all children are up and
+ * none came or went since. The remaining replies are still compared,
+ * and whatever heal they call for is deferred.
+ */
+static gf_boolean_t
+afr_lookup_is_cached_clean (xlator_t *this, afr_local_t *local, loc_t *loc)
+{
+        afr_private_t   *priv = NULL;
+        uint64_t        gen   = 0;
+
+        priv = this->private;
+
+        if (!priv->lookup_cached_changelog || local->cont.lookup.no_heal ||
+            local->cont.lookup.foreground_heal)
+                return _gf_false;
+
+        if (afr_up_children_count (local->child_up, priv->child_count) !=
+            priv->child_count)
+                return _gf_false;
+
+        gen = afr_inode_get_clean_gen (this, loc->inode);
+        return (gen == afr_event_gen (priv));
+}
+
 void
 afr_update_loc_gfids (loc_t *loc, struct iatt *buf, struct iatt *postparent)
 {
@@ -1557,6 +1950,89 @@ afr_post_gfid_sh_success (call_frame_t *sh_frame, xlator_t *this)
                            sh->fresh_children, priv->child_count);
 }
 
+/* remembers whether this lookup found the inode clean, whether or not
+   the heals it would need are enabled */
+static void
+afr_lookup_update_clean_gen (afr_local_t *local, xlator_t *this)
+{
+        afr_private_t   *priv  = NULL;
+        afr_self_heal_t *sh    = NULL;
+        gf_boolean_t    clean  = _gf_false;
+
+        priv = this->private;
+        sh   = &local->self_heal;
+
+        if (!local->cont.lookup.inode)
+                return;
+
+        clean = ((local->op_ret == 0) &&
+                 (local->success_count == priv->child_count) &&
+                 !local->cont.lookup.no_heal &&
+                 !afr_is_transaction_running (local) &&
+                 !sh->do_data_self_heal && !sh->do_metadata_self_heal &&
+                 !sh->do_entry_self_heal && !sh->do_gfid_self_heal &&
+                 !sh->do_missing_entry_self_heal &&
+                 !afr_is_split_brain (this, local->cont.lookup.inode));
+
+        if (!clean)
+                afr_inode_clear_clean_gen (this, local->cont.lookup.inode);
+        else if (!local->cont.lookup.cached_clean)
+                afr_inode_set_clean_gen (this, local->cont.lookup.inode,
+                                         afr_event_gen (priv));
+}
+
+/*
+ * Heals are queued to afr_self_heal_defer instead of holding the lookup
+ * in a foreground heal once every background self-heal slot is taken.
+ * A lookup answered early by a cached clean revalidate has no frame to
+ * heal on, so its heals are always queued. Heals of the gfid or of
+ * conflicting entries change what the lookup returns and are not
+ * deferred; the next lookup does them.
+ */
+static gf_boolean_t
+afr_lookup_defer_self_heal (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv  = NULL;
+        afr_local_t     *local = NULL;
+        afr_self_heal_t *sh    = NULL;
+        gf_boolean_t    busy   = _gf_false;
+        int             ret    = 0;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+
+        if (!local->cont.lookup.orig_frame) {
+                if (local->cont.lookup.foreground_heal ||
+                    !priv->background_self_heal_count)
+                        return _gf_false;
+                if (sh->do_gfid_self_heal || sh->do_missing_entry_self_heal)
+                        return _gf_false;
+
+                LOCK (&priv->lock);
+                {
+                        busy = (priv->background_self_heals_started >=
+                                priv->background_self_heal_count);
+                }
+                UNLOCK (&priv->lock);
+                if (!busy)
+                        return _gf_false;
+        } else if (sh->do_gfid_self_heal || sh->do_missing_entry_self_heal) {
+                return _gf_true;
+        }
+
+        ret = afr_self_heal_defer (this, &local->loc,
+                                   local->cont.lookup.buf.ia_gfid);
+        if (ret)
+                gf_log (this->name, GF_LOG_DEBUG, "%s: could not queue "
+                        "self-heal", local->loc.path);
+        else
+                gf_log (this->name, GF_LOG_DEBUG, "%s: self-heal queued",
+                        local->loc.path);
+
+        return (local->cont.lookup.orig_frame || !ret);
+}
+
 static void
 afr_lookup_perform_self_heal (call_frame_t *frame, xlator_t *this,
                               gf_boolean_t *sh_launched)
@@ -1578,14 +2054,21 @@ afr_lookup_perform_self_heal (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        if (local->cont.lookup.no_heal)
+                goto out;
+
         afr_lookup_set_self_heal_params (local, this);
         if (afr_can_self_heal_proceed (&local->self_heal, priv)) {
                 if  (afr_is_transaction_running (local))
                         goto out;
 
+                if (afr_lookup_defer_self_heal (frame, this))
+                        goto out;
+
                 reason = "lookup detected pending operations";
                 afr_launch_self_heal (frame, this, local->cont.lookup.inode,
-                                      _gf_true, local->cont.lookup.buf.ia_type,
+                                      !local->cont.lookup.foreground_heal,
+                                      local->cont.lookup.buf.ia_type,
                                       reason, afr_post_gfid_sh_success,
                                       afr_self_heal_lookup_unwind);
                 *sh_launched = _gf_true;
@@ -1617,6 +2100,31 @@ afr_get_fresh_children (int32_t *success_children, int32_t *sources,
         }
 }
 
+/* spreads inodes over the fresh children by their gfid, so that every
+   client reads a given file from the same brick */
+static int32_t
+afr_gfid_hash_read_child (afr_local_t *local, afr_private_t *priv,
+                          int32_t read_child)
+{
+        unsigned char   *gfid = NULL;
+        uint32_t        hash = 0;
+        int             count = 0;
+        int             i = 0;
+
+        for (count = 0; count < priv->child_count; count++)
+                if (local->fresh_children[count] == -1)
+                        break;
+        if (!count)
+                goto out;
+
+        gfid = local->cont.lookup.bufs[read_child].ia_gfid;
+        for (i = 0; i < 16; i++)
+                hash = hash * 31 + gfid[i];
+        read_child = local->fresh_children[hash % count];
+out:
+        return read_child;
+}
+
 static int
 afr_lookup_set_read_ctx (afr_local_t *local, xlator_t *this, int32_t read_child)
 {
@@ -1628,6 +2136,9 @@ afr_lookup_set_read_ctx (afr_local_t *local, xlator_t *this, int32_t read_child)
         afr_get_fresh_children (local->cont.lookup.success_children,
                                 local->cont.lookup.sources,
                                 local->fresh_children, priv->child_count);
+        if ((priv->read_policy == AFR_READ_POLICY_GFID_HASH) &&
+            (priv->read_child < 0))
+                read_child = afr_gfid_hash_read_child (local, priv, read_child);
         afr_inode_set_read_ctx (this, local->cont.lookup.inode, read_child,
                                 local->fresh_children);
 
@@ -1686,6 +2197,38 @@ out:
         return ret;
 }
 
+/* a cached clean revalidate was wound on a copy of the lookup frame,
+   which is done with here whether or not the lookup was answered */
+static void
+afr_lookup_unwind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t         *local      = NULL;
+        call_frame_t        *orig_frame = NULL;
+
+        local      = frame->local;
+        orig_frame = local->cont.lookup.orig_frame;
+
+        if (!orig_frame) {
+                AFR_STACK_UNWIND (lookup, frame, local->op_ret,
+                                  local->op_errno, local->cont.lookup.inode,
+                                  &local->cont.lookup.buf,
+                                  local->cont.lookup.xattr,
+                                  &local->cont.lookup.postparent);
+                return;
+        }
+
+        if (local->op_ret < 0)
+                afr_inode_clear_clean_gen (this, local->loc.inode);
+
+        if (!local->cont.lookup.unwound)
+                STACK_UNWIND_STRICT (lookup, orig_frame, local->op_ret,
+                                     local->op_errno, local->cont.lookup.inode,
+                                     &local->cont.lookup.buf,
+                                     local->cont.lookup.xattr,
+                                     &local->cont.lookup.postparent);
+        AFR_STACK_DESTROY (frame);
+}
+
 static void
 afr_lookup_done (call_frame_t *frame, xlator_t *this)
 {
@@ -1724,18 +2267,16 @@ afr_lookup_done (call_frame_t *frame, xlator_t *this)
 
         afr_lookup_perform_self_heal (frame, this, &sh_launched);
         if (sh_launched) {
+                afr_inode_clear_clean_gen (this, local->cont.lookup.inode);
                 unwind = 0;
                 goto unwind;
         }
 
+        afr_lookup_update_clean_gen (local, this);
+
  unwind:
-         if (unwind) {
-                 AFR_STACK_UNWIND (lookup, frame, local->op_ret,
-                                   local->op_errno, local->cont.lookup.inode,
-                                   &local->cont.lookup.buf,
-                                   local->cont.lookup.xattr,
-                                   &local->cont.lookup.postparent);
-        }
+         if (unwind)
+                 afr_lookup_unwind (frame, this);
 }
 
 /*
@@ -1871,6 +2412,7 @@ afr_lookup_cbk (call_frame_t *frame, void *cookie,
         afr_local_t *   local = NULL;
         int             call_count      = -1;
         int             child_index     = -1;
+        gf_boolean_t    unwind_early    = _gf_false;
 
          child_index = (long) cookie;
 
@@ -1886,10 +2428,21 @@ afr_lookup_cbk (call_frame_t *frame, void *cookie,
                                            op_errno, inode, buf, xattr,
                                            postparent);
 
+                if (local->cont.lookup.orig_frame &&
+                    (child_index == local->read_child_index)) {
+                        local->cont.lookup.unwound = _gf_true;
+                        unwind_early = _gf_true;
+                }
          }
 unlock:
         UNLOCK (&frame->lock);
 
+        /* the other replies are still waited for on the copied frame */
+        if (unwind_early)
+                STACK_UNWIND_STRICT (lookup, local->cont.lookup.orig_frame,
+                                     op_ret, op_errno, inode, buf, xattr,
+                                     postparent);
+
         call_count = afr_frame_return (frame);
         if (call_count == 0) {
                afr_lookup_done (frame, this);
@@ -1948,6 +2501,7 @@ afr_lookup (call_frame_t *frame, xlator_t *this,
         int               call_count     = 0;
         uint64_t          ctx            = 0;
         int32_t           op_errno       = 0;
+        call_frame_t     *lookup_frame   = NULL;
 
         priv = this->private;
 
@@ -2017,6 +2571,17 @@ afr_lookup (call_frame_t *frame, xlator_t *this,
         afr_lookup_save_gfid (local->cont.lookup.gfid_req, gfid_req,
                               loc->inode);
         local->fop = GF_FOP_LOOKUP;
+
+        if (local->cont.lookup.cached_clean) {
+                lookup_frame = copy_frame (frame);
+                if (lookup_frame) {
+                        lookup_frame->local = local;
+                        frame->local = NULL;
+                        local->cont.lookup.orig_frame = frame;
+                        frame = lookup_frame;
+                }
+        }
+
         for (i = 0; i < priv->child_count; i++) {
                 if (local->child_up[i]) {
                         STACK_WIND_COOKIE (frame, afr_lookup_cbk,
@@ -2274,6 +2839,9 @@ afr_flush (call_frame_t *frame, xlator_t *this, fd_t *fd)
 
         priv = this->private;
 
+        /* the changelog should be clean once the fd is closed */
+        afr_delayed_changelog_wake_up (this, fd);
+
         ALLOC_OR_GOTO (local, afr_local_t, out);
 
         ret = AFR_LOCAL_INIT (local, priv);
@@ -2470,6 +3038,8 @@ afr_fsync (call_frame_t *frame, xlator_t *this, fd_t *fd,
 
         priv = this->private;
 
+        afr_delayed_changelog_wake_up (this, fd);
+
         ALLOC_OR_GOTO (local, afr_local_t, out);
 
         ret = AFR_LOCAL_INIT (local, priv);
@@ -3368,6 +3938,7 @@ afr_priv_dump (xlator_t *this)
         gf_proc_dump_add_section(key_prefix);
         gf_proc_dump_write("child_count", "%u", priv->child_count);
         gf_proc_dump_write("read_child_rr", "%u", priv->read_child_rr);
+        gf_proc_dump_write("read_policy", "%d", priv->read_policy);
         for (i = 0; i < priv->child_count; i++) {
                 sprintf (key, "child_up[%d]", i);
                 gf_proc_dump_write(key, "%d", priv->child_up[i]);
@@ -3388,6 +3959,7 @@ afr_priv_dump (xlator_t *this)
         gf_proc_dump_write("entry_lock_server_count", "%u",
                            priv->entry_lock_server_count);
         gf_proc_dump_write("wait_count", "%u", priv->wait_count);
+        gf_proc_dump_write("quorum_count", "%u", priv->quorum_count);
 
         return 0;
 }
@@ -3417,7 +3989,7 @@ find_child_index (xlator_t *this, xlator_t *child)
 
 int32_t
 afr_notify (xlator_t *this, int32_t event,
-            void *data, ...)
+            void *data, void *data2)
 {
         afr_private_t   *priv               = NULL;
         int             i                   = -1;
@@ -3430,12 +4002,19 @@ afr_notify (xlator_t *this, int32_t event,
         int             ret                 = -1;
         int             call_psh            = 0;
         int             up_child            = AFR_ALL_CHILDREN;
+        int32_t         heal_op             = GF_AFR_OP_HEAL_INDEX;
+        afr_crawl_type_t crawl              = AFR_CRAWL_INDEX;
 
         priv = this->private;
 
         if (!priv)
                 return 0;
 
+        /* 'volume heal info' from the self-heal daemon; not meant for
+           the parents */
+        if (event == GF_EVENT_TRANSLATOR_INFO)
+                return afr_xl_op (this, data, data2);
+
         had_heard_from_all = 1;
         for (i = 0; i < priv->child_count; i++) {
                 if (!priv->last_event[i]) {
@@ -3524,6 +4103,9 @@ afr_notify (xlator_t *this, int32_t event,
         case GF_EVENT_TRIGGER_HEAL:
                 gf_log (this->name, GF_LOG_INFO, "Self-heal was triggered"
                         " manually. Start crawling");
+                if (data && !dict_get_int32 (data, "heal-op", &heal_op) &&
+                    (heal_op == GF_AFR_OP_HEAL_FULL))
+                        crawl = AFR_CRAWL_FULL;
                 call_psh = 1;
                 break;
 
@@ -3580,7 +4162,7 @@ afr_notify (xlator_t *this, int32_t event,
         if (propagate)
                 ret = default_notify (this, event, data);
         if (call_psh)
-                afr_proactive_self_heal (this, up_child);
+                afr_proactive_self_heal (this, up_child, crawl);
 
 out:
         return ret;
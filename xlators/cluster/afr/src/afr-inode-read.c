@@ -415,6 +415,136 @@ out:
 
 /* }}} */
 
+/* {{{ seek */
+
+int32_t
+afr_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        afr_private_t   *priv           = NULL;
+        afr_local_t     *local          = NULL;
+        xlator_t        **children      = NULL;
+        int             unwind          = 1;
+        int32_t         *last_index     = NULL;
+        int32_t         next_call_child = -1;
+        int32_t         read_child      = -1;
+        int32_t         *fresh_children  = NULL;
+
+        priv     = this->private;
+        children = priv->children;
+
+        local = frame->local;
+
+        read_child = (long) cookie;
+
+        /* ENXIO means there is no more data, every replica agrees on that */
+        if ((op_ret == -1) && (op_errno != ENXIO)) {
+                last_index = &local->cont.seek.last_index;
+                fresh_children = local->fresh_children;
+                next_call_child = afr_next_call_child (fresh_children,
+                                                       local->child_up,
+                                                       priv->child_count,
+                                                       last_index, read_child);
+                if (next_call_child < 0)
+                        goto out;
+
+                unwind = 0;
+
+                STACK_WIND_COOKIE (frame, afr_seek_cbk,
+                                   (void *) (long) read_child,
+                                   children[next_call_child],
+                                   children[next_call_child]->fops->seek,
+                                   local->fd, local->cont.seek.offset,
+                                   local->cont.seek.what);
+        }
+
+out:
+        if (unwind) {
+                AFR_STACK_UNWIND (seek, frame, op_ret, op_errno, offset);
+        }
+
+        return 0;
+}
+
+
+int32_t
+afr_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+          gf_seek_what_t what)
+{
+        afr_private_t   *priv      = NULL;
+        afr_local_t     *local     = NULL;
+        xlator_t        **children = NULL;
+        int             call_child = 0;
+        int32_t         op_ret     = -1;
+        int32_t         op_errno   = 0;
+        int32_t         read_child = 0;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+        VALIDATE_OR_GOTO (this->private, out);
+
+        priv     = this->private;
+        VALIDATE_OR_GOTO (priv->children, out);
+
+        children = priv->children;
+
+        VALIDATE_OR_GOTO (fd->inode, out);
+
+        ALLOC_OR_GOTO (local, afr_local_t, out);
+        frame->local = local;
+
+        op_ret = AFR_LOCAL_INIT (local, priv);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                goto out;
+        }
+
+        local->fresh_children = afr_children_create (priv->child_count);
+        if (!local->fresh_children) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        read_child = afr_inode_get_read_ctx (this, fd->inode,
+                                             local->fresh_children);
+
+        op_ret = afr_get_call_child (this, local->child_up, read_child,
+                                     local->fresh_children,
+                                     &call_child,
+                                     &local->cont.seek.last_index);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+                goto out;
+        }
+
+        local->fd = fd_ref (fd);
+        local->cont.seek.offset = offset;
+        local->cont.seek.what   = what;
+
+        op_ret = afr_open_fd_fix (frame, this, _gf_false);
+        if (op_ret) {
+                op_errno = -op_ret;
+                op_ret = -1;
+                goto out;
+        }
+        STACK_WIND_COOKIE (frame, afr_seek_cbk, (void *) (long) call_child,
+                           children[call_child],
+                           children[call_child]->fops->seek,
+                           fd, offset, what);
+
+        op_ret = 0;
+out:
+        if (op_ret == -1) {
+                AFR_STACK_UNWIND (seek, frame, op_ret, op_errno, 0);
+        }
+
+        return 0;
+}
+
+/* }}} */
+
 /* {{{ readlink */
 
 int32_t
@@ -954,6 +1084,9 @@ afr_readv_cbk (call_frame_t *frame, void *cookie,
 
         read_child = (long) cookie;
 
+        afr_read_stats_end (this, &local->cont.readv.stats_child,
+                            &local->cont.readv.start);
+
         if (op_ret == -1) {
                 last_index = &local->cont.readv.last_index;
                 fresh_children = local->fresh_children;
@@ -966,6 +1099,10 @@ afr_readv_cbk (call_frame_t *frame, void *cookie,
 
                 unwind = 0;
 
+                afr_read_stats_begin (this, next_call_child,
+                                      &local->cont.readv.stats_child,
+                                      &local->cont.readv.start);
+
                 STACK_WIND_COOKIE (frame, afr_readv_cbk,
                                    (void *) (long) read_child,
                                    children[next_call_child],
@@ -984,6 +1121,229 @@ out:
 }
 
 
+/* no more pieces than this per readv, smaller stripes are only
+   interleaved */
+#define AFR_READ_STRIPES_MAX 64
+
+static void
+afr_readv_stripe_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t       *local    = NULL;
+        afr_read_stripe_t *stripes  = NULL;
+        struct iovec      *vector   = NULL;
+        struct iobref     *iobref   = NULL;
+        struct iatt       *buf      = NULL;
+        int32_t            op_ret   = 0;
+        int32_t            op_errno = 0;
+        int32_t            count    = 0;
+        int                used     = 0;
+        int                i        = 0;
+        int                j        = 0;
+
+        local   = frame->local;
+        stripes = local->cont.readv.stripes;
+
+        /* the reply is what was read contiguously from the offset: a
+           short piece is the end of file, the ones after it are empty */
+        for (used = 0; used < local->cont.readv.stripe_count; used++) {
+                if (stripes[used].op_ret < 0) {
+                        op_ret   = -1;
+                        op_errno = stripes[used].op_errno;
+                        goto unwind;
+                }
+                op_ret += stripes[used].op_ret;
+                count  += stripes[used].count;
+                if (stripes[used].op_ret < stripes[used].size) {
+                        used++;
+                        break;
+                }
+        }
+
+        buf = &stripes[used - 1].buf;
+        vector = GF_CALLOC (count ? count : 1, sizeof (*vector),
+                            gf_afr_mt_iovec);
+        iobref = iobref_new ();
+        if (!vector || !iobref) {
+                op_ret   = -1;
+                op_errno = ENOMEM;
+                goto unwind;
+        }
+
+        for (i = 0; i < used; i++) {
+                if (stripes[i].count) {
+                        memcpy (&vector[j], stripes[i].vector,
+                                stripes[i].count * sizeof (*vector));
+                        j += stripes[i].count;
+                }
+                if (stripes[i].iobref)
+                        iobref_merge (iobref, stripes[i].iobref);
+        }
+
+unwind:
+        if (op_ret == -1) {
+                count = 0;
+                buf   = NULL;
+        }
+
+        AFR_STACK_UNWIND (readv, frame, op_ret, op_errno, vector, count, buf,
+                          iobref);
+
+        if (vector)
+                GF_FREE (vector);
+        if (iobref)
+                iobref_unref (iobref);
+}
+
+int32_t
+afr_readv_stripe_cbk (call_frame_t *frame, void *cookie,
+                      xlator_t *this, int32_t op_ret, int32_t op_errno,
+                      struct iovec *vector, int32_t count, struct iatt *buf,
+                      struct iobref *iobref)
+{
+        afr_private_t     *priv       = NULL;
+        afr_local_t       *local      = NULL;
+        afr_read_stripe_t *stripe     = NULL;
+        int32_t            child      = -1;
+        int                call_count = 0;
+
+        priv   = this->private;
+        local  = frame->local;
+        stripe = &local->cont.readv.stripes[(long) cookie];
+
+        if (op_ret == -1) {
+                /* try the piece on the other candidates in turn */
+                stripe->tries++;
+                if (stripe->tries < local->cont.readv.candidate_count) {
+                        child = local->cont.readv.candidates[
+                                (stripe->pos + stripe->tries) %
+                                local->cont.readv.candidate_count];
+                        STACK_WIND_COOKIE (frame, afr_readv_stripe_cbk,
+                                           cookie, priv->children[child],
+                                           priv->children[child]->fops->readv,
+                                           local->fd, stripe->size,
+                                           stripe->offset);
+                        return 0;
+                }
+        }
+
+        stripe->op_ret   = op_ret;
+        stripe->op_errno = op_errno;
+        if (op_ret >= 0) {
+                stripe->buf = *buf;
+                if (count) {
+                        stripe->vector = iov_dup (vector, count);
+                        if (!stripe->vector) {
+                                stripe->op_ret   = -1;
+                                stripe->op_errno = ENOMEM;
+                        }
+                        stripe->count = count;
+                }
+                if (iobref)
+                        stripe->iobref = iobref_ref (iobref);
+        }
+
+        call_count = afr_frame_return (frame);
+        if (call_count == 0)
+                afr_readv_stripe_done (frame, this);
+
+        return 0;
+}
+
+/* With read-stripe-size set, the file is read in stripes of that size
+ * from each of the fresh children in turn, stripe n from the n-th modulo
+ * their number. A readv within one stripe only has its child chosen so,
+ * consecutive ones, like those of read-ahead, spread over the children;
+ * a larger one is split and its pieces read in parallel.
+ * Returns 0 when the pieces were wound, -1 when the readv goes to
+ * *call_child as a whole.
+ */
+static int
+afr_readv_stripe (call_frame_t *frame, xlator_t *this, int32_t *call_child)
+{
+        afr_private_t     *priv       = NULL;
+        afr_local_t       *local      = NULL;
+        afr_read_stripe_t *stripes    = NULL;
+        int32_t           *candidates = NULL;
+        uint64_t           stripe_size = 0;
+        uint64_t           first      = 0;
+        uint64_t           last       = 0;
+        off_t              start      = 0;
+        off_t              end        = 0;
+        int32_t            child      = -1;
+        int                count      = 0;
+        int                nstripes   = 0;
+        int                i          = 0;
+
+        priv  = this->private;
+        local = frame->local;
+
+        stripe_size = priv->read_stripe_size;
+        if (!stripe_size || !local->cont.readv.size)
+                goto out;
+
+        candidates = GF_CALLOC (priv->child_count, sizeof (*candidates),
+                                gf_afr_mt_int32_t);
+        if (!candidates)
+                goto out;
+
+        count = afr_read_candidates (this, local->fd, local->child_up,
+                                     local->fresh_children, candidates);
+        if (count < 2)
+                goto out;
+
+        first = local->cont.readv.offset / stripe_size;
+        last  = (local->cont.readv.offset + local->cont.readv.size - 1) /
+                stripe_size;
+
+        *call_child = candidates[first % count];
+        local->cont.readv.last_index = -1;
+
+        if ((first == last) || (last - first >= AFR_READ_STRIPES_MAX))
+                goto out;
+
+        nstripes = last - first + 1;
+        stripes = GF_CALLOC (nstripes, sizeof (*stripes),
+                             gf_afr_mt_read_stripe_t);
+        if (!stripes)
+                goto out;
+
+        for (i = 0; i < nstripes; i++) {
+                start = (first + i) * stripe_size;
+                end   = start + stripe_size;
+                if (start < local->cont.readv.offset)
+                        start = local->cont.readv.offset;
+                if (end > local->cont.readv.offset + local->cont.readv.size)
+                        end = local->cont.readv.offset +
+                              local->cont.readv.size;
+
+                stripes[i].offset = start;
+                stripes[i].size   = end - start;
+                stripes[i].pos    = (first + i) % count;
+        }
+
+        local->cont.readv.stripes         = stripes;
+        local->cont.readv.stripe_count    = nstripes;
+        local->cont.readv.candidates      = candidates;
+        local->cont.readv.candidate_count = count;
+        local->call_count                 = nstripes;
+
+        /* the last wind can unwind the frame */
+        for (i = 0; i < nstripes; i++) {
+                child = candidates[stripes[i].pos];
+                STACK_WIND_COOKIE (frame, afr_readv_stripe_cbk,
+                                   (void *) (long) i, priv->children[child],
+                                   priv->children[child]->fops->readv,
+                                   local->fd, stripes[i].size,
+                                   stripes[i].offset);
+        }
+
+        return 0;
+out:
+        if (candidates)
+                GF_FREE (candidates);
+        return -1;
+}
+
 int32_t
 afr_readv (call_frame_t *frame, xlator_t *this,
            fd_t *fd, size_t size, off_t offset)
@@ -1040,6 +1400,24 @@ afr_readv (call_frame_t *frame, xlator_t *this,
                 op_ret = -1;
                 goto out;
         }
+
+        if (priv->read_stripe_size && (priv->read_child < 0)) {
+                if (afr_readv_stripe (frame, this, &call_child) == 0) {
+                        op_ret = 0;
+                        goto out;
+                }
+        } else {
+                read_child = afr_read_policy_child (this, fd, local->child_up,
+                                                    local->fresh_children);
+                if (read_child >= 0) {
+                        call_child = read_child;
+                        local->cont.readv.last_index = -1;
+                }
+        }
+
+        afr_read_stats_begin (this, call_child,
+                              &local->cont.readv.stats_child,
+                              &local->cont.readv.start);
         STACK_WIND_COOKIE (frame, afr_readv_cbk,
                            (void *) (long) call_child,
                            children[call_child],
@@ -61,6 +61,18 @@ int
 afr_fsetattr (call_frame_t *frame, xlator_t *this,
               fd_t *fd, struct iatt *buf, int32_t valid);
 
+int
+afr_fallocate (call_frame_t *frame, xlator_t *this,
+               fd_t *fd, int32_t keep_size, off_t offset, size_t len);
+
+int
+afr_discard (call_frame_t *frame, xlator_t *this,
+             fd_t *fd, off_t offset, size_t len);
+
+int
+afr_zerofill (call_frame_t *frame, xlator_t *this,
+              fd_t *fd, off_t offset, size_t len);
+
 int32_t
 afr_setxattr (call_frame_t *frame, xlator_t *this,
 	      loc_t *loc, dict_t *dict, int32_t flags);
@@ -65,6 +65,20 @@ afr_set_lk_owner (call_frame_t *frame, xlator_t *this)
         frame->root->lk_owner = (uint64_t) (unsigned long)frame->root;
 }
 
+/* eager locks are only taken for transactions on an fd */
+static gf_boolean_t
+afr_is_eager_lock (xlator_t *this, afr_local_t *local)
+{
+        afr_private_t   *priv = NULL;
+
+        priv = this->private;
+
+        return (priv->eager_lock && local->fd &&
+                local->transaction.eager_lock &&
+                (local->internal_lock.transaction_lk_type ==
+                 AFR_TRANSACTION_LK));
+}
+
 static int
 is_afr_lock_selfheal (afr_local_t *local)
 {
@@ -570,9 +584,9 @@ afr_unlock_inodelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 
         int_lock->inode_locked_nodes[child_index] &= LOCKED_NO;
 
-        if (op_ret == 1) {
+        /* a blocking retry after this takes a plain range lock */
+        if (local->transaction.eager_lock)
                 local->transaction.eager_lock[child_index] = 0;
-        }
 
         afr_unlock_common_cbk (frame, cookie, this, op_ret, op_errno);
 
@@ -587,6 +601,8 @@ afr_unlock_inodelk (call_frame_t *frame, xlator_t *this)
         afr_local_t         *local    = NULL;
         afr_private_t       *priv     = NULL;
         struct gf_flock flock = {0,};
+        struct gf_flock full_flock = {0,};
+        struct gf_flock *flock_use = NULL;
         int call_count = 0;
         int i = 0;
         int piggyback = 0;
@@ -600,6 +616,7 @@ afr_unlock_inodelk (call_frame_t *frame, xlator_t *this)
         flock.l_start = int_lock->lk_flock.l_start;
         flock.l_len   = int_lock->lk_flock.l_len;
         flock.l_type  = F_UNLCK;
+        full_flock.l_type = F_UNLCK;
 
         gf_log (this->name, GF_LOG_DEBUG, "attempting data unlock range %"PRIu64
                 " %"PRIu64" by %"PRIu64, flock.l_start, flock.l_len,
@@ -626,10 +643,14 @@ afr_unlock_inodelk (call_frame_t *frame, xlator_t *this)
                         continue;
 
                 if (local->fd) {
-                        if (!local->transaction.eager_lock[i]) {
+                        flock_use = &flock;
+                        if (!local->transaction.eager_lock ||
+                            !local->transaction.eager_lock[i]) {
                                 goto wind;
                         }
 
+                        /* eager locks cover the whole file */
+                        flock_use = &full_flock;
                         piggyback = 0;
 
                         LOCK (&local->fd->lock);
@@ -637,6 +658,8 @@ afr_unlock_inodelk (call_frame_t *frame, xlator_t *this)
                                 if (fd_ctx->lock_piggyback[i]) {
                                         fd_ctx->lock_piggyback[i]--;
                                         piggyback = 1;
+                                } else {
+                                        fd_ctx->lock_acquired[i]--;
                                 }
                         }
                         UNLOCK (&local->fd->lock);
@@ -649,17 +672,17 @@ afr_unlock_inodelk (call_frame_t *frame, xlator_t *this)
                                 continue;
                         }
 
-                        fd_ctx->lock_acquired[i]--;
                 wind:
                         afr_trace_inodelk_in (frame, AFR_INODELK_TRANSACTION,
-                                              AFR_UNLOCK_OP, &flock, F_SETLK, i);
+                                              AFR_UNLOCK_OP, flock_use,
+                                              F_SETLK, i);
 
                         STACK_WIND_COOKIE (frame, afr_unlock_inodelk_cbk,
                                            (void *) (long)i,
                                            priv->children[i],
                                            priv->children[i]->fops->finodelk,
                                            this->name, local->fd,
-                                           F_SETLK, &flock);
+                                           F_SETLK, flock_use);
 
                         if (!--call_count)
                                 break;
@@ -1322,10 +1345,8 @@ afr_nonblocking_inodelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         int call_count  = 0;
         int child_index = (long) cookie;
         afr_fd_ctx_t        *fd_ctx = NULL;
-        afr_private_t       *priv     = NULL;
 
 
-        priv = this->private;
         local    = frame->local;
         int_lock = &local->internal_lock;
 
@@ -1355,7 +1376,7 @@ afr_nonblocking_inodelk_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         |= LOCKED_YES;
                 int_lock->inodelk_lock_count++;
 
-                if (priv->eager_lock && local->fd) {
+                if (afr_is_eager_lock (this, local)) {
                         fd_ctx = afr_fd_ctx_get (local->fd, this);
                         local->transaction.eager_lock[child_index] = 1;
                         /* piggybacked */
@@ -1463,7 +1484,7 @@ afr_nonblocking_inodelk (call_frame_t *frame, xlator_t *this)
                         if (!local->child_up[i] || !local->fd_open_on[i])
                                 continue;
 
-                        if (!priv->eager_lock)
+                        if (!afr_is_eager_lock (this, local))
                                 goto wind;
 
                         flock_use = &full_flock;
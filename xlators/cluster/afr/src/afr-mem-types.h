@@ -46,6 +46,13 @@ enum gf_afr_mem_types_ {
         gf_afr_fd_paused_call_t,
         gf_afr_mt_afr_crawl_data_t,
         gf_afr_mt_afr_brick_pos_t,
+        gf_afr_mt_sh_loop_delay_t,
+        gf_afr_mt_shd_heal_job_t,
+        gf_afr_mt_child_stats_t,
+        gf_afr_mt_sh_entry_scan_t,
+        gf_afr_mt_pump_copy_t,
+        gf_afr_mt_deferred_heal_t,
+        gf_afr_mt_read_stripe_t,
         gf_afr_mt_end
 };
 #endif
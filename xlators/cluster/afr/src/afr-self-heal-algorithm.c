@@ -34,6 +34,8 @@
 #include "compat.h"
 #include "byte-order.h"
 #include "md5.h"
+#include "checksum.h"
+#include "timer.h"
 
 #include "afr-transaction.h"
 #include "afr-self-heal.h"
@@ -51,6 +53,8 @@ static int
 sh_loop_return (call_frame_t *sh_frame, xlator_t *this, call_frame_t *loop_frame,
                 int32_t op_ret, int32_t op_errno);
 static int
+sh_diff_next_block (call_frame_t *loop_frame, xlator_t *this);
+static int
 sh_destroy_frame (call_frame_t *frame, xlator_t *this)
 {
         if (!frame)
@@ -186,8 +190,10 @@ sh_loop_lock_success (call_frame_t *loop_frame, xlator_t *this)
         loop_sh->old_loop_frame = NULL;
 
         gf_log (this->name, GF_LOG_DEBUG, "Aquired lock for range %"PRIu64
-                " %"PRIu64, loop_sh->offset, loop_sh->block_size);
+                " %"PRIu64, loop_sh->offset,
+                loop_sh->block_size * loop_sh->loop_blocks);
         loop_sh->data_lock_held = _gf_true;
+        gettimeofday (&loop_sh->loop_start, NULL);
         loop_sh->sh_data_algo_start (loop_frame, this);
         return 0;
 }
@@ -204,7 +210,8 @@ sh_loop_lock_failure (call_frame_t *loop_frame, xlator_t *this)
         sh_frame = loop_sh->sh_frame;
 
         gf_log (this->name, GF_LOG_ERROR, "failed lock for range %"PRIu64
-                " %"PRIu64, loop_sh->offset, loop_sh->block_size);
+                " %"PRIu64, loop_sh->offset,
+                loop_sh->block_size * loop_sh->loop_blocks);
         if (loop_sh->old_loop_frame != loop_sh->sh_frame)
                 sh_loop_finish (loop_sh->old_loop_frame, this);
         loop_sh->old_loop_frame = NULL;
@@ -248,11 +255,15 @@ sh_loop_start (call_frame_t *sh_frame, xlator_t *this, off_t offset,
                                                gf_afr_mt_char);
         if (!new_loop_sh->write_needed)
                 goto out;
-        new_loop_sh->checksum = GF_CALLOC (priv->child_count, MD5_DIGEST_LEN,
+        new_loop_sh->checksum = GF_CALLOC (priv->child_count *
+                                           sh->private->loop_blocks,
+                                           GF_RCHECKSUM_LEN,
                                            gf_afr_mt_uint8_t);
         if (!new_loop_sh->checksum)
                 goto out;
         new_loop_sh->offset = offset;
+        new_loop_sh->loop_offset = offset;
+        new_loop_sh->loop_blocks = sh->private->loop_blocks;
         new_loop_sh->block_size = sh->block_size;
         new_loop_sh->inode      = inode_ref (sh->inode);
         new_loop_sh->sh_data_algo_start = sh->sh_data_algo_start;
@@ -263,7 +274,8 @@ sh_loop_start (call_frame_t *sh_frame, xlator_t *this, off_t offset,
         new_loop_sh->loop_completion_cbk = sh_destroy_frame;
         new_loop_sh->old_loop_frame = old_loop_frame;
         new_loop_sh->sh_frame = sh_frame;
-        afr_sh_data_lock (new_loop_frame, this, offset, new_loop_sh->block_size,
+        afr_sh_data_lock (new_loop_frame, this, offset,
+                          new_loop_sh->block_size * new_loop_sh->loop_blocks,
                           sh_loop_lock_success, sh_loop_lock_failure);
         return 0;
 out:
@@ -277,6 +289,232 @@ out:
         return 0;
 }
 
+/*
+ * Self-heal bandwidth throttle. Loops take their size out of a token
+ * bucket refilled at throttle->rate bytes a second and wait when it
+ * runs dry. The rate starts at self-heal-bandwidth and follows the
+ * time loops take per MB: when that grows well past the best seen
+ * lately the bricks are busy serving something else, so the rate is
+ * halved, otherwise it creeps back up to the configured one.
+ */
+#define SH_THROTTLE_ADJUST_USEC 1000000
+
+static uint64_t
+sh_throttle_take (xlator_t *this, uint64_t bytes)
+{
+        afr_private_t               *priv     = NULL;
+        afr_heal_throttle_t         *throttle = NULL;
+        struct timeval              now       = {0,};
+        uint64_t                    bandwidth = 0;
+        int64_t                     elapsed   = 0;
+        uint64_t                    wait      = 0;
+
+        priv     = this->private;
+        throttle = &priv->heal_throttle;
+
+        bandwidth = priv->self_heal_bandwidth;
+        if (!bandwidth)
+                goto out;
+
+        gettimeofday (&now, NULL);
+        LOCK (&throttle->lock);
+        {
+                if (!throttle->rate) {
+                        throttle->rate = bandwidth;
+                        throttle->tokens = bandwidth;
+                        throttle->last = now;
+                        throttle->last_adjust = now;
+                }
+                if (throttle->rate > bandwidth)
+                        throttle->rate = bandwidth;
+
+                elapsed = (now.tv_sec - throttle->last.tv_sec) * 1000000 +
+                          (now.tv_usec - throttle->last.tv_usec);
+                if (elapsed > 1000000)
+                        elapsed = 1000000;
+                if (elapsed > 0)
+                        throttle->tokens += throttle->rate * elapsed / 1000000;
+                if (throttle->tokens > (int64_t)throttle->rate)
+                        throttle->tokens = throttle->rate;
+                throttle->last = now;
+
+                throttle->tokens -= bytes;
+                if (throttle->tokens < 0)
+                        wait = (-throttle->tokens) * 1000000 / throttle->rate;
+        }
+        UNLOCK (&throttle->lock);
+out:
+        return wait;
+}
+
+static void
+sh_throttle_update (xlator_t *this, afr_self_heal_t *loop_sh)
+{
+        afr_private_t               *priv     = NULL;
+        afr_heal_throttle_t         *throttle = NULL;
+        struct timeval              now       = {0,};
+        uint64_t                    bandwidth = 0;
+        uint64_t                    bytes     = 0;
+        int64_t                     took      = 0;
+        uint64_t                    cost      = 0;
+
+        priv     = this->private;
+        throttle = &priv->heal_throttle;
+
+        bandwidth = priv->self_heal_bandwidth;
+        bytes = loop_sh->block_size * loop_sh->loop_blocks;
+        if (!bandwidth || !bytes || !loop_sh->loop_start.tv_sec)
+                goto out;
+
+        gettimeofday (&now, NULL);
+        took = (now.tv_sec - loop_sh->loop_start.tv_sec) * 1000000 +
+               (now.tv_usec - loop_sh->loop_start.tv_usec);
+        if (took <= 0)
+                goto out;
+        cost = took * 1048576 / bytes;
+
+        LOCK (&throttle->lock);
+        {
+                if (throttle->latency)
+                        throttle->latency = (throttle->latency * 7 + cost) / 8;
+                else
+                        throttle->latency = cost;
+                if (!throttle->floor || (cost < throttle->floor))
+                        throttle->floor = cost;
+
+                if (((now.tv_sec - throttle->last_adjust.tv_sec) * 1000000 +
+                     (now.tv_usec - throttle->last_adjust.tv_usec)) <
+                    SH_THROTTLE_ADJUST_USEC)
+                        goto unlock;
+
+                if (throttle->latency > 2 * throttle->floor) {
+                        throttle->rate /= 2;
+                        if (throttle->rate < bandwidth / 16)
+                                throttle->rate = bandwidth / 16;
+                } else {
+                        throttle->rate += bandwidth / 16;
+                }
+                if (throttle->rate > bandwidth)
+                        throttle->rate = bandwidth;
+                if (!throttle->rate)
+                        throttle->rate = 1;
+                /* let the baseline follow lasting changes of the load */
+                throttle->floor += throttle->floor / 32 + 1;
+                throttle->last_adjust = now;
+
+                gf_log (this->name, GF_LOG_DEBUG, "self-heal rate %"PRIu64
+                        " bytes/sec (%"PRIu64" usec/MB, best %"PRIu64")",
+                        throttle->rate, throttle->latency, throttle->floor);
+        }
+unlock:
+        UNLOCK (&throttle->lock);
+out:
+        return;
+}
+
+typedef struct sh_loop_delay_ {
+        xlator_t        *this;
+        call_frame_t    *sh_frame;
+        off_t           offset;
+        gf_lock_t       lock;
+        gf_timer_t      *timer;
+} sh_loop_delay_t;
+
+static void
+sh_loop_delayed_start (void *data)
+{
+        sh_loop_delay_t             *delay = data;
+        gf_timer_t                  *timer = NULL;
+
+        THIS = delay->this;
+
+        /* the event fired, it is up to us to free it */
+        LOCK (&delay->lock);
+        {
+                timer = delay->timer;
+                delay->timer = NULL;
+        }
+        UNLOCK (&delay->lock);
+        if (timer)
+                gf_timer_call_cancel (delay->this->ctx, timer);
+
+        sh_loop_start (delay->sh_frame, delay->this, delay->offset, NULL);
+
+        LOCK_DESTROY (&delay->lock);
+        GF_FREE (delay);
+}
+
+/* starts the loop at @offset once the throttle lets it */
+static int
+sh_loop_schedule (call_frame_t *sh_frame, xlator_t *this, off_t offset,
+                  call_frame_t *old_loop_frame)
+{
+        afr_local_t                 *local = NULL;
+        afr_self_heal_t             *sh    = NULL;
+        sh_loop_delay_t             *delay = NULL;
+        gf_timer_t                  *timer = NULL;
+        struct timeval              delta  = {0,};
+        uint64_t                    wait   = 0;
+
+        local = sh_frame->local;
+        sh    = &local->self_heal;
+
+        wait = sh_throttle_take (this, sh->block_size *
+                                 sh->private->loop_blocks);
+        if (!wait)
+                goto start;
+
+        delay = GF_CALLOC (1, sizeof (*delay), gf_afr_mt_sh_loop_delay_t);
+        if (!delay)
+                goto start;
+        delay->this = this;
+        delay->sh_frame = sh_frame;
+        delay->offset = offset;
+        LOCK_INIT (&delay->lock);
+
+        /* the region of the old loop must not stay locked while the
+           throttle holds the next one back */
+        if (old_loop_frame) {
+                sh_loop_finish (old_loop_frame, this);
+                old_loop_frame = NULL;
+        }
+
+        delta.tv_sec = wait / 1000000;
+        delta.tv_usec = wait % 1000000;
+
+        LOCK (&delay->lock);
+        {
+                timer = gf_timer_call_after (this->ctx, delta,
+                                             sh_loop_delayed_start, delay);
+                delay->timer = timer;
+        }
+        UNLOCK (&delay->lock);
+
+        if (timer)
+                return 0;
+
+        LOCK_DESTROY (&delay->lock);
+        GF_FREE (delay);
+start:
+        return sh_loop_start (sh_frame, this, offset, old_loop_frame);
+}
+
+/* first loop from @offset on which covers a dirty region, when the
+   heal is limited to those */
+static off_t
+sh_loop_next_dirty (afr_self_heal_t *sh, off_t offset, off_t loop_size)
+{
+        if (!sh->dirty_regions)
+                return offset;
+
+        while ((offset < sh->file_size) &&
+               !afr_dirty_regions_test (sh->dirty_regions, offset,
+                                        loop_size))
+                offset += loop_size;
+
+        return offset;
+}
+
 static int
 sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
                 gf_boolean_t is_first_call, call_frame_t *old_loop_frame)
@@ -286,7 +524,7 @@ sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
         afr_self_heal_t *           sh             = NULL;
         afr_sh_algo_private_t       *sh_priv        = NULL;
         gf_boolean_t                is_driver_done = _gf_false;
-        blksize_t                   block_size     = 0;
+        off_t                       loop_size      = 0;
         int                         loop           = 0;
         off_t                       offset         = 0;
 
@@ -299,14 +537,19 @@ sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
         {
                 if (_gf_false == is_first_call)
                         sh_priv->loops_running--;
+                loop_size = sh->block_size * sh_priv->loop_blocks;
+                sh_priv->offset = sh_loop_next_dirty (sh, sh_priv->offset,
+                                                      loop_size);
                 offset = sh_priv->offset;
-                block_size = sh->block_size;
                 while ((!sh->eof_reached) && (0 == sh->op_failed) &&
                        (sh_priv->loops_running < priv->data_self_heal_window_size)
                        && (sh_priv->offset < sh->file_size)) {
 
                         loop++;
-                        sh_priv->offset += block_size;
+                        sh_priv->offset += loop_size;
+                        sh_priv->offset = sh_loop_next_dirty (sh,
+                                                              sh_priv->offset,
+                                                              loop_size);
                         sh_priv->loops_running++;
 
                         if (_gf_false == is_first_call)
@@ -343,9 +586,11 @@ sh_loop_driver (call_frame_t *sh_frame, xlator_t *this,
                         gf_log (this->name, GF_LOG_TRACE, "spawning a loop "
                                 "for offset %"PRId64, offset);
 
-                        sh_loop_start (sh_frame, this, offset, old_loop_frame);
+                        sh_loop_schedule (sh_frame, this, offset,
+                                          old_loop_frame);
                         old_loop_frame = NULL;
-                        offset += block_size;
+                        offset = sh_loop_next_dirty (sh, offset + loop_size,
+                                                     loop_size);
                 }
         }
 
@@ -376,6 +621,8 @@ sh_loop_return (call_frame_t *sh_frame, xlator_t *this, call_frame_t *loop_frame
                 if (loop_sh)
                         gf_log (this->name, GF_LOG_TRACE, "loop for offset "
                                 "%"PRId64" returned", loop_sh->offset);
+                if (loop_sh && (op_ret == 0))
+                        sh_throttle_update (this, loop_sh);
         }
 
         if (op_ret == -1) {
@@ -392,6 +639,35 @@ sh_loop_return (call_frame_t *sh_frame, xlator_t *this, call_frame_t *loop_frame
         return 0;
 }
 
+/* a block of the loop is done, move on to the next one of the loop */
+static int
+sh_loop_block_return (call_frame_t *loop_frame, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno)
+{
+        afr_local_t                *loop_local = NULL;
+        afr_self_heal_t            *loop_sh    = NULL;
+        call_frame_t               *sh_frame   = NULL;
+        afr_local_t                *sh_local   = NULL;
+        afr_self_heal_t            *sh         = NULL;
+
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
+
+        if ((op_ret < 0) || sh->op_failed || sh->eof_reached ||
+            (++loop_sh->block_index >= loop_sh->loop_blocks)) {
+                sh_loop_return (sh_frame, this, loop_frame, op_ret, op_errno);
+                goto out;
+        }
+
+        sh_diff_next_block (loop_frame, this);
+out:
+        return 0;
+}
+
 static int
 sh_loop_write_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
                    int32_t op_ret, int32_t op_errno, struct iatt *buf,
@@ -434,8 +710,8 @@ sh_loop_write_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
         call_count = afr_frame_return (loop_frame);
 
         if (call_count == 0) {
-                sh_loop_return (sh_frame, this, loop_frame,
-                                loop_sh->op_ret, loop_sh->op_errno);
+                sh_loop_block_return (loop_frame, this,
+                                      loop_sh->op_ret, loop_sh->op_errno);
         }
 
         return 0;
@@ -486,11 +762,17 @@ sh_loop_read_cbk (call_frame_t *loop_frame, void *cookie,
 
         if (loop_sh->file_has_holes && iov_0filled (vector, count) == 0) {
                         gf_log (this->name, GF_LOG_DEBUG, "0 filled block");
-                        sh_loop_return (sh_frame, this, loop_frame,
-                                        op_ret, op_errno);
+                        sh_loop_block_return (loop_frame, this,
+                                              op_ret, op_errno);
                         goto out;
         }
 
+        LOCK (&priv->lock);
+        {
+                priv->data_healed += op_ret;
+        }
+        UNLOCK (&priv->lock);
+
         call_count = sh_number_of_writes_needed (loop_sh->write_needed,
                                                  priv->child_count);
         GF_ASSERT (call_count > 0);
@@ -537,6 +819,7 @@ sh_loop_read (call_frame_t *loop_frame, xlator_t *this)
 }
 
 
+/* per block checksum, used when a subvolume can't do rchecksumv */
 static int
 sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
                       int32_t op_ret, int32_t op_errno,
@@ -613,8 +896,8 @@ sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
                 if (write_needed && !sh->op_failed) {
                         sh_loop_read (loop_frame, this);
                 } else {
-                        sh_loop_return (sh_frame, this, loop_frame,
-                                        op_ret, op_errno);
+                        sh_loop_block_return (loop_frame, this,
+                                              op_ret, op_errno);
                 }
         }
 
@@ -622,7 +905,7 @@ sh_diff_checksum_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
 }
 
 static int
-sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
+sh_diff_block_checksum (call_frame_t *loop_frame, xlator_t *this)
 {
         afr_private_t           *priv         = NULL;
         afr_local_t             *loop_local   = NULL;
@@ -663,6 +946,245 @@ sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
         return 0;
 }
 
+/*
+  Heal the block at block_index of the loop. With the checksums of the
+  whole loop at hand only the blocks which differ are read and written,
+  otherwise fall back to checksumming one block at a time.
+*/
+static int
+sh_diff_next_block (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t                 *priv         = NULL;
+        afr_local_t                   *loop_local   = NULL;
+        afr_self_heal_t               *loop_sh      = NULL;
+        call_frame_t                  *sh_frame     = NULL;
+        afr_local_t                   *sh_local     = NULL;
+        afr_self_heal_t               *sh           = NULL;
+        afr_sh_algo_private_t         *sh_priv      = NULL;
+        uint8_t                       *source_sum   = NULL;
+        uint8_t                       *sink_sum     = NULL;
+        int                           i             = 0;
+        int                           write_needed  = 0;
+        int32_t                       total_blocks  = 0;
+        int32_t                       diff_blocks   = 0;
+
+        priv       = this->private;
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
+        sh_priv  = sh->private;
+
+        if (loop_sh->checksum_batch_failed) {
+                loop_sh->offset = loop_sh->loop_offset +
+                        (loop_sh->block_index * loop_sh->block_size);
+                if (loop_sh->offset >= sh->file_size) {
+                        sh_loop_return (sh_frame, this, loop_frame, 0, 0);
+                        goto out;
+                }
+
+                memset (loop_sh->write_needed, 0,
+                        priv->child_count * sizeof (*loop_sh->write_needed));
+                sh_diff_block_checksum (loop_frame, this);
+                goto out;
+        }
+
+        for (; loop_sh->block_index < loop_sh->checksum_blocks;
+             loop_sh->block_index++) {
+                total_blocks++;
+
+                source_sum = loop_sh->checksum +
+                        (((loop_sh->source * loop_sh->loop_blocks) +
+                          loop_sh->block_index) * GF_RCHECKSUM_LEN);
+
+                for (i = 0; i < priv->child_count; i++) {
+                        loop_sh->write_needed[i] = 0;
+                        if (sh->sources[i] || !sh_local->child_up[i])
+                                continue;
+
+                        sink_sum = loop_sh->checksum +
+                                (((i * loop_sh->loop_blocks) +
+                                  loop_sh->block_index) * GF_RCHECKSUM_LEN);
+
+                        if (memcmp (sink_sum, source_sum, GF_RCHECKSUM_LEN))
+                                write_needed = loop_sh->write_needed[i] = 1;
+                }
+
+                if (write_needed) {
+                        diff_blocks++;
+                        break;
+                }
+        }
+
+        LOCK (&sh_priv->lock);
+        {
+                sh_priv->total_blocks += total_blocks;
+                sh_priv->diff_blocks  += diff_blocks;
+        }
+        UNLOCK (&sh_priv->lock);
+
+        if (!write_needed) {
+                sh_loop_return (sh_frame, this, loop_frame, 0, 0);
+                goto out;
+        }
+
+        loop_sh->offset = loop_sh->loop_offset +
+                (loop_sh->block_index * loop_sh->block_size);
+
+        gf_log (this->name, GF_LOG_DEBUG, "%s: block at offset %"PRId64
+                " differs from that on source", sh_local->loc.path,
+                loop_sh->offset);
+
+        sh_loop_read (loop_frame, this);
+out:
+        return 0;
+}
+
+static int
+sh_diff_checksumv_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, int32_t algo,
+                       int32_t count, uint8_t *strong_checksums)
+{
+        afr_private_t                 *priv         = NULL;
+        afr_local_t                   *loop_local   = NULL;
+        afr_self_heal_t               *loop_sh      = NULL;
+        int                           child_index  = 0;
+        int                           call_count   = 0;
+
+        priv  = this->private;
+
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        child_index = (long) cookie;
+
+        if ((op_ret < 0) || (algo != GF_RCHECKSUM_XXHASH) ||
+            (count > loop_sh->loop_blocks)) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "batched checksum failed on subvolume %s (%s), "
+                        "checksumming block by block",
+                        priv->children[child_index]->name,
+                        (op_ret < 0) ? strerror (op_errno) :
+                        "unexpected reply");
+                loop_sh->checksum_batch_failed = _gf_true;
+        } else {
+                /* blocks missing on the sinks stay zeroed and differ */
+                memcpy (loop_sh->checksum + (child_index *
+                                             loop_sh->loop_blocks *
+                                             GF_RCHECKSUM_LEN),
+                        strong_checksums, count * GF_RCHECKSUM_LEN);
+                if (child_index == loop_sh->source)
+                        loop_sh->checksum_blocks = count;
+        }
+
+        call_count = afr_frame_return (loop_frame);
+
+        if (call_count == 0) {
+                loop_sh->block_index = 0;
+                sh_diff_next_block (loop_frame, this);
+        }
+
+        return 0;
+}
+
+static int
+sh_diff_checksum (call_frame_t *loop_frame, xlator_t *this)
+{
+        afr_private_t           *priv         = NULL;
+        afr_local_t             *loop_local   = NULL;
+        afr_self_heal_t         *loop_sh      = NULL;
+        int                     call_count    = 0;
+        int                     i             = 0;
+
+        priv         = this->private;
+        loop_local   = loop_frame->local;
+        loop_sh      = &loop_local->self_heal;
+
+        call_count = loop_sh->active_sinks + 1;  /* sinks and source */
+
+        loop_local->call_count = call_count;
+
+        STACK_WIND_COOKIE (loop_frame, sh_diff_checksumv_cbk,
+                           (void *) (long) loop_sh->source,
+                           priv->children[loop_sh->source],
+                           priv->children[loop_sh->source]->fops->rchecksumv,
+                           loop_sh->healing_fd, loop_sh->loop_offset,
+                           loop_sh->block_size, loop_sh->loop_blocks,
+                           GF_RCHECKSUM_XXHASH);
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (loop_sh->sources[i] || !loop_local->child_up[i])
+                        continue;
+
+                STACK_WIND_COOKIE (loop_frame, sh_diff_checksumv_cbk,
+                                   (void *) (long) i,
+                                   priv->children[i],
+                                   priv->children[i]->fops->rchecksumv,
+                                   loop_sh->healing_fd, loop_sh->loop_offset,
+                                   loop_sh->block_size, loop_sh->loop_blocks,
+                                   GF_RCHECKSUM_XXHASH);
+
+                if (!--call_count)
+                        break;
+        }
+
+        return 0;
+}
+
+static int
+sh_full_seek_data_cbk (call_frame_t *loop_frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        afr_local_t             *loop_local   = NULL;
+        afr_self_heal_t         *loop_sh      = NULL;
+        call_frame_t            *sh_frame     = NULL;
+        afr_local_t             *sh_local     = NULL;
+        afr_self_heal_t         *sh           = NULL;
+        afr_sh_algo_private_t   *sh_priv      = NULL;
+        off_t                    next_offset  = 0;
+
+        loop_local = loop_frame->local;
+        loop_sh    = &loop_local->self_heal;
+
+        sh_frame = loop_sh->sh_frame;
+        sh_local = sh_frame->local;
+        sh       = &sh_local->self_heal;
+        sh_priv  = sh->private;
+
+        if (op_ret == -1) {
+                if (op_errno != ENXIO) {
+                        /* source can't tell where its data is, read it */
+                        sh_loop_read (loop_frame, this);
+                        goto out;
+                }
+                /* nothing but a hole till the end of the file */
+                next_offset = sh->file_size;
+        } else if (offset < (loop_sh->offset + loop_sh->block_size)) {
+                sh_loop_read (loop_frame, this);
+                goto out;
+        } else {
+                next_offset = offset - (offset % loop_sh->block_size);
+        }
+
+        gf_log (this->name, GF_LOG_TRACE, "%s: skipping hole from offset %"
+                PRId64" to %"PRId64, sh_local->loc.path, loop_sh->offset,
+                next_offset);
+
+        /* no need to spawn loops for the blocks inside the hole */
+        LOCK (&sh_priv->lock);
+        {
+                if (sh_priv->offset < next_offset)
+                        sh_priv->offset = next_offset;
+        }
+        UNLOCK (&sh_priv->lock);
+
+        sh_loop_return (sh_frame, this, loop_frame, 0, 0);
+out:
+        return 0;
+}
+
 static int
 sh_full_read_write_to_sinks (call_frame_t *loop_frame, xlator_t *this)
 {
@@ -680,6 +1202,19 @@ sh_full_read_write_to_sinks (call_frame_t *loop_frame, xlator_t *this)
                         continue;
                 loop_sh->write_needed[i] = 1;
         }
+
+        if (loop_sh->file_has_holes) {
+                /* find out from the source if this block is all hole,
+                   so that it is neither read nor sent to the sinks */
+                STACK_WIND_COOKIE (loop_frame, sh_full_seek_data_cbk,
+                                   (void *) (long) loop_sh->source,
+                                   priv->children[loop_sh->source],
+                                   priv->children[loop_sh->source]->fops->seek,
+                                   loop_sh->healing_fd, loop_sh->offset,
+                                   GF_SEEK_DATA);
+                return 0;
+        }
+
         sh_loop_read (loop_frame, this);
         return 0;
 }
@@ -692,7 +1227,7 @@ sh_do_nothing (call_frame_t *frame, xlator_t *this)
 
 int
 afr_sh_start_loops (call_frame_t *sh_frame, xlator_t *this,
-                    afr_sh_algo_fn sh_data_algo_start)
+                    afr_sh_algo_fn sh_data_algo_start, int32_t loop_blocks)
 {
         afr_local_t             *sh_local   = NULL;
         afr_self_heal_t         *sh      = NULL;
@@ -710,6 +1245,7 @@ afr_sh_start_loops (call_frame_t *sh_frame, xlator_t *this,
         }
 
         LOCK_INIT (&sh_priv->lock);
+        sh_priv->loop_blocks = loop_blocks;
 
         sh->private = sh_priv;
         sh->sh_data_algo_start = sh_data_algo_start;
@@ -725,14 +1261,15 @@ out:
 int
 afr_sh_algo_diff (call_frame_t *sh_frame, xlator_t *this)
 {
-        afr_sh_start_loops (sh_frame, this, sh_diff_checksum);
+        afr_sh_start_loops (sh_frame, this, sh_diff_checksum,
+                            AFR_SH_DIFF_BLOCKS_PER_LOOP);
         return 0;
 }
 
 int
 afr_sh_algo_full (call_frame_t *sh_frame, xlator_t *this)
 {
-        afr_sh_start_loops (sh_frame, this, sh_full_read_write_to_sinks);
+        afr_sh_start_loops (sh_frame, this, sh_full_read_write_to_sinks, 1);
         return 0;
 }
 
@@ -30,10 +30,16 @@ struct afr_sh_algorithm {
 };
 
 extern struct afr_sh_algorithm afr_self_heal_algorithms[3];
+
+/* number of blocks whose checksums the diff algorithm asks for
+   in a single rchecksumv call */
+#define AFR_SH_DIFF_BLOCKS_PER_LOOP 16
+
 typedef struct {
         gf_lock_t lock;
         unsigned int loops_running;
         off_t offset;
+        int32_t loop_blocks;
 
         int32_t total_blocks;
         int32_t diff_blocks;
@@ -2298,3 +2298,161 @@ out:
 
         return ret;
 }
+
+/*
+ * Heals lookups found needed while every background self-heal slot was
+ * taken. Rather than holding the lookup till a foreground heal is done
+ * they are queued, once per gfid, and a single synctask heals them one
+ * after the other by looking them up again with a foreground heal.
+ */
+#define AFR_DEFERRED_HEALS_MAX 1024
+
+typedef struct afr_deferred_heal_ {
+        struct list_head list;
+        loc_t            loc;
+        uuid_t           gfid;
+} afr_deferred_heal_t;
+
+static void
+afr_deferred_heal_free (afr_deferred_heal_t *heal)
+{
+        loc_wipe (&heal->loc);
+        GF_FREE (heal);
+}
+
+static int
+afr_deferred_heal_worker (void *data)
+{
+        xlator_t            *this = data;
+        afr_private_t       *priv = NULL;
+        afr_deferred_heal_t *heal = NULL;
+        dict_t              *xattr_req = NULL;
+        struct iatt         iatt = {0};
+        struct iatt         parent = {0};
+        int                 ret = 0;
+
+        priv = this->private;
+
+        for (;;) {
+                heal = NULL;
+                LOCK (&priv->lock);
+                {
+                        if (list_empty (&priv->deferred_heals)) {
+                                priv->deferred_heal_running = _gf_false;
+                        } else {
+                                heal = list_entry (priv->deferred_heals.next,
+                                                   afr_deferred_heal_t, list);
+                                list_del_init (&heal->list);
+                                priv->deferred_heal_count--;
+                        }
+                }
+                UNLOCK (&priv->lock);
+
+                if (!heal)
+                        break;
+
+                xattr_req = dict_new ();
+                if (xattr_req)
+                        ret = dict_set_uint32 (xattr_req,
+                                               AFR_LOOKUP_FG_HEAL_KEY, 1);
+                if (xattr_req && !ret) {
+                        ret = syncop_lookup (this, &heal->loc, xattr_req,
+                                             &iatt, NULL, &parent);
+                        if (ret)
+                                gf_log (this->name, GF_LOG_DEBUG, "deferred "
+                                        "heal of %s failed", heal->loc.path);
+                }
+                if (xattr_req)
+                        dict_unref (xattr_req);
+                xattr_req = NULL;
+
+                afr_deferred_heal_free (heal);
+        }
+
+        return 0;
+}
+
+static int
+afr_deferred_heal_worker_done (int ret, call_frame_t *frame, void *data)
+{
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+/* queues a heal of @loc, returns 0 if it will be done */
+int
+afr_self_heal_defer (xlator_t *this, loc_t *loc, uuid_t gfid)
+{
+        afr_private_t       *priv = NULL;
+        afr_deferred_heal_t *heal = NULL;
+        afr_deferred_heal_t *tmp = NULL;
+        call_frame_t        *frame = NULL;
+        gf_boolean_t        start = _gf_false;
+        int                 ret = -1;
+
+        priv = this->private;
+
+        if (!this->ctx->env || uuid_is_null (gfid))
+                goto out;
+
+        heal = GF_CALLOC (1, sizeof (*heal), gf_afr_mt_deferred_heal_t);
+        if (!heal)
+                goto out;
+        INIT_LIST_HEAD (&heal->list);
+        uuid_copy (heal->gfid, gfid);
+        ret = loc_copy (&heal->loc, loc);
+        if (ret)
+                goto out;
+
+        ret = -1;
+        LOCK (&priv->lock);
+        {
+                list_for_each_entry (tmp, &priv->deferred_heals, list) {
+                        if (!uuid_compare (tmp->gfid, gfid)) {
+                                ret = 0;
+                                goto unlock;
+                        }
+                }
+                if (priv->deferred_heal_count >= AFR_DEFERRED_HEALS_MAX)
+                        goto unlock;
+
+                list_add_tail (&heal->list, &priv->deferred_heals);
+                priv->deferred_heal_count++;
+                heal = NULL;
+                ret = 0;
+
+                if (!priv->deferred_heal_running) {
+                        priv->deferred_heal_running = _gf_true;
+                        start = _gf_true;
+                }
+        }
+unlock:
+        UNLOCK (&priv->lock);
+
+        if (!start)
+                goto out;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (frame) {
+                afr_set_lk_owner (frame, this);
+                afr_set_low_priority (frame);
+                if (!synctask_new (this->ctx->env, afr_deferred_heal_worker,
+                                   afr_deferred_heal_worker_done, frame,
+                                   this))
+                        goto out;
+                STACK_DESTROY (frame->root);
+        }
+
+        /* no worker, the queue waits for the next lookup to start one */
+        gf_log (this->name, GF_LOG_WARNING, "could not start the deferred "
+                "self-heal worker");
+        LOCK (&priv->lock);
+        {
+                priv->deferred_heal_running = _gf_false;
+        }
+        UNLOCK (&priv->lock);
+out:
+        if (heal)
+                afr_deferred_heal_free (heal);
+        return ret;
+}
@@ -129,4 +129,6 @@ int
 afr_impunge_frame_create (call_frame_t *frame, xlator_t *this,
                           int active_source, int ret_child, mode_t entry_mode,
                           call_frame_t **impunge_frame);
+int
+afr_self_heal_defer (xlator_t *this, loc_t *loc, uuid_t gfid);
 #endif /* __AFR_SELF_HEAL_COMMON_H__ */
@@ -645,6 +645,104 @@ out:
         return ret;
 }
 
+/*
+ * The dirty regions recorded on the source cover every write a sink
+ * missed only when the sink took part in none of them: its changelog
+ * is clean, the source blames it and not itself, and the sink holds
+ * the file, not an empty one made by entry self-heal.
+ */
+static gf_boolean_t
+afr_sh_data_regions_usable (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t     *local  = NULL;
+        afr_self_heal_t *sh     = NULL;
+        afr_private_t   *priv   = NULL;
+        int              source = 0;
+        int              i      = 0;
+        int              j      = 0;
+
+        local  = frame->local;
+        sh     = &local->self_heal;
+        priv   = this->private;
+        source = sh->source;
+
+        if (local->enoent_count ||
+            sh_zero_byte_files_exist (sh, priv->child_count))
+                return _gf_false;
+
+        if (sh->pending_matrix[source][source])
+                return _gf_false;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (sh->sources[i] || !local->child_up[i])
+                        continue;
+
+                if (!sh->pending_matrix[source][i])
+                        return _gf_false;
+
+                for (j = 0; j < priv->child_count; j++) {
+                        if (sh->pending_matrix[i][j])
+                                return _gf_false;
+                }
+        }
+
+        return _gf_true;
+}
+
+int
+afr_sh_data_regions_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                         int32_t op_ret, int32_t op_errno, dict_t *dict)
+{
+        afr_local_t     *local = NULL;
+        afr_self_heal_t *sh    = NULL;
+        data_t          *data  = NULL;
+
+        local = frame->local;
+        sh    = &local->self_heal;
+
+        if (op_ret == 0)
+                data = dict_get (dict, AFR_DIRTY_REGIONS_KEY);
+
+        if (data && (data->len == AFR_DIRTY_REGIONS_SIZE))
+                sh->dirty_regions = memdup (data->data,
+                                            AFR_DIRTY_REGIONS_SIZE);
+
+        gf_log (this->name, GF_LOG_DEBUG, "%s: healing %s",
+                local->loc.path, sh->dirty_regions ? "the dirty regions" :
+                "the whole file");
+
+        afr_sh_data_trim_sinks (frame, this);
+        return 0;
+}
+
+static int
+afr_sh_data_get_regions (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t     *local = NULL;
+        afr_self_heal_t *sh    = NULL;
+        afr_private_t   *priv  = NULL;
+
+        local = frame->local;
+        sh    = &local->self_heal;
+        priv  = this->private;
+
+        if (sh->dirty_regions) {
+                GF_FREE (sh->dirty_regions);
+                sh->dirty_regions = NULL;
+        }
+
+        if (!afr_sh_data_regions_usable (frame, this)) {
+                afr_sh_data_trim_sinks (frame, this);
+                return 0;
+        }
+
+        STACK_WIND (frame, afr_sh_data_regions_cbk,
+                    priv->children[sh->source],
+                    priv->children[sh->source]->fops->fgetxattr,
+                    sh->healing_fd, AFR_DIRTY_REGIONS_KEY);
+        return 0;
+}
+
 int
 afr_sh_data_fix (call_frame_t *frame, xlator_t *this)
 {
@@ -745,7 +843,7 @@ afr_sh_data_fix (call_frame_t *frame, xlator_t *this)
                 "self-healing file %s from subvolume %s to %d other",
                 local->loc.path, priv->children[sh->source]->name,
                 sh->active_sinks);
-        afr_sh_data_trim_sinks (frame, this);
+        afr_sh_data_get_regions (frame, this);
 
         return 0;
 }
@@ -955,6 +1053,67 @@ afr_sh_common_fxattrop_resp_handler (call_frame_t *frame, void *cookie,
         UNLOCK (&frame->lock);
 }
 
+int
+afr_sh_data_clear_regions_cbk (call_frame_t *frame, void *cookie,
+                               xlator_t *this, int32_t op_ret,
+                               int32_t op_errno)
+{
+        int call_count = 0;
+
+        call_count = afr_frame_return (frame);
+        if (call_count == 0)
+                afr_sh_set_timestamps (frame, this);
+
+        return 0;
+}
+
+/*
+ * Drops the dirty regions once no child blames any other. The big lock
+ * keeps data transactions out meanwhile, so none can be between its
+ * pre-op and the regions it has to record.
+ */
+static int
+afr_sh_data_clear_regions (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t     *local      = NULL;
+        afr_self_heal_t *sh         = NULL;
+        afr_private_t   *priv       = NULL;
+        int              call_count = 0;
+        int              i          = 0;
+        int              j          = 0;
+
+        local = frame->local;
+        sh    = &local->self_heal;
+        priv  = this->private;
+
+        if (sh->success_count != priv->child_count)
+                goto out;
+
+        for (i = 0; i < priv->child_count; i++) {
+                for (j = 0; j < priv->child_count; j++) {
+                        if (sh->pending_matrix[i][j])
+                                goto out;
+                }
+        }
+
+        call_count = priv->child_count;
+        local->call_count = call_count;
+        for (i = 0; i < priv->child_count; i++) {
+                STACK_WIND_COOKIE (frame, afr_sh_data_clear_regions_cbk,
+                                   (void *) (long) i,
+                                   priv->children[i],
+                                   priv->children[i]->fops->removexattr,
+                                   &local->loc, AFR_DIRTY_REGIONS_KEY);
+                if (!--call_count)
+                        break;
+        }
+
+        return 0;
+out:
+        afr_sh_set_timestamps (frame, this);
+        return 0;
+}
+
 int
 afr_post_sh_data_fxattrop_cbk (call_frame_t *frame, void *cookie,
                                xlator_t *this, int32_t op_ret, int32_t op_errno,
@@ -980,7 +1139,7 @@ afr_post_sh_data_fxattrop_cbk (call_frame_t *frame, void *cookie,
                 if (ret)
                         afr_sh_data_fail (frame, this);
                 else
-                        afr_sh_set_timestamps (frame, this);
+                        afr_sh_data_clear_regions (frame, this);
         }
 
         return 0;
@@ -58,19 +58,27 @@
                 _sh_sh    = &_sh_local->self_heal;\
         } while (0);
 
+static void
+afr_sh_entry_scan_destroy (struct afr_sh_entry_scan *scan, int child_count);
+
 int
 afr_sh_entry_done (call_frame_t *frame, xlator_t *this)
 {
         afr_local_t     *local = NULL;
         afr_self_heal_t *sh = NULL;
+        afr_private_t   *priv = NULL;
 
         local = frame->local;
         sh = &local->self_heal;
+        priv = this->private;
 
         if (sh->healing_fd)
                 fd_unref (sh->healing_fd);
         sh->healing_fd = NULL;
 
+        afr_sh_entry_scan_destroy (sh->entry_scan, priv->child_count);
+        sh->entry_scan = NULL;
+
         sh->completion_cbk (frame, this);
 
         return 0;
@@ -687,7 +695,6 @@ afr_sh_entry_expunge_entry (call_frame_t *frame, xlator_t *this,
 
         active_src = sh->active_source;
         source = sh->source;
-        sh->expunge_done = afr_sh_entry_expunge_entry_done;
 
         name = entry->d_name;
 
@@ -796,6 +803,7 @@ afr_sh_entry_expunge_readdir_cbk (call_frame_t *frame, void *cookie,
 
         sh->offset = last_offset;
         local->call_count = entry_count;
+        sh->expunge_done = afr_sh_entry_expunge_entry_done;
 
         list_for_each_entry (entry, &entries->list, list) {
                 afr_sh_entry_expunge_entry (frame, this, entry);
@@ -1742,7 +1750,6 @@ afr_sh_entry_impunge_entry (call_frame_t *frame, xlator_t *this,
         sh = &local->self_heal;
 
         active_src = sh->active_source;
-        sh->impunge_done = afr_sh_entry_impunge_entry_done;
 
         if ((strcmp (entry->d_name, ".") == 0)
             || (strcmp (entry->d_name, "..") == 0)
@@ -1842,6 +1849,7 @@ afr_sh_entry_impunge_readdir_cbk (call_frame_t *frame, void *cookie,
 
         sh->offset = last_offset;
         local->call_count = entry_count;
+        sh->impunge_done = afr_sh_entry_impunge_entry_done;
 
         list_for_each_entry (entry, &entries->list, list) {
                 afr_sh_entry_impunge_entry (frame, this, entry);
@@ -1910,6 +1918,702 @@ afr_sh_entry_impunge_all (call_frame_t *frame, xlator_t *this)
 }
 
 
+/*
+ * Scanned entry self-heal. The directory is first read from all the
+ * children it is open on at once, and each listing is sorted by name.
+ * Expunge and impunge then only look at the names that differ: those
+ * missing on the source or on some other child, or present there with
+ * another gfid or type. Their lookups and fixes run AFR_SH_ENTRY_WINDOW
+ * at a time, so a large directory that is mostly in sync costs little
+ * more than reading it. If a listing cannot be read the heal falls back
+ * to the readdir driven one above.
+ *
+ * At most about AFR_SH_ENTRY_SCAN_BATCH names of a child are held at a
+ * time. The names are split by their hash into partitions which are
+ * healed one after the other, each with its own pass over the
+ * directory. The first pass doubles the number of partitions whenever a
+ * listing grows past the batch, keeping only the names of the first one.
+ * Every pass reads the whole directory again, so the partitions are
+ * capped at AFR_SH_ENTRY_SCAN_MAX_PARTS; a directory still too large
+ * for them is healed by the readdir driven walk, which reads it once.
+ */
+
+#define AFR_SH_ENTRY_WINDOW         64
+#define AFR_SH_ENTRY_SCAN_BATCH     4096
+#define AFR_SH_ENTRY_SCAN_MAX_PARTS 8
+
+struct afr_sh_entry_scan {
+        gf_dirent_t     *entries;    /* per child, as read */
+        gf_dirent_t   ***sorted;     /* per child, by name */
+        int             *count;
+        off_t           *offset;
+        unsigned char   *scanned;
+        gf_boolean_t     failed;
+        unsigned int     parts;      /* partitions of the names */
+        unsigned int     part;       /* the one being healed */
+
+        /* the names the current phase works on */
+        gf_dirent_t    **work;
+        int              work_count;
+        int              work_next;
+        int              inflight;
+        gf_boolean_t     expunging;
+        gf_boolean_t     phase_done;
+};
+
+static int
+afr_sh_entry_scan_expunge_all (call_frame_t *frame, xlator_t *this);
+
+static int
+afr_sh_entry_scan_impunge_all (call_frame_t *frame, xlator_t *this);
+
+static void
+afr_sh_entry_scan_start (call_frame_t *frame, xlator_t *this);
+
+static void
+afr_sh_entry_scan_destroy (struct afr_sh_entry_scan *scan, int child_count)
+{
+        int i = 0;
+
+        if (!scan)
+                return;
+
+        for (i = 0; scan->entries && (i < child_count); i++) {
+                gf_dirent_free (&scan->entries[i]);
+                if (scan->sorted && scan->sorted[i])
+                        GF_FREE (scan->sorted[i]);
+        }
+
+        if (scan->entries)
+                GF_FREE (scan->entries);
+        if (scan->sorted)
+                GF_FREE (scan->sorted);
+        if (scan->count)
+                GF_FREE (scan->count);
+        if (scan->offset)
+                GF_FREE (scan->offset);
+        if (scan->scanned)
+                GF_FREE (scan->scanned);
+        if (scan->work)
+                GF_FREE (scan->work);
+
+        GF_FREE (scan);
+}
+
+static struct afr_sh_entry_scan *
+afr_sh_entry_scan_new (int child_count)
+{
+        struct afr_sh_entry_scan *scan = NULL;
+        int                       i    = 0;
+
+        scan = GF_CALLOC (1, sizeof (*scan), gf_afr_mt_sh_entry_scan_t);
+        if (!scan)
+                goto err;
+
+        scan->entries = GF_CALLOC (child_count, sizeof (*scan->entries),
+                                   gf_afr_mt_sh_entry_scan_t);
+        scan->sorted  = GF_CALLOC (child_count, sizeof (*scan->sorted),
+                                   gf_afr_mt_sh_entry_scan_t);
+        scan->count   = GF_CALLOC (child_count, sizeof (*scan->count),
+                                   gf_afr_mt_int32_t);
+        scan->offset  = GF_CALLOC (child_count, sizeof (*scan->offset),
+                                   gf_afr_mt_sh_entry_scan_t);
+        scan->scanned = GF_CALLOC (child_count, sizeof (*scan->scanned),
+                                   gf_afr_mt_char);
+        if (!scan->entries || !scan->sorted || !scan->count ||
+            !scan->offset || !scan->scanned)
+                goto err;
+
+        for (i = 0; i < child_count; i++)
+                INIT_LIST_HEAD (&scan->entries[i].list);
+
+        scan->parts = 1;
+
+        return scan;
+err:
+        if (scan)
+                afr_sh_entry_scan_destroy (scan, 0);
+        return NULL;
+}
+
+/* forget the listings, for the pass over the next partition */
+static void
+afr_sh_entry_scan_reset (struct afr_sh_entry_scan *scan, int child_count)
+{
+        int i = 0;
+
+        for (i = 0; i < child_count; i++) {
+                gf_dirent_free (&scan->entries[i]);
+                if (scan->sorted[i])
+                        GF_FREE (scan->sorted[i]);
+                scan->sorted[i] = NULL;
+                scan->count[i]  = 0;
+                scan->offset[i] = 0;
+        }
+
+        scan->failed = _gf_false;
+}
+
+static unsigned int
+afr_sh_entry_scan_part_of (const char *name, unsigned int parts)
+{
+        return SuperFastHash (name, strlen (name)) % parts;
+}
+
+/* double the partitions during the first pass, dropping the names
+   which are not in the first one any more; called with frame->lock
+   held */
+static void
+__afr_sh_entry_scan_split (struct afr_sh_entry_scan *scan, int child_count)
+{
+        gf_dirent_t *entry = NULL;
+        gf_dirent_t *tmp   = NULL;
+        int          i     = 0;
+
+        scan->parts *= 2;
+
+        for (i = 0; i < child_count; i++) {
+                list_for_each_entry_safe (entry, tmp, &scan->entries[i].list,
+                                          list) {
+                        if (afr_sh_entry_scan_part_of (entry->d_name,
+                                                       scan->parts) ==
+                            scan->part)
+                                continue;
+
+                        list_del_init (&entry->list);
+                        GF_FREE (entry);
+                        scan->count[i]--;
+                }
+        }
+}
+
+static int
+afr_sh_entry_scan_name_cmp (const void *a, const void *b)
+{
+        const gf_dirent_t *e1 = *(const gf_dirent_t **) a;
+        const gf_dirent_t *e2 = *(const gf_dirent_t **) b;
+
+        return strcmp (e1->d_name, e2->d_name);
+}
+
+static gf_dirent_t *
+afr_sh_entry_scan_find (struct afr_sh_entry_scan *scan, int child,
+                        gf_dirent_t *entry)
+{
+        gf_dirent_t **found = NULL;
+
+        found = bsearch (&entry, scan->sorted[child], scan->count[child],
+                         sizeof (*scan->sorted[child]),
+                         afr_sh_entry_scan_name_cmp);
+
+        return found ? *found : NULL;
+}
+
+static gf_boolean_t
+afr_sh_entry_scan_gfid_differs (gf_dirent_t *e1, gf_dirent_t *e2)
+{
+        return (!uuid_is_null (e1->d_stat.ia_gfid) &&
+                !uuid_is_null (e2->d_stat.ia_gfid) &&
+                uuid_compare (e1->d_stat.ia_gfid, e2->d_stat.ia_gfid));
+}
+
+static int
+afr_sh_entry_scan_sort (xlator_t *this, struct afr_sh_entry_scan *scan)
+{
+        afr_private_t *priv  = NULL;
+        gf_dirent_t   *entry = NULL;
+        int            i     = 0;
+        int            n     = 0;
+
+        priv = this->private;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (!scan->scanned[i] || !scan->count[i])
+                        continue;
+
+                scan->sorted[i] = GF_CALLOC (scan->count[i],
+                                             sizeof (*scan->sorted[i]),
+                                             gf_afr_mt_sh_entry_scan_t);
+                if (!scan->sorted[i])
+                        return -1;
+
+                n = 0;
+                list_for_each_entry (entry, &scan->entries[i].list, list)
+                        scan->sorted[i][n++] = entry;
+
+                qsort (scan->sorted[i], n, sizeof (*scan->sorted[i]),
+                       afr_sh_entry_scan_name_cmp);
+        }
+
+        return 0;
+}
+
+static int
+afr_sh_entry_scan_work_add (struct afr_sh_entry_scan *scan,
+                            gf_dirent_t *entry, int max)
+{
+        if (!scan->work) {
+                scan->work = GF_CALLOC (max, sizeof (*scan->work),
+                                        gf_afr_mt_sh_entry_scan_t);
+                if (!scan->work)
+                        return -1;
+        }
+
+        scan->work[scan->work_count++] = entry;
+        return 0;
+}
+
+static void
+afr_sh_entry_scan_work_reset (struct afr_sh_entry_scan *scan,
+                              gf_boolean_t expunging)
+{
+        if (scan->work)
+                GF_FREE (scan->work);
+
+        scan->work       = NULL;
+        scan->work_count = 0;
+        scan->work_next  = 0;
+        scan->inflight   = 0;
+        scan->expunging  = expunging;
+        scan->phase_done = _gf_false;
+}
+
+/* names of @sink that the source lacks or has with another gfid */
+static int
+afr_sh_entry_scan_expunge_work (struct afr_sh_entry_scan *scan, int sink,
+                                int source)
+{
+        gf_dirent_t *entry = NULL;
+        gf_dirent_t *found = NULL;
+        int          i     = 0;
+
+        afr_sh_entry_scan_work_reset (scan, _gf_true);
+
+        for (i = 0; i < scan->count[sink]; i++) {
+                entry = scan->sorted[sink][i];
+                found = afr_sh_entry_scan_find (scan, source, entry);
+                if (found && !afr_sh_entry_scan_gfid_differs (entry, found))
+                        continue;
+
+                if (afr_sh_entry_scan_work_add (scan, entry,
+                                                scan->count[sink]))
+                        return -1;
+        }
+
+        return 0;
+}
+
+/* names of @source that some other child lacks, or has with another
+   gfid or type, or without a gfid */
+static int
+afr_sh_entry_scan_impunge_work (xlator_t *this,
+                                struct afr_sh_entry_scan *scan, int source)
+{
+        afr_private_t *priv  = NULL;
+        gf_dirent_t   *entry = NULL;
+        gf_dirent_t   *found = NULL;
+        int            i     = 0;
+        int            j     = 0;
+
+        priv = this->private;
+
+        afr_sh_entry_scan_work_reset (scan, _gf_false);
+
+        for (i = 0; i < scan->count[source]; i++) {
+                entry = scan->sorted[source][i];
+                for (j = 0; j < priv->child_count; j++) {
+                        if ((j == source) || !scan->scanned[j])
+                                continue;
+
+                        found = afr_sh_entry_scan_find (scan, j, entry);
+                        if (!found ||
+                            (found->d_stat.ia_type != entry->d_stat.ia_type) ||
+                            uuid_is_null (found->d_stat.ia_gfid) ||
+                            uuid_is_null (entry->d_stat.ia_gfid) ||
+                            afr_sh_entry_scan_gfid_differs (entry, found))
+                                break;
+                }
+
+                if (j == priv->child_count)
+                        continue;
+
+                if (afr_sh_entry_scan_work_add (scan, entry,
+                                                scan->count[source]))
+                        return -1;
+        }
+
+        return 0;
+}
+
+static void
+afr_sh_entry_scan_pump (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t              *local      = NULL;
+        afr_self_heal_t          *sh         = NULL;
+        struct afr_sh_entry_scan *scan       = NULL;
+        gf_dirent_t              *batch[AFR_SH_ENTRY_WINDOW];
+        gf_boolean_t              phase_done = _gf_false;
+        int                       count      = 0;
+        int                       i          = 0;
+
+        local = frame->local;
+        sh    = &local->self_heal;
+        scan  = sh->entry_scan;
+
+        LOCK (&frame->lock);
+        {
+                while (!sh->op_failed &&
+                       (scan->inflight < AFR_SH_ENTRY_WINDOW) &&
+                       (scan->work_next < scan->work_count)) {
+                        batch[count++] = scan->work[scan->work_next++];
+                        scan->inflight++;
+                }
+
+                if (!scan->inflight && !scan->phase_done) {
+                        scan->phase_done = _gf_true;
+                        phase_done = _gf_true;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        for (i = 0; i < count; i++) {
+                if (scan->expunging)
+                        afr_sh_entry_expunge_entry (frame, this, batch[i]);
+                else
+                        afr_sh_entry_impunge_entry (frame, this, batch[i]);
+        }
+
+        if (!phase_done)
+                return;
+
+        if (scan->expunging)
+                afr_sh_entry_scan_expunge_all (frame, this);
+        else
+                afr_sh_entry_scan_impunge_all (frame, this);
+}
+
+int
+afr_sh_entry_scan_entry_done (call_frame_t *frame, xlator_t *this,
+                              int active_src, int32_t op_ret,
+                              int32_t op_errno)
+{
+        afr_local_t              *local = NULL;
+        afr_self_heal_t          *sh    = NULL;
+        struct afr_sh_entry_scan *scan  = NULL;
+
+        local = frame->local;
+        sh    = &local->self_heal;
+        scan  = sh->entry_scan;
+
+        LOCK (&frame->lock);
+        {
+                scan->inflight--;
+        }
+        UNLOCK (&frame->lock);
+
+        afr_sh_entry_scan_pump (frame, this);
+        return 0;
+}
+
+static int
+afr_sh_entry_scan_impunge_all (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t            *priv       = NULL;
+        afr_local_t              *local      = NULL;
+        afr_self_heal_t          *sh         = NULL;
+        struct afr_sh_entry_scan *scan       = NULL;
+        int                       active_src = -1;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+        scan  = sh->entry_scan;
+
+        active_src = next_active_source (frame, this, sh->active_source);
+        sh->active_source = active_src;
+
+        if (sh->op_failed) {
+                afr_sh_entry_finish (frame, this);
+                return 0;
+        }
+
+        if (active_src == -1) {
+                if (scan->part + 1 < scan->parts) {
+                        afr_sh_entry_scan_reset (scan, priv->child_count);
+                        scan->part++;
+                        afr_sh_entry_scan_start (frame, this);
+                        return 0;
+                }
+
+                afr_sh_entry_erase_pending (frame, this);
+                return 0;
+        }
+
+        if (afr_sh_entry_scan_impunge_work (this, scan, active_src)) {
+                sh->op_failed = 1;
+                afr_sh_entry_finish (frame, this);
+                return 0;
+        }
+
+        gf_log (this->name, GF_LOG_DEBUG,
+                "impunging %d of %d entries of %s on %s to other sinks",
+                scan->work_count, scan->count[active_src], local->loc.path,
+                priv->children[active_src]->name);
+
+        sh->impunge_done = afr_sh_entry_scan_entry_done;
+        afr_sh_entry_scan_pump (frame, this);
+
+        return 0;
+}
+
+static int
+afr_sh_entry_scan_expunge_all (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t            *priv       = NULL;
+        afr_local_t              *local      = NULL;
+        afr_self_heal_t          *sh         = NULL;
+        struct afr_sh_entry_scan *scan       = NULL;
+        int                       active_src = -1;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+        scan  = sh->entry_scan;
+
+        if (sh->source == -1)
+                goto out;
+
+        active_src = next_active_sink (frame, this, sh->active_source);
+        sh->active_source = active_src;
+
+        if (sh->op_failed || (active_src == -1))
+                goto out;
+
+        if (afr_sh_entry_scan_expunge_work (scan, active_src, sh->source)) {
+                sh->op_failed = 1;
+                goto out;
+        }
+
+        gf_log (this->name, GF_LOG_DEBUG,
+                "expunging %d of %d entries of %s on %s",
+                scan->work_count, scan->count[active_src], local->loc.path,
+                priv->children[active_src]->name);
+
+        sh->expunge_done = afr_sh_entry_scan_entry_done;
+        afr_sh_entry_scan_pump (frame, this);
+
+        return 0;
+out:
+        afr_sh_entry_scan_impunge_all (frame, this);
+        return 0;
+}
+
+static void
+afr_sh_entry_scan_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t            *priv  = NULL;
+        afr_local_t              *local = NULL;
+        afr_self_heal_t          *sh    = NULL;
+        struct afr_sh_entry_scan *scan  = NULL;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+        scan  = sh->entry_scan;
+
+        if (scan->failed || afr_sh_entry_scan_sort (this, scan)) {
+                gf_log (this->name, GF_LOG_DEBUG, "scan of %s failed, "
+                        "healing it entry by entry", local->loc.path);
+                afr_sh_entry_scan_destroy (scan, priv->child_count);
+                sh->entry_scan = NULL;
+                sh->active_source = -1;
+                afr_sh_entry_expunge_all (frame, this);
+                return;
+        }
+
+        if (scan->parts > 1)
+                gf_log (this->name, GF_LOG_DEBUG, "healing part %d of %d "
+                        "of %s", scan->part + 1, scan->parts,
+                        local->loc.path);
+
+        sh->active_source = -1;
+        afr_sh_entry_scan_expunge_all (frame, this);
+}
+
+int
+afr_sh_entry_scan_readdir_cbk (call_frame_t *frame, void *cookie,
+                               xlator_t *this, int32_t op_ret,
+                               int32_t op_errno, gf_dirent_t *entries)
+{
+        afr_private_t            *priv        = NULL;
+        afr_local_t              *local       = NULL;
+        afr_self_heal_t          *sh          = NULL;
+        struct afr_sh_entry_scan *scan        = NULL;
+        gf_dirent_t              *entry       = NULL;
+        gf_dirent_t              *copy        = NULL;
+        int                       child_index = (long) cookie;
+        int                       call_count  = 0;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+        scan  = sh->entry_scan;
+
+        if (op_ret < 0) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "readdir of %s on subvolume %s failed (%s)",
+                        local->loc.path, priv->children[child_index]->name,
+                        strerror (op_errno));
+                scan->failed = _gf_true;
+                goto done;
+        }
+
+        if ((op_ret == 0) || scan->failed)
+                goto done;
+
+        /* the first pass may split the partitions from under the
+           readdirs of the other children */
+        LOCK (&frame->lock);
+        {
+                list_for_each_entry (entry, &entries->list, list) {
+                        scan->offset[child_index] = entry->d_off;
+
+                        if (!strcmp (entry->d_name, ".") ||
+                            !strcmp (entry->d_name, "..") ||
+                            (!strcmp (local->loc.path, "/") &&
+                             !strcmp (entry->d_name, GF_REPLICATE_TRASH_DIR)))
+                                continue;
+
+                        if (afr_sh_entry_scan_part_of (entry->d_name,
+                                                       scan->parts) !=
+                            scan->part)
+                                continue;
+
+                        copy = gf_dirent_for_name (entry->d_name);
+                        if (!copy) {
+                                scan->failed = _gf_true;
+                                break;
+                        }
+                        copy->d_ino  = entry->d_ino;
+                        copy->d_off  = entry->d_off;
+                        copy->d_type = entry->d_type;
+                        copy->d_stat = entry->d_stat;
+
+                        list_add_tail (&copy->list,
+                                       &scan->entries[child_index].list);
+                        scan->count[child_index]++;
+                }
+
+                /* the partitions are fixed once the first one is done or
+                   there are AFR_SH_ENTRY_SCAN_MAX_PARTS of them, a part
+                   still far larger than the batch is healed entry by
+                   entry */
+                while (!scan->failed &&
+                       (scan->count[child_index] > AFR_SH_ENTRY_SCAN_BATCH)) {
+                        if ((scan->part == 0) &&
+                            (scan->parts < AFR_SH_ENTRY_SCAN_MAX_PARTS)) {
+                                __afr_sh_entry_scan_split (scan,
+                                                           priv->child_count);
+                                continue;
+                        }
+
+                        if (scan->count[child_index] >
+                            2 * AFR_SH_ENTRY_SCAN_BATCH)
+                                scan->failed = _gf_true;
+                        break;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        if (scan->failed)
+                goto done;
+
+        STACK_WIND_COOKIE (frame, afr_sh_entry_scan_readdir_cbk,
+                           (void *) (long) child_index,
+                           priv->children[child_index],
+                           priv->children[child_index]->fops->readdirp,
+                           sh->healing_fd, sh->block_size,
+                           scan->offset[child_index]);
+        return 0;
+
+done:
+        call_count = afr_frame_return (frame);
+        if (call_count == 0)
+                afr_sh_entry_scan_done (frame, this);
+
+        return 0;
+}
+
+/* read the listings of the current partition */
+static void
+afr_sh_entry_scan_start (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t            *priv       = NULL;
+        afr_local_t              *local      = NULL;
+        afr_self_heal_t          *sh         = NULL;
+        struct afr_sh_entry_scan *scan       = NULL;
+        int                       call_count = 0;
+        int                       i          = 0;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+        scan  = sh->entry_scan;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (scan->scanned[i])
+                        call_count++;
+        }
+
+        local->call_count = call_count;
+        for (i = 0; i < priv->child_count; i++) {
+                if (!scan->scanned[i])
+                        continue;
+
+                STACK_WIND_COOKIE (frame, afr_sh_entry_scan_readdir_cbk,
+                                   (void *) (long) i,
+                                   priv->children[i],
+                                   priv->children[i]->fops->readdirp,
+                                   sh->healing_fd, sh->block_size, 0);
+                if (!--call_count)
+                        break;
+        }
+}
+
+static int
+afr_sh_entry_scan (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t            *priv       = NULL;
+        afr_local_t              *local      = NULL;
+        afr_self_heal_t          *sh         = NULL;
+        struct afr_sh_entry_scan *scan       = NULL;
+        int                       i          = 0;
+
+        priv  = this->private;
+        local = frame->local;
+        sh    = &local->self_heal;
+
+        scan = afr_sh_entry_scan_new (priv->child_count);
+        if (!scan) {
+                afr_sh_entry_expunge_all (frame, this);
+                return 0;
+        }
+        sh->entry_scan = scan;
+
+        /* the children afr_sh_entry_open opened the directory on */
+        for (i = 0; i < priv->child_count; i++) {
+                if (!local->child_up[i])
+                        continue;
+                if ((i == sh->source) || !sh->sources[i])
+                        scan->scanned[i] = 1;
+        }
+
+        afr_sh_entry_scan_start (frame, this);
+
+        return 0;
+}
+
+
 int
 afr_sh_entry_opendir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                           int32_t op_ret, int32_t op_errno, fd_t *fd)
@@ -1955,7 +2659,7 @@ afr_sh_entry_opendir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         local->loc.path);
 
                 sh->active_source = -1;
-                afr_sh_entry_expunge_all (frame, this);
+                afr_sh_entry_scan (frame, this);
         }
 
         return 0;
@@ -414,6 +414,7 @@ afr_sh_metadata_getxattr_cbk (call_frame_t *frame, void *cookie,
                 for (i = 0; i < priv->child_count; i++) {
                         dict_del (xattr, priv->pending_key[i]);
                 }
+                dict_del (xattr, AFR_DIRTY_REGIONS_KEY);
 
                 afr_sh_metadata_sync (frame, this, xattr);
         }
@@ -230,24 +230,13 @@ out:
         return ret;
 }
 
-int
-afr_find_child_position (xlator_t *this, int child)
+static int
+afr_init_root_inode (xlator_t *this)
 {
         afr_private_t    *priv = NULL;
-        dict_t           *xattr_rsp = NULL;
-        loc_t            loc = {0};
-        int              ret = 0;
-        gf_boolean_t     local = _gf_false;
-        char             *pathinfo = NULL;
-        afr_child_pos_t  *pos = NULL;
         inode_table_t    *itable = NULL;
 
         priv = this->private;
-        pos = &priv->shd.pos[child];
-
-        if (*pos != AFR_POS_UNKNOWN) {
-                goto out;
-        }
 
         //TODO: Hack to make the root_loc hack work
         LOCK (&priv->lock);
@@ -264,10 +253,709 @@ afr_find_child_position (xlator_t *this, int child)
 unlock:
         UNLOCK (&priv->lock);
 
-        if (!priv->root_inode) {
-                ret = -1;
+        return priv->root_inode ? 0 : -1;
+}
+
+/* Walks the index of @child in batches and calls @fn for each entry.
+ * Fails if the brick does not keep an index.
+ */
+static int
+afr_index_foreach (xlator_t *this, int child, afr_index_entry_fn_t fn,
+                   void *data)
+{
+        afr_private_t    *priv = NULL;
+        dict_t           *batch = NULL;
+        loc_t            loc = {0};
+        char             key[256] = {0};
+        char             *gfid_str = NULL;
+        char             *path = NULL;
+        uuid_t           gfid = {0};
+        int64_t          offset = 0;
+        int32_t          count = 0;
+        int32_t          eof = 0;
+        int              i = 0;
+        int              ret = 0;
+
+        priv = this->private;
+        afr_build_root_loc (priv->root_inode, &loc);
+
+        while (!eof) {
+                if (offset)
+                        snprintf (key, sizeof (key), "%s.%"PRId64,
+                                  GF_XATTROP_INDEX_KEY, offset);
+                else
+                        snprintf (key, sizeof (key), "%s",
+                                  GF_XATTROP_INDEX_KEY);
+
+                ret = syncop_getxattr (priv->children[child], &loc, &batch,
+                                       key);
+                if (ret)
+                        goto out;
+
+                ret = dict_get_int32 (batch, GF_INDEX_COUNT_KEY, &count);
+                if (!ret)
+                        ret = dict_get_int64 (batch, GF_INDEX_OFFSET_KEY,
+                                              &offset);
+                if (!ret)
+                        ret = dict_get_int32 (batch, GF_INDEX_EOF_KEY, &eof);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_ERROR, "malformed index "
+                                "reply from %s", priv->children[child]->name);
+                        goto out;
+                }
+
+                for (i = 0; i < count; i++) {
+                        snprintf (key, sizeof (key), "%s-%d",
+                                  GF_INDEX_GFID_KEY, i);
+                        ret = dict_get_str (batch, key, &gfid_str);
+                        if (ret || uuid_parse (gfid_str, gfid))
+                                continue;
+                        snprintf (key, sizeof (key), "%s-%d",
+                                  GF_INDEX_PATH_KEY, i);
+                        ret = dict_get_str (batch, key, &path);
+                        if (ret)
+                                path = "";
+
+                        ret = fn (this, child, gfid, path, data);
+                        if (ret)
+                                goto out;
+                }
+
+                dict_unref (batch);
+                batch = NULL;
+        }
+        ret = 0;
+out:
+        if (batch)
+                dict_unref (batch);
+        return ret;
+}
+
+/* Looks @path up one component at a time, so that every parent gets
+ * the same entry self-heal a crawl would have given it. The entry
+ * itself is only resolved into @loc, its heal is left to the caller.
+ */
+static int
+afr_resolve_index_path (xlator_t *this, const char *path, loc_t *loc,
+                        struct iatt *stbuf)
+{
+        afr_private_t    *priv = NULL;
+        loc_t            rootloc = {0};
+        loc_t            parentloc = {0};
+        struct iatt      iatt = {0};
+        struct iatt      parent = {0};
+        dict_t           *xattr_req = NULL;
+        char             *dup = NULL;
+        char             *component = NULL;
+        char             *next = NULL;
+        char             *saveptr = NULL;
+        uuid_t           gfid = {0};
+        int              ret = -1;
+
+        priv = this->private;
+
+        xattr_req = dict_new ();
+        dup = gf_strdup (path);
+        if (!xattr_req || !dup)
+                goto out;
+
+        afr_build_root_loc (priv->root_inode, &rootloc);
+        ret = loc_copy (&parentloc, &rootloc);
+        if (ret)
+                goto out;
+
+        ret = -1;
+        component = strtok_r (dup, "/", &saveptr);
+        while (component) {
+                next = strtok_r (NULL, "/", &saveptr);
+
+                ret = dict_reset (xattr_req);
+                if (ret)
+                        goto out;
+
+                ret = afr_build_child_loc (this, loc, &parentloc, component);
+                if (ret)
+                        goto out;
+
+                afr_generate_gfid_on_empty (gfid);
+                ret = afr_set_dict_gfid (xattr_req, gfid);
+                if (!ret && !next)
+                        ret = dict_set_uint32 (xattr_req,
+                                               AFR_LOOKUP_NO_HEAL_KEY, 1);
+                if (ret)
+                        goto out;
+
+                gf_log (this->name, GF_LOG_DEBUG, "lookup %s", loc->path);
+                ret = syncop_lookup (this, loc, xattr_req, &iatt, NULL,
+                                     &parent);
+                afr_empty_gfid_on_set (gfid, ret, &iatt);
+                if (ret) {
+                        gf_log (this->name, GF_LOG_DEBUG, "lookup of %s "
+                                "failed", loc->path);
+                        goto out;
+                }
+                afr_fill_loc_info (loc, &iatt, &parent);
+
+                if (!next)
+                        break;
+
+                if (!IA_ISDIR (iatt.ia_type)) {
+                        ret = -1;
+                        goto out;
+                }
+
+                loc_wipe (&parentloc);
+                parentloc = *loc;
+                memset (loc, 0, sizeof (*loc));
+                component = next;
+        }
+
+        if (!ret)
+                *stbuf = iatt;
+out:
+        if (ret)
+                loc_wipe (loc);
+        loc_wipe (&parentloc);
+        if (xattr_req)
+                dict_unref (xattr_req);
+        if (dup)
+                GF_FREE (dup);
+        return ret;
+}
+
+/*
+ * Heal scheduler of the index crawl. Index entries are resolved in
+ * batches, ordered so that the heals which are cheap and most likely
+ * to be waited upon go first, and handed out to up to shd-max-heals
+ * tasks healing in parallel. Each heal runs in the foreground of its
+ * task, so the daemon never has more than that many files open.
+ */
+#define AFR_SHD_BATCH_SIZE 1024
+
+typedef struct afr_shd_heal_job_ {
+        struct list_head list;
+        char             *path;
+        uuid_t           gfid;
+        loc_t            loc;
+        struct iatt      iatt;
+} afr_shd_heal_job_t;
+
+typedef struct afr_shd_batch_ {
+        struct list_head jobs;
+        int              count;
+} afr_shd_batch_t;
+
+static void
+afr_shd_heal_job_free (afr_shd_heal_job_t *job)
+{
+        loc_wipe (&job->loc);
+        if (job->path)
+                GF_FREE (job->path);
+        GF_FREE (job);
+}
+
+static int
+afr_size_bucket (uint64_t size)
+{
+        int     bucket = 0;
+
+        while (size) {
+                size >>= 1;
+                bucket++;
+        }
+        return bucket;
+}
+
+/* Directories and other non-regular files first: they are cheap and
+ * their heal may bring back entries that are waited upon. Then smaller
+ * files before larger ones, within a power of two the recently used
+ * ones first.
+ */
+static int
+afr_shd_heal_job_cmp (const void *a, const void *b)
+{
+        afr_shd_heal_job_t  *ja = *(afr_shd_heal_job_t **)a;
+        afr_shd_heal_job_t  *jb = *(afr_shd_heal_job_t **)b;
+        int                 ra = 0;
+        int                 rb = 0;
+        int                 sa = 0;
+        int                 sb = 0;
+
+        ra = IA_ISREG (ja->iatt.ia_type);
+        rb = IA_ISREG (jb->iatt.ia_type);
+        if (ra != rb)
+                return ra - rb;
+
+        sa = afr_size_bucket (ja->iatt.ia_size);
+        sb = afr_size_bucket (jb->iatt.ia_size);
+        if (sa != sb)
+                return sa - sb;
+
+        if (ja->iatt.ia_atime != jb->iatt.ia_atime)
+                return (ja->iatt.ia_atime < jb->iatt.ia_atime) ? 1 : -1;
+        return 0;
+}
+
+/* Looks the entry up once more, now letting it heal. The bricks drop
+ * the index entry if the changelog turns out to be clean.
+ */
+static int
+afr_shd_heal_job_run (xlator_t *this, afr_shd_heal_job_t *job)
+{
+        dict_t           *xattr_req = NULL;
+        struct iatt      iatt = {0};
+        struct iatt      parent = {0};
+        int              ret = -1;
+
+        xattr_req = dict_new ();
+        if (!xattr_req)
+                goto out;
+
+        ret = dict_set_uint32 (xattr_req, GF_XATTROP_INDEX_CHECK_KEY, 1);
+        if (!ret)
+                ret = dict_set_uint32 (xattr_req, AFR_LOOKUP_FG_HEAL_KEY, 1);
+        if (ret)
+                goto out;
+
+        ret = syncop_lookup (this, &job->loc, xattr_req, &iatt, NULL,
+                             &parent);
+        if (ret) {
+                gf_log (this->name, GF_LOG_DEBUG, "heal of %s failed",
+                        job->loc.path);
+                goto out;
+        }
+
+        if (uuid_compare (iatt.ia_gfid, job->gfid))
+                gf_log (this->name, GF_LOG_INFO, "%s no longer refers to "
+                        "%s, a full heal is needed to find it", job->path,
+                        uuid_utoa (job->gfid));
+out:
+        if (xattr_req)
+                dict_unref (xattr_req);
+        return ret;
+}
+
+static void
+afr_shd_heal_drain (xlator_t *this)
+{
+        afr_private_t      *priv = NULL;
+        afr_self_heald_t   *shd = NULL;
+        afr_shd_heal_job_t *job = NULL;
+
+        priv = this->private;
+        shd = &priv->shd;
+
+        for (;;) {
+                job = NULL;
+                LOCK (&priv->lock);
+                {
+                        if (!list_empty (&shd->heal_queue)) {
+                                job = list_entry (shd->heal_queue.next,
+                                                  afr_shd_heal_job_t, list);
+                                list_del_init (&job->list);
+                        }
+                }
+                UNLOCK (&priv->lock);
+
+                if (!job)
+                        break;
+
+                /* failures are most likely split-brains, keep going */
+                if (afr_up_children_count (priv->child_up,
+                                           priv->child_count) >= 2)
+                        afr_shd_heal_job_run (this, job);
+                afr_shd_heal_job_free (job);
+        }
+}
+
+static int
+afr_shd_heal_worker (void *data)
+{
+        xlator_t           *this = data;
+        afr_private_t      *priv = NULL;
+        afr_self_heald_t   *shd = NULL;
+        struct synctask    *waiter = NULL;
+
+        priv = this->private;
+        shd = &priv->shd;
+
+        afr_shd_heal_drain (this);
+
+        LOCK (&priv->lock);
+        {
+                if (!--shd->heal_workers) {
+                        waiter = shd->heal_waiter;
+                        shd->heal_waiter = NULL;
+                }
+        }
+        UNLOCK (&priv->lock);
+
+        if (waiter)
+                synctask_wake (waiter);
+        return 0;
+}
+
+static int
+afr_shd_heal_worker_done (int ret, call_frame_t *frame, void *data)
+{
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+static void
+afr_shd_spawn_workers (xlator_t *this, int count)
+{
+        afr_private_t      *priv = NULL;
+        afr_self_heald_t   *shd = NULL;
+        call_frame_t       *frame = NULL;
+        int                i = 0;
+        int                ret = 0;
+
+        priv = this->private;
+        shd = &priv->shd;
+
+        for (i = 0; i < count; i++) {
+                frame = create_frame (this, this->ctx->pool);
+                if (!frame)
+                        break;
+                afr_set_lk_owner (frame, this);
+                afr_set_low_priority (frame);
+
+                LOCK (&priv->lock);
+                {
+                        shd->heal_workers++;
+                }
+                UNLOCK (&priv->lock);
+
+                ret = synctask_new (this->ctx->env, afr_shd_heal_worker,
+                                    afr_shd_heal_worker_done, frame, this);
+                if (ret) {
+                        LOCK (&priv->lock);
+                        {
+                                shd->heal_workers--;
+                        }
+                        UNLOCK (&priv->lock);
+                        STACK_DESTROY (frame->root);
+                        break;
+                }
+        }
+}
+
+/* Heals the jobs of @batch in priority order, returns once all of
+ * them are done.
+ */
+static void
+afr_shd_heal_batch (xlator_t *this, afr_shd_batch_t *batch)
+{
+        afr_private_t      *priv = NULL;
+        afr_self_heald_t   *shd = NULL;
+        afr_shd_heal_job_t **jobs = NULL;
+        afr_shd_heal_job_t *job = NULL;
+        afr_shd_heal_job_t *tmp = NULL;
+        struct synctask    *task = NULL;
+        int                i = 0;
+        int                helpers = 0;
+
+        priv = this->private;
+        shd = &priv->shd;
+
+        if (!batch->count)
+                return;
+
+        jobs = GF_CALLOC (batch->count, sizeof (*jobs),
+                          gf_afr_mt_shd_heal_job_t);
+        if (jobs) {
+                list_for_each_entry (job, &batch->jobs, list)
+                        jobs[i++] = job;
+                qsort (jobs, batch->count, sizeof (*jobs),
+                       afr_shd_heal_job_cmp);
+        }
+
+        LOCK (&priv->lock);
+        {
+                if (jobs) {
+                        for (i = 0; i < batch->count; i++) {
+                                list_del_init (&jobs[i]->list);
+                                list_add_tail (&jobs[i]->list,
+                                               &shd->heal_queue);
+                        }
+                } else {
+                        list_for_each_entry_safe (job, tmp, &batch->jobs,
+                                                  list) {
+                                list_del_init (&job->list);
+                                list_add_tail (&job->list, &shd->heal_queue);
+                        }
+                }
+        }
+        UNLOCK (&priv->lock);
+
+        helpers = min (priv->shd_max_heals, batch->count) - 1;
+        batch->count = 0;
+        if (jobs)
+                GF_FREE (jobs);
+
+        afr_shd_spawn_workers (this, helpers);
+        afr_shd_heal_drain (this);
+
+        task = synctask_get ();
+        LOCK (&priv->lock);
+        {
+                if (shd->heal_workers) {
+                        shd->heal_waiter = task;
+                        synctask_yawn (task);
+                } else {
+                        task = NULL;
+                }
+        }
+        UNLOCK (&priv->lock);
+
+        if (task)
+                synctask_yield (task);
+}
+
+static int
+_queue_index_entry (xlator_t *this, int child, uuid_t gfid, char *path,
+                    void *data)
+{
+        afr_private_t      *priv = NULL;
+        afr_shd_batch_t    *batch = data;
+        afr_shd_heal_job_t *job = NULL;
+        int                ret = 0;
+
+        priv = this->private;
+        if (afr_up_children_count (priv->child_up, priv->child_count) < 2) {
+                gf_log (this->name, GF_LOG_ERROR, "Stopping crawl as "
+                        "< 2 children are up");
+                return -1;
+        }
+
+        if (!path[0]) {
+                gf_log (this->name, GF_LOG_INFO, "no path recorded for %s "
+                        "on %s, a full heal is needed to find it",
+                        uuid_utoa (gfid), priv->children[child]->name);
+                return 0;
+        }
+
+        job = GF_CALLOC (1, sizeof (*job), gf_afr_mt_shd_heal_job_t);
+        if (!job)
+                return 0;
+        INIT_LIST_HEAD (&job->list);
+        uuid_copy (job->gfid, gfid);
+        job->path = gf_strdup (path);
+        if (!job->path)
+                goto free;
+
+        /* failures are most likely split-brains, keep going */
+        ret = afr_resolve_index_path (this, path, &job->loc, &job->iatt);
+        if (ret)
+                goto free;
+
+        list_add_tail (&job->list, &batch->jobs);
+        if (++batch->count >= AFR_SHD_BATCH_SIZE)
+                afr_shd_heal_batch (this, batch);
+        return 0;
+free:
+        afr_shd_heal_job_free (job);
+        return 0;
+}
+
+/* Heals what the indices of the local bricks point at. Returns 1 if
+ * some local brick keeps no index, so that the caller falls back to a
+ * full crawl.
+ */
+static int
+_crawl_index (xlator_t *this)
+{
+        afr_private_t      *priv = NULL;
+        afr_shd_batch_t    batch = {{0},};
+        afr_shd_heal_job_t *job = NULL;
+        afr_shd_heal_job_t *tmp = NULL;
+        int                i = 0;
+        int                ret = 0;
+
+        priv = this->private;
+        INIT_LIST_HEAD (&batch.jobs);
+
+        for (i = 0; i < priv->child_count; i++) {
+                if ((priv->shd.pos[i] != AFR_POS_LOCAL) ||
+                    !priv->child_up[i])
+                        continue;
+
+                gf_log (this->name, GF_LOG_DEBUG, "crawling the index of %s",
+                        priv->children[i]->name);
+                ret = afr_index_foreach (this, i, _queue_index_entry, &batch);
+                if (ret == -1) {
+                        if (afr_up_children_count (priv->child_up,
+                                                   priv->child_count) < 2)
+                                goto out;
+                        gf_log (this->name, GF_LOG_WARNING, "could not read "
+                                "the index of %s, falling back to a full "
+                                "crawl", priv->children[i]->name);
+                        ret = 1;
+                        goto out;
+                }
+                afr_shd_heal_batch (this, &batch);
+        }
+out:
+        list_for_each_entry_safe (job, tmp, &batch.jobs, list) {
+                list_del_init (&job->list);
+                afr_shd_heal_job_free (job);
+        }
+        return ret;
+}
+
+typedef struct afr_heal_info_ {
+        dict_t          *output;
+        int             brick;
+        int             count;
+        int             listed;
+} afr_heal_info_t;
+
+static int
+_add_heal_info_entry (xlator_t *this, int child, uuid_t gfid, char *path,
+                      void *data)
+{
+        afr_heal_info_t  *info = data;
+        char             key[256] = {0};
+        char             *entry = NULL;
+        int              ret = 0;
+
+        info->count++;
+        if (info->listed >= AFR_HEAL_INFO_MAX_ENTRIES)
+                return 0;
+
+        if (path[0])
+                entry = gf_strdup (path);
+        else
+                ret = gf_asprintf (&entry, "<gfid:%s>", uuid_utoa (gfid));
+        if (!entry || (ret < 0))
+                return -1;
+
+        snprintf (key, sizeof (key), "%d-entry-%d", info->brick,
+                  info->listed);
+        ret = dict_set_dynstr (info->output, key, entry);
+        if (ret) {
+                GF_FREE (entry);
+                return -1;
+        }
+        info->listed++;
+        return 0;
+}
+
+static int
+afr_add_heal_info (xlator_t *this, int child, dict_t *output)
+{
+        afr_private_t    *priv = NULL;
+        afr_heal_info_t  info = {0};
+        xlator_t         *subvol = NULL;
+        char             key[256] = {0};
+        char             *host = NULL;
+        char             *brick = NULL;
+        char             *name = NULL;
+        int32_t          brick_count = 0;
+        int              ret = 0;
+
+        priv = this->private;
+        subvol = priv->children[child];
+
+        ret = dict_get_int32 (output, "brick-count", &brick_count);
+        if (ret)
+                brick_count = 0;
+
+        info.output = output;
+        info.brick = brick_count;
+
+        if (!dict_get_str (subvol->options, "remote-host", &host) &&
+            !dict_get_str (subvol->options, "remote-subvolume", &brick))
+                ret = gf_asprintf (&name, "%s:%s", host, brick);
+        else
+                ret = gf_asprintf (&name, "%s", subvol->name);
+        if (ret < 0)
+                goto out;
+
+        snprintf (key, sizeof (key), "%d-brick", info.brick);
+        ret = dict_set_dynstr (output, key, name);
+        if (ret) {
+                GF_FREE (name);
+                goto out;
+        }
+
+        snprintf (key, sizeof (key), "%d-status", info.brick);
+        if (!priv->child_up[child]) {
+                ret = dict_set_str (output, key, "Brick is not connected");
+        } else if (afr_index_foreach (this, child, _add_heal_info_entry,
+                                      &info)) {
+                ret = dict_set_str (output, key, "Could not read the index "
+                                    "of the brick");
+        } else {
+                ret = dict_set_str (output, key, "");
+        }
+        if (ret)
+                goto out;
+
+        snprintf (key, sizeof (key), "%d-count", info.brick);
+        ret = dict_set_int32 (output, key, info.count);
+        if (ret)
+                goto out;
+
+        snprintf (key, sizeof (key), "%d-listed", info.brick);
+        ret = dict_set_int32 (output, key, info.listed);
+        if (ret)
+                goto out;
+
+        ret = dict_set_int32 (output, "brick-count", brick_count + 1);
+out:
+        return ret;
+}
+
+int
+afr_xl_op (xlator_t *this, dict_t *input, dict_t *output)
+{
+        afr_private_t    *priv = NULL;
+        int32_t          heal_op = GF_AFR_OP_HEAL_INDEX;
+        int              i = 0;
+        int              ret = -1;
+
+        priv = this->private;
+
+        ret = dict_get_int32 (input, "heal-op", &heal_op);
+        if (ret || (heal_op != GF_AFR_OP_INDEX_SUMMARY))
                 goto out;
+
+        ret = afr_init_root_inode (this);
+        if (ret)
+                goto out;
+
+        for (i = 0; i < priv->child_count; i++) {
+                ret = afr_add_heal_info (this, i, output);
+                if (ret)
+                        goto out;
         }
+out:
+        return ret;
+}
+
+int
+afr_find_child_position (xlator_t *this, int child)
+{
+        afr_private_t    *priv = NULL;
+        dict_t           *xattr_rsp = NULL;
+        loc_t            loc = {0};
+        int              ret = 0;
+        gf_boolean_t     local = _gf_false;
+        char             *pathinfo = NULL;
+        afr_child_pos_t  *pos = NULL;
+
+        priv = this->private;
+        pos = &priv->shd.pos[child];
+
+        if (*pos != AFR_POS_UNKNOWN) {
+                goto out;
+        }
+
+        ret = afr_init_root_inode (this);
+        if (ret)
+                goto out;
         afr_build_root_loc (priv->root_inode, &loc);
 
         ret = syncop_getxattr (priv->children[child], &loc, &xattr_rsp,
@@ -375,7 +1063,7 @@ afr_is_local_child (afr_self_heald_t *shd, int child, unsigned int child_count)
 }
 
 static int
-afr_crawl_directory (xlator_t *this, pid_t pid)
+afr_crawl_directory (xlator_t *this, pid_t pid, afr_crawl_type_t type)
 {
         afr_private_t    *priv = NULL;
         afr_self_heald_t *shd = NULL;
@@ -392,6 +1080,8 @@ afr_crawl_directory (xlator_t *this, pid_t pid)
         {
                 if (shd->inprogress) {
                         shd->pending = _gf_true;
+                        if (type == AFR_CRAWL_FULL)
+                                shd->pending_full = _gf_true;
                 } else {
                         shd->inprogress = _gf_true;
                         crawl = _gf_true;
@@ -409,7 +1099,11 @@ afr_crawl_directory (xlator_t *this, pid_t pid)
 
         afr_build_root_loc (priv->root_inode, &loc);
         while (crawl) {
-                ret = _crawl_directory (&loc, pid, gfid);
+                ret = 1;
+                if (type == AFR_CRAWL_INDEX)
+                        ret = _crawl_index (this);
+                if (ret == 1)
+                        ret = _crawl_directory (&loc, pid, gfid);
                 if (ret)
                         gf_log (this->name, GF_LOG_ERROR, "Crawl failed");
                 else
@@ -418,6 +1112,9 @@ afr_crawl_directory (xlator_t *this, pid_t pid)
                 {
                         if (shd->pending) {
                                 shd->pending = _gf_false;
+                                type = shd->pending_full ? AFR_CRAWL_FULL :
+                                                           AFR_CRAWL_INDEX;
+                                shd->pending_full = _gf_false;
                         } else {
                                 shd->inprogress = _gf_false;
                                 crawl = _gf_false;
@@ -437,25 +1134,33 @@ afr_crawl (void *data)
         afr_self_heald_t *shd = NULL;
         int              ret = -1;
         afr_crawl_data_t *crawl_data = data;
+        int              child = 0;
 
         this = THIS;
         priv = this->private;
         shd = &priv->shd;
 
-        ret = afr_init_child_position (this, crawl_data->child);
+        /* The index that matters when a child comes back is on the
+         * bricks that stayed up, so index crawls look at every local
+         * brick whichever child triggered them. */
+        child = crawl_data->child;
+        if (crawl_data->crawl == AFR_CRAWL_INDEX)
+                child = AFR_ALL_CHILDREN;
+
+        ret = afr_init_child_position (this, child);
         if (ret)
                 goto out;
 
-        if (!afr_is_local_child (shd, crawl_data->child, priv->child_count))
+        if (!afr_is_local_child (shd, child, priv->child_count))
                 goto out;
 
-        ret = afr_crawl_directory (this, crawl_data->pid);
+        ret = afr_crawl_directory (this, crawl_data->pid, crawl_data->crawl);
 out:
         return ret;
 }
 
 void
-afr_proactive_self_heal (xlator_t *this, int idx)
+afr_proactive_self_heal (xlator_t *this, int idx, afr_crawl_type_t crawl)
 {
         afr_private_t              *priv = NULL;
         afr_self_heald_t           *shd = NULL;
@@ -468,7 +1173,7 @@ afr_proactive_self_heal (xlator_t *this, int idx)
         if (!shd->enabled)
                 goto out;
 
-        if ((idx != AFR_ALL_CHILDREN) &&
+        if ((crawl == AFR_CRAWL_FULL) && (idx != AFR_ALL_CHILDREN) &&
             (shd->pos[idx] == AFR_POS_REMOTE))
                 goto out;
 
@@ -484,7 +1189,9 @@ afr_proactive_self_heal (xlator_t *this, int idx)
                 goto out;
         crawl_data->child = idx;
         crawl_data->pid = frame->root->pid;
-        gf_log (this->name, GF_LOG_INFO, "starting crawl for %d", idx);
+        crawl_data->crawl = crawl;
+        gf_log (this->name, GF_LOG_INFO, "starting %s crawl for %d",
+                (crawl == AFR_CRAWL_FULL) ? "full" : "index", idx);
         ret = synctask_new (this->ctx->env, afr_crawl,
                             afr_crawl_done, frame, crawl_data);
         if (ret)
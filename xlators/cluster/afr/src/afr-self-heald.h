@@ -25,13 +25,26 @@
 #define IS_ENTRY_CWD(entry) (!strcmp (entry, "."))
 #define IS_ENTRY_PARENT(entry) (!strcmp (entry, ".."))
 #define AFR_ALL_CHILDREN -1
+#define AFR_HEAL_INFO_MAX_ENTRIES 1024
+
+typedef enum {
+        AFR_CRAWL_INDEX,
+        AFR_CRAWL_FULL,
+} afr_crawl_type_t;
 
 typedef struct afr_crawl_data_ {
-        int     child;
-        pid_t   pid;
+        int                     child;
+        pid_t                   pid;
+        afr_crawl_type_t        crawl;
 } afr_crawl_data_t;
 
-void afr_proactive_self_heal (xlator_t *this, int idx);
+typedef int (*afr_index_entry_fn_t) (xlator_t *this, int child,
+                                     uuid_t gfid, char *path, void *data);
+
+void afr_proactive_self_heal (xlator_t *this, int idx,
+                              afr_crawl_type_t crawl);
+
+int afr_xl_op (xlator_t *this, dict_t *input, dict_t *output);
 
 void afr_build_root_loc (inode_t *inode, loc_t *loc);
 
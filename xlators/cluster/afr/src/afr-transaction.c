@@ -32,6 +32,8 @@
                                       of RENAME */
 #define LOCKED_LOWER    0x2        /* for lower_path of RENAME */
 
+static int afr_quorum_log;
+
 
 afr_fd_ctx_t *
 afr_fd_ctx_get (fd_t *fd, xlator_t *this)
@@ -231,6 +233,9 @@ __fop_changelog_needed (call_frame_t *frame, xlator_t *this)
 
                 case GF_FOP_WRITE:
                 case GF_FOP_FTRUNCATE:
+                case GF_FOP_FALLOCATE:
+                case GF_FOP_DISCARD:
+                case GF_FOP_ZEROFILL:
                         op_ret = 1;
                         break;
 
@@ -674,6 +679,360 @@ out:
 }
 
 
+/* {{{ delayed post-op */
+
+/* Only a write which went fine everywhere is held back: a failure has
+ * to reach the changelog right away. Neither is a write on a file open
+ * more than once, as the writes on the other fds would wait for the
+ * eager lock till the timer fires.
+ */
+static gf_boolean_t
+afr_changelog_post_op_can_delay (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv     = NULL;
+        afr_local_t     *local    = NULL;
+        inode_t         *inode    = NULL;
+        fd_t            *fd       = NULL;
+        int              index    = 0;
+        int              fd_count = 0;
+        int              i        = 0;
+
+        priv  = this->private;
+        local = frame->local;
+
+        if (!priv->eager_lock || !priv->post_op_delay_secs)
+                return _gf_false;
+        if (!local->fd || (local->op != GF_FOP_WRITE) ||
+            (local->transaction.type != AFR_DATA_TRANSACTION))
+                return _gf_false;
+
+        index = afr_index_for_transaction_type (local->transaction.type);
+        for (i = 0; i < priv->child_count; i++) {
+                if (!priv->child_up[i] || !local->transaction.pre_op[i] ||
+                    !local->pending[i][index])
+                        return _gf_false;
+        }
+
+        inode = local->fd->inode;
+        LOCK (&inode->lock);
+        {
+                list_for_each_entry (fd, &inode->fd_list, inode_list) {
+                        fd_count++;
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        if (fd_count > 1)
+                return _gf_false;
+
+        return _gf_true;
+}
+
+/* The timer of the held back write is owned by whoever clears
+ * delay_timer under fd->lock: that side frees the event and drops the
+ * ref on the fd taken for it. The timer of a later write may have been
+ * set by the time an earlier one, already taken over by a wake up,
+ * gets to run, so the callback only takes a timer which is due.
+ */
+static void
+afr_delayed_changelog_post_op (void *data)
+{
+        fd_t            *fd       = data;
+        xlator_t        *this     = NULL;
+        afr_fd_ctx_t    *fd_ctx   = NULL;
+        call_frame_t    *frame    = NULL;
+        gf_timer_t      *timer    = NULL;
+        struct timeval   now      = {0,};
+
+        this = THIS;
+        fd_ctx = afr_fd_ctx_get (fd, this);
+        if (!fd_ctx)
+                return;
+
+        gettimeofday (&now, NULL);
+
+        LOCK (&fd->lock);
+        {
+                timer = fd_ctx->delay_timer;
+                if (timer && !timercmp (&now, &timer->at, <)) {
+                        frame = fd_ctx->delay_frame;
+                        fd_ctx->delay_frame = NULL;
+                        fd_ctx->delay_timer = NULL;
+                } else {
+                        timer = NULL;
+                }
+        }
+        UNLOCK (&fd->lock);
+
+        if (!timer)
+                return;
+
+        /* the event fired, it is up to us to free it */
+        gf_timer_call_cancel (this->ctx, timer);
+
+        if (frame)
+                afr_changelog_post_op (frame, this);
+
+        fd_unref (fd);
+}
+
+/* Lets the write transaction held back on @fd, if any, finish. When a
+ * later transaction on @fd has already piggybacked on its pre-op and
+ * lock, both the post-op and the unlock turn into no-ops.
+ */
+void
+afr_delayed_changelog_wake_up (xlator_t *this, fd_t *fd)
+{
+        afr_fd_ctx_t    *fd_ctx   = NULL;
+        call_frame_t    *frame    = NULL;
+        gf_timer_t      *timer    = NULL;
+
+        fd_ctx = afr_fd_ctx_get (fd, this);
+        if (!fd_ctx)
+                return;
+
+        LOCK (&fd->lock);
+        {
+                frame = fd_ctx->delay_frame;
+                timer = fd_ctx->delay_timer;
+                fd_ctx->delay_frame = NULL;
+                fd_ctx->delay_timer = NULL;
+        }
+        UNLOCK (&fd->lock);
+
+        if (timer) {
+                gf_timer_call_cancel (this->ctx, timer);
+                fd_unref (fd);
+        }
+
+        if (frame)
+                afr_changelog_post_op (frame, this);
+}
+
+/* Holds the post-op (and so the eager lock) of @frame back for
+ * post-op-delay-secs. Returns _gf_false if the caller has to go on
+ * with the post-op itself.
+ */
+static gf_boolean_t
+afr_changelog_post_op_delay (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv     = NULL;
+        afr_local_t     *local    = NULL;
+        afr_fd_ctx_t    *fd_ctx   = NULL;
+        gf_timer_t      *timer    = NULL;
+        struct timeval   delta    = {0,};
+
+        priv  = this->private;
+        local = frame->local;
+
+        if (!afr_changelog_post_op_can_delay (frame, this))
+                return _gf_false;
+
+        fd_ctx = afr_fd_ctx_get (local->fd, this);
+        if (!fd_ctx)
+                return _gf_false;
+
+        /* two writes may have been in flight together */
+        afr_delayed_changelog_wake_up (this, local->fd);
+
+        delta.tv_sec = priv->post_op_delay_secs;
+
+        /* the timer can not fire before it is in fd_ctx */
+        LOCK (&local->fd->lock);
+        {
+                timer = gf_timer_call_after (this->ctx, delta,
+                                             afr_delayed_changelog_post_op,
+                                             fd_ref (local->fd));
+                if (timer) {
+                        fd_ctx->delay_frame = frame;
+                        fd_ctx->delay_timer = timer;
+                }
+        }
+        UNLOCK (&local->fd->lock);
+
+        if (!timer) {
+                fd_unref (local->fd);
+                return _gf_false;
+        }
+
+        return _gf_true;
+}
+
+/* }}} */
+
+static int
+afr_changelog_pre_op_done (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+
+        local = frame->local;
+
+        /* the pre-op and the lock of a held back write
+           are shared by now, it may go */
+        if (local->fd &&
+            (local->transaction.type == AFR_DATA_TRANSACTION))
+                afr_delayed_changelog_wake_up (this, local->fd);
+
+        afr_pid_restore (frame);
+
+        local->transaction.fop (frame, this);
+
+        return 0;
+}
+
+/* {{{ dirty regions */
+
+/* A data transaction which could not pre-op on some child leaves that
+ * child behind. The regions it writes are recorded on the children
+ * which do take part before the fop goes out, so that data self-heal
+ * can restrict itself to them. A child which fails to record them is
+ * treated as if the fop failed there: it keeps accusing itself and is
+ * never trusted as a source for a region-limited heal.
+ */
+
+static gf_boolean_t
+afr_changelog_regions_needed (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t *priv  = NULL;
+        afr_local_t   *local = NULL;
+        int            i     = 0;
+
+        priv  = this->private;
+        local = frame->local;
+
+        if (local->transaction.type != AFR_DATA_TRANSACTION)
+                return _gf_false;
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (!local->transaction.pre_op[i])
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+int32_t
+afr_changelog_regions_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int32_t op_ret, int32_t op_errno, dict_t *xattr)
+{
+        afr_local_t   *local       = NULL;
+        afr_private_t *priv        = NULL;
+        int            call_count  = -1;
+        int            child_index = (long) cookie;
+
+        local = frame->local;
+        priv  = this->private;
+
+        LOCK (&frame->lock);
+        {
+                if (op_ret == -1) {
+                        gf_log (this->name, GF_LOG_INFO,
+                                "failed to record dirty regions of %s on "
+                                "%s: %s", local->loc.path,
+                                priv->children[child_index]->name,
+                                strerror (op_errno));
+                        afr_transaction_fop_failed (frame, this,
+                                                    child_index);
+                }
+
+                call_count = --local->call_count;
+        }
+        UNLOCK (&frame->lock);
+
+        if (call_count == 0)
+                afr_changelog_pre_op_done (frame, this);
+
+        return 0;
+}
+
+static int
+afr_changelog_mark_regions (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t *priv       = NULL;
+        afr_local_t   *local      = NULL;
+        unsigned char *regions    = NULL;
+        dict_t       **xattr      = NULL;
+        char          *value      = NULL;
+        int            call_count = 0;
+        int            i          = 0;
+        int            ret        = 0;
+
+        priv  = this->private;
+        local = frame->local;
+
+        regions = alloca (AFR_DIRTY_REGIONS_SIZE);
+        memset (regions, 0, AFR_DIRTY_REGIONS_SIZE);
+        afr_dirty_regions_mark (regions, local->transaction.start,
+                                local->transaction.len);
+
+        xattr = alloca (priv->child_count * sizeof (*xattr));
+        memset (xattr, 0, (priv->child_count * sizeof (*xattr)));
+        for (i = 0; i < priv->child_count; i++) {
+                if (!local->transaction.pre_op[i])
+                        continue;
+
+                /* one dict each, posix returns the result in it */
+                xattr[i] = dict_new ();
+                value = memdup (regions, AFR_DIRTY_REGIONS_SIZE);
+                if (!xattr[i] || !value)
+                        goto err;
+
+                ret = dict_set_bin (xattr[i], AFR_DIRTY_REGIONS_KEY, value,
+                                    AFR_DIRTY_REGIONS_SIZE);
+                if (ret)
+                        goto err;
+                value = NULL;
+                call_count++;
+        }
+
+        local->call_count = call_count;
+        for (i = 0; i < priv->child_count; i++) {
+                if (!xattr[i])
+                        continue;
+
+                if (local->fd)
+                        STACK_WIND_COOKIE (frame, afr_changelog_regions_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->fxattrop,
+                                           local->fd, GF_XATTROP_OR_ARRAY,
+                                           xattr[i]);
+                else
+                        STACK_WIND_COOKIE (frame, afr_changelog_regions_cbk,
+                                           (void *) (long) i,
+                                           priv->children[i],
+                                           priv->children[i]->fops->xattrop,
+                                           &local->loc, GF_XATTROP_OR_ARRAY,
+                                           xattr[i]);
+
+                if (!--call_count)
+                        break;
+        }
+
+        for (i = 0; i < priv->child_count; i++) {
+                if (xattr[i])
+                        dict_unref (xattr[i]);
+        }
+
+        return 0;
+err:
+        if (value)
+                GF_FREE (value);
+
+        /* without the map no child may vouch for these regions */
+        for (i = 0; i < priv->child_count; i++) {
+                if (xattr[i])
+                        dict_unref (xattr[i]);
+                if (local->transaction.pre_op[i])
+                        afr_transaction_fop_failed (frame, this, i);
+        }
+
+        afr_changelog_pre_op_done (frame, this);
+        return 0;
+}
+
+/* }}} */
+
 int32_t
 afr_changelog_pre_op_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                           int32_t op_ret, int32_t op_errno, dict_t *xattr)
@@ -724,9 +1083,10 @@ afr_changelog_pre_op_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         __mark_all_success (local->pending, priv->child_count,
                                             local->transaction.type);
 
-                        afr_pid_restore (frame);
-
-                        local->transaction.fop (frame, this);
+                        if (afr_changelog_regions_needed (frame, this))
+                                afr_changelog_mark_regions (frame, this);
+                        else
+                                afr_changelog_pre_op_done (frame, this);
                 }
         }
 
@@ -1128,6 +1488,24 @@ afr_lock_rec (call_frame_t *frame, xlator_t *this)
 }
 
 
+/* An eager lock is taken by one transaction on the fd and released by
+ * whichever transaction sharing it is the last, so they all have to
+ * use the same owner.
+ */
+static void
+afr_set_eager_lk_owner (call_frame_t *frame, xlator_t *this)
+{
+        afr_private_t   *priv  = NULL;
+        afr_local_t     *local = NULL;
+
+        priv  = this->private;
+        local = frame->local;
+
+        if (priv->eager_lock && local->fd &&
+            (local->transaction.type == AFR_DATA_TRANSACTION))
+                frame->root->lk_owner = (uint64_t) (unsigned long) local->fd;
+}
+
 int
 afr_lock (call_frame_t *frame, xlator_t *this)
 {
@@ -1136,6 +1514,7 @@ afr_lock (call_frame_t *frame, xlator_t *this)
         frame->root->pid = (long) frame->root;
 
         afr_set_lk_owner (frame, this);
+        afr_set_eager_lk_owner (frame, this);
 
         afr_set_lock_number (frame, this);
 
@@ -1169,6 +1548,67 @@ afr_internal_lock_finish (call_frame_t *frame, xlator_t *this)
 }
 
 
+/*
+ * With client quorum on, a fop which some child took but fewer than the
+ * quorum did fails with EROFS. Acknowledging it on a minority would let
+ * the two sides of a partition take conflicting writes, which only a
+ * split-brain resolution could undo.
+ */
+static void
+afr_transaction_check_quorum (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t   *local    = NULL;
+        afr_private_t *priv     = NULL;
+        unsigned char *success  = NULL;
+        gf_boolean_t   pre_op   = _gf_false;
+        int            i        = 0;
+        int            j        = 0;
+
+        local = frame->local;
+        priv  = this->private;
+
+        if (!priv->quorum_count || (local->op_ret == -1))
+                return;
+
+        pre_op = __fop_changelog_needed (frame, this);
+        j = afr_index_for_transaction_type (local->transaction.type);
+
+        success = alloca (priv->child_count);
+        for (i = 0; i < priv->child_count; i++) {
+                success[i] = (local->pending[i][j] != 0);
+                if (pre_op)
+                        success[i] = success[i] &&
+                                     local->transaction.pre_op[i];
+                else
+                        success[i] = success[i] && local->child_up[i];
+        }
+
+        if (afr_have_quorum (this, success))
+                return;
+
+        gf_log (this->name, GF_LOG_WARNING, "%s: fop succeeded on fewer "
+                "subvolumes than the quorum, failing it", local->loc.path);
+
+        local->op_ret   = -1;
+        local->op_errno = EROFS;
+}
+
+
+/* every unwind of a transaction goes through here, so that no fop is
+   acknowledged without the quorum */
+static int
+afr_transaction_unwind (call_frame_t *frame, xlator_t *this)
+{
+        afr_local_t *local = NULL;
+
+        local = frame->local;
+
+        afr_transaction_check_quorum (frame, this);
+
+        return local->transaction.fop_unwind (frame, this);
+}
+
+
 int
 afr_transaction_resume (call_frame_t *frame, xlator_t *this)
 {
@@ -1180,8 +1620,11 @@ afr_transaction_resume (call_frame_t *frame, xlator_t *this)
         int_lock = &local->internal_lock;
         priv     = this->private;
 
+        afr_transaction_check_quorum (frame, this);
+
         if (__fop_changelog_needed (frame, this)) {
-                afr_changelog_post_op (frame, this);
+                if (!afr_changelog_post_op_delay (frame, this))
+                        afr_changelog_post_op (frame, this);
         } else {
                 if (afr_lock_server_count (priv, local->transaction.type) == 0) {
                         local->transaction.done (frame, this);
@@ -1210,6 +1653,12 @@ afr_transaction_fop_failed (call_frame_t *frame, xlator_t *this, int child_index
 
         __mark_child_dead (local->pending, priv->child_count,
                            child_index, local->transaction.type);
+
+        /* the changelog now has something pending, lookups must see it */
+        if (local->fd)
+                afr_inode_clear_clean_gen (this, local->fd->inode);
+        afr_inode_clear_clean_gen (this, local->loc.inode);
+        afr_inode_clear_clean_gen (this, local->loc.parent);
 }
 
 
@@ -1227,6 +1676,23 @@ afr_transaction (call_frame_t *frame, xlator_t *this, afr_transaction_type type)
         local->transaction.resume = afr_transaction_resume;
         local->transaction.type   = type;
 
+        if (local->transaction.unwind != afr_transaction_unwind) {
+                local->transaction.fop_unwind = local->transaction.unwind;
+                local->transaction.unwind     = afr_transaction_unwind;
+        }
+
+        /* without a quorum of the children up, fail before locking
+           rather than write to a minority */
+        if (!afr_have_quorum (this, local->child_up)) {
+                GF_LOG_OCCASIONALLY (afr_quorum_log, this->name,
+                                     GF_LOG_WARNING, "failing fop, client "
+                                     "quorum is not met");
+                local->op_ret   = -1;
+                local->op_errno = EROFS;
+                local->transaction.done (frame, this);
+                return 0;
+        }
+
         if (afr_lock_server_count (priv, local->transaction.type) == 0) {
                 afr_internal_lock_finish (frame, this);
         } else {
@@ -32,4 +32,7 @@ afr_transaction (call_frame_t *frame, xlator_t *this, afr_transaction_type type)
 
 afr_fd_ctx_t *
 afr_fd_ctx_get (fd_t *fd, xlator_t *this);
+
+void
+afr_delayed_changelog_wake_up (xlator_t *this, fd_t *fd);
 #endif /* __TRANSACTION_H__ */
@@ -36,9 +36,18 @@ int32_t
 notify (xlator_t *this, int32_t event,
         void *data, ...)
 {
-        int ret = -1;
+        int      ret   = -1;
+        va_list  ap;
+        void    *data2 = NULL;
+
+        /* only TRANSLATOR_INFO is sent with an output dict */
+        if (event == GF_EVENT_TRANSLATOR_INFO) {
+                va_start (ap, data);
+                data2 = va_arg (ap, dict_t*);
+                va_end (ap);
+        }
 
-        ret = afr_notify (this, event, data);
+        ret = afr_notify (this, event, data, data2);
 
         return ret;
 }
@@ -98,11 +107,34 @@ xlator_subvolume_count (xlator_t *this)
 }
 
 
+/* client quorum also sets how many successes a write waits for before
+   it is unwound */
+static void
+afr_set_quorum (afr_private_t *priv, char *qtype, uint32_t count)
+{
+        if (!strcmp (qtype, "auto"))
+                priv->quorum_count = AFR_QUORUM_AUTO;
+        else if (!strcmp (qtype, "fixed"))
+                priv->quorum_count = min (count, priv->child_count);
+        else
+                priv->quorum_count = 0;
+
+        if (priv->quorum_count == AFR_QUORUM_AUTO)
+                priv->wait_count = priv->child_count / 2 + 1;
+        else if (priv->quorum_count)
+                priv->wait_count = priv->quorum_count;
+        else
+                priv->wait_count = 1;
+}
+
 int
 reconfigure (xlator_t *this, dict_t *options)
 {
         afr_private_t * priv        = NULL;
         xlator_t      * read_subvol     = NULL;
+        char          * read_policy     = NULL;
+        char          * qtype           = NULL;
+        uint32_t        quorum_count    = 0;
         int             ret = -1;
         int             index = -1;
 
@@ -142,6 +174,30 @@ reconfigure (xlator_t *this, dict_t *options)
 
         GF_OPTION_RECONF ("self-heal-daemon", priv->shd.enabled, options, bool, out);
 
+        GF_OPTION_RECONF ("lookup-cached-changelog",
+                          priv->lookup_cached_changelog, options, bool, out);
+
+        GF_OPTION_RECONF ("eager-lock", priv->eager_lock, options, bool, out);
+
+        GF_OPTION_RECONF ("post-op-delay-secs", priv->post_op_delay_secs,
+                          options, uint32, out);
+
+        GF_OPTION_RECONF ("shd-max-heals", priv->shd_max_heals, options,
+                          int32, out);
+
+        GF_OPTION_RECONF ("self-heal-bandwidth", priv->self_heal_bandwidth,
+                          options, size, out);
+
+        GF_OPTION_RECONF ("read-policy", read_policy, options, str, out);
+        priv->read_policy = afr_read_policy_get (read_policy);
+
+        GF_OPTION_RECONF ("read-stripe-size", priv->read_stripe_size,
+                          options, size, out);
+
+        GF_OPTION_RECONF ("quorum-type", qtype, options, str, out);
+        GF_OPTION_RECONF ("quorum-count", quorum_count, options, uint32, out);
+        afr_set_quorum (priv, qtype, quorum_count);
+
         GF_OPTION_RECONF ("read-subvolume", read_subvol, options, xlator, out);
 
         if (read_subvol) {
@@ -181,6 +237,9 @@ init (xlator_t *this)
         GF_UNUSED int   op_errno    = 0;
         xlator_t * read_subvol     = NULL;
         xlator_t * fav_child       = NULL;
+        char     * read_policy     = NULL;
+        char     * qtype           = NULL;
+        uint32_t   quorum_count    = 0;
 
 
         if (!this->children) {
@@ -201,6 +260,11 @@ init (xlator_t *this)
 
         priv->read_child = -1;
 
+        GF_OPTION_INIT ("read-policy", read_policy, str, out);
+        priv->read_policy = afr_read_policy_get (read_policy);
+
+        GF_OPTION_INIT ("read-stripe-size", priv->read_stripe_size, size, out);
+
         GF_OPTION_INIT ("read-subvolume", read_subvol, xlator, out);
         if (read_subvol) {
                 priv->read_child = xlator_subvolume_index (this, read_subvol);
@@ -244,6 +308,19 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("self-heal-daemon", priv->shd.enabled, bool, out);
 
+        GF_OPTION_INIT ("lookup-cached-changelog",
+                        priv->lookup_cached_changelog, bool, out);
+
+        GF_OPTION_INIT ("eager-lock", priv->eager_lock, bool, out);
+
+        GF_OPTION_INIT ("post-op-delay-secs", priv->post_op_delay_secs,
+                        uint32, out);
+
+        GF_OPTION_INIT ("shd-max-heals", priv->shd_max_heals, int32, out);
+
+        GF_OPTION_INIT ("self-heal-bandwidth", priv->self_heal_bandwidth,
+                        size, out);
+
         GF_OPTION_INIT ("data-change-log", priv->data_change_log, bool, out);
 
         GF_OPTION_INIT ("metadata-change-log", priv->metadata_change_log, bool,
@@ -266,6 +343,10 @@ init (xlator_t *this)
 
         priv->child_count = child_count;
 
+        GF_OPTION_INIT ("quorum-type", qtype, str, out);
+        GF_OPTION_INIT ("quorum-count", quorum_count, uint32, out);
+        afr_set_quorum (priv, qtype, quorum_count);
+
         LOCK_INIT (&priv->lock);
         LOCK_INIT (&priv->read_child_lock);
 
@@ -317,6 +398,14 @@ init (xlator_t *this)
                 i++;
         }
 
+        priv->child_stats = GF_CALLOC (child_count,
+                                       sizeof (*priv->child_stats),
+                                       gf_afr_mt_child_stats_t);
+        if (!priv->child_stats) {
+                ret = -ENOMEM;
+                goto out;
+        }
+
         priv->last_event = GF_CALLOC (child_count, sizeof (*priv->last_event),
                                       gf_afr_mt_int32_t);
         if (!priv->last_event) {
@@ -337,6 +426,9 @@ init (xlator_t *this)
 
         pthread_mutex_init (&priv->mutex, NULL);
         INIT_LIST_HEAD (&priv->saved_fds);
+        INIT_LIST_HEAD (&priv->shd.heal_queue);
+        INIT_LIST_HEAD (&priv->deferred_heals);
+        LOCK_INIT (&priv->heal_throttle.lock);
 
         ret = 0;
 out:
@@ -370,6 +462,7 @@ struct xlator_fops fops = {
         .access      = afr_access,
         .stat        = afr_stat,
         .fstat       = afr_fstat,
+        .seek        = afr_seek,
         .readlink    = afr_readlink,
         .getxattr    = afr_getxattr,
         .readv       = afr_readv,
@@ -382,6 +475,9 @@ struct xlator_fops fops = {
         .setattr     = afr_setattr,
         .fsetattr    = afr_fsetattr,
         .removexattr = afr_removexattr,
+        .fallocate   = afr_fallocate,
+        .discard     = afr_discard,
+        .zerofill    = afr_zerofill,
 
         /* dir read */
         .opendir     = afr_opendir,
@@ -419,6 +515,49 @@ struct volume_options options[] = {
         { .key  = {"favorite-child"},
           .type = GF_OPTION_TYPE_XLATOR
         },
+        { .key  = {"read-policy"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = {"inode", "gfid-hash", "round-robin",
+                    "least-outstanding", "latency"},
+          .default_value = "inode",
+          .description = "How reads are spread over the up to date "
+                         "subvolumes. \"inode\" reads a file from the "
+                         "subvolume picked at its lookup, \"gfid-hash\" "
+                         "picks that subvolume by the gfid, \"round-robin\" "
+                         "rotates per read, \"least-outstanding\" sends "
+                         "each read where the fewest reads are in flight and "
+                         "\"latency\" where they are served the fastest. "
+                         "read-subvolume takes precedence."
+        },
+        { .key  = {"read-stripe-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Reads files in stripes of this size from each of "
+                         "the up to date subvolumes in turn, so that a "
+                         "sequential reader uses the bandwidth of all of "
+                         "them. A read spanning stripes is split and its "
+                         "pieces read in parallel. Takes precedence over "
+                         "read-policy, read-subvolume over it. 0 disables."
+        },
+        { .key  = {"quorum-type"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = {"none", "auto", "fixed"},
+          .default_value = "none",
+          .description = "Client quorum. With \"auto\" fops that modify "
+                         "the volume need more than half of the subvolumes "
+                         "up, or exactly half including the first one; with "
+                         "\"fixed\" they need quorum-count of them. "
+                         "Otherwise they fail with EROFS. A write is "
+                         "acknowledged once a quorum of subvolumes took it."
+        },
+        { .key  = {"quorum-count"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = INT_MAX,
+          .default_value = "1",
+          .description = "Number of subvolumes a fop needs with "
+                         "quorum-type \"fixed\"."
+        },
         { .key  = {"background-self-heal-count"},
           .type = GF_OPTION_TYPE_INT,
           .min  = 0,
@@ -490,5 +629,47 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "off",
         },
+        { .key  = {"lookup-cached-changelog"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Revalidate an inode found clean by an earlier "
+                         "lookup without fetching its changelog, returning "
+                         "once its read child answers, as long as no child "
+                         "came or went and no fop on it failed since. "
+                         "Operations other clients leave pending are then "
+                         "found by the self-heal daemon only."
+        },
+        { .key  = {"eager-lock"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "on",
+          .description = "Lock the whole file for a write transaction and "
+                         "let the writes that overlap it on the same fd share "
+                         "that lock and its changelog pre-op."
+        },
+        { .key  = {"post-op-delay-secs"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 0,
+          .max  = 60,
+          .default_value = "1",
+          .description = "With eager-lock, hold the post-op and unlock of a "
+                         "write back for this long, so that a sequential "
+                         "writer keeps the lock and the changelog between its "
+                         "writes. 0 disables it."
+        },
+        { .key  = {"shd-max-heals"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 64,
+          .default_value = "4",
+          .description = "Maximum number of files the self-heal daemon "
+                         "heals at the same time."
+        },
+        { .key  = {"self-heal-bandwidth"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Bytes per second data self-heal may read. It backs "
+                         "off below this while the bricks are slow to serve "
+                         "it. 0 means unlimited."
+        },
         { .key  = {NULL} },
 };
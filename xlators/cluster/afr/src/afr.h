@@ -30,13 +30,33 @@
 #include "compat-errno.h"
 #include "afr-mem-types.h"
 #include "afr-self-heal-algorithm.h"
+#include "timer.h"
 
 #include "libxlator.h"
 
 #define AFR_XATTR_PREFIX "trusted.afr"
 #define AFR_PATHINFO_HEADER "REPLICATE:"
 
+/* lookup xattr_req keys used by the self-heal daemon, not sent to the
+   bricks: the first only resolves the entry, the second makes the
+   self-heal it triggers run before the lookup returns */
+#define AFR_LOOKUP_NO_HEAL_KEY "glusterfs.afr.lookup-no-heal"
+#define AFR_LOOKUP_FG_HEAL_KEY "glusterfs.afr.lookup-foreground-heal"
+
+/* bitmap of the regions written while some child was left out of the
+   data transactions, ORed in by the children which took part. Region r
+   maps to bit r % AFR_DIRTY_REGION_BITS, so a file of any size fits and
+   a set bit may only cost a region which did not need healing. */
+#define AFR_DIRTY_REGIONS_KEY  AFR_XATTR_PREFIX".dirty-regions"
+#define AFR_DIRTY_REGION_SIZE  (4 * GF_UNIT_MB)
+#define AFR_DIRTY_REGIONS_SIZE 1024
+#define AFR_DIRTY_REGION_BITS  (AFR_DIRTY_REGIONS_SIZE * 8)
+
+/* quorum_count asking for more than half of the children */
+#define AFR_QUORUM_AUTO INT_MAX
+
 struct _pump_private;
+struct afr_sh_entry_scan;
 
 typedef int (*afr_expunge_done_cbk_t) (call_frame_t *frame, xlator_t *this,
                                        int child, int32_t op_error,
@@ -65,12 +85,15 @@ typedef enum {
         AFR_INODE_GET_READ_CTX,
         AFR_INODE_GET_OPENDIR_DONE,
         AFR_INODE_GET_SPLIT_BRAIN,
+        AFR_INODE_SET_CLEAN_GEN,
+        AFR_INODE_GET_CLEAN_GEN,
 } afr_inode_op_t;
 
 typedef struct afr_inode_params_ {
         afr_inode_op_t op;
         union {
                 gf_boolean_t value;
+                uint64_t     gen;
                 struct {
                         int32_t read_child;
                         int32_t *children;
@@ -78,24 +101,76 @@ typedef struct afr_inode_params_ {
         } u;
 } afr_inode_params_t;
 
+/* how reads are spread over the fresh children */
+typedef enum {
+        AFR_READ_POLICY_INODE = 0,      /* the read child of the inode */
+        AFR_READ_POLICY_GFID_HASH,      /* read child hashed from the gfid */
+        AFR_READ_POLICY_ROUND_ROBIN,
+        AFR_READ_POLICY_LEAST_PENDING,
+        AFR_READ_POLICY_LATENCY,
+} afr_read_policy_t;
+
+typedef struct afr_child_stats_ {
+        uint64_t        pending;        /* reads in flight */
+        uint64_t        latency;        /* average usecs a read took */
+} afr_child_stats_t;
+
+/* piece of a readv split over the fresh children, see
+   afr_readv_stripe () */
+typedef struct afr_read_stripe_ {
+        off_t           offset;
+        size_t          size;
+        int             pos;            /* index of its child in the
+                                           candidates */
+        int             tries;
+        int32_t         op_ret;
+        int32_t         op_errno;
+        struct iovec   *vector;
+        int32_t         count;
+        struct iatt     buf;
+        struct iobref  *iobref;
+} afr_read_stripe_t;
+
 typedef struct afr_inode_ctx_ {
         uint64_t masks;
         int32_t  *fresh_children;//increasing order of latency
+        uint64_t clean_gen;     /* afr_event_gen () when a lookup last found
+                                   no pending changelog, 0 if it did not */
 } afr_inode_ctx_t;
 
 typedef struct afr_self_heald_ {
         gf_boolean_t    enabled;
         gf_boolean_t    pending;
+        gf_boolean_t    pending_full;   /* a full crawl was asked for */
         gf_boolean_t    inprogress;
         afr_child_pos_t *pos;
+        struct list_head heal_queue;     /* index entries waiting for a
+                                            heal worker */
+        int             heal_workers;    /* helper tasks draining it */
+        struct synctask *heal_waiter;    /* crawl waiting for the helpers */
 } afr_self_heald_t;
 
+/* token bucket limiting the bytes/sec data self-heal reads */
+typedef struct afr_heal_throttle_ {
+        gf_lock_t       lock;
+        uint64_t        rate;           /* current rate, <= the option */
+        int64_t         tokens;         /* negative while in debt */
+        struct timeval  last;           /* last refill */
+        struct timeval  last_adjust;    /* last change of rate */
+        uint64_t        latency;        /* average usecs a loop took per MB */
+        uint64_t        floor;          /* best of those seen lately */
+} afr_heal_throttle_t;
+
 typedef struct _afr_private {
         gf_lock_t lock;               /* to guard access to child_count, etc */
         unsigned int child_count;     /* total number of children   */
 
         unsigned int read_child_rr;   /* round-robin index of the read_child */
         gf_lock_t read_child_lock;    /* lock to protect above */
+        afr_read_policy_t read_policy;
+        afr_child_stats_t *child_stats; /* guarded by read_child_lock */
+        uint64_t read_stripe_size;    /* 0, or bytes of a file read in turn
+                                         from each fresh child */
 
         xlator_t **children;
 
@@ -133,8 +208,10 @@ typedef struct _afr_private {
         gf_boolean_t entrylk_trace;
 
         gf_boolean_t strict_readdir;
+        gf_boolean_t lookup_cached_changelog;
 
         unsigned int wait_count;      /* # of servers to wait for success */
+        unsigned int quorum_count;    /* 0 if client quorum is off */
 
         uint64_t up_count;      /* number of CHILD_UPs we have seen */
         uint64_t down_count;    /* number of CHILD_DOWNs we have seen */
@@ -146,10 +223,20 @@ typedef struct _afr_private {
         struct list_head saved_fds;   /* list of fds on which locks have succeeded */
         gf_boolean_t     optimistic_change_log;
         gf_boolean_t     eager_lock;
+        uint32_t         post_op_delay_secs;
 
         char                   vol_uuid[UUID_SIZE + 1];
         int32_t                *last_event;
         afr_self_heald_t       shd;
+        int                    shd_max_heals;
+        uint64_t               self_heal_bandwidth;
+        afr_heal_throttle_t    heal_throttle;
+        uint64_t               data_healed;  /* bytes data self-heal copied
+                                                to sinks, under lock */
+        struct list_head       deferred_heals; /* queued by lookups, one per
+                                                  gfid, under lock */
+        int                    deferred_heal_count;
+        gf_boolean_t           deferred_heal_running;
 } afr_private_t;
 
 typedef struct {
@@ -241,6 +328,22 @@ typedef struct {
         uint8_t *checksum;
         afr_post_remove_call_t post_remove_call;
 
+        /* a loop of the data self-heal covers loop_blocks blocks
+           starting at loop_offset, offset is the block being healed */
+        off_t loop_offset;
+        int32_t loop_blocks;
+        int32_t block_index;
+        int32_t checksum_blocks;
+        gf_boolean_t checksum_batch_failed;
+        struct timeval loop_start;
+
+        /* dirty regions of the source, NULL when the whole file is
+           to be healed */
+        unsigned char *dirty_regions;
+
+        /* sorted listings of the directory under entry self-heal */
+        struct afr_sh_entry_scan *entry_scan;
+
         loc_t parent_loc;
 
         call_frame_t *orig_frame;
@@ -433,6 +536,11 @@ typedef struct _afr_local {
                         int32_t read_child;
                         int32_t *sources;
                         int32_t *success_children;
+                        gf_boolean_t no_heal;
+                        gf_boolean_t foreground_heal;
+                        gf_boolean_t cached_clean;  /* changelog not fetched */
+                        call_frame_t *orig_frame;   /* wound on a copy of it */
+                        gf_boolean_t unwound;       /* orig_frame was */
                 } lookup;
 
                 struct {
@@ -462,6 +570,12 @@ typedef struct _afr_local {
                         int last_index;
                 } fstat;
 
+                struct {
+                        off_t offset;
+                        gf_seek_what_t what;
+                        int last_index;
+                } seek;
+
                 struct {
                         size_t size;
                         int last_index;
@@ -477,6 +591,12 @@ typedef struct _afr_local {
                         size_t size;
                         off_t offset;
                         int last_index;
+                        int32_t stats_child; /* -1 if not accounted */
+                        struct timeval start;
+                        afr_read_stripe_t *stripes;
+                        int stripe_count;
+                        int32_t *candidates;
+                        int candidate_count;
                 } readv;
 
                 /* dir read */
@@ -529,6 +649,28 @@ typedef struct _afr_local {
                         struct iatt postbuf;
                 } ftruncate;
 
+                struct {
+                        int32_t mode;
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } fallocate;
+
+                struct {
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } discard;
+
+                struct {
+                        off_t offset;
+                        size_t len;
+                        struct iatt prebuf;
+                        struct iatt postbuf;
+                } zerofill;
+
                 struct {
                         struct iatt in_buf;
                         int32_t valid;
@@ -667,6 +809,9 @@ typedef struct _afr_local {
 
                 int (*unwind) (call_frame_t *frame, xlator_t *this);
 
+                /* unwind of the fop, unwind checks the quorum first */
+                int (*fop_unwind) (call_frame_t *frame, xlator_t *this);
+
                 /* post-op hook */
         } transaction;
 
@@ -707,6 +852,11 @@ typedef struct {
 
         unsigned char *locked_on; /* which subvolumes locks have been successful */
 	struct list_head  paused_calls; /* queued calls while fix_open happens  */
+
+        /* write transaction whose post-op and unlock are held back, so
+           that the next write on the fd can piggyback on them */
+        call_frame_t *delay_frame;
+        gf_timer_t   *delay_timer;
 } afr_fd_ctx_t;
 
 
@@ -741,7 +891,7 @@ pump_command_reply (call_frame_t *frame, xlator_t *this);
 
 int32_t
 afr_notify (xlator_t *this, int32_t event,
-            void *data, ...);
+            void *data, void *data2);
 
 int
 afr_attempt_lock_recovery (xlator_t *this, int32_t child_index);
@@ -825,6 +975,9 @@ afr_is_split_brain (xlator_t *this, inode_t *inode);
 void
 afr_set_split_brain (xlator_t *this, inode_t *inode, gf_boolean_t set);
 
+void
+afr_inode_clear_clean_gen (xlator_t *this, inode_t *inode);
+
 int
 afr_open (call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
           fd_t *fd, int32_t wbflags);
@@ -912,6 +1065,34 @@ afr_set_read_ctx_from_policy (xlator_t *this, inode_t *inode,
                               int32_t *fresh_children, int32_t prev_read_child,
                               int32_t config_read_child);
 
+afr_read_policy_t
+afr_read_policy_get (const char *str);
+
+int32_t
+afr_read_policy_child (xlator_t *this, fd_t *fd, unsigned char *child_up,
+                       int32_t *fresh_children);
+
+int
+afr_read_candidates (xlator_t *this, fd_t *fd, unsigned char *child_up,
+                     int32_t *fresh_children, int32_t *candidates);
+
+void
+afr_read_stats_begin (xlator_t *this, int32_t child, int32_t *stats_child,
+                      struct timeval *start);
+
+void
+afr_read_stats_end (xlator_t *this, int32_t *stats_child,
+                    struct timeval *start);
+
+gf_boolean_t
+afr_have_quorum (xlator_t *this, unsigned char *children);
+
+void
+afr_dirty_regions_mark (unsigned char *regions, off_t start, off_t len);
+
+gf_boolean_t
+afr_dirty_regions_test (unsigned char *regions, off_t start, off_t len);
+
 int32_t
 afr_get_call_child (xlator_t *this, unsigned char *child_up, int32_t read_child,
                     int32_t *fresh_children,
@@ -322,6 +322,270 @@ pump_save_file_stats (xlator_t *this, const char *path)
         return 0;
 }
 
+/*
+ * Regular files are copied by copier synctasks of their own, up to
+ * copy-window of them at a time, each self-healing its file with
+ * data-self-heal-window-size blocks in flight. The crawl only waits for
+ * them when the window is full. The path saved for resuming is that of
+ * the oldest file still being copied, so that a paused pump resumes
+ * with nothing left behind. A failed copy stops the pump.
+ */
+
+/* waits till fewer than @limit copies are running */
+static void
+pump_copy_wait (xlator_t *this, int limit)
+{
+        afr_private_t   *priv      = NULL;
+        pump_private_t  *pump_priv = NULL;
+        struct synctask *task      = NULL;
+        gf_boolean_t     wait      = _gf_false;
+
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+        task      = synctask_get ();
+
+        for (;;) {
+                LOCK (&pump_priv->copy_lock);
+                {
+                        wait = (pump_priv->copy_inflight >= limit);
+                        if (wait) {
+                                pump_priv->copy_waiter = task;
+                                synctask_yawn (task);
+                        }
+                }
+                UNLOCK (&pump_priv->copy_lock);
+
+                if (!wait)
+                        break;
+                synctask_yield (task);
+        }
+}
+
+/* saves where a resumed pump has to start from: the oldest file still
+   being copied, else the path the crawl got to. Once a copy failed the
+   saved path stays before that file. */
+static void
+pump_save_resume_point (xlator_t *this, const char *path)
+{
+        afr_private_t   *priv      = NULL;
+        pump_private_t  *pump_priv = NULL;
+        pump_copy_t     *copy      = NULL;
+        char            *resume    = NULL;
+
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+
+        LOCK (&pump_priv->copy_lock);
+        {
+                if (path) {
+                        if (pump_priv->crawl_path)
+                                GF_FREE (pump_priv->crawl_path);
+                        pump_priv->crawl_path = gf_strdup (path);
+                }
+
+                if (pump_priv->copy_failed)
+                        goto unlock;
+
+                if (!list_empty (&pump_priv->copy_list)) {
+                        copy = list_entry (pump_priv->copy_list.next,
+                                           pump_copy_t, list);
+                        resume = gf_strdup (copy->loc.path);
+                } else if (pump_priv->crawl_path) {
+                        resume = gf_strdup (pump_priv->crawl_path);
+                }
+        }
+unlock:
+        UNLOCK (&pump_priv->copy_lock);
+
+        if (resume) {
+                pump_save_path (this, resume);
+                GF_FREE (resume);
+        }
+}
+
+static void
+pump_copy_failed (xlator_t *this, const char *path)
+{
+        afr_private_t   *priv      = NULL;
+        pump_private_t  *pump_priv = NULL;
+
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+
+        LOCK (&pump_priv->copy_lock);
+        {
+                pump_priv->copy_failed = _gf_true;
+        }
+        UNLOCK (&pump_priv->copy_lock);
+
+        gf_log (this->name, GF_LOG_ERROR, "%s: copy failed, pausing the "
+                "pump", path);
+
+        pump_change_state (this, PUMP_STATE_PAUSE);
+}
+
+static int
+pump_copy_task (void *data)
+{
+        pump_copy_t     *copy      = data;
+        xlator_t        *this      = NULL;
+        afr_private_t   *priv      = NULL;
+        pump_private_t  *pump_priv = NULL;
+        dict_t          *xattr_req = NULL;
+        dict_t          *xattr_rsp = NULL;
+        struct iatt     iatt       = {0};
+        struct iatt     parent     = {0};
+        uuid_t          gfid       = {0};
+        int             ret        = -1;
+
+        this      = copy->this;
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+
+        xattr_req = dict_new ();
+        if (!xattr_req)
+                goto out;
+
+        afr_generate_gfid_on_empty (gfid);
+        ret = afr_set_dict_gfid (xattr_req, gfid);
+        if (ret)
+                goto out;
+
+        /* pump does no background self-heals, the file is on the sink
+           once the lookup returns */
+        ret = syncop_lookup (this, &copy->loc, xattr_req, &iatt,
+                             &xattr_rsp, &parent);
+        if (ret) {
+                /* removed since the crawl found it */
+                if (errno == ENOENT)
+                        ret = 0;
+                goto out;
+        }
+
+        pump_save_file_stats (this, copy->loc.path);
+out:
+        if (xattr_req)
+                dict_unref (xattr_req);
+        if (xattr_rsp)
+                dict_unref (xattr_rsp);
+
+        LOCK (&pump_priv->copy_lock);
+        {
+                list_del_init (&copy->list);
+        }
+        UNLOCK (&pump_priv->copy_lock);
+
+        if (ret)
+                pump_copy_failed (this, copy->loc.path);
+        else
+                pump_save_resume_point (this, NULL);
+
+        return ret;
+}
+
+static void
+pump_copy_destroy (pump_copy_t *copy)
+{
+        loc_wipe (&copy->loc);
+        GF_FREE (copy);
+}
+
+static int
+pump_copy_done (int ret, call_frame_t *frame, void *data)
+{
+        pump_copy_t     *copy      = data;
+        afr_private_t   *priv      = NULL;
+        pump_private_t  *pump_priv = NULL;
+        struct synctask *waiter    = NULL;
+
+        priv      = copy->this->private;
+        pump_priv = priv->pump_private;
+
+        LOCK (&pump_priv->copy_lock);
+        {
+                pump_priv->copy_inflight--;
+                waiter = pump_priv->copy_waiter;
+                pump_priv->copy_waiter = NULL;
+        }
+        UNLOCK (&pump_priv->copy_lock);
+
+        if (waiter)
+                synctask_wake (waiter);
+
+        pump_copy_destroy (copy);
+        STACK_DESTROY (frame->root);
+        return 0;
+}
+
+/* hands the regular file @entry of @parent to a copier task */
+static int
+pump_copy_file (xlator_t *this, loc_t *parent, gf_dirent_t *entry)
+{
+        afr_private_t   *priv      = NULL;
+        pump_private_t  *pump_priv = NULL;
+        pump_copy_t     *copy      = NULL;
+        call_frame_t    *frame     = NULL;
+        int             ret        = -1;
+
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+
+        pump_copy_wait (this, pump_priv->copy_window);
+
+        copy = GF_CALLOC (1, sizeof (*copy), gf_afr_mt_pump_copy_t);
+        if (!copy)
+                goto out;
+
+        INIT_LIST_HEAD (&copy->list);
+        copy->this = this;
+        copy->size = entry->d_stat.ia_size;
+        gettimeofday (&copy->start, NULL);
+
+        ret = afr_build_child_loc (this, &copy->loc, parent, entry->d_name);
+        if (ret)
+                goto out;
+
+        frame = create_frame (this, this->ctx->pool);
+        if (!frame) {
+                ret = -1;
+                goto out;
+        }
+        frame->root->lk_owner = (uint64_t) (unsigned long)frame->root;
+
+        LOCK (&pump_priv->copy_lock);
+        {
+                list_add_tail (&copy->list, &pump_priv->copy_list);
+                pump_priv->copy_inflight++;
+        }
+        UNLOCK (&pump_priv->copy_lock);
+
+        ret = synctask_new (pump_priv->env, pump_copy_task, pump_copy_done,
+                            frame, copy);
+        if (ret) {
+                LOCK (&pump_priv->copy_lock);
+                {
+                        list_del_init (&copy->list);
+                        pump_priv->copy_inflight--;
+                }
+                UNLOCK (&pump_priv->copy_lock);
+                STACK_DESTROY (frame->root);
+
+                gf_log (this->name, GF_LOG_DEBUG, "%s: could not start a "
+                        "copier, copying it inline", copy->loc.path);
+                ret = pump_copy_task (copy);
+                pump_copy_destroy (copy);
+                return ret;
+        }
+
+        copy = NULL;
+out:
+        if (ret)
+                pump_copy_failed (this, entry->d_name);
+        if (copy)
+                pump_copy_destroy (copy);
+        return ret;
+}
+
 static int
 gf_pump_traverse_directory (loc_t *loc, uuid_t gfid)
 {
@@ -340,15 +604,15 @@ gf_pump_traverse_directory (loc_t *loc, uuid_t gfid)
         dict_t          *xattr_req         = NULL;
         gf_boolean_t    free_entries       = _gf_false;
 
+        INIT_LIST_HEAD (&entries.list);
+        this = THIS;
+
         xattr_req = dict_new ();
         if (!xattr_req) {
                 ret = -1;
                 goto out;
         }
 
-        INIT_LIST_HEAD (&entries.list);
-        this = THIS;
-
         GF_ASSERT (loc->inode);
 
 	fd = fd_create (loc->inode, pump_pid);
@@ -392,6 +656,25 @@ gf_pump_traverse_directory (loc_t *loc, uuid_t gfid)
                             !IS_ENTRY_PARENT (entry->d_name)) {
 
                                     is_directory_empty = _gf_false;
+
+                                    if (IA_ISREG (entry->d_stat.ia_type)) {
+                                            pump_update_resume_state (this, entry_loc.path);
+                                            pump_save_resume_point (this, entry_loc.path);
+
+                                            ret = pump_check_and_update_status (this);
+                                            if (ret < 0) {
+                                                    gf_log (this->name, GF_LOG_DEBUG,
+                                                            "Pump beginning to exit out");
+                                                    goto out;
+                                            }
+
+                                            ret = pump_copy_file (this, loc, entry);
+                                            if (ret)
+                                                    goto out;
+                                            offset = entry->d_off;
+                                            continue;
+                                    }
+
                                     gf_log (this->name, GF_LOG_DEBUG,
                                             "lookup %s => %"PRId64,
                                             entry_loc.path,
@@ -419,7 +702,7 @@ gf_pump_traverse_directory (loc_t *loc, uuid_t gfid)
 
                                     pump_update_resume_state (this, entry_loc.path);
 
-                                    pump_save_path (this, entry_loc.path);
+                                    pump_save_resume_point (this, entry_loc.path);
                                     pump_save_file_stats (this, entry_loc.path);
 
                                     ret = pump_check_and_update_status (this);
@@ -615,6 +898,42 @@ out:
         return ret;
 }
 
+/* what the status command measures the progress against */
+static void
+pump_start_progress (xlator_t *this, loc_t *root_loc)
+{
+        afr_private_t  *priv      = NULL;
+        pump_private_t *pump_priv = NULL;
+        struct statvfs buf        = {0,};
+        uint64_t       used       = 0;
+        int            ret        = 0;
+
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+
+        ret = syncop_statfs (PUMP_SOURCE_CHILD (this), root_loc, &buf);
+        if (ret)
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "statfs on the source failed, no estimate of the "
+                        "time left");
+        else
+                used = (buf.f_blocks - buf.f_bfree) * buf.f_frsize;
+
+        LOCK (&priv->lock);
+        {
+                pump_priv->healed_at_start = priv->data_healed;
+        }
+        UNLOCK (&priv->lock);
+
+        LOCK (&pump_priv->copy_lock);
+        {
+                pump_priv->source_used = used;
+                gettimeofday (&pump_priv->start_time, NULL);
+                pump_priv->copy_failed = _gf_false;
+        }
+        UNLOCK (&pump_priv->copy_lock);
+}
+
 static int
 pump_task (void *data)
 {
@@ -667,8 +986,13 @@ pump_task (void *data)
                 goto out;
         }
 
+        pump_start_progress (this, &loc);
+
         gf_pump_traverse_directory (&loc, gfid);
 
+        /* the last copies are still running */
+        pump_copy_wait (this, 1);
+
         pump_complete_migration (this);
 out:
         if (xattr_req)
@@ -940,6 +1264,66 @@ out:
 	return 0;
 }
 
+/* bytes copied, the rate and time left, and the files being copied */
+static void
+pump_format_progress (xlator_t *this, char *buf, int size)
+{
+        afr_private_t  *priv      = NULL;
+        pump_private_t *pump_priv = NULL;
+        pump_copy_t    *copy      = NULL;
+        struct timeval now        = {0,};
+        uint64_t       healed     = 0;
+        uint64_t       rate       = 0;
+        int64_t        elapsed    = 0;
+        int            len        = 0;
+
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+
+        gettimeofday (&now, NULL);
+
+        LOCK (&priv->lock);
+        {
+                healed = priv->data_healed - pump_priv->healed_at_start;
+        }
+        UNLOCK (&priv->lock);
+
+        LOCK (&pump_priv->copy_lock);
+        {
+                elapsed = now.tv_sec - pump_priv->start_time.tv_sec;
+                if (elapsed > 0)
+                        rate = healed / elapsed;
+
+                len += snprintf (buf + len, size - len,
+                                 "\nData migrated = %"PRIu64" bytes", healed);
+                if ((len < size) && pump_priv->source_used)
+                        len += snprintf (buf + len, size - len,
+                                         " of about %"PRIu64,
+                                         pump_priv->source_used);
+                if ((len < size) && rate)
+                        len += snprintf (buf + len, size - len,
+                                         ", %"PRIu64" bytes/sec", rate);
+                if ((len < size) && rate &&
+                    (pump_priv->source_used > healed))
+                        len += snprintf (buf + len, size - len,
+                                         ", about %"PRIu64" secs left",
+                                         (pump_priv->source_used - healed) /
+                                         rate);
+
+                list_for_each_entry (copy, &pump_priv->copy_list, list) {
+                        if (len >= size)
+                                break;
+                        len += snprintf (buf + len, size - len,
+                                         "\nCopying %s (%"PRIu64" bytes, "
+                                         "%ld secs)", copy->loc.path,
+                                         copy->size,
+                                         (long) (now.tv_sec -
+                                                 copy->start.tv_sec));
+                }
+        }
+        UNLOCK (&pump_priv->copy_lock);
+}
+
 int
 pump_execute_status (call_frame_t *frame, xlator_t *this)
 {
@@ -950,6 +1334,7 @@ pump_execute_status (call_frame_t *frame, xlator_t *this)
 
         char filename[PATH_MAX];
         char *dict_str = NULL;
+        int len = 0;
 
         int32_t op_ret = 0;
         int32_t op_errno = 0;
@@ -967,7 +1352,7 @@ pump_execute_status (call_frame_t *frame, xlator_t *this)
         }
         UNLOCK (&pump_priv->resume_path_lock);
 
-        dict_str     = GF_CALLOC (1, PATH_MAX + 256, gf_afr_mt_char);
+        dict_str     = GF_CALLOC (1, PUMP_STATUS_SIZE, gf_afr_mt_char);
         if (!dict_str) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "Out of memory");
@@ -977,11 +1362,14 @@ pump_execute_status (call_frame_t *frame, xlator_t *this)
         }
 
         if (pump_priv->pump_finished) {
-        snprintf (dict_str, PATH_MAX + 256, "Number of files migrated = %"PRIu64"        Migration complete ",
+        snprintf (dict_str, PUMP_STATUS_SIZE, "Number of files migrated = %"PRIu64"        Migration complete ",
                   number_files);
         } else {
-        snprintf (dict_str, PATH_MAX + 256, "Number of files migrated = %"PRIu64"       Current file= %s ",
-                  number_files, filename);
+        len = snprintf (dict_str, PUMP_STATUS_SIZE, "Number of files migrated = %"PRIu64"       Current file= %s ",
+                        number_files, filename);
+        if (len < PUMP_STATUS_SIZE)
+                pump_format_progress (this, dict_str + len,
+                                      PUMP_STATUS_SIZE - len);
         }
 
         dict = dict_new ();
@@ -1801,6 +2189,80 @@ pump_ftruncate (call_frame_t *frame,
         return 0;
 }
 
+static int32_t
+pump_fallocate (call_frame_t *frame,
+                xlator_t *this,
+                fd_t *fd,
+                int32_t keep_size,
+                off_t offset,
+                size_t len)
+{
+        afr_private_t *priv  = NULL;
+	priv = this->private;
+        if (!priv->use_afr_in_pump) {
+                STACK_WIND (frame,
+                            default_fallocate_cbk,
+                            FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->fallocate,
+                            fd,
+                            keep_size,
+                            offset,
+                            len);
+                return 0;
+        }
+
+        afr_fallocate (frame, this, fd, keep_size, offset, len);
+        return 0;
+}
+
+static int32_t
+pump_discard (call_frame_t *frame,
+              xlator_t *this,
+              fd_t *fd,
+              off_t offset,
+              size_t len)
+{
+        afr_private_t *priv  = NULL;
+	priv = this->private;
+        if (!priv->use_afr_in_pump) {
+                STACK_WIND (frame,
+                            default_discard_cbk,
+                            FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->discard,
+                            fd,
+                            offset,
+                            len);
+                return 0;
+        }
+
+        afr_discard (frame, this, fd, offset, len);
+        return 0;
+}
+
+static int32_t
+pump_zerofill (call_frame_t *frame,
+               xlator_t *this,
+               fd_t *fd,
+               off_t offset,
+               size_t len)
+{
+        afr_private_t *priv  = NULL;
+	priv = this->private;
+        if (!priv->use_afr_in_pump) {
+                STACK_WIND (frame,
+                            default_zerofill_cbk,
+                            FIRST_CHILD(this),
+                            FIRST_CHILD(this)->fops->zerofill,
+                            fd,
+                            offset,
+                            len);
+                return 0;
+        }
+
+        afr_zerofill (frame, this, fd, offset, len);
+        return 0;
+}
+
 
 
 
@@ -2344,7 +2806,7 @@ notify (xlator_t *this, int32_t event,
 
         child_xl = (xlator_t *) data;
 
-        ret = afr_notify (this, event, data);
+        ret = afr_notify (this, event, data, NULL);
 
 	switch (event) {
 	case GF_EVENT_CHILD_DOWN:
@@ -2370,12 +2832,38 @@ notify (xlator_t *this, int32_t event,
         return ret;
 }
 
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        afr_private_t  *priv      = NULL;
+        pump_private_t *pump_priv = NULL;
+        int             ret       = -1;
+
+        priv      = this->private;
+        pump_priv = priv->pump_private;
+
+        GF_OPTION_RECONF ("data-self-heal-window-size",
+                          priv->data_self_heal_window_size, options,
+                          uint32, out);
+
+        GF_OPTION_RECONF ("self-heal-bandwidth", priv->self_heal_bandwidth,
+                          options, size, out);
+
+        GF_OPTION_RECONF ("copy-window", pump_priv->copy_window, options,
+                          int32, out);
+
+        ret = 0;
+out:
+        return ret;
+}
+
 int32_t
 init (xlator_t *this)
 {
 	afr_private_t * priv        = NULL;
         pump_private_t *pump_priv = NULL;
 	int             child_count = 0;
+        int32_t         copy_window = 0;
 	xlator_list_t * trav        = NULL;
 	int             i           = 0;
 	int             ret         = -1;
@@ -2409,7 +2897,14 @@ init (xlator_t *this)
 
         priv->data_self_heal_algorithm = "";
 
-        priv->data_self_heal_window_size = 16;
+        GF_OPTION_INIT ("data-self-heal-window-size",
+                        priv->data_self_heal_window_size, uint32, out);
+
+        GF_OPTION_INIT ("self-heal-bandwidth", priv->self_heal_bandwidth,
+                        size, out);
+        LOCK_INIT (&priv->heal_throttle.lock);
+
+        GF_OPTION_INIT ("copy-window", copy_window, int32, out);
 
 	priv->data_change_log     = 1;
 	priv->metadata_change_log = 1;
@@ -2516,6 +3011,10 @@ init (xlator_t *this)
         LOCK_INIT (&pump_priv->resume_path_lock);
         LOCK_INIT (&pump_priv->pump_state_lock);
 
+        LOCK_INIT (&pump_priv->copy_lock);
+        INIT_LIST_HEAD (&pump_priv->copy_list);
+        pump_priv->copy_window = copy_window;
+
         pump_priv->resume_path = GF_CALLOC (1, PATH_MAX,
                                             gf_afr_mt_char);
         if (!pump_priv->resume_path) {
@@ -2537,6 +3036,7 @@ init (xlator_t *this)
 
         pthread_mutex_init (&priv->mutex, NULL);
         INIT_LIST_HEAD (&priv->saved_fds);
+        INIT_LIST_HEAD (&priv->deferred_heals);
 
         pump_change_state (this, PUMP_STATE_ABORT);
 
@@ -2566,6 +3066,9 @@ struct xlator_fops fops = {
 	.writev      = pump_writev,
 	.truncate    = pump_truncate,
 	.ftruncate   = pump_ftruncate,
+	.fallocate   = pump_fallocate,
+	.discard     = pump_discard,
+	.zerofill    = pump_zerofill,
 	.setxattr    = pump_setxattr,
         .setattr     = pump_setattr,
 	.fsetattr    = pump_fsetattr,
@@ -2598,5 +3101,27 @@ struct xlator_cbks cbks = {
 };
 
 struct volume_options options[] = {
+        { .key  = {"copy-window"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 256,
+          .default_value = "16",
+          .description = "Maximum number of files replace-brick copies at "
+                         "the same time."
+        },
+        { .key  = {"data-self-heal-window-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min  = 1,
+          .max  = 1024,
+          .default_value = "16",
+          .description = "Maximum number of blocks of a file replace-brick "
+                         "copies at the same time."
+        },
+        { .key  = {"self-heal-bandwidth"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Bytes per second replace-brick may read from the "
+                         "source brick. 0 means unlimited."
+        },
 	{ .key  = {NULL} },
 };
@@ -37,6 +37,9 @@
 
 #define PUMP_PATH "trusted.glusterfs.pump-path"
 
+/* longest status reply glusterd reads back */
+#define PUMP_STATUS_SIZE 8192
+
 #define PUMP_SOURCE_CHILD(xl) (xl->children->xlator)
 #define PUMP_SINK_CHILD(xl) (xl->children->next->xlator)
 
@@ -48,6 +51,15 @@ typedef enum {
         PUMP_STATE_COMMIT,              /* Pump is commited */
 } pump_state_t;
 
+/* a regular file being copied by its own synctask */
+typedef struct _pump_copy {
+        struct list_head  list;         /* in pump_priv->copy_list */
+        xlator_t         *this;
+        loc_t             loc;
+        uint64_t          size;         /* as readdirp found it */
+        struct timeval    start;
+} pump_copy_t;
+
 typedef struct _pump_private {
 	struct syncenv *env;            /* The env pointer to the pump synctask */
         const char *resume_path;        /* path to resume from the last pause */
@@ -60,6 +72,17 @@ typedef struct _pump_private {
         char pump_start_pending;        /* Boolean to mark start pending until
                                            CHILD_UP */
         call_stub_t *cleaner;
+
+        int copy_window;                /* files copied at the same time */
+        gf_lock_t copy_lock;            /* guards the copy_* members */
+        int copy_inflight;              /* copier tasks running */
+        struct synctask *copy_waiter;   /* crawl waiting for them */
+        struct list_head copy_list;     /* pump_copy_t being copied */
+        gf_boolean_t copy_failed;       /* a copy failed, the pump stops */
+        char *crawl_path;               /* last path the crawl got to */
+        struct timeval start_time;      /* of this run of the pump */
+        uint64_t healed_at_start;       /* priv->data_healed back then */
+        uint64_t source_used;           /* bytes in use on the source */
 } pump_private_t;
 
 void
@@ -40,6 +40,7 @@ dht_aggregate (dict_t *this, char *key, data_t *value, void *data)
 {
         dict_t  *dst  = NULL;
         int64_t *ptr  = 0, *size = NULL;
+        int32_t *cnt_ptr = NULL, *cnt = NULL;
         int32_t  ret  = -1;
         data_pair_t  *data_pair = NULL;
 
@@ -71,6 +72,33 @@ dht_aggregate (dict_t *this, char *key, data_t *value, void *data)
                 }
 
                 *size = hton64 (ntoh64 (*size) + ntoh64 (*ptr));
+        } else if (strcmp (key, DHT_LINKFILE_COUNT_KEY) == 0) {
+                /* each subvolume counts the linkfiles it holds */
+                ret = dict_get_bin (dst, key, (void **)&cnt);
+                if (ret < 0) {
+                        cnt = GF_CALLOC (1, sizeof (int32_t),
+                                         gf_common_mt_char);
+                        if (cnt == NULL) {
+                                gf_log ("dht", GF_LOG_WARNING,
+                                        "memory allocation failed");
+                                return;
+                        }
+                        ret = dict_set_bin (dst, key, cnt, sizeof (int32_t));
+                        if (ret < 0) {
+                                gf_log ("dht", GF_LOG_WARNING,
+                                        "dht aggregate dict set failed");
+                                GF_FREE (cnt);
+                                return;
+                        }
+                }
+
+                cnt_ptr = data_to_bin (value);
+                if ((cnt_ptr == NULL) || (value->len < sizeof (int32_t))) {
+                        gf_log ("dht", GF_LOG_WARNING, "data to bin failed");
+                        return;
+                }
+
+                *cnt = hton32 (ntoh32 (*cnt) + ntoh32 (*cnt_ptr));
         } else {
                 /* compare user xattrs only */
                 if (!strncmp (key, "user.", strlen ("user."))) {
@@ -353,6 +381,10 @@ dht_revalidate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         ret = dht_layout_dir_mismatch (this, layout,
                                                        prev->this, &local->loc,
                                                        xattr);
+                        if (!ret && conf->layout_gen_revalidate)
+                                ret = dht_layout_gen_mismatch (this, layout,
+                                                               &local->loc,
+                                                               xattr);
                         if (ret != 0) {
                                 gf_log (this->name, GF_LOG_INFO,
                                         "mismatching layouts for %s",
@@ -427,6 +459,81 @@ err:
 }
 
 
+int
+dht_revalidate_wind (call_frame_t *frame, xlator_t *this)
+{
+        dht_local_t  *local = NULL;
+        dht_layout_t *layout = NULL;
+        xlator_t     *subvol = NULL;
+        int           call_cnt = 0;
+        int           i = 0;
+
+        local  = frame->local;
+        layout = local->layout;
+
+        call_cnt = local->call_cnt = layout->cnt;
+
+        for (i = 0; i < layout->cnt; i++) {
+                subvol = layout->list[i].xlator;
+
+                STACK_WIND (frame, dht_revalidate_cbk,
+                            subvol, subvol->fops->lookup,
+                            &local->loc, local->xattr_req);
+
+                if (!--call_cnt)
+                        break;
+        }
+
+        return 0;
+}
+
+
+/* A directory revalidate asked only one subvolume. If its range and the
+   layout generation there are the ones cached, so is the rest of the
+   layout; otherwise ask them all. */
+int
+dht_revalidate_gen_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                        int op_ret, int op_errno,
+                        inode_t *inode, struct iatt *stbuf, dict_t *xattr,
+                        struct iatt *postparent)
+{
+        dht_local_t  *local  = NULL;
+        call_frame_t *prev   = NULL;
+        dht_layout_t *layout = NULL;
+
+        local  = frame->local;
+        prev   = cookie;
+        layout = local->layout;
+
+        if ((op_ret == -1)
+            || (stbuf->ia_type != local->inode->ia_type)
+            || dht_layout_dir_mismatch (this, layout, prev->this,
+                                        &local->loc, xattr)
+            || dht_layout_gen_mismatch (this, layout, &local->loc, xattr)) {
+                gf_log (this->name, GF_LOG_TRACE,
+                        "%s: layout not confirmed by %s, revalidating on "
+                        "all subvolumes", local->loc.path, prev->this->name);
+
+                dht_revalidate_wind (frame, this);
+                return 0;
+        }
+
+        dht_iatt_merge (this, &local->stbuf, stbuf, prev->this);
+        dht_iatt_merge (this, &local->postparent, postparent, prev->this);
+
+        local->op_ret = 0;
+        local->xattr = dict_ref (xattr);
+
+        WIPE (&local->postparent);
+
+        DHT_STRIP_PHASE1_FLAGS (&local->stbuf);
+        DHT_STACK_UNWIND (lookup, frame, local->op_ret, local->op_errno,
+                          local->inode, &local->stbuf, local->xattr,
+                          &local->postparent);
+        return 0;
+}
+
+
 int
 dht_lookup_linkfile_create_cbk (call_frame_t *frame, void *cookie,
                                 xlator_t *this,
@@ -507,6 +614,10 @@ dht_lookup_everywhere_done (call_frame_t *frame, xlator_t *this)
         }
 
         if (!cached_subvol) {
+                if (local->nlc_hashed && (local->op_errno == ENOENT))
+                        dht_nlc_add (this, &local->loc, local->nlc_hashed,
+                                     &local->nlc_postparent);
+
                 DHT_STACK_UNWIND (lookup, frame, -1, ENOENT, NULL, NULL, NULL,
                                   NULL);
                 return 0;
@@ -920,6 +1031,7 @@ dht_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         int           ret           = 0;
         uint64_t      tmp_layout    = 0;
         dht_layout_t *parent_layout = NULL;
+        gf_boolean_t  everywhere    = _gf_false;
 
         GF_VALIDATE_OR_GOTO ("dht", frame, err);
         GF_VALIDATE_OR_GOTO ("dht", this, out);
@@ -942,20 +1054,31 @@ dht_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         if (ENTRY_MISSING (op_ret, op_errno)) {
                 gf_log (this->name, GF_LOG_TRACE, "Entry %s missing on subvol"
                         " %s", loc->path, prev->this->name);
-                if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_ON) {
-                        local->op_errno = ENOENT;
-                        dht_lookup_everywhere (frame, this, loc);
-                        return 0;
-                }
+                if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_ON)
+                        everywhere = _gf_true;
                 if ((conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO) &&
                     (loc->parent)) {
                         ret = inode_ctx_get (loc->parent, this, &tmp_layout);
                         parent_layout = (dht_layout_t *)(long)tmp_layout;
-                        if (parent_layout->search_unhashed) {
-                                local->op_errno = ENOENT;
-                                dht_lookup_everywhere (frame, this, loc);
+                        if (parent_layout->search_unhashed)
+                                everywhere = _gf_true;
+                }
+
+                if (everywhere) {
+                        if (dht_nlc_check (this, loc, prev->this,
+                                           postparent)) {
+                                DHT_STACK_UNWIND (lookup, frame, -1, ENOENT,
+                                                  NULL, NULL, NULL, NULL);
                                 return 0;
                         }
+
+                        if (postparent) {
+                                local->nlc_hashed     = prev->this;
+                                local->nlc_postparent = *postparent;
+                        }
+                        local->op_errno = ENOENT;
+                        dht_lookup_everywhere (frame, this, loc);
+                        return 0;
                 }
         }
 
@@ -1113,35 +1236,56 @@ dht_lookup (call_frame_t *frame, xlator_t *this,
 
                 local->inode = inode_ref (loc->inode);
 
-                call_cnt = local->call_cnt = layout->cnt;
-
                 /* NOTE: we don't require 'trusted.glusterfs.dht.linkto' attribute,
                  *       revalidates directly go to the cached-subvolume.
                  */
                 ret = dict_set_uint32 (local->xattr_req,
                                        "trusted.glusterfs.dht", 4 * 4);
 
+                ret = dict_set_uint32 (local->xattr_req,
+                                       DHT_LAYOUT_GEN_KEY, 4);
+
                 /* need it for self-healing linkfiles which is
                    'in-migration' state */
                 ret = dict_set_uint32 (local->xattr_req,
                                        GLUSTERFS_OPEN_FD_COUNT, 4);
 
-		for (i = 0; i < layout->cnt; i++) {
-			subvol = layout->list[i].xlator;
+                if (conf->layout_gen_revalidate
+                    && IA_ISDIR (loc->inode->ia_type)
+                    && layout->disk_gen && !layout->disk_gen_mixed) {
+                        /* the hashed subvolume if it has a range here,
+                           so that revalidates spread like lookups */
+                        subvol = NULL;
+                        for (i = 0; i < layout->cnt; i++) {
+                                if (layout->list[i].start
+                                    == layout->list[i].stop)
+                                        continue;
+                                if (!subvol
+                                    || (layout->list[i].xlator
+                                        == hashed_subvol))
+                                        subvol = layout->list[i].xlator;
+                        }
 
-			STACK_WIND (frame, dht_revalidate_cbk,
-				    subvol, subvol->fops->lookup,
-				    &local->loc, local->xattr_req);
+                        if (subvol) {
+                                local->call_cnt = 1;
+
+                                STACK_WIND (frame, dht_revalidate_gen_cbk,
+                                            subvol, subvol->fops->lookup,
+                                            &local->loc, local->xattr_req);
+                                return 0;
+                        }
+                }
 
-			if (!--call_cnt)
-				break;
-		}
+                dht_revalidate_wind (frame, this);
         } else {
         do_fresh_lookup:
                 /* TODO: remove the hard-coding */
                 ret = dict_set_uint32 (local->xattr_req,
                                        "trusted.glusterfs.dht", 4 * 4);
 
+                ret = dict_set_uint32 (local->xattr_req,
+                                       DHT_LAYOUT_GEN_KEY, 4);
+
                 ret = dict_set_uint32 (local->xattr_req,
                                        DHT_LINKFILE_KEY, 256);
 
@@ -1512,6 +1656,9 @@ dht_getxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         if (dict_get (xattr, "trusted.glusterfs.dht")) {
                 dict_del (xattr, "trusted.glusterfs.dht");
         }
+        if (dict_get (xattr, DHT_LAYOUT_GEN_KEY)) {
+                dict_del (xattr, DHT_LAYOUT_GEN_KEY);
+        }
         local->op_ret = 0;
 
         if (!local->xattr) {
@@ -2256,24 +2403,360 @@ err:
 }
 
 
+static dht_dir_fd_ctx_t *
+dht_dir_fd_ctx_get (xlator_t *this, fd_t *fd)
+{
+        dht_dir_fd_ctx_t *ctx = NULL;
+        uint64_t          value = 0;
+        int               ret = -1;
+
+        LOCK (&fd->lock);
+        {
+                ret = __fd_ctx_get (fd, this, &value);
+                if (ret == 0) {
+                        ctx = (dht_dir_fd_ctx_t *) (long) value;
+                        goto unlock;
+                }
+
+                ctx = GF_CALLOC (1, sizeof (*ctx), gf_dht_mt_dir_fd_ctx_t);
+                if (!ctx)
+                        goto unlock;
+
+                LOCK_INIT (&ctx->lock);
+                INIT_LIST_HEAD (&ctx->batches);
+
+                ret = __fd_ctx_set (fd, this, (uint64_t) (long) ctx);
+                if (ret) {
+                        LOCK_DESTROY (&ctx->lock);
+                        GF_FREE (ctx);
+                        ctx = NULL;
+                }
+        }
+unlock:
+        UNLOCK (&fd->lock);
+
+        return ctx;
+}
+
+
+static void
+dht_readdir_batch_free (dht_readdir_batch_t *batch)
+{
+        gf_dirent_free (&batch->entries);
+        GF_FREE (batch);
+}
+
+
+int32_t
+dht_releasedir (xlator_t *this, fd_t *fd)
+{
+        dht_dir_fd_ctx_t    *ctx = NULL;
+        dht_readdir_batch_t *batch = NULL;
+        dht_readdir_batch_t *tmp = NULL;
+        uint64_t             value = 0;
+
+        /* in flight batches hold a ref on the fd, only done ones are
+           left here */
+        fd_ctx_del (fd, this, &value);
+        ctx = (dht_dir_fd_ctx_t *) (long) value;
+        if (!ctx)
+                return 0;
+
+        list_for_each_entry_safe (batch, tmp, &ctx->batches, list) {
+                list_del_init (&batch->list);
+                dht_readdir_batch_free (batch);
+        }
+
+        LOCK_DESTROY (&ctx->lock);
+        GF_FREE (ctx);
+
+        return 0;
+}
+
+
+static dht_readdir_batch_t *
+__dht_readdir_batch_find (dht_dir_fd_ctx_t *ctx, xlator_t *subvol,
+                          off_t offset, size_t size)
+{
+        dht_readdir_batch_t *batch = NULL;
+
+        list_for_each_entry (batch, &ctx->batches, list) {
+                if ((batch->subvol == subvol) && (batch->offset == offset)
+                    && (batch->size == size) && !batch->stale)
+                        return batch;
+        }
+
+        return NULL;
+}
+
+
+int dht_readdirp_process (call_frame_t *frame, xlator_t *this,
+                          xlator_t *subvol, int op_ret, int op_errno,
+                          gf_dirent_t *orig_entries);
+int dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int op_ret, int op_errno, gf_dirent_t *orig_entries);
+
 int
-dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
-                  int op_errno, gf_dirent_t *orig_entries)
+dht_readdirp_prefetch_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                           int op_ret, int op_errno, gf_dirent_t *entries)
+{
+        dht_readdir_batch_t *batch = NULL;
+        dht_dir_fd_ctx_t    *ctx = NULL;
+        call_frame_t        *waiter = NULL;
+        fd_t                *fd = NULL;
+        gf_boolean_t         drop = _gf_false;
+
+        batch = cookie;
+        fd = frame->local;
+        frame->local = NULL;
+
+        ctx = dht_dir_fd_ctx_get (this, fd);
+        if (!ctx) {
+                /* nothing to hand the entries to */
+                gf_log (this->name, GF_LOG_DEBUG, "no fd context, dropping "
+                        "the readdirp read ahead from %s",
+                        batch->subvol->name);
+                list_del_init (&batch->list);
+                dht_readdir_batch_free (batch);
+                goto out;
+        }
+
+        LOCK (&ctx->lock);
+        {
+                batch->done     = _gf_true;
+                gettimeofday (&batch->done_at, NULL);
+                batch->op_ret   = op_ret;
+                batch->op_errno = op_errno;
+                if ((op_ret > 0) && entries)
+                        list_splice_init (&entries->list,
+                                          &batch->entries.list);
+
+                waiter = batch->waiter;
+                if (waiter || batch->stale) {
+                        list_del_init (&batch->list);
+                        ctx->count--;
+                        drop = _gf_true;
+                }
+        }
+        UNLOCK (&ctx->lock);
+
+        if (waiter)
+                dht_readdirp_process (waiter, this, batch->subvol,
+                                      batch->op_ret, batch->op_errno,
+                                      &batch->entries);
+        if (drop)
+                dht_readdir_batch_free (batch);
+
+out:
+        STACK_DESTROY (frame->root);
+        fd_unref (fd);
+
+        return 0;
+}
+
+
+/* Reads ahead of the application, in parallel, the readdirp replies it
+ * will ask next: (@subvol, @offset) and the first ones of the subvolumes
+ * after @subvol, as long as the fd has fewer than readdir-prefetch of them.
+ * They are served by dht_readdirp_wind () when the offset and size of a
+ * readdirp match.
+ */
+static void
+dht_readdirp_prefetch (call_frame_t *frame, xlator_t *this, xlator_t *subvol,
+                       off_t offset)
+{
+        dht_local_t          *local = NULL;
+        dht_conf_t           *conf = NULL;
+        dht_dir_fd_ctx_t     *ctx = NULL;
+        dht_readdir_batch_t  *batch = NULL;
+        dht_readdir_batch_t **batches = NULL;
+        call_frame_t         *pframe = NULL;
+        int                   window = 0;
+        int                   cnt = 0;
+        int                   i = 0;
+
+        local = frame->local;
+        conf  = this->private;
+
+        window = conf->readdir_prefetch;
+        if (window <= 0)
+                return;
+
+        ctx = dht_dir_fd_ctx_get (this, local->fd);
+        if (!ctx)
+                return;
+
+        batches = alloca (window * sizeof (*batches));
+
+        LOCK (&ctx->lock);
+        {
+                while (subvol && (ctx->count < window)) {
+                        if (__dht_readdir_batch_find (ctx, subvol, offset,
+                                                      local->size))
+                                goto next;
+
+                        batch = GF_CALLOC (1, sizeof (*batch),
+                                           gf_dht_mt_readdir_batch_t);
+                        if (!batch)
+                                break;
+
+                        batch->subvol = subvol;
+                        batch->offset = offset;
+                        batch->size   = local->size;
+                        INIT_LIST_HEAD (&batch->entries.list);
+                        list_add_tail (&batch->list, &ctx->batches);
+                        ctx->count++;
+
+                        batches[cnt++] = batch;
+                next:
+                        subvol = dht_subvol_next (this, subvol);
+                        offset = 0;
+                }
+        }
+        UNLOCK (&ctx->lock);
+
+        for (i = 0; i < cnt; i++) {
+                batch = batches[i];
+
+                pframe = copy_frame (frame);
+                if (!pframe) {
+                        LOCK (&ctx->lock);
+                        {
+                                list_del_init (&batch->list);
+                                ctx->count--;
+                        }
+                        UNLOCK (&ctx->lock);
+                        dht_readdir_batch_free (batch);
+                        continue;
+                }
+
+                /* the fd ref keeps the ctx until the reply */
+                pframe->local = fd_ref (local->fd);
+
+                STACK_WIND_COOKIE (pframe, dht_readdirp_prefetch_cbk, batch,
+                                   batch->subvol,
+                                   batch->subvol->fops->readdirp,
+                                   local->fd, batch->size, batch->offset);
+        }
+}
+
+
+/* Reads (@subvol, @offset) for the readdirp of @frame, from the batch read
+   ahead for it when there is one */
+int
+dht_readdirp_wind (call_frame_t *frame, xlator_t *this, xlator_t *subvol,
+                   off_t offset)
+{
+        dht_local_t         *local = NULL;
+        dht_conf_t          *conf = NULL;
+        dht_dir_fd_ctx_t    *ctx = NULL;
+        dht_readdir_batch_t *batch = NULL;
+        dht_readdir_batch_t *tmp = NULL;
+        dht_readdir_batch_t *found = NULL;
+        struct list_head     passed;
+        struct timeval       now = {0,};
+        gf_boolean_t         waiting = _gf_false;
+        int                  idx = 0;
+
+        local = frame->local;
+        conf  = this->private;
+
+        if (!conf->readdir_prefetch)
+                goto wind;
+
+        ctx = dht_dir_fd_ctx_get (this, local->fd);
+        if (!ctx)
+                goto wind;
+
+        INIT_LIST_HEAD (&passed);
+        idx = dht_subvol_cnt (this, subvol);
+        gettimeofday (&now, NULL);
+
+        LOCK (&ctx->lock);
+        {
+                list_for_each_entry_safe (batch, tmp, &ctx->batches, list) {
+                        if (batch->stale)
+                                continue;
+
+                        /* too old to be trusted */
+                        if (batch->done &&
+                            (((now.tv_sec - batch->done_at.tv_sec) * 1000000
+                              + (now.tv_usec - batch->done_at.tv_usec))
+                             > DHT_READDIR_BATCH_MAX_AGE)) {
+                                list_move_tail (&batch->list, &passed);
+                                ctx->count--;
+                                continue;
+                        }
+
+                        if ((batch->subvol == subvol)
+                            && (batch->offset == offset)
+                            && (batch->size == local->size)) {
+                                if (batch->done) {
+                                        list_del_init (&batch->list);
+                                        ctx->count--;
+                                        found = batch;
+                                } else if (!batch->waiter) {
+                                        batch->waiter = frame;
+                                        waiting = _gf_true;
+                                }
+                                continue;
+                        }
+
+                        /* the listing went past it, or restarted */
+                        if ((offset == 0 && idx == 0)
+                            || (batch->subvol == subvol)
+                            || (dht_subvol_cnt (this, batch->subvol) < idx)) {
+                                if (batch->done) {
+                                        list_move_tail (&batch->list, &passed);
+                                        ctx->count--;
+                                } else {
+                                        batch->stale = _gf_true;
+                                }
+                        }
+                }
+        }
+        UNLOCK (&ctx->lock);
+
+        list_for_each_entry_safe (batch, tmp, &passed, list) {
+                list_del_init (&batch->list);
+                dht_readdir_batch_free (batch);
+        }
+
+        if (found) {
+                dht_readdirp_process (frame, this, found->subvol,
+                                      found->op_ret, found->op_errno,
+                                      &found->entries);
+                dht_readdir_batch_free (found);
+                return 0;
+        }
+
+        if (waiting)
+                return 0;
+
+wind:
+        STACK_WIND (frame, dht_readdirp_cbk, subvol, subvol->fops->readdirp,
+                    local->fd, local->size, offset);
+        return 0;
+}
+
+
+int
+dht_readdirp_process (call_frame_t *frame, xlator_t *this, xlator_t *subvol,
+                      int op_ret, int op_errno, gf_dirent_t *orig_entries)
 {
         dht_local_t  *local = NULL;
         gf_dirent_t   entries;
         gf_dirent_t  *orig_entry = NULL;
         gf_dirent_t  *entry = NULL;
-        call_frame_t *prev = NULL;
         xlator_t     *next_subvol = NULL;
         off_t         next_offset = 0;
+        off_t         last_offset = 0;
         int           count = 0;
         dht_layout_t *layout = 0;
         dht_conf_t   *conf   = NULL;
-        xlator_t     *subvol = 0;
+        xlator_t     *hashed = 0;
 
         INIT_LIST_HEAD (&entries.list);
-        prev = cookie;
         local = frame->local;
         conf  = this->private;
 
@@ -2290,7 +2773,7 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
 
                 if (check_is_linkfile_wo_dict (NULL, (&orig_entry->d_stat))
                     || (check_is_dir (NULL, (&orig_entry->d_stat), NULL)
-                        && (prev->this != dht_first_up_subvol (this)))) {
+                        && (subvol != dht_first_up_subvol (this)))) {
                         continue;
                 }
 
@@ -2302,17 +2785,18 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
 
                 /* Do this if conf->search_unhashed is set to "auto" */
                 if (conf->search_unhashed == GF_DHT_LOOKUP_UNHASHED_AUTO) {
-                        subvol = dht_layout_search (this, layout,
+                        hashed = dht_layout_search (this, layout,
                                                     orig_entry->d_name);
-                        if (!subvol || (subvol != prev->this)) {
+                        if (!hashed || (hashed != subvol)) {
                                 /* TODO: Count the number of entries which need
                                    linkfile to prove its existance in fs */
                                 layout->search_unhashed++;
                         }
                 }
 
-                dht_itransform (this, prev->this, orig_entry->d_off,
+                dht_itransform (this, subvol, orig_entry->d_off,
                                 &entry->d_off);
+                last_offset = orig_entry->d_off;
 
                 entry->d_stat = orig_entry->d_stat;
                 entry->d_ino  = orig_entry->d_ino;
@@ -2330,7 +2814,7 @@ dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
          * distribute we're not concerned only with a posix's view of the
          * directory but the aggregated namespace' view of the directory.
          */
-        if (prev->this != dht_last_up_subvol (this))
+        if (subvol != dht_last_up_subvol (this))
                 op_errno = 0;
 
 done:
@@ -2339,21 +2823,23 @@ done:
                    EOF is not yet hit on the current subvol
                 */
                 if (next_offset == 0) {
-                        next_subvol = dht_subvol_next (this, prev->this);
+                        next_subvol = dht_subvol_next (this, subvol);
                 } else {
-                        next_subvol = prev->this;
+                        next_subvol = subvol;
                 }
 
                 if (!next_subvol) {
                         goto unwind;
                 }
 
-                STACK_WIND (frame, dht_readdirp_cbk,
-                            next_subvol, next_subvol->fops->readdirp,
-                            local->fd, local->size, next_offset);
+                dht_readdirp_wind (frame, this, next_subvol, next_offset);
                 return 0;
         }
 
+        /* the application continues from the last entry it gets */
+        if (conf->readdir_prefetch)
+                dht_readdirp_prefetch (frame, this, subvol, last_offset);
+
 unwind:
         if (op_ret < 0)
                 op_ret = 0;
@@ -2367,6 +2853,19 @@ unwind:
 
 
 
+int
+dht_readdirp_cbk (call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                  int op_errno, gf_dirent_t *orig_entries)
+{
+        call_frame_t *prev = NULL;
+
+        prev = cookie;
+
+        return dht_readdirp_process (frame, this, prev->this, op_ret,
+                                     op_errno, orig_entries);
+}
+
+
 int
 dht_readdir_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                  int op_ret, int op_errno, gf_dirent_t *orig_entries)
@@ -2492,8 +2991,7 @@ dht_do_readdir (call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                 STACK_WIND (frame, dht_readdir_cbk, xvol, xvol->fops->readdir,
                             fd, size, xoff);
         else
-                STACK_WIND (frame, dht_readdirp_cbk, xvol, xvol->fops->readdirp,
-                            fd, size, xoff);
+                dht_readdirp_wind (frame, this, xvol, xoff);
 
         return 0;
 
@@ -2703,6 +3201,8 @@ dht_mknod (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (this, err);
         VALIDATE_OR_GOTO (loc, err);
 
+        dht_nlc_invalidate (this, loc);
+
         dht_get_du_info (frame, this, loc);
 
         local = dht_local_init (frame, loc, NULL, GF_FOP_MKNOD);
@@ -2774,6 +3274,8 @@ dht_symlink (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (this, err);
         VALIDATE_OR_GOTO (loc, err);
 
+        dht_nlc_invalidate (this, loc);
+
         local = dht_local_init (frame, loc, NULL, GF_FOP_SYMLINK);
         if (!local) {
                 op_errno = ENOMEM;
@@ -2951,6 +3453,8 @@ dht_link (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (oldloc, err);
         VALIDATE_OR_GOTO (newloc, err);
 
+        dht_nlc_invalidate (this, newloc);
+
         local = dht_local_init (frame, oldloc, NULL, GF_FOP_LINK);
         if (!local) {
                 op_errno = ENOMEM;
@@ -3087,6 +3591,8 @@ dht_create (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (this, err);
         VALIDATE_OR_GOTO (loc, err);
 
+        dht_nlc_invalidate (this, loc);
+
         dht_get_du_info (frame, this, loc);
 
         local = dht_local_init (frame, loc, fd, GF_FOP_CREATE);
@@ -3321,6 +3827,8 @@ dht_mkdir (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (loc->path, err);
         VALIDATE_OR_GOTO (this->private, err);
 
+        dht_nlc_invalidate (this, loc);
+
         conf = this->private;
 
         dht_get_du_info (frame, this, loc);
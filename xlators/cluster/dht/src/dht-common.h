@@ -52,7 +52,20 @@ struct dht_layout {
         int                gen;
         int                type;
         int                ref; /* use with dht_conf_t->layout_lock */
+        /* generation of the on-disk layout, written along with the ranges
+           by self-heal and fix-layout, and how many subvolumes it was
+           merged from. disk_gen_mixed is set when they did not all agree */
+        uint32_t           disk_gen;
+        int                disk_gen_cnt;
+        int                disk_gen_mixed;
         int                search_unhashed;
+        /* ranges without error sorted by start, in parallel arrays after
+           list[] so that dht_layout_search () bisects the starts without
+           touching the rest. Built by dht_layout_set (). */
+        int                search_cnt;
+        xlator_t         **search_xlator;
+        uint32_t          *search_start;
+        uint32_t          *search_stop;
         struct {
                 int        err;   /* 0 = normal
                                      -1 = dir exists and no xattr
@@ -70,6 +83,12 @@ typedef enum {
         DHT_HASH_TYPE_DM,
 } dht_hashfn_type_t;
 
+/* how the hash space of a directory is given out to its subvolumes */
+typedef enum {
+        DHT_LAYOUT_EQUAL = 0,           /* equal ranges in turn */
+        DHT_LAYOUT_CONSISTENT,          /* arcs between hashed points */
+} dht_layout_type_t;
+
 /* rebalance related */
 struct dht_rebalance_ {
         xlator_t            *from_subvol;
@@ -162,14 +181,80 @@ struct dht_local {
         glusterfs_fop_t      fop;
 
         struct dht_rebalance_ rebalance;
+
+        /* hashed subvolume that had no entry, and the parent it
+           returned, for the negative lookup cache */
+        xlator_t                *nlc_hashed;
+        struct iatt              nlc_postparent;
 };
 typedef struct dht_local dht_local_t;
 
+/* readdirp reply fetched ahead of the application, see
+   dht_readdirp_prefetch (). It is not served once older than
+   DHT_READDIR_BATCH_MAX_AGE, the directory may have changed since. */
+#define DHT_READDIR_BATCH_MAX_AGE 1000000 /* usec */
+
+struct dht_readdir_batch {
+        struct list_head  list;
+        xlator_t         *subvol;
+        off_t             offset;
+        size_t            size;
+        gf_boolean_t      done;         /* reply arrived */
+        struct timeval    done_at;
+        gf_boolean_t      stale;        /* passed while in flight */
+        int               op_ret;
+        int               op_errno;
+        gf_dirent_t       entries;
+        call_frame_t     *waiter;       /* readdirp served on arrival */
+};
+typedef struct dht_readdir_batch dht_readdir_batch_t;
+
+/* fd ctx of a directory, only set with readdir-prefetch */
+struct dht_dir_fd_ctx {
+        gf_lock_t         lock;
+        struct list_head  batches;
+        int               count;        /* done or in flight */
+};
+typedef struct dht_dir_fd_ctx dht_dir_fd_ctx_t;
+
+/* name found on no subvolume, see dht-nlc.c */
+struct dht_nlc_entry {
+        struct list_head  hash;
+        struct list_head  lru;
+        uuid_t            pargfid;
+        char             *name;
+        xlator_t         *hashed;
+        int               layout_gen;   /* of the parent's layout */
+        uint32_t          layout_disk_gen;
+        uint32_t          mtime;        /* of the parent on hashed */
+        uint32_t          mtime_nsec;
+        time_t            expires;
+};
+typedef struct dht_nlc_entry dht_nlc_entry_t;
+
+struct dht_nlc {
+        gf_lock_t          lock;
+        struct list_head  *buckets;
+        struct list_head   lru;
+        int                count;
+        uint64_t           hits;
+        uint64_t           misses;
+        uint64_t           inserts;
+        uint64_t           invalidations;
+        uint64_t           evictions;
+};
+typedef struct dht_nlc dht_nlc_t;
+
 /* du - disk-usage */
 struct dht_du {
         double   avail_percent;
         uint64_t avail_space;
+        uint64_t total_space;
         uint32_t log;
+        /* when the last statfs was sent, and the usecs the statfs calls
+           took, smoothed */
+        struct timeval statfs_sent;
+        uint64_t rtt;
 };
 typedef struct dht_du dht_du_t;
 
@@ -193,18 +278,38 @@ struct dht_conf {
         void          *private;     /* Can be used by wrapper xlators over
                                        dht */
         gf_boolean_t   use_readdirp;
+        int            readdir_prefetch; /* readdirp replies buffered
+                                            ahead per directory fd */
         char           vol_uuid[UUID_SIZE + 1];
         gf_boolean_t   assert_no_child_down;
         time_t        *subvol_up_time;
 
+        dht_layout_type_t layout_type;
+        gf_boolean_t   weighted_layout;
+        gf_boolean_t   layout_gen_revalidate;
+
         /* This is the count used as the distribute layout for a directory */
         /* Will be a global flag to control the layout spread count */
         uint32_t       dir_spread_cnt;
 
 	struct syncenv *env; /* The env pointer to the rebalance synctask */
 
+        /* cap on the bytes/sec all migrations of this process copy, and
+           the time the next block may be sent at to keep under it */
+        uint64_t       rebalance_bandwidth;
+        struct timeval rebalance_next;
+
+        /* files up to this size are migrated to the subvolume their new
+           name hashes to as part of a rename, 0 leaves them to rebalance */
+        uint64_t       rename_migrate_size;
+
         /* to keep track of nodes which are decomissioned */
         xlator_t     **decommissioned_bricks;
+
+        /* negative lookup cache */
+        dht_nlc_t      nlc;
+        int            nlc_size;
+        int            nlc_timeout;
 };
 typedef struct dht_conf dht_conf_t;
 
@@ -233,6 +338,8 @@ typedef struct dht_disk_layout dht_disk_layout_t;
 #define DHT_MIGRATION_COMPLETED   2
 
 #define DHT_LINKFILE_KEY         "trusted.glusterfs.dht.linkto"
+#define DHT_LAYOUT_GEN_KEY       "trusted.glusterfs.dht.gen"
+#define DHT_LINKFILE_COUNT_KEY   "trusted.glusterfs.dht.linkfiles"
 #define DHT_LINKFILE_MODE        (S_ISVTX)
 
 #define check_is_linkfile(i,s,x) (                                      \
@@ -299,6 +406,9 @@ int dht_layout_anomalies (xlator_t      *this, loc_t *loc, dht_layout_t *layout,
                           uint32_t      *misc_p);
 int dht_layout_dir_mismatch (xlator_t   *this, dht_layout_t *layout,
                              xlator_t   *subvol, loc_t *loc, dict_t *xattr);
+uint32_t dht_layout_gen_next (dht_layout_t *layout);
+int dht_layout_gen_mismatch (xlator_t *this, dht_layout_t *layout,
+                             loc_t    *loc, dict_t *xattr);
 
 xlator_t *dht_linkfile_subvol (xlator_t *this, inode_t *inode,
                                struct iatt *buf, dict_t *xattr);
@@ -306,6 +416,17 @@ int dht_linkfile_unlink (call_frame_t      *frame, xlator_t *this,
                          xlator_t          *subvol, loc_t *loc);
 
 int dht_layouts_init (xlator_t *this, dht_conf_t *conf);
+dht_layout_type_t dht_layout_type_get (const char *str);
+
+int dht_nlc_init (xlator_t *this, dht_conf_t *conf);
+void dht_nlc_fini (xlator_t *this, dht_conf_t *conf);
+void dht_nlc_resize (xlator_t *this, dht_conf_t *conf);
+gf_boolean_t dht_nlc_check (xlator_t *this, loc_t *loc, xlator_t *hashed,
+                            struct iatt *postparent);
+void dht_nlc_add (xlator_t *this, loc_t *loc, xlator_t *hashed,
+                  struct iatt *postparent);
+void dht_nlc_invalidate (xlator_t *this, loc_t *loc);
+void dht_nlc_dump (xlator_t *this);
 int dht_layout_merge (xlator_t *this, dht_layout_t *layout, xlator_t *subvol,
                       int       op_ret, int op_errno, dict_t *xattr);
 
@@ -358,6 +479,7 @@ int dht_get_du_info (call_frame_t *frame, xlator_t *this, loc_t *loc);
 int       dht_is_subvol_filled (xlator_t *this, xlator_t *subvol);
 xlator_t *dht_free_disk_available_subvol (xlator_t *this, xlator_t *subvol);
 int       dht_get_du_info_for_subvol (xlator_t *this, int subvol_idx);
+uint64_t  dht_get_du_capacity (xlator_t *this, xlator_t *subvol);
 
 int dht_layout_preset (xlator_t *this, xlator_t *subvol, inode_t *inode);
 int           dht_layout_set (xlator_t *this, inode_t *inode, dht_layout_t *layout);
@@ -385,6 +507,8 @@ int dht_init_subvolumes (xlator_t *this, dht_conf_t *conf);
 
 /* migration/rebalance */
 int dht_start_rebalance_task (xlator_t *this, call_frame_t *frame);
+int dht_migrate_file (xlator_t *this, loc_t *loc, xlator_t *from,
+                      xlator_t *to, int flag);
 
 int dht_rebalance_in_progress_check (xlator_t *this, call_frame_t *frame);
 int dht_rebalance_complete_check (xlator_t *this, call_frame_t *frame);
@@ -414,6 +538,31 @@ int32_t dht_ftruncate (call_frame_t *frame,
                        fd_t     *fd,
                        off_t     offset);
 
+int32_t dht_fallocate (call_frame_t *frame,
+                       xlator_t *this,
+                       fd_t     *fd,
+                       int32_t   keep_size,
+                       off_t     offset,
+                       size_t    len);
+
+int32_t dht_discard (call_frame_t *frame,
+                     xlator_t *this,
+                     fd_t     *fd,
+                     off_t     offset,
+                     size_t    len);
+
+int32_t dht_zerofill (call_frame_t *frame,
+                      xlator_t *this,
+                      fd_t     *fd,
+                      off_t     offset,
+                      size_t    len);
+
+int32_t dht_seek (call_frame_t *frame,
+                  xlator_t *this,
+                  fd_t     *fd,
+                  off_t     offset,
+                  gf_seek_what_t what);
+
 int32_t dht_access (call_frame_t *frame,
                     xlator_t *this,
                     loc_t    *loc,
@@ -568,6 +717,7 @@ int32_t dht_fxattrop (call_frame_t *frame,
                       dict_t             *dict);
 
 int32_t dht_forget (xlator_t *this, inode_t *inode);
+int32_t dht_releasedir (xlator_t *this, fd_t *fd);
 int32_t dht_setattr (call_frame_t  *frame, xlator_t *this, loc_t *loc,
                      struct iatt   *stbuf, int32_t valid);
 int32_t dht_fsetattr (call_frame_t *frame, xlator_t *this, fd_t *fd,
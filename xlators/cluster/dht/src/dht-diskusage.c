@@ -43,10 +43,16 @@ dht_du_info_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         int            i = 0;
         double         percent = 0;
         uint64_t       bytes = 0;
+        uint64_t       total = 0;
+        uint64_t       rtt = 0;
+        struct timeval now = {0,};
+        dht_du_t      *du = NULL;
 
         conf = this->private;
         prev = cookie;
 
+        gettimeofday (&now, NULL);
+
         if (op_ret == -1) {
                 gf_log (this->name, GF_LOG_DEBUG,
                         "failed to get disk info from %s", prev->this->name);
@@ -56,6 +62,7 @@ dht_du_info_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         if (statvfs && statvfs->f_blocks) {
                 percent = (statvfs->f_bavail * 100) / statvfs->f_blocks;
                 bytes = (statvfs->f_bavail * statvfs->f_frsize);
+                total = (statvfs->f_blocks * statvfs->f_frsize);
         }
 
         LOCK (&conf->subvolume_lock);
@@ -64,6 +71,18 @@ dht_du_info_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                         if (prev->this == conf->subvolumes[i]) {
                                 conf->du_stats[i].avail_percent = percent;
                                 conf->du_stats[i].avail_space   = bytes;
+                                conf->du_stats[i].total_space   = total;
+
+                                du = &conf->du_stats[i];
+                                if (du->statfs_sent.tv_sec) {
+                                        rtt = (now.tv_sec
+                                               - du->statfs_sent.tv_sec)
+                                                * 1000000 + now.tv_usec
+                                                - du->statfs_sent.tv_usec;
+                                        if (du->rtt)
+                                                rtt = (7 * du->rtt + rtt) / 8;
+                                        du->rtt = rtt ? rtt : 1;
+                                }
                                 gf_log (this->name, GF_LOG_DEBUG,
                                         "on subvolume '%s': avail_percent is: "
                                         "%.2f and avail_space is: %"PRIu64"",
@@ -109,6 +128,12 @@ dht_get_du_info_for_subvol (xlator_t *this, int subvol_idx)
                           .path = "/",
         };
 
+        LOCK (&conf->subvolume_lock);
+        {
+                gettimeofday (&conf->du_stats[subvol_idx].statfs_sent, NULL);
+        }
+        UNLOCK (&conf->subvolume_lock);
+
         statfs_local->call_cnt = 1;
         STACK_WIND (statfs_frame, dht_du_info_cbk,
                     conf->subvolumes[subvol_idx],
@@ -154,6 +179,13 @@ dht_get_du_info (call_frame_t *frame, xlator_t *this, loc_t *loc)
                                   .path = "/",
                 };
 
+                LOCK (&conf->subvolume_lock);
+                {
+                        for (i = 0; i < conf->subvolume_cnt; i++)
+                                conf->du_stats[i].statfs_sent = tv;
+                }
+                UNLOCK (&conf->subvolume_lock);
+
                 statfs_local->call_cnt = conf->subvolume_cnt;
                 for (i = 0; i < conf->subvolume_cnt; i++) {
                         STACK_WIND (statfs_frame, dht_du_info_cbk,
@@ -173,6 +205,31 @@ err:
 }
 
 
+/* size of @subvol as its last statfs gave it, 0 if not known yet */
+uint64_t
+dht_get_du_capacity (xlator_t *this, xlator_t *subvol)
+{
+        int         i = 0;
+        uint64_t    capacity = 0;
+        dht_conf_t *conf = NULL;
+
+        conf = this->private;
+
+        LOCK (&conf->subvolume_lock);
+        {
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        if (subvol == conf->subvolumes[i]) {
+                                capacity = conf->du_stats[i].total_space;
+                                break;
+                        }
+                }
+        }
+        UNLOCK (&conf->subvolume_lock);
+
+        return capacity;
+}
+
+
 int
 dht_is_subvol_filled (xlator_t *this, xlator_t *subvol)
 {
@@ -32,7 +32,10 @@
 
 #define layout_entry_size (sizeof ((dht_layout_t *)NULL)->list[0])
 
-#define layout_size(cnt) (layout_base_size + (cnt * layout_entry_size))
+#define layout_index_entry_size (sizeof (xlator_t *) + 2 * sizeof (uint32_t))
+
+#define layout_size(cnt) (layout_base_size + (cnt * layout_entry_size) \
+                          + (cnt * layout_index_entry_size))
 
 
 dht_layout_t *
@@ -53,6 +56,10 @@ dht_layout_new (xlator_t *this, int cnt)
         layout->type = DHT_HASH_TYPE_DM;
         layout->cnt = cnt;
 
+        layout->search_xlator = (xlator_t **) &layout->list[cnt];
+        layout->search_start  = (uint32_t *) &layout->search_xlator[cnt];
+        layout->search_stop   = &layout->search_start[cnt];
+
         if (conf) {
                 layout->spread_cnt = conf->dir_spread_cnt;
                 layout->gen = conf->gen;
@@ -91,6 +98,42 @@ out:
 }
 
 
+/* (re)builds the search index of @layout from its list[], which normally
+   is sorted by start already */
+static void
+dht_layout_index (dht_layout_t *layout)
+{
+        uint32_t  start = 0;
+        uint32_t  stop = 0;
+        xlator_t *xlator = NULL;
+        int       cnt = 0;
+        int       i = 0;
+        int       j = 0;
+
+        for (i = 0; i < layout->cnt; i++) {
+                if (layout->list[i].err || !layout->list[i].xlator)
+                        continue;
+
+                start  = layout->list[i].start;
+                stop   = layout->list[i].stop;
+                xlator = layout->list[i].xlator;
+
+                for (j = cnt; (j > 0) && (layout->search_start[j - 1] > start);
+                     j--) {
+                        layout->search_start[j]  = layout->search_start[j - 1];
+                        layout->search_stop[j]   = layout->search_stop[j - 1];
+                        layout->search_xlator[j] = layout->search_xlator[j - 1];
+                }
+                layout->search_start[j]  = start;
+                layout->search_stop[j]   = stop;
+                layout->search_xlator[j] = xlator;
+                cnt++;
+        }
+
+        layout->search_cnt = cnt;
+}
+
+
 int
 dht_layout_set (xlator_t *this, inode_t *inode, dht_layout_t *layout)
 {
@@ -104,6 +147,8 @@ dht_layout_set (xlator_t *this, inode_t *inode, dht_layout_t *layout)
         if (!conf)
                 goto out;
 
+        dht_layout_index (layout);
+
         LOCK (&conf->layout_lock);
         {
                 oldret = inode_ctx_get (inode, this, &old_layout_int);
@@ -170,6 +215,10 @@ dht_layout_search (xlator_t *this, dht_layout_t *layout, const char *name)
 {
         uint32_t   hash = 0;
         xlator_t  *subvol = NULL;
+        uint32_t  *starts = NULL;
+        int        base = 0;
+        int        half = 0;
+        int        n = 0;
         int        i = 0;
         int        ret = 0;
 
@@ -182,6 +231,25 @@ dht_layout_search (xlator_t *this, dht_layout_t *layout, const char *name)
                 goto out;
         }
 
+        /* last range starting at or before the hash; the loop has no
+           data dependent branch, only the select */
+        n = layout->search_cnt;
+        if (n) {
+                starts = layout->search_start;
+                while (n > 1) {
+                        half = n / 2;
+                        base = (starts[base + half] <= hash) ? base + half
+                                                             : base;
+                        n -= half;
+                }
+                if ((starts[base] <= hash)
+                    && (layout->search_stop[base] >= hash)) {
+                        subvol = layout->search_xlator[base];
+                        goto out;
+                }
+        }
+
+        /* not indexed yet, or a layout with holes or errors */
         for (i = 0; i < layout->cnt; i++) {
                 if (layout->list[i].start <= hash
                     && layout->list[i].stop >= hash) {
@@ -223,6 +291,16 @@ out:
 }
 
 
+dht_layout_type_t
+dht_layout_type_get (const char *str)
+{
+        if (str && !strcasecmp (str, "consistent"))
+                return DHT_LAYOUT_CONSISTENT;
+
+        return DHT_LAYOUT_EQUAL;
+}
+
+
 int
 dht_layouts_init (xlator_t *this, dht_conf_t *conf)
 {
@@ -325,6 +403,22 @@ dht_disk_layout_merge (xlator_t *this, dht_layout_t *layout,
 }
 
 
+/* the layout generation in a lookup reply, 0 when it has none */
+static uint32_t
+dht_layout_disk_gen (dict_t *xattr)
+{
+        void     *gen_raw = NULL;
+        uint32_t  gen = 0;
+
+        if (!xattr || dict_get_ptr (xattr, DHT_LAYOUT_GEN_KEY, &gen_raw))
+                return 0;
+
+        memcpy (&gen, gen_raw, sizeof (gen));
+
+        return ntoh32 (gen);
+}
+
+
 int
 dht_layout_merge (xlator_t *this, dht_layout_t *layout, xlator_t *subvol,
                   int op_ret, int op_errno, dict_t *xattr)
@@ -333,6 +427,7 @@ dht_layout_merge (xlator_t *this, dht_layout_t *layout, xlator_t *subvol,
         int      ret   = -1;
         int      err   = -1;
         void    *disk_layout_raw = NULL;
+        uint32_t gen   = 0;
 
 
         if (op_ret != 0) {
@@ -376,6 +471,15 @@ dht_layout_merge (xlator_t *this, dht_layout_t *layout, xlator_t *subvol,
         }
         layout->list[i].err = 0;
 
+        gen = dht_layout_disk_gen (xattr);
+        if (layout->disk_gen_cnt++ == 0) {
+                layout->disk_gen = gen;
+        } else if (layout->disk_gen != gen) {
+                layout->disk_gen_mixed = 1;
+                if (gen > layout->disk_gen)
+                        layout->disk_gen = gen;
+        }
+
 out:
         return ret;
 }
@@ -692,6 +796,45 @@ out:
 }
 
 
+/* The generation to write with a layout that replaces @layout. The time
+   keeps two clients that fix the same directory from a stale copy from
+   both writing the generation after it. */
+uint32_t
+dht_layout_gen_next (dht_layout_t *layout)
+{
+        uint32_t gen = 0;
+
+        gen = time (NULL);
+        if (gen <= layout->disk_gen)
+                gen = layout->disk_gen + 1;
+
+        return gen;
+}
+
+
+/* Whether the layout generation in a lookup reply says @layout is out of
+   date. One that was merged from disagreeing subvolumes cannot tell. */
+int
+dht_layout_gen_mismatch (xlator_t *this, dht_layout_t *layout, loc_t *loc,
+                         dict_t *xattr)
+{
+        uint32_t gen = 0;
+
+        if (layout->disk_gen_mixed)
+                return 0;
+
+        gen = dht_layout_disk_gen (xattr);
+        if (gen == layout->disk_gen)
+                return 0;
+
+        gf_log (this->name, GF_LOG_DEBUG,
+                "%s - layout generation %"PRIu32" on disk, %"PRIu32" cached",
+                loc->path, gen, layout->disk_gen);
+
+        return 1;
+}
+
+
 int
 dht_layout_preset (xlator_t *this, xlator_t *subvol, inode_t *inode)
 {
@@ -37,6 +37,10 @@ enum gf_dht_mem_types_ {
         gf_switch_mt_switch_struct,
         gf_dht_mt_subvol_time,
         gf_dht_mt_loc_t,
+        gf_dht_mt_readdir_batch_t,
+        gf_dht_mt_dir_fd_ctx_t,
+        gf_dht_mt_nlc_entry_t,
+        gf_nufa_mt_nufa_private_t,
         gf_dht_mt_end
 };
 #endif
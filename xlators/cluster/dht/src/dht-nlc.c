@@ -0,0 +1,353 @@
+/*
+  Copyright (c) 2008-2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+/* negative lookup cache: names that lookup-everywhere found on no
+ * subvolume. An entry is only trusted while the parent directory on the
+ * hashed subvolume keeps the mtime it had, and the parent keeps the
+ * layout generations it had, when the name was found missing; a create
+ * there, of the file or of a linkfile to it, changes that mtime. A backend
+ * with whole second mtimes would not show a create in the same second, so
+ * nothing is cached for a parent whose mtime has no nanoseconds. Creates
+ * through this client drop the entry as well, and every entry expires
+ * after negative-lookup-cache-timeout seconds.
+ */
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "dht-common.h"
+#include "statedump.h"
+#include "hashfn.h"
+
+#define DHT_NLC_BUCKETS 1024
+
+
+static const unsigned char *
+dht_nlc_pargfid (loc_t *loc)
+{
+        if (loc->parent)
+                return loc->parent->gfid;
+        return loc->pargfid;
+}
+
+
+static uint32_t
+dht_nlc_hash (const unsigned char *pargfid, const char *name)
+{
+        uint32_t hash = 0;
+        int      i = 0;
+
+        hash = gf_dm_hashfn (name, strlen (name));
+        for (i = 0; i < 16; i++)
+                hash = (hash * 31) + pargfid[i];
+
+        return hash % DHT_NLC_BUCKETS;
+}
+
+
+static dht_nlc_entry_t *
+__dht_nlc_find (dht_nlc_t *nlc, const unsigned char *pargfid,
+                const char *name)
+{
+        dht_nlc_entry_t *entry = NULL;
+        uint32_t         bucket = 0;
+
+        bucket = dht_nlc_hash (pargfid, name);
+        list_for_each_entry (entry, &nlc->buckets[bucket], hash) {
+                if (!uuid_compare (entry->pargfid, pargfid)
+                    && !strcmp (entry->name, name))
+                        return entry;
+        }
+
+        return NULL;
+}
+
+
+static void
+__dht_nlc_remove (dht_nlc_t *nlc, dht_nlc_entry_t *entry)
+{
+        list_del_init (&entry->hash);
+        list_del_init (&entry->lru);
+        nlc->count--;
+
+        GF_FREE (entry->name);
+        GF_FREE (entry);
+}
+
+
+/* drops the least recently used entries over @size */
+static void
+__dht_nlc_shrink (dht_nlc_t *nlc, int size)
+{
+        dht_nlc_entry_t *entry = NULL;
+
+        while (nlc->count > size) {
+                entry = list_entry (nlc->lru.next, dht_nlc_entry_t, lru);
+                __dht_nlc_remove (nlc, entry);
+                nlc->evictions++;
+        }
+}
+
+
+int
+dht_nlc_init (xlator_t *this, dht_conf_t *conf)
+{
+        dht_nlc_t *nlc = NULL;
+        int        i = 0;
+
+        nlc = &conf->nlc;
+
+        nlc->buckets = GF_CALLOC (DHT_NLC_BUCKETS, sizeof (*nlc->buckets),
+                                  gf_dht_mt_nlc_entry_t);
+        if (!nlc->buckets)
+                return -1;
+
+        for (i = 0; i < DHT_NLC_BUCKETS; i++)
+                INIT_LIST_HEAD (&nlc->buckets[i]);
+        INIT_LIST_HEAD (&nlc->lru);
+        LOCK_INIT (&nlc->lock);
+
+        return 0;
+}
+
+
+void
+dht_nlc_fini (xlator_t *this, dht_conf_t *conf)
+{
+        dht_nlc_t *nlc = NULL;
+
+        nlc = &conf->nlc;
+        if (!nlc->buckets)
+                return;
+
+        LOCK (&nlc->lock);
+        {
+                __dht_nlc_shrink (nlc, 0);
+        }
+        UNLOCK (&nlc->lock);
+
+        LOCK_DESTROY (&nlc->lock);
+        GF_FREE (nlc->buckets);
+        nlc->buckets = NULL;
+}
+
+
+/* applies a new negative-lookup-cache-size */
+void
+dht_nlc_resize (xlator_t *this, dht_conf_t *conf)
+{
+        dht_nlc_t *nlc = NULL;
+
+        nlc = &conf->nlc;
+        if (!nlc->buckets)
+                return;
+
+        LOCK (&nlc->lock);
+        {
+                __dht_nlc_shrink (nlc, conf->nlc_size);
+        }
+        UNLOCK (&nlc->lock);
+}
+
+
+/* Whether @loc is known missing, @hashed having just answered ENOENT with
+   @postparent for the parent. */
+gf_boolean_t
+dht_nlc_check (xlator_t *this, loc_t *loc, xlator_t *hashed,
+               struct iatt *postparent)
+{
+        dht_conf_t      *conf = NULL;
+        dht_nlc_t       *nlc = NULL;
+        dht_nlc_entry_t *entry = NULL;
+        dht_layout_t    *layout = NULL;
+        gf_boolean_t     hit = _gf_false;
+
+        conf = this->private;
+        nlc  = &conf->nlc;
+
+        if (!conf->nlc_size || !nlc->buckets || !loc->name || !postparent)
+                return _gf_false;
+
+        /* without the parent's attributes there is nothing to validate
+           the entry against */
+        if (uuid_is_null (postparent->ia_gfid) || !postparent->ia_mtime_nsec)
+                return _gf_false;
+
+        if (loc->parent)
+                layout = dht_layout_get (this, loc->parent);
+        if (!layout)
+                return _gf_false;
+
+        LOCK (&nlc->lock);
+        {
+                entry = __dht_nlc_find (nlc, dht_nlc_pargfid (loc),
+                                        loc->name);
+                if (!entry) {
+                        nlc->misses++;
+                        goto unlock;
+                }
+
+                if ((entry->hashed != hashed)
+                    || (entry->layout_gen != layout->gen)
+                    || (entry->layout_disk_gen != layout->disk_gen)
+                    || (entry->mtime != postparent->ia_mtime)
+                    || (entry->mtime_nsec != postparent->ia_mtime_nsec)
+                    || (entry->expires < time (NULL))) {
+                        __dht_nlc_remove (nlc, entry);
+                        nlc->invalidations++;
+                        nlc->misses++;
+                        goto unlock;
+                }
+
+                list_move_tail (&entry->lru, &nlc->lru);
+                nlc->hits++;
+                hit = _gf_true;
+        }
+unlock:
+        UNLOCK (&nlc->lock);
+
+        dht_layout_unref (this, layout);
+
+        return hit;
+}
+
+
+/* Records that lookup-everywhere found @loc on no subvolume, @hashed
+   having answered ENOENT with @postparent for the parent. */
+void
+dht_nlc_add (xlator_t *this, loc_t *loc, xlator_t *hashed,
+             struct iatt *postparent)
+{
+        dht_conf_t      *conf = NULL;
+        dht_nlc_t       *nlc = NULL;
+        dht_nlc_entry_t *entry = NULL;
+        dht_layout_t    *layout = NULL;
+        uint32_t         bucket = 0;
+
+        conf = this->private;
+        nlc  = &conf->nlc;
+
+        if (!conf->nlc_size || !nlc->buckets || !loc->name || !loc->parent
+            || uuid_is_null (postparent->ia_gfid)
+            || !postparent->ia_mtime_nsec)
+                return;
+
+        layout = dht_layout_get (this, loc->parent);
+        if (!layout)
+                return;
+
+        LOCK (&nlc->lock);
+        {
+                entry = __dht_nlc_find (nlc, dht_nlc_pargfid (loc),
+                                        loc->name);
+                if (!entry) {
+                        entry = GF_CALLOC (1, sizeof (*entry),
+                                           gf_dht_mt_nlc_entry_t);
+                        if (!entry)
+                                goto unlock;
+
+                        entry->name = gf_strdup (loc->name);
+                        if (!entry->name) {
+                                GF_FREE (entry);
+                                goto unlock;
+                        }
+
+                        uuid_copy (entry->pargfid, dht_nlc_pargfid (loc));
+                        bucket = dht_nlc_hash (entry->pargfid, entry->name);
+                        list_add (&entry->hash, &nlc->buckets[bucket]);
+                        INIT_LIST_HEAD (&entry->lru);
+                        nlc->count++;
+                        nlc->inserts++;
+                }
+
+                entry->hashed     = hashed;
+                entry->layout_gen      = layout->gen;
+                entry->layout_disk_gen = layout->disk_gen;
+                entry->mtime           = postparent->ia_mtime;
+                entry->mtime_nsec      = postparent->ia_mtime_nsec;
+                entry->expires         = time (NULL) + conf->nlc_timeout;
+                list_move_tail (&entry->lru, &nlc->lru);
+
+                __dht_nlc_shrink (nlc, conf->nlc_size);
+        }
+unlock:
+        UNLOCK (&nlc->lock);
+
+        dht_layout_unref (this, layout);
+}
+
+
+/* @loc is about to be created through this client */
+void
+dht_nlc_invalidate (xlator_t *this, loc_t *loc)
+{
+        dht_conf_t      *conf = NULL;
+        dht_nlc_t       *nlc = NULL;
+        dht_nlc_entry_t *entry = NULL;
+
+        conf = this->private;
+        nlc  = &conf->nlc;
+
+        if (!nlc->buckets || !nlc->count || !loc || !loc->name)
+                return;
+
+        LOCK (&nlc->lock);
+        {
+                entry = __dht_nlc_find (nlc, dht_nlc_pargfid (loc),
+                                        loc->name);
+                if (entry) {
+                        __dht_nlc_remove (nlc, entry);
+                        nlc->invalidations++;
+                }
+        }
+        UNLOCK (&nlc->lock);
+}
+
+
+void
+dht_nlc_dump (xlator_t *this)
+{
+        dht_conf_t *conf = NULL;
+        dht_nlc_t  *nlc = NULL;
+
+        conf = this->private;
+        nlc  = &conf->nlc;
+
+        if (!nlc->buckets)
+                return;
+
+        LOCK (&nlc->lock);
+        {
+                gf_proc_dump_write ("nlc.size", "%d", conf->nlc_size);
+                gf_proc_dump_write ("nlc.count", "%d", nlc->count);
+                gf_proc_dump_write ("nlc.hits", "%"PRIu64, nlc->hits);
+                gf_proc_dump_write ("nlc.misses", "%"PRIu64, nlc->misses);
+                gf_proc_dump_write ("nlc.inserts", "%"PRIu64, nlc->inserts);
+                gf_proc_dump_write ("nlc.invalidations", "%"PRIu64,
+                                    nlc->invalidations);
+                gf_proc_dump_write ("nlc.evictions", "%"PRIu64,
+                                    nlc->evictions);
+        }
+        UNLOCK (&nlc->lock);
+}
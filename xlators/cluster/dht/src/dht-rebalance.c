@@ -24,6 +24,8 @@
 #endif
 
 #include "dht-common.h"
+#include "syncop.h"
+#include "timer.h"
 
 #define GF_DISK_SECTOR_SIZE             512
 #define DHT_REBALANCE_PID               4242 /* Change it if required */
@@ -246,28 +248,272 @@ out:
         return ret;
 }
 
+/* the writev left in flight while the next block is read */
+struct dht_rebalance_write {
+        gf_lock_t          lock;
+        struct synctask   *task;
+        int                pending;
+        int                waiting;
+        int                size;
+        int                op_ret;
+        int                op_errno;
+        struct iovec      *vector;
+        struct iobref     *iobref;
+};
+
+/* a task waiting out rebalance-bandwidth, and the event to wake it */
+struct dht_rebalance_sleep {
+        gf_lock_t          lock;
+        struct synctask   *task;
+        gf_timer_t        *timer;
+};
+
+
+static void
+dht_rebalance_wake (void *data)
+{
+        struct dht_rebalance_sleep *rest = NULL;
+        struct synctask            *task = NULL;
+        gf_timer_t                 *timer = NULL;
+
+        rest = data;
+
+        /* the fired event is ours to free */
+        LOCK (&rest->lock);
+        {
+                task  = rest->task;
+                timer = rest->timer;
+                rest->timer = NULL;
+        }
+        UNLOCK (&rest->lock);
+
+        if (timer)
+                gf_timer_call_cancel (THIS->ctx, timer);
+
+        synctask_wake (task);
+}
+
+
+/* Holds the calling task back until @size more bytes fit under
+   rebalance-bandwidth. The wait is on a timer, other migrations of the
+   syncenv keep running meanwhile. */
+static void
+dht_rebalance_throttle (xlator_t *this, size_t size)
+{
+        dht_conf_t                 *conf = NULL;
+        struct synctask            *task = NULL;
+        struct dht_rebalance_sleep  rest = {0,};
+        struct timeval              now = {0,};
+        struct timeval              delta = {0,};
+        uint64_t                    usec = 0;
+
+        conf = this->private;
+        if (!conf->rebalance_bandwidth)
+                return;
+
+        gettimeofday (&now, NULL);
+        usec = ((uint64_t) size * 1000000) / conf->rebalance_bandwidth;
+
+        LOCK (&conf->subvolume_lock);
+        {
+                if (timercmp (&conf->rebalance_next, &now, <))
+                        conf->rebalance_next = now;
+                else
+                        timersub (&conf->rebalance_next, &now, &delta);
+
+                conf->rebalance_next.tv_sec  += usec / 1000000;
+                conf->rebalance_next.tv_usec += usec % 1000000;
+                if (conf->rebalance_next.tv_usec >= 1000000) {
+                        conf->rebalance_next.tv_sec++;
+                        conf->rebalance_next.tv_usec -= 1000000;
+                }
+        }
+        UNLOCK (&conf->subvolume_lock);
+
+        if (!timerisset (&delta))
+                return;
+
+        task = synctask_get ();
+        if (!task) {
+                usleep (delta.tv_sec * 1000000 + delta.tv_usec);
+                return;
+        }
+
+        rest.task = task;
+        LOCK_INIT (&rest.lock);
+
+        synctask_yawn (task);
+        LOCK (&rest.lock);
+        {
+                rest.timer = gf_timer_call_after (this->ctx, delta,
+                                                   dht_rebalance_wake,
+                                                   &rest);
+        }
+        UNLOCK (&rest.lock);
+        if (!rest.timer)
+                synctask_wake (task);
+        synctask_yield (task);
+
+        LOCK_DESTROY (&rest.lock);
+}
+
+
+static int
+dht_rebalance_writev_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                          int op_ret, int op_errno, struct iatt *prebuf,
+                          struct iatt *postbuf)
+{
+        struct dht_rebalance_write *write = NULL;
+        int                         waiting = 0;
+
+        write = cookie;
+
+        LOCK (&write->lock);
+        {
+                write->op_ret   = op_ret;
+                write->op_errno = op_errno;
+                write->pending  = 0;
+                waiting         = write->waiting;
+                write->waiting  = 0;
+        }
+        UNLOCK (&write->lock);
+
+        if (waiting)
+                synctask_wake (write->task);
+
+        return 0;
+}
+
+
+/* waits for the writev in flight, if any, and tells how it went */
+static int
+dht_rebalance_write_wait (struct dht_rebalance_write *write)
+{
+        int ret = 0;
+
+        LOCK (&write->lock);
+        if (write->pending) {
+                write->waiting = 1;
+                synctask_yawn (write->task);
+                UNLOCK (&write->lock);
+                synctask_yield (write->task);
+        } else {
+                UNLOCK (&write->lock);
+        }
+
+        if (write->vector) {
+                ret = write->op_ret;
+                if ((ret >= 0) && (ret < write->size)) {
+                        /* a short write leaves a gap in the target */
+                        ret = -1;
+                        write->op_errno = EIO;
+                }
+                if (ret < 0)
+                        errno = write->op_errno;
+
+                GF_FREE (write->vector);
+                iobref_unref (write->iobref);
+                write->vector = NULL;
+                write->iobref = NULL;
+        }
+
+        return ret;
+}
+
+
+/* Copies a range without holes with the read of each block overlapping
+   the write of the previous one, instead of the two taking turns. */
 static inline int
-__dht_rebalane_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst,
-                             uint64_t ia_size, int hole_exists)
+__dht_rebalance_copy_pipelined (xlator_t *from, xlator_t *to, fd_t *src,
+                                fd_t *dst, off_t offset, uint64_t len,
+                                struct synctask *task)
+{
+        int                         ret    = 0;
+        int                         tmp    = 0;
+        int                         count  = 0;
+        struct iovec               *vector = NULL;
+        struct iobref              *iobref = NULL;
+        uint64_t                    total  = 0;
+        size_t                      read_size = 0;
+        struct dht_rebalance_write  write = {0, };
+
+        LOCK_INIT (&write.lock);
+        write.task = task;
+
+        while (total < len) {
+                read_size = (((len - total) > DHT_REBALANCE_BLKSIZE) ?
+                             DHT_REBALANCE_BLKSIZE : (len - total));
+                ret = syncop_readv (from, src, read_size,
+                                    offset, &vector, &count, &iobref);
+                if (!ret || (ret < 0))
+                        break;
+
+                tmp = dht_rebalance_write_wait (&write);
+                if (tmp < 0) {
+                        GF_FREE (vector);
+                        iobref_unref (iobref);
+                        ret = tmp;
+                        break;
+                }
+
+                dht_rebalance_throttle (THIS, ret);
+
+                write.pending = 1;
+                write.size    = ret;
+                write.vector  = vector;
+                write.iobref  = iobref;
+                STACK_WIND_COOKIE (task->frame, dht_rebalance_writev_cbk,
+                                   &write, to, to->fops->writev, dst, vector,
+                                   count, offset, iobref);
+
+                offset += write.size;
+                total  += write.size;
+                vector  = NULL;
+                iobref  = NULL;
+        }
+
+        tmp = dht_rebalance_write_wait (&write);
+        if ((ret >= 0) && (tmp < 0))
+                ret = tmp;
+
+        LOCK_DESTROY (&write.lock);
+
+        if (ret >= 0)
+                ret = 0;
+
+        return ret;
+}
+
+
+static inline int
+__dht_rebalance_copy_range (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst,
+                            off_t offset, uint64_t len, int hole_exists)
 {
         int            ret    = 0;
         int            count  = 0;
-        off_t          offset = 0;
         struct iovec  *vector = NULL;
         struct iobref *iobref = NULL;
         uint64_t       total  = 0;
         size_t         read_size = 0;
+        struct synctask *task = NULL;
+
+        task = synctask_get ();
+        if (!hole_exists && task)
+                return __dht_rebalance_copy_pipelined (from, to, src, dst,
+                                                       offset, len, task);
 
-        /* if file size is '0', no need to enter this loop */
-        while (total < ia_size) {
-                read_size = (((ia_size - total) > DHT_REBALANCE_BLKSIZE) ?
-                             DHT_REBALANCE_BLKSIZE : (ia_size - total));
+        /* if range is empty, no need to enter this loop */
+        while (total < len) {
+                read_size = (((len - total) > DHT_REBALANCE_BLKSIZE) ?
+                             DHT_REBALANCE_BLKSIZE : (len - total));
                 ret = syncop_readv (from, src, read_size,
                                     offset, &vector, &count, &iobref);
                 if (!ret || (ret < 0)) {
                         break;
                 }
 
+                dht_rebalance_throttle (THIS, ret);
+
                 if (hole_exists)
                         ret = dht_write_with_holes (to, dst, vector, count,
                                                     ret, offset, iobref);
@@ -298,6 +544,64 @@ __dht_rebalane_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst,
         return ret;
 }
 
+static inline int
+__dht_rebalane_migrate_data (xlator_t *from, xlator_t *to, fd_t *src, fd_t *dst,
+                             uint64_t ia_size, int hole_exists)
+{
+        int            ret         = 0;
+        off_t          offset      = 0;
+        off_t          data_offset = 0;
+        off_t          hole_offset = 0;
+
+        if (!hole_exists)
+                return __dht_rebalance_copy_range (from, to, src, dst, 0,
+                                                   ia_size, 0);
+
+        /* Sparse file: ask the source brick where the data extents are
+           and copy only those, instead of reading the holes as zeros */
+        while (offset < ia_size) {
+                ret = syncop_seek (from, src, offset, GF_SEEK_DATA,
+                                   &data_offset);
+                if (ret < 0) {
+                        if (errno == ENXIO) {
+                                /* only a hole is left till the end */
+                                ret = 0;
+                                break;
+                        }
+                        /* subvolume can't tell, copy whatever is left */
+                        ret = __dht_rebalance_copy_range (from, to, src, dst,
+                                                          offset,
+                                                          ia_size - offset, 1);
+                        goto out;
+                }
+
+                if (data_offset >= ia_size)
+                        break;
+
+                ret = syncop_seek (from, src, data_offset, GF_SEEK_HOLE,
+                                   &hole_offset);
+                if ((ret < 0) || (hole_offset > ia_size))
+                        hole_offset = ia_size;
+
+                ret = __dht_rebalance_copy_range (from, to, src, dst,
+                                                  data_offset,
+                                                  hole_offset - data_offset, 1);
+                if (ret < 0)
+                        goto out;
+
+                offset = hole_offset;
+        }
+
+        /* skipped holes at the end of the file still count in its size */
+        ret = syncop_ftruncate (to, dst, ia_size);
+        if (ret < 0)
+                gf_log (THIS->name, GF_LOG_WARNING,
+                        "failed to set size of target file (%s)",
+                        strerror (errno));
+out:
+        return ret;
+}
+
 
 static inline int
 __dht_rebalance_open_src_file (xlator_t *from, xlator_t *to, loc_t *loc,
@@ -29,6 +29,10 @@
 #include "xlator.h"
 #include "dht-common.h"
 #include "defaults.h"
+#include "syncop.h"
+#include "byte-order.h"
+
+#include <libgen.h>
 
 
 int
@@ -314,6 +318,264 @@ err:
 }
 
 
+static int
+dht_rename_parent_loc (loc_t *parent, loc_t *child)
+{
+        char *tmp = NULL;
+
+        if (!child->parent)
+                return -1;
+
+        tmp = gf_strdup (child->path);
+        if (!tmp)
+                return -1;
+
+        parent->path = gf_strdup (dirname (tmp));
+        GF_FREE (tmp);
+        if (!parent->path)
+                return -1;
+
+        parent->name = strrchr (parent->path, '/');
+        if (parent->name)
+                parent->name++;
+
+        parent->inode  = inode_ref (child->parent);
+        parent->parent = inode_parent (parent->inode, 0, NULL);
+        if (!uuid_is_null (child->pargfid))
+                uuid_copy (parent->gfid, child->pargfid);
+        else
+                uuid_copy (parent->gfid, child->parent->gfid);
+
+        return 0;
+}
+
+
+int
+dht_rename_linkfile_count_cbk (call_frame_t *frame, void *cookie,
+                               xlator_t *this, int32_t op_ret,
+                               int32_t op_errno, dict_t *dict)
+{
+        dht_local_t  *local = NULL;
+        call_frame_t *prev = NULL;
+
+        local = frame->local;
+        prev  = cookie;
+
+        if (op_ret == -1)
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s: failed to count the linkfile on %s (%s)",
+                        local->loc.path, prev->this->name,
+                        strerror (op_errno));
+
+        DHT_STACK_DESTROY (frame);
+        return 0;
+}
+
+
+/* Counts the linkfile the rename left on @subvol in the directory of the
+   new name, in the background. */
+static void
+dht_rename_linkfile_count (call_frame_t *frame, xlator_t *subvol)
+{
+        dht_local_t  *local = NULL;
+        dht_local_t  *count_local = NULL;
+        call_frame_t *count_frame = NULL;
+        dict_t       *xattr = NULL;
+        int32_t      *count = NULL;
+        xlator_t     *this = NULL;
+
+        local = frame->local;
+        this  = frame->this;
+
+        count_frame = copy_frame (frame);
+        if (!count_frame)
+                goto err;
+
+        count_local = dht_local_init (count_frame, NULL, NULL,
+                                      GF_FOP_MAXVALUE);
+        if (!count_local)
+                goto err;
+
+        if (dht_rename_parent_loc (&count_local->loc, &local->loc2))
+                goto err;
+
+        xattr = dict_new ();
+        if (!xattr)
+                goto err;
+
+        count = GF_CALLOC (1, sizeof (*count), gf_dht_mt_int32_t);
+        if (!count)
+                goto err;
+
+        *count = hton32 (1);
+        if (dict_set_bin (xattr, DHT_LINKFILE_COUNT_KEY, count,
+                          sizeof (*count))) {
+                GF_FREE (count);
+                goto err;
+        }
+
+        FRAME_SU_DO (count_frame, dht_local_t);
+        STACK_WIND (count_frame, dht_rename_linkfile_count_cbk,
+                    subvol, subvol->fops->xattrop,
+                    &count_local->loc, GF_XATTROP_ADD_ARRAY, xattr);
+
+        dict_unref (xattr);
+        return;
+
+err:
+        gf_log (this->name, GF_LOG_DEBUG,
+                "%s: failed to count the linkfile on %s",
+                local->loc2.path, subvol->name);
+
+        if (xattr)
+                dict_unref (xattr);
+        if (count_frame)
+                DHT_STACK_DESTROY (count_frame);
+}
+
+
+static int
+dht_rename_unwind (call_frame_t *frame)
+{
+        dht_local_t *local = NULL;
+
+        local = frame->local;
+
+        WIPE (&local->preoldparent);
+        WIPE (&local->postoldparent);
+        WIPE (&local->preparent);
+        WIPE (&local->postparent);
+
+        DHT_STRIP_PHASE1_FLAGS (&local->stbuf);
+        DHT_STACK_UNWIND (rename, frame, local->op_ret, local->op_errno,
+                          &local->stbuf, &local->preoldparent,
+                          &local->postoldparent, &local->preparent,
+                          &local->postparent);
+
+        return 0;
+}
+
+
+/* the renamed file, still on src_cached, under its new name */
+static int
+dht_rename_migrate_task (void *data)
+{
+        call_frame_t *frame = NULL;
+        dht_local_t  *local = NULL;
+        dht_conf_t   *conf = NULL;
+        xlator_t     *this = NULL;
+        struct iatt   stbuf = {0,};
+        loc_t         loc = {0,};
+        int           ret = -1;
+
+        frame = data;
+        local = frame->local;
+        this  = THIS;
+        conf  = this->private;
+
+        ret = loc_copy (&loc, &local->loc2);
+        if (ret)
+                goto out;
+
+        if (loc.inode)
+                inode_unref (loc.inode);
+        loc.inode = inode_ref (local->loc.inode);
+        uuid_copy (loc.gfid, local->loc.inode->gfid);
+
+        ret = syncop_lookup (local->src_cached, &loc, NULL, &stbuf,
+                             NULL, NULL);
+        if (ret)
+                goto out;
+
+        if (!IA_ISREG (stbuf.ia_type)
+            || (stbuf.ia_size > conf->rename_migrate_size)) {
+                ret = 1;
+                goto out;
+        }
+
+        ret = dht_migrate_file (this, &loc, local->src_cached,
+                                local->dst_hashed, 0);
+out:
+        loc_wipe (&loc);
+
+        return ret;
+}
+
+
+static int
+dht_rename_migrate_done (int op_ret, call_frame_t *sync_frame, void *data)
+{
+        dht_local_t  *local = NULL;
+        dht_layout_t *layout = NULL;
+        xlator_t     *this = NULL;
+        uint64_t      layout_int = 0;
+        int           ret = -1;
+
+        this  = THIS;
+        local = sync_frame->local;
+
+        FRAME_SU_UNDO (sync_frame, dht_local_t);
+
+        if (op_ret == 0) {
+                ret = inode_ctx_del (local->loc.inode, this, &layout_int);
+                if (!ret && layout_int) {
+                        layout = (dht_layout_t *)(long)layout_int;
+                        dht_layout_unref (this, layout);
+                }
+
+                ret = dht_layout_preset (this, local->dst_hashed,
+                                         local->loc.inode);
+                if (ret)
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "%s: failed to set inode ctx",
+                                local->loc2.path);
+        } else {
+                dht_rename_linkfile_count (sync_frame, local->dst_hashed);
+        }
+
+        return dht_rename_unwind (sync_frame);
+}
+
+
+/* A file renamed to a name that hashes elsewhere is left with a linkfile
+   there. Small ones are migrated before the rename returns, so that later
+   lookups do not have to follow it. */
+static int
+dht_rename_done (call_frame_t *frame)
+{
+        dht_local_t *local = NULL;
+        dht_conf_t  *conf = NULL;
+        xlator_t    *this = NULL;
+        int          ret = -1;
+
+        local = frame->local;
+        this  = frame->this;
+        conf  = this->private;
+
+        if ((local->op_ret == -1) || (local->src_cached == local->dst_hashed))
+                goto unwind;
+
+        if (conf->rename_migrate_size && conf->env) {
+                FRAME_SU_DO (frame, dht_local_t);
+
+                ret = synctask_new (conf->env, dht_rename_migrate_task,
+                                    dht_rename_migrate_done, frame, frame);
+                if (!ret)
+                        return 0;
+
+                FRAME_SU_UNDO (frame, dht_local_t);
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s: failed to create a new synctask",
+                        local->loc2.path);
+        }
+
+        dht_rename_linkfile_count (frame, local->dst_hashed);
+
+unwind:
+        return dht_rename_unwind (frame);
+}
+
+
 int
 dht_rename_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                        int32_t op_ret, int32_t op_errno, struct iatt *preparent,
@@ -345,13 +607,8 @@ dht_rename_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
         WIPE (&local->preparent);
         WIPE (&local->postparent);
 
-        if (is_last_call (this_call_cnt)) {
-                DHT_STRIP_PHASE1_FLAGS (&local->stbuf);
-                DHT_STACK_UNWIND (rename, frame, local->op_ret, local->op_errno,
-                                  &local->stbuf, &local->preoldparent,
-                                  &local->postoldparent, &local->preparent,
-                                  &local->postparent);
-        }
+        if (is_last_call (this_call_cnt))
+                dht_rename_done (frame);
 
 out:
         return 0;
@@ -572,16 +829,7 @@ err:
         return 0;
 
 unwind:
-        WIPE (&local->preoldparent);
-        WIPE (&local->postoldparent);
-        WIPE (&local->preparent);
-        WIPE (&local->postparent);
-
-        DHT_STRIP_PHASE1_FLAGS (&local->stbuf);
-        DHT_STACK_UNWIND (rename, frame, local->op_ret, local->op_errno,
-                          &local->stbuf, &local->preoldparent,
-                          &local->postoldparent, &local->preparent,
-                          &local->postparent);
+        dht_rename_done (frame);
 
         return 0;
 
@@ -790,6 +1038,8 @@ dht_rename (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (oldloc, err);
         VALIDATE_OR_GOTO (newloc, err);
 
+        dht_nlc_invalidate (this, newloc);
+
         src_hashed = dht_subvol_get_hashed (this, oldloc);
         if (!src_hashed) {
                 gf_log (this->name, GF_LOG_INFO,
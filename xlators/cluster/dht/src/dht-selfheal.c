@@ -26,6 +26,7 @@
 #include "glusterfs.h"
 #include "xlator.h"
 #include "dht-common.h"
+#include "byte-order.h"
 
 
 #define DHT_SET_LAYOUT_RANGE(layout,i,srt,chunk,cnt,path)    do {       \
@@ -136,6 +137,7 @@ dht_selfheal_dir_xattr_persubvol (call_frame_t *frame, loc_t *loc,
         int                ret = 0;
         xlator_t          *this = NULL;
         int32_t           *disk_layout = NULL;
+        uint32_t          *disk_gen = NULL;
 
 
         subvol = layout->list[i].xlator;
@@ -164,6 +166,21 @@ dht_selfheal_dir_xattr_persubvol (call_frame_t *frame, loc_t *loc,
         }
         disk_layout = NULL;
 
+        disk_gen = GF_CALLOC (1, sizeof (*disk_gen), gf_dht_mt_int32_t);
+        if (!disk_gen)
+                goto err;
+
+        *disk_gen = hton32 (layout->disk_gen);
+        ret = dict_set_bin (xattr, DHT_LAYOUT_GEN_KEY, disk_gen,
+                            sizeof (*disk_gen));
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "%s: (subvol %s) failed to set xattr dictionary",
+                        loc->path, subvol->name);
+                goto err;
+        }
+        disk_gen = NULL;
+
         gf_log (this->name, GF_LOG_TRACE,
                 "setting hash range %u - %u (type %d) on subvolume %s for %s",
                 layout->list[i].start, layout->list[i].stop,
@@ -186,6 +203,9 @@ err:
         if (disk_layout)
                 GF_FREE (disk_layout);
 
+        if (disk_gen)
+                GF_FREE (disk_gen);
+
         dht_selfheal_dir_xattr_cbk (frame, subvol, frame->this,
                                     -1, ENOMEM);
         return 0;
@@ -503,6 +523,142 @@ dht_get_layout_count (xlator_t *this, dht_layout_t *layout, int new_layout)
 }
 
 
+/* Gives each subvolume of @layout marked -1 the arc of the hash space
+ * from its point up to the next point. The points are hashed from the
+ * directory gfid and the subvolume name, so they stay put when subvolumes
+ * come or go: adding one only splits the arc its point falls in, removing
+ * one merges its arc into the previous, and about 1/N of the directory
+ * moves. The points differ per directory, which evens out the uneven arcs
+ * over the volume. The first arc also covers the hash space below the
+ * first point, so that every subvolume keeps a single range.
+ */
+static void
+dht_layout_consistent_ranges (call_frame_t *frame, loc_t *loc,
+                              dht_layout_t *layout)
+{
+        xlator_t    *this = NULL;
+        dht_local_t *local = NULL;
+        uint32_t    *points = NULL;
+        int         *order = NULL;
+        uuid_t       gfid = {0, };
+        char         key[512];
+        uint32_t     point = 0;
+        int          idx = 0;
+        int          cnt = 0;
+        int          i = 0;
+        int          j = 0;
+
+        this  = frame->this;
+        local = frame->local;
+
+        if (loc->inode && !uuid_is_null (loc->inode->gfid))
+                uuid_copy (gfid, loc->inode->gfid);
+        else if (!uuid_is_null (loc->gfid))
+                uuid_copy (gfid, loc->gfid);
+        else
+                uuid_copy (gfid, local->gfid);
+
+        points = alloca (layout->cnt * sizeof (*points));
+        order  = alloca (layout->cnt * sizeof (*order));
+
+        for (i = 0; i < layout->cnt; i++) {
+                if ((layout->list[i].err != -1) || !layout->list[i].xlator)
+                        continue;
+
+                if (uuid_is_null (gfid))
+                        snprintf (key, sizeof (key), "%s:%s", loc->path,
+                                  layout->list[i].xlator->name);
+                else
+                        snprintf (key, sizeof (key), "%s:%s",
+                                  uuid_utoa (gfid),
+                                  layout->list[i].xlator->name);
+                dht_hash_compute (layout->type, key, &point);
+
+                for (j = cnt; (j > 0) && (points[j - 1] > point); j--) {
+                        points[j] = points[j - 1];
+                        order[j]  = order[j - 1];
+                }
+                points[j] = point;
+                order[j]  = i;
+                cnt++;
+        }
+
+        /* two subvolumes hashing alike must not share a start */
+        for (j = 1; j < cnt; j++) {
+                if ((points[j] <= points[j - 1])
+                    && (points[j - 1] < 0xffffffff))
+                        points[j] = points[j - 1] + 1;
+        }
+
+        for (j = 0; j < cnt; j++) {
+                idx = order[j];
+                layout->list[idx].start = (j == 0) ? 0 : points[j];
+                layout->list[idx].stop  = (j == cnt - 1) ? 0xffffffff
+                                                         : points[j + 1] - 1;
+
+                gf_log (this->name, GF_LOG_TRACE,
+                        "gave fix: %u - %u on %s for %s",
+                        layout->list[idx].start, layout->list[idx].stop,
+                        layout->list[idx].xlator->name, loc->path);
+        }
+}
+
+
+/* Cuts the hash space into consecutive ranges for the @cnt subvolumes of
+ * @layout listed in @order, each as wide as its share of their total
+ * capacity. Leaves @layout alone and returns -1 if the size of one of them
+ * is not known yet.
+ */
+static int
+dht_layout_weighted_ranges (xlator_t *this, loc_t *loc, dht_layout_t *layout,
+                            int *order, int cnt)
+{
+        uint64_t *weights = NULL;
+        double    total = 0;
+        double    sum = 0;
+        uint32_t  start = 0;
+        uint32_t  stop = 0;
+        int       idx = 0;
+        int       i = 0;
+
+        if (!cnt)
+                return -1;
+
+        weights = alloca (cnt * sizeof (*weights));
+
+        for (i = 0; i < cnt; i++) {
+                weights[i] = dht_get_du_capacity (this,
+                                                  layout->list[order[i]].xlator);
+                if (!weights[i])
+                        return -1;
+                total += weights[i];
+        }
+
+        for (i = 0; i < cnt; i++) {
+                idx  = order[i];
+                sum += weights[i];
+
+                stop = (i == cnt - 1) ? 0xffffffff
+                                      : (uint32_t) (sum / total * 0xffffffff);
+                if (stop < start)
+                        stop = start;
+
+                layout->list[idx].start = start;
+                layout->list[idx].stop  = stop;
+
+                gf_log (this->name, GF_LOG_TRACE,
+                        "gave weighted fix: %u - %u on %s for %s (%.2f%%)",
+                        start, stop, layout->list[idx].xlator->name,
+                        loc->path, weights[i] * 100 / total);
+
+                if (stop != 0xffffffff)
+                        start = stop + 1;
+        }
+
+        return 0;
+}
+
+
 dht_layout_t *
 dht_fix_layout_of_directory (call_frame_t *frame, loc_t *loc,
                              dht_layout_t *layout)
@@ -521,6 +677,7 @@ dht_fix_layout_of_directory (call_frame_t *frame, loc_t *loc,
         int           loop_cnt     = 0;
         int           start_subvol = 0;
         int          *fix_array    = NULL;
+        int          *order        = NULL;
         xlator_t     *this         = NULL;
         dht_layout_t *new_layout   = NULL;
         dht_conf_t   *priv         = NULL;
@@ -532,6 +689,73 @@ dht_fix_layout_of_directory (call_frame_t *frame, loc_t *loc,
 
         count = cnt = dht_get_layout_count (this, layout, 0);
 
+        if ((priv->layout_type == DHT_LAYOUT_CONSISTENT)
+            && !layout->spread_cnt) {
+                new_layout = dht_layout_new (this, priv->subvolume_cnt);
+                if (!new_layout)
+                        goto done;
+
+                for (i = 0; i < new_layout->cnt; i++) {
+                        new_layout->list[i].err = -ENOENT;
+                        if (i < layout->cnt) {
+                                new_layout->list[i].xlator =
+                                        layout->list[i].xlator;
+                                new_layout->list[i].err =
+                                        layout->list[i].err;
+                        }
+                }
+
+                dht_layout_consistent_ranges (frame, loc, new_layout);
+                goto done;
+        }
+
+        if (priv->weighted_layout && !layout->spread_cnt) {
+                /* keep the subvolumes in the order of their current
+                   ranges so that each range only slides, and append
+                   those without one */
+                order = alloca (layout->cnt * sizeof (*order));
+                for (i = 0, cnt = 0; i < layout->cnt; i++) {
+                        if (layout->list[i].err != -1)
+                                continue;
+                        for (j = cnt; j > 0; j--) {
+                                k = order[j - 1];
+                                if ((layout->list[i].stop
+                                     == layout->list[i].start)
+                                    || ((layout->list[k].stop
+                                         != layout->list[k].start)
+                                        && (layout->list[k].start
+                                            <= layout->list[i].start)))
+                                        break;
+                                order[j] = k;
+                        }
+                        order[j] = i;
+                        cnt++;
+                }
+
+                new_layout = dht_layout_new (this, priv->subvolume_cnt);
+                if (!new_layout)
+                        goto done;
+
+                for (i = 0; i < new_layout->cnt; i++) {
+                        new_layout->list[i].err = -ENOENT;
+                        if (i < layout->cnt) {
+                                new_layout->list[i].xlator =
+                                        layout->list[i].xlator;
+                                new_layout->list[i].err =
+                                        layout->list[i].err;
+                        }
+                }
+
+                if (dht_layout_weighted_ranges (this, loc, new_layout, order,
+                                                cnt) == 0)
+                        goto done;
+
+                /* sizes not known yet, fall back to equal ranges */
+                dht_layout_unref (this, new_layout);
+                new_layout = NULL;
+                cnt = count;
+        }
+
         chunk = ((unsigned long) 0xffffffff) / ((cnt) ? cnt : 1);
 
         start_subvol = dht_selfheal_layout_alloc_start (this, loc, layout);
@@ -641,6 +865,8 @@ dht_fix_layout_of_directory (call_frame_t *frame, loc_t *loc,
 
 done:
         if (new_layout) {
+                new_layout->disk_gen = dht_layout_gen_next (layout);
+
                 /* Now that the new layout has all the proper layout, change the
                    inode context */
                 dht_layout_set (this, loc->inode, new_layout);
@@ -660,21 +886,45 @@ dht_selfheal_layout_new_directory (call_frame_t *frame, loc_t *loc,
                                    dht_layout_t *layout)
 {
         xlator_t    *this = NULL;
+        dht_conf_t  *conf = NULL;
         uint32_t     chunk = 0;
         int          i = 0;
         uint32_t     start = 0;
         int          cnt = 0;
         int          err = 0;
         int          start_subvol = 0;
+        int         *order = NULL;
+        int          n = 0;
+        int          j = 0;
 
         this = frame->this;
+        conf = this->private;
 
         cnt = dht_get_layout_count (this, layout, 1);
 
+        if ((conf->layout_type == DHT_LAYOUT_CONSISTENT)
+            && !layout->spread_cnt) {
+                dht_layout_consistent_ranges (frame, loc, layout);
+                goto done;
+        }
+
         chunk = ((unsigned long) 0xffffffff) / ((cnt) ? cnt : 1);
 
         start_subvol = dht_selfheal_layout_alloc_start (this, loc, layout);
 
+        if (conf->weighted_layout && !layout->spread_cnt) {
+                order = alloca (layout->cnt * sizeof (*order));
+                for (i = 0; i < layout->cnt; i++) {
+                        j = (start_subvol + i) % layout->cnt;
+                        if (layout->list[j].err == -1)
+                                order[n++] = j;
+                }
+
+                if (dht_layout_weighted_ranges (this, loc, layout, order,
+                                                n) == 0)
+                        goto done;
+        }
+
         for (i = start_subvol; i < layout->cnt; i++) {
                 err = layout->list[i].err;
                 if (err == -1) {
@@ -702,6 +952,14 @@ dht_selfheal_layout_new_directory (call_frame_t *frame, loc_t *loc,
         }
 
 done:
+        /* subvolumes that kept their range keep their generation too */
+        layout->disk_gen = dht_layout_gen_next (layout);
+        layout->disk_gen_mixed = 0;
+        for (i = 0; i < layout->cnt; i++) {
+                if (layout->list[i].err == 0)
+                        layout->disk_gen_mixed = 1;
+        }
+
         return;
 }
 
@@ -787,6 +1045,10 @@ dht_fix_directory_layout (call_frame_t *frame,
         local->selfheal.dir_cbk = dir_cbk;
         local->selfheal.layout = dht_layout_ref (frame->this, layout);
 
+        /* keep the brick sizes fresh for weighted layouts */
+        if (((dht_conf_t *)frame->this->private)->weighted_layout)
+                dht_get_du_info (frame, frame->this, &local->loc);
+
         /* No layout sorting required here */
         tmp_layout = dht_fix_layout_of_directory (frame, &local->loc, layout);
         dht_fix_dir_xattr (frame, &local->loc, tmp_layout);
@@ -142,6 +142,7 @@ dht_priv_dump (xlator_t *this)
                 gf_proc_dump_write("du_stats.log", "%lu", conf->du_stats->log);
         }
         gf_proc_dump_write("last_stat_fetch", "%s", ctime(&conf->last_stat_fetch.tv_sec));
+        dht_nlc_dump (this);
 
         UNLOCK(&conf->subvolume_lock);
 
@@ -213,6 +214,8 @@ fini (xlator_t *this)
                 if (conf->subvolume_status)
                         GF_FREE (conf->subvolume_status);
 
+                dht_nlc_fini (this, conf);
+
                 GF_FREE (conf);
         }
 out:
@@ -284,6 +287,7 @@ reconfigure (xlator_t *this, dict_t *options)
 {
         dht_conf_t      *conf = NULL;
         char            *temp_str = NULL;
+        char            *layout_type = NULL;
         gf_boolean_t     search_unhashed;
         int              ret = -1;
 
@@ -324,6 +328,30 @@ reconfigure (xlator_t *this, dict_t *options)
         GF_OPTION_RECONF ("directory-layout-spread", conf->dir_spread_cnt,
                           options, uint32, out);
 
+        GF_OPTION_RECONF ("readdir-prefetch", conf->readdir_prefetch,
+                          options, int32, out);
+
+        GF_OPTION_RECONF ("layout-type", layout_type, options, str, out);
+        conf->layout_type = dht_layout_type_get (layout_type);
+
+        GF_OPTION_RECONF ("weighted-layout", conf->weighted_layout, options,
+                          bool, out);
+
+        GF_OPTION_RECONF ("layout-gen-revalidate", conf->layout_gen_revalidate,
+                          options, bool, out);
+
+        GF_OPTION_RECONF ("rebalance-bandwidth", conf->rebalance_bandwidth,
+                          options, size, out);
+
+        GF_OPTION_RECONF ("rename-migrate-size", conf->rename_migrate_size,
+                          options, size, out);
+
+        GF_OPTION_RECONF ("negative-lookup-cache-size", conf->nlc_size,
+                          options, int32, out);
+        GF_OPTION_RECONF ("negative-lookup-cache-timeout", conf->nlc_timeout,
+                          options, int32, out);
+        dht_nlc_resize (this, conf);
+
         if (dict_get_str (options, "decommissioned-bricks", &temp_str) == 0) {
                 ret = dht_parse_decommissioned_bricks (this, conf, temp_str);
                 if (ret == -1)
@@ -341,6 +369,7 @@ init (xlator_t *this)
 {
         dht_conf_t    *conf = NULL;
         char          *temp_str = NULL;
+        char          *layout_type = NULL;
         int            ret = -1;
         int            i = 0;
 
@@ -376,6 +405,28 @@ init (xlator_t *this)
 
         GF_OPTION_INIT ("use-readdirp", conf->use_readdirp, bool, err);
 
+        GF_OPTION_INIT ("readdir-prefetch", conf->readdir_prefetch, int32,
+                        err);
+
+        GF_OPTION_INIT ("layout-type", layout_type, str, err);
+        conf->layout_type = dht_layout_type_get (layout_type);
+
+        GF_OPTION_INIT ("weighted-layout", conf->weighted_layout, bool, err);
+
+        GF_OPTION_INIT ("layout-gen-revalidate", conf->layout_gen_revalidate,
+                        bool, err);
+
+        GF_OPTION_INIT ("rebalance-bandwidth", conf->rebalance_bandwidth,
+                        size, err);
+
+        GF_OPTION_INIT ("rename-migrate-size", conf->rename_migrate_size,
+                        size, err);
+
+        GF_OPTION_INIT ("negative-lookup-cache-size", conf->nlc_size, int32,
+                        err);
+        GF_OPTION_INIT ("negative-lookup-cache-timeout", conf->nlc_timeout,
+                        int32, err);
+
         GF_OPTION_INIT ("min-free-disk", conf->min_free_disk, percent_or_size,
                         err);
 
@@ -405,6 +456,10 @@ init (xlator_t *this)
         LOCK_INIT (&conf->subvolume_lock);
         LOCK_INIT (&conf->layout_lock);
 
+        ret = dht_nlc_init (this, conf);
+        if (ret == -1)
+                goto err;
+
         conf->gen = 1;
 
         /* Create 'syncop' environment */
@@ -438,6 +493,8 @@ err:
                 if (conf->du_stats)
                         GF_FREE (conf->du_stats);
 
+                dht_nlc_fini (this, conf);
+
                 GF_FREE (conf);
         }
 
@@ -484,6 +541,10 @@ struct xlator_fops fops = {
         .fsetxattr   = dht_fsetxattr,
         .truncate    = dht_truncate,
         .ftruncate   = dht_ftruncate,
+        .fallocate   = dht_fallocate,
+        .discard     = dht_discard,
+        .zerofill    = dht_zerofill,
+        .seek        = dht_seek,
         .writev      = dht_writev,
         .xattrop     = dht_xattrop,
         .fxattrop    = dht_fxattrop,
@@ -499,7 +560,7 @@ struct xlator_dumpops dumpops = {
 
 struct xlator_cbks cbks = {
 //      .release    = dht_release,
-//      .releasedir = dht_releasedir,
+        .releasedir = dht_releasedir,
         .forget     = dht_forget
 };
 
@@ -525,6 +586,87 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "on",
         },
+        { .key = {"readdir-prefetch"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 64,
+          .default_value = "8",
+          .description = "Number of readdirp replies of a directory read "
+                         "ahead, from its current subvolume and the next "
+                         "ones in parallel, while the application lists it. "
+                         "0 reads one subvolume at a time."
+        },
+        { .key = {"layout-type"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = {"equal", "consistent"},
+          .default_value = "equal",
+          .description = "How new and fixed directory layouts give out the "
+                         "hash space. \"equal\" gives each subvolume an "
+                         "equal range in turn. \"consistent\" gives each "
+                         "the range from a point hashed from the directory "
+                         "and the subvolume name up to the next point, so "
+                         "that a fix-layout after adding or removing a "
+                         "subvolume moves only about 1/N of the files. Its "
+                         "ranges are uneven per directory and even out over "
+                         "many directories."
+        },
+        { .key = {"weighted-layout"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Give each subvolume a share of the hash space of "
+                         "new and fixed directories in proportion to its "
+                         "size, so that bricks of different sizes fill at "
+                         "the same rate. A fix-layout picks up bricks that "
+                         "grew. Has no effect with layout-type consistent "
+                         "or a directory-layout-spread."
+        },
+        { .key = {"layout-gen-revalidate"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+          .description = "Revalidate a cached directory layout with a "
+                         "lookup on one subvolume instead of all of them. "
+                         "Self-heal and fix-layout write a generation with "
+                         "the layout; while that subvolume still has the "
+                         "cached range and generation the layout is kept, "
+                         "otherwise all subvolumes are asked as usual. The "
+                         "directory attributes then come from that one "
+                         "subvolume."
+        },
+        { .key = {"rebalance-bandwidth"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "Bytes per second that all the file migrations of "
+                         "a rebalance process copy together, at most. 0 "
+                         "does not limit them."
+        },
+        { .key = {"rename-migrate-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+          .description = "A rename whose new name hashes to another "
+                         "subvolume than the one the file is on migrates "
+                         "files up to this size there before it returns, "
+                         "the way rebalance does, instead of leaving a "
+                         "linkfile. Larger files, and those that fail to "
+                         "migrate, get the linkfile and are counted in "
+                         "the trusted.glusterfs.dht.linkfiles xattr of the "
+                         "new parent directory. 0 migrates none."
+        },
+        { .key = {"negative-lookup-cache-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 1048576,
+          .default_value = "0",
+          .description = "Number of names remembered as found on no "
+                         "subvolume, so that lookups of them again do not "
+                         "go to every subvolume. 0 disables the cache."
+        },
+        { .key = {"negative-lookup-cache-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 1,
+          .max = 3600,
+          .default_value = "60",
+          .description = "Seconds a name is remembered as missing at most."
+        },
         { .key = {"assert-no-child-down"},
           .type = GF_OPTION_TYPE_BOOL,
           .default_value = "off",
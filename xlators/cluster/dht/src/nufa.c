@@ -25,8 +25,133 @@
 
 #include "dht-common.h"
 
+#include <netdb.h>
+
 /* TODO: all 'TODO's in dht.c holds good */
 
+/* kept in dht_conf_t->private */
+struct nufa_private {
+        xlator_t     *local_subvol;  /* where new files go, NULL if no
+                                        subvolume is on this host */
+        char         *is_local;      /* per subvolume */
+        gf_boolean_t  prefer_nearest;
+};
+typedef struct nufa_private nufa_private_t;
+
+
+/* an address of @hostname that a socket here can bind to is ours */
+static gf_boolean_t
+nufa_host_is_local (const char *hostname)
+{
+        struct addrinfo *result = NULL;
+        struct addrinfo *res = NULL;
+        gf_boolean_t     local = _gf_false;
+        int              sd = -1;
+
+        if (getaddrinfo (hostname, NULL, NULL, &result) != 0)
+                return _gf_false;
+
+        for (res = result; res && !local; res = res->ai_next) {
+                sd = socket (res->ai_family, SOCK_DGRAM, 0);
+                if (sd == -1)
+                        continue;
+                if (bind (sd, res->ai_addr, res->ai_addrlen) == 0)
+                        local = _gf_true;
+                close (sd);
+        }
+
+        freeaddrinfo (result);
+
+        return local;
+}
+
+
+/* Whether a brick under @subvol is on this host: a protocol/client whose
+   remote-host is one of ours, or any other leaf, which runs in this
+   process. */
+static gf_boolean_t
+nufa_subvol_is_local (xlator_t *subvol)
+{
+        xlator_list_t *trav = NULL;
+        char          *host = NULL;
+
+        if (!subvol->children) {
+                if (strcmp (subvol->type, "protocol/client"))
+                        return _gf_true;
+                if (dict_get_str (subvol->options, "remote-host", &host))
+                        return _gf_false;
+                return nufa_host_is_local (host);
+        }
+
+        for (trav = subvol->children; trav; trav = trav->next) {
+                if (nufa_subvol_is_local (trav->xlator))
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+
+/* Where a new file that hashes to @hashed goes: the local subvolume, or
+   the hashed one when it is local too. Without one, and with
+   prefer-nearest, the subvolume whose statfs calls answer fastest when
+   that is under half the time the hashed one takes; clients about as far
+   from every brick keep to hashing. Full subvolumes are skipped as in
+   dht_create (). */
+static xlator_t *
+nufa_placement_subvol (xlator_t *this, xlator_t *hashed)
+{
+        dht_conf_t     *conf = NULL;
+        nufa_private_t *priv = NULL;
+        xlator_t       *subvol = NULL;
+        uint64_t        hashed_rtt = 0;
+        uint64_t        nearest_rtt = 0;
+        int             i = 0;
+
+        conf = this->private;
+        priv = conf->private;
+
+        if (priv->local_subvol) {
+                subvol = priv->local_subvol;
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        if ((conf->subvolumes[i] == hashed)
+                            && priv->is_local[i])
+                                subvol = hashed;
+                }
+        } else if (priv->prefer_nearest) {
+                LOCK (&conf->subvolume_lock);
+                {
+                        for (i = 0; i < conf->subvolume_cnt; i++) {
+                                if (conf->subvolumes[i] == hashed)
+                                        hashed_rtt = conf->du_stats[i].rtt;
+
+                                if (!conf->subvolume_status[i]
+                                    || !conf->du_stats[i].rtt)
+                                        continue;
+
+                                if (!nearest_rtt
+                                    || (conf->du_stats[i].rtt < nearest_rtt)) {
+                                        nearest_rtt = conf->du_stats[i].rtt;
+                                        subvol = conf->subvolumes[i];
+                                }
+                        }
+                }
+                UNLOCK (&conf->subvolume_lock);
+
+                if (!hashed_rtt || ((nearest_rtt * 2) >= hashed_rtt))
+                        subvol = hashed;
+        }
+
+        if (!subvol)
+                subvol = hashed;
+
+        if (dht_is_subvol_filled (this, subvol))
+                subvol = dht_free_disk_available_subvol (this, subvol);
+
+        return subvol;
+}
+
+
 int
 nufa_local_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                        int op_ret, int op_errno,
@@ -158,6 +283,7 @@ nufa_lookup (call_frame_t *frame, xlator_t *this,
         dht_layout_t *layout = NULL;
         int           i = 0;
         int           call_cnt = 0;
+        nufa_private_t *priv = NULL;
 
 
         VALIDATE_OR_GOTO (frame, err);
@@ -167,6 +293,11 @@ nufa_lookup (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (loc->path, err);
 
         conf = this->private;
+        priv = conf->private;
+
+        /* nothing local to look on first */
+        if (!priv->local_subvol)
+                return dht_lookup (frame, this, loc, xattr_req);
 
         local = dht_local_init (frame, loc, NULL, GF_FOP_LOOKUP);
         if (!local) {
@@ -251,8 +382,8 @@ nufa_lookup (call_frame_t *frame, xlator_t *this,
 
                 /* Send it to only local volume */
                 STACK_WIND (frame, nufa_local_lookup_cbk,
-                            (xlator_t *)conf->private,
-                            ((xlator_t *)conf->private)->fops->lookup,
+                            priv->local_subvol,
+                            priv->local_subvol->fops->lookup,
                             loc, local->xattr_req);
         }
 
@@ -297,7 +428,6 @@ nufa_create (call_frame_t *frame, xlator_t *this,
              fd_t *fd, dict_t *params)
 {
         dht_local_t *local = NULL;
-        dht_conf_t  *conf  = NULL;
         xlator_t    *subvol = NULL;
         xlator_t    *avail_subvol = NULL;
         int          op_errno = -1;
@@ -306,8 +436,6 @@ nufa_create (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (this, err);
         VALIDATE_OR_GOTO (loc, err);
 
-        conf  = this->private;
-
         dht_get_du_info (frame, this, loc);
 
         local = dht_local_init (frame, loc, fd, GF_FOP_CREATE);
@@ -325,12 +453,7 @@ nufa_create (call_frame_t *frame, xlator_t *this,
                 goto err;
         }
 
-        avail_subvol = conf->private;
-        if (dht_is_subvol_filled (this, (xlator_t *)conf->private)) {
-                avail_subvol =
-                        dht_free_disk_available_subvol (this,
-                                                        (xlator_t *)conf->private);
-        }
+        avail_subvol = nufa_placement_subvol (this, subvol);
 
         if (subvol != avail_subvol) {
                 /* create a link file instead of actual file */
@@ -396,7 +519,6 @@ nufa_mknod (call_frame_t *frame, xlator_t *this,
             loc_t *loc, mode_t mode, dev_t rdev, dict_t *params)
 {
         dht_local_t *local = NULL;
-        dht_conf_t  *conf  = NULL;
         xlator_t    *subvol = NULL;
         xlator_t    *avail_subvol = NULL;
         int          op_errno = -1;
@@ -405,8 +527,6 @@ nufa_mknod (call_frame_t *frame, xlator_t *this,
         VALIDATE_OR_GOTO (this, err);
         VALIDATE_OR_GOTO (loc, err);
 
-        conf  = this->private;
-
         dht_get_du_info (frame, this, loc);
 
         local = dht_local_init (frame, loc, NULL, GF_FOP_MKNOD);
@@ -425,12 +545,7 @@ nufa_mknod (call_frame_t *frame, xlator_t *this,
         }
 
         /* Consider the disksize in consideration */
-        avail_subvol = conf->private;
-        if (dht_is_subvol_filled (this, (xlator_t *)conf->private)) {
-                avail_subvol =
-                        dht_free_disk_available_subvol (this,
-                                                        (xlator_t *)conf->private);
-        }
+        avail_subvol = nufa_placement_subvol (this, subvol);
 
         if (avail_subvol != subvol) {
                 /* Create linkfile first */
@@ -476,12 +591,19 @@ notify (xlator_t *this, int event, void *data, ...)
 void
 fini (xlator_t *this)
 {
-        int         i = 0;
-        dht_conf_t *conf = NULL;
+        int             i = 0;
+        dht_conf_t     *conf = NULL;
+        nufa_private_t *priv = NULL;
 
         conf = this->private;
 
         if (conf) {
+                priv = conf->private;
+                if (priv) {
+                        GF_FREE (priv->is_local);
+                        GF_FREE (priv);
+                }
+
                 if (conf->file_layouts) {
                         for (i = 0; i < conf->subvolume_cnt; i++) {
                                 GF_FREE (conf->file_layouts[i]);
@@ -495,12 +617,62 @@ fini (xlator_t *this)
                 if (conf->subvolume_status)
                         GF_FREE (conf->subvolume_status);
 
+                dht_nlc_fini (this, conf);
+
                 GF_FREE (conf);
         }
 
         return;
 }
 
+int
+reconfigure (xlator_t *this, dict_t *options)
+{
+        dht_conf_t      *conf = NULL;
+        nufa_private_t  *priv = NULL;
+        char            *layout_type = NULL;
+        int              ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("nufa", this, out);
+        GF_VALIDATE_OR_GOTO ("nufa", options, out);
+
+        conf = this->private;
+        if (!conf)
+                return 0;
+        priv = conf->private;
+
+        GF_OPTION_RECONF ("prefer-nearest", priv->prefer_nearest, options,
+                          bool, out);
+
+        GF_OPTION_RECONF ("readdir-prefetch", conf->readdir_prefetch,
+                          options, int32, out);
+
+        GF_OPTION_RECONF ("layout-type", layout_type, options, str, out);
+        conf->layout_type = dht_layout_type_get (layout_type);
+
+        GF_OPTION_RECONF ("weighted-layout", conf->weighted_layout, options,
+                          bool, out);
+
+        GF_OPTION_RECONF ("layout-gen-revalidate", conf->layout_gen_revalidate,
+                          options, bool, out);
+
+        GF_OPTION_RECONF ("rebalance-bandwidth", conf->rebalance_bandwidth,
+                          options, size, out);
+
+        GF_OPTION_RECONF ("rename-migrate-size", conf->rename_migrate_size,
+                          options, size, out);
+
+        GF_OPTION_RECONF ("negative-lookup-cache-size", conf->nlc_size,
+                          options, int32, out);
+        GF_OPTION_RECONF ("negative-lookup-cache-timeout", conf->nlc_timeout,
+                          options, int32, out);
+        dht_nlc_resize (this, conf);
+
+        ret = 0;
+out:
+        return ret;
+}
+
 int
 init (xlator_t *this)
 {
@@ -509,10 +681,12 @@ init (xlator_t *this)
         data_t        *data = NULL;
         char          *local_volname = NULL;
         char          *temp_str = NULL;
+        char          *layout_type = NULL;
         int            ret = -1;
         int            i = 0;
         char           my_hostname[256];
         uint32_t       temp_free_disk = 0;
+        nufa_private_t *priv = NULL;
 
         if (!this->children) {
                 gf_log (this->name, GF_LOG_CRITICAL,
@@ -540,6 +714,28 @@ init (xlator_t *this)
                         conf->search_unhashed = GF_DHT_LOOKUP_UNHASHED_AUTO;
         }
 
+        GF_OPTION_INIT ("readdir-prefetch", conf->readdir_prefetch, int32,
+                        err);
+
+        GF_OPTION_INIT ("layout-type", layout_type, str, err);
+        conf->layout_type = dht_layout_type_get (layout_type);
+
+        GF_OPTION_INIT ("weighted-layout", conf->weighted_layout, bool, err);
+
+        GF_OPTION_INIT ("layout-gen-revalidate", conf->layout_gen_revalidate,
+                        bool, err);
+
+        GF_OPTION_INIT ("rebalance-bandwidth", conf->rebalance_bandwidth,
+                        size, err);
+
+        GF_OPTION_INIT ("rename-migrate-size", conf->rename_migrate_size,
+                        size, err);
+
+        GF_OPTION_INIT ("negative-lookup-cache-size", conf->nlc_size, int32,
+                        err);
+        GF_OPTION_INIT ("negative-lookup-cache-timeout", conf->nlc_timeout,
+                        int32, err);
+
         ret = dht_init_subvolumes (this, conf);
         if (ret == -1) {
                 goto err;
@@ -553,8 +749,25 @@ init (xlator_t *this)
         LOCK_INIT (&conf->subvolume_lock);
         LOCK_INIT (&conf->layout_lock);
 
+        ret = dht_nlc_init (this, conf);
+        if (ret == -1)
+                goto err;
+
         conf->gen = 1;
 
+        priv = GF_CALLOC (1, sizeof (*priv), gf_nufa_mt_nufa_private_t);
+        if (!priv)
+                goto err;
+        conf->private = priv;
+
+        priv->is_local = GF_CALLOC (conf->subvolume_cnt, sizeof (char),
+                                    gf_nufa_mt_nufa_private_t);
+        if (!priv->is_local)
+                goto err;
+
+        if (dict_get_str (this->options, "prefer-nearest", &temp_str) == 0)
+                gf_string2boolean (temp_str, &priv->prefer_nearest);
+
         local_volname = "localhost";
         ret = gethostname (my_hostname, 256);
         if (ret < 0) {
@@ -578,7 +791,7 @@ init (xlator_t *this)
                 trav = trav->next;
         }
 
-        if (!trav) {
+        if (!trav && data) {
                 gf_log (this->name, GF_LOG_ERROR,
                         "Could not find subvolume named '%s'. "
                         "Please define volume with the name as the hostname "
@@ -586,8 +799,36 @@ init (xlator_t *this)
                         local_volname);
                 goto err;
         }
-        /* The volume specified exists */
-        conf->private = trav->xlator;
+
+        if (trav) {
+                /* The volume specified exists */
+                priv->local_subvol = trav->xlator;
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        if (conf->subvolumes[i] == trav->xlator)
+                                priv->is_local[i] = 1;
+                }
+        } else {
+                /* not named after this host, look for the bricks that
+                   are on it */
+                for (i = 0; i < conf->subvolume_cnt; i++) {
+                        if (!nufa_subvol_is_local (conf->subvolumes[i]))
+                                continue;
+
+                        priv->is_local[i] = 1;
+                        if (!priv->local_subvol)
+                                priv->local_subvol = conf->subvolumes[i];
+                }
+
+                if (priv->local_subvol)
+                        gf_log (this->name, GF_LOG_INFO,
+                                "subvolume %s is on this host, creating "
+                                "new files there", priv->local_subvol->name);
+                else
+                        gf_log (this->name, GF_LOG_INFO,
+                                "no subvolume is on this host, %s",
+                                priv->prefer_nearest ? "creating new files "
+                                "on the nearest one" : "hashing new files");
+        }
 
         conf->min_free_disk = 10;
         conf->disk_unit = 'p';
@@ -632,6 +873,11 @@ init (xlator_t *this)
 
 err:
         if (conf) {
+                if (priv) {
+                        GF_FREE (priv->is_local);
+                        GF_FREE (priv);
+                }
+
                 if (conf->file_layouts) {
                         for (i = 0; i < conf->subvolume_cnt; i++) {
                                 GF_FREE (conf->file_layouts[i]);
@@ -648,6 +894,8 @@ err:
                 if (conf->du_stats)
                         GF_FREE (conf->du_stats);
 
+                dht_nlc_fini (this, conf);
+
                 GF_FREE (conf);
         }
 
@@ -664,6 +912,10 @@ struct xlator_fops fops = {
         .fstat       = dht_fstat,
         .truncate    = dht_truncate,
         .ftruncate   = dht_ftruncate,
+        .fallocate   = dht_fallocate,
+        .discard     = dht_discard,
+        .zerofill    = dht_zerofill,
+        .seek        = dht_seek,
         .access      = dht_access,
         .readlink    = dht_readlink,
         .setxattr    = dht_setxattr,
@@ -697,6 +949,7 @@ struct xlator_fops fops = {
 
 
 struct xlator_cbks cbks = {
+        .releasedir = dht_releasedir,
         .forget     = dht_forget
 };
 
@@ -710,8 +963,50 @@ struct volume_options options[] = {
         { .key  = {"local-volume-name"},
           .type = GF_OPTION_TYPE_XLATOR
         },
+        { .key  = {"prefer-nearest"},
+          .type = GF_OPTION_TYPE_BOOL
+        },
         { .key  = {"min-free-disk"},
           .type = GF_OPTION_TYPE_PERCENT_OR_SIZET,
         },
+        { .key = {"readdir-prefetch"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 64,
+          .default_value = "8",
+        },
+        { .key = {"layout-type"},
+          .type = GF_OPTION_TYPE_STR,
+          .value = {"equal", "consistent"},
+          .default_value = "equal",
+        },
+        { .key = {"weighted-layout"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+        },
+        { .key = {"layout-gen-revalidate"},
+          .type = GF_OPTION_TYPE_BOOL,
+          .default_value = "off",
+        },
+        { .key = {"rebalance-bandwidth"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+        },
+        { .key = {"rename-migrate-size"},
+          .type = GF_OPTION_TYPE_SIZET,
+          .default_value = "0",
+        },
+        { .key = {"negative-lookup-cache-size"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 0,
+          .max = 1048576,
+          .default_value = "0",
+        },
+        { .key = {"negative-lookup-cache-timeout"},
+          .type = GF_OPTION_TYPE_INT,
+          .min = 1,
+          .max = 3600,
+          .default_value = "60",
+        },
         { .key  = {NULL} },
 };
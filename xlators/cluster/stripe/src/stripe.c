@@ -3884,6 +3884,327 @@ err:
 }
 
 
+int32_t
+stripe_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                      struct iatt *postbuf)
+{
+        int32_t         callcnt = 0;
+        stripe_local_t *local = NULL;
+        call_frame_t   *prev = NULL;
+
+        if (!this || !frame || !frame->local || !cookie) {
+                gf_log ("stripe", GF_LOG_DEBUG, "possible NULL deref");
+                goto out;
+        }
+
+        prev  = cookie;
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                callcnt = --local->call_count;
+
+                if (op_ret == -1) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "%s returned error %s",
+                                prev->this->name, strerror (op_errno));
+                        local->op_errno = op_errno;
+                        local->failed = 1;
+                }
+
+                if (op_ret == 0) {
+                        local->op_ret = 0;
+                        if (local->postbuf_size <= postbuf->ia_size) {
+                                local->pre_buf  = *prebuf;
+                                local->post_buf = *postbuf;
+                        }
+
+                        if (local->prebuf_size < prebuf->ia_size)
+                                local->prebuf_size = prebuf->ia_size;
+
+                        if (local->postbuf_size < postbuf->ia_size)
+                                local->postbuf_size = postbuf->ia_size;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        if (!callcnt) {
+                if (local->failed)
+                        local->op_ret = -1;
+
+                if (local->op_ret != -1) {
+                        local->pre_buf.ia_size  = local->prebuf_size;
+                        local->post_buf.ia_size = local->postbuf_size;
+                }
+
+                /* discard and zerofill share the fallocate callback type */
+                STRIPE_STACK_UNWIND (fallocate, frame, local->op_ret,
+                                     local->op_errno, &local->pre_buf,
+                                     &local->post_buf);
+        }
+out:
+        return 0;
+}
+
+/* Splits [offset, offset + len) at stripe-block boundaries and sends every
+   piece to the child holding it, the same way writev distributes data. */
+static int32_t
+stripe_range_fop (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  glusterfs_fop_t fop, int32_t keep_size, off_t offset,
+                  size_t len)
+{
+        stripe_local_t   *local = NULL;
+        stripe_fd_ctx_t  *fctx = NULL;
+        xlator_t         *subvol = NULL;
+        int32_t           op_errno = 1;
+        int32_t           idx = 0;
+        off_t             start = 0;
+        off_t             end = 0;
+        off_t             fill_size = 0;
+        uint64_t          stripe_size = 0;
+        uint64_t          tmp_fctx = 0;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        fd_ctx_get (fd, this, &tmp_fctx);
+        if (!tmp_fctx) {
+                op_errno = EINVAL;
+                goto err;
+        }
+        fctx = (stripe_fd_ctx_t *)(long)tmp_fctx;
+        stripe_size = fctx->stripe_size;
+        if (!stripe_size || !len) {
+                op_errno = EINVAL;
+                goto err;
+        }
+
+        local = GF_CALLOC (1, sizeof (stripe_local_t),
+                           gf_stripe_mt_stripe_local_t);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+        local->op_ret = -1;
+        local->stripe_size = stripe_size;
+        frame->local = local;
+
+        /* count the pieces first, so no reply can unwind the frame
+           before the last piece is wound */
+        end = offset + len;
+        local->call_count = (roof (end, stripe_size) -
+                             floor (offset, stripe_size)) / stripe_size;
+
+        for (start = offset; start < end; start += fill_size) {
+                idx = (start / stripe_size) % fctx->stripe_count;
+                subvol = fctx->xl_array[idx];
+
+                fill_size = stripe_size - (start % stripe_size);
+                if (fill_size > (end - start))
+                        fill_size = end - start;
+
+                switch (fop) {
+                case GF_FOP_FALLOCATE:
+                        STACK_WIND (frame, stripe_fallocate_cbk, subvol,
+                                    subvol->fops->fallocate, fd, keep_size,
+                                    start, fill_size);
+                        break;
+                case GF_FOP_DISCARD:
+                        STACK_WIND (frame, stripe_fallocate_cbk, subvol,
+                                    subvol->fops->discard, fd, start,
+                                    fill_size);
+                        break;
+                default:
+                        STACK_WIND (frame, stripe_fallocate_cbk, subvol,
+                                    subvol->fops->zerofill, fd, start,
+                                    fill_size);
+                        break;
+                }
+        }
+
+        return 0;
+err:
+        STRIPE_STACK_UNWIND (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+int32_t
+stripe_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t keep_size, off_t offset, size_t len)
+{
+        return stripe_range_fop (frame, this, fd, GF_FOP_FALLOCATE,
+                                 keep_size, offset, len);
+}
+
+int32_t
+stripe_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                off_t offset, size_t len)
+{
+        return stripe_range_fop (frame, this, fd, GF_FOP_DISCARD, 0,
+                                 offset, len);
+}
+
+int32_t
+stripe_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                 off_t offset, size_t len)
+{
+        return stripe_range_fop (frame, this, fd, GF_FOP_ZEROFILL, 0,
+                                 offset, len);
+}
+
+
+int32_t
+stripe_seek_data_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        int32_t         callcnt = 0;
+        stripe_local_t *local = NULL;
+        call_frame_t   *prev = NULL;
+
+        if (!this || !frame || !frame->local || !cookie) {
+                gf_log ("stripe", GF_LOG_DEBUG, "possible NULL deref");
+                goto out;
+        }
+
+        prev  = cookie;
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                callcnt = --local->call_count;
+
+                if ((op_ret == -1) && (op_errno != ENXIO)) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "%s returned error %s",
+                                prev->this->name, strerror (op_errno));
+                        local->op_errno = op_errno;
+                        local->failed = 1;
+                }
+
+                /* every child holds only its own stripe blocks, so the
+                   next data of the file is the closest one among them */
+                if ((op_ret == 0) &&
+                    ((local->op_ret == -1) || (offset < local->stbuf_size))) {
+                        local->op_ret = 0;
+                        local->stbuf_size = offset;
+                }
+        }
+        UNLOCK (&frame->lock);
+
+        if (!callcnt) {
+                if (local->failed)
+                        local->op_ret = -1;
+                else if (local->op_ret == -1)
+                        local->op_errno = ENXIO;
+
+                STRIPE_STACK_UNWIND (seek, frame, local->op_ret,
+                                     local->op_errno, local->stbuf_size);
+        }
+out:
+        return 0;
+}
+
+int32_t
+stripe_seek_hole_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno, struct iatt *buf)
+{
+        int32_t         callcnt = 0;
+        stripe_local_t *local = NULL;
+        call_frame_t   *prev = NULL;
+
+        if (!this || !frame || !frame->local || !cookie) {
+                gf_log ("stripe", GF_LOG_DEBUG, "possible NULL deref");
+                goto out;
+        }
+
+        prev  = cookie;
+        local = frame->local;
+
+        LOCK (&frame->lock);
+        {
+                callcnt = --local->call_count;
+
+                if (op_ret == -1) {
+                        gf_log (this->name, GF_LOG_DEBUG,
+                                "%s returned error %s",
+                                prev->this->name, strerror (op_errno));
+                        local->op_errno = op_errno;
+                        local->failed = 1;
+                }
+
+                if ((op_ret == 0) && (local->stbuf_size < buf->ia_size))
+                        local->stbuf_size = buf->ia_size;
+        }
+        UNLOCK (&frame->lock);
+
+        if (!callcnt) {
+                local->op_ret = 0;
+                if (local->failed) {
+                        local->op_ret = -1;
+                } else if (local->offset >= local->stbuf_size) {
+                        local->op_ret = -1;
+                        local->op_errno = ENXIO;
+                }
+
+                STRIPE_STACK_UNWIND (seek, frame, local->op_ret,
+                                     local->op_errno, local->stbuf_size);
+        }
+out:
+        return 0;
+}
+
+/* A hole in one child's file is usually another child's stripe block, so
+   SEEK_HOLE is answered with the implicit hole at end of file, which
+   lseek(2) permits. SEEK_DATA is exact. */
+int32_t
+stripe_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             gf_seek_what_t what)
+{
+        stripe_local_t   *local = NULL;
+        stripe_private_t *priv = NULL;
+        xlator_list_t    *trav = NULL;
+        int32_t           op_errno = 1;
+
+        VALIDATE_OR_GOTO (frame, err);
+        VALIDATE_OR_GOTO (this, err);
+        VALIDATE_OR_GOTO (fd, err);
+        VALIDATE_OR_GOTO (fd->inode, err);
+
+        priv = this->private;
+        trav = this->children;
+
+        local = GF_CALLOC (1, sizeof (stripe_local_t),
+                           gf_stripe_mt_stripe_local_t);
+        if (!local) {
+                op_errno = ENOMEM;
+                goto err;
+        }
+        local->op_ret = -1;
+        local->offset = offset;
+        frame->local = local;
+        local->call_count = priv->child_count;
+
+        while (trav) {
+                if (what == GF_SEEK_DATA)
+                        STACK_WIND (frame, stripe_seek_data_cbk, trav->xlator,
+                                    trav->xlator->fops->seek, fd, offset,
+                                    what);
+                else
+                        STACK_WIND (frame, stripe_seek_hole_cbk, trav->xlator,
+                                    trav->xlator->fops->fstat, fd);
+                trav = trav->next;
+        }
+
+        return 0;
+err:
+        STRIPE_STACK_UNWIND (seek, frame, -1, op_errno, 0);
+        return 0;
+}
+
+
 int32_t
 stripe_release (xlator_t *this, fd_t *fd)
 {
@@ -4855,6 +5176,10 @@ struct xlator_fops fops = {
         .flush       = stripe_flush,
         .fsync       = stripe_fsync,
         .ftruncate   = stripe_ftruncate,
+        .fallocate   = stripe_fallocate,
+        .discard     = stripe_discard,
+        .zerofill    = stripe_zerofill,
+        .seek        = stripe_seek,
         .fstat       = stripe_fstat,
         .mkdir       = stripe_mkdir,
         .rmdir       = stripe_rmdir,
@@ -0,0 +1,780 @@
+/*
+   Copyright (c) 2012 Gluster, Inc. <http://www.gluster.com>
+   This file is part of GlusterFS.
+
+   GlusterFS is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published
+   by the Free Software Foundation; either version 3 of the License,
+   or (at your option) any later version.
+
+   GlusterFS is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see
+   <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+#include <dirent.h>
+
+#include "index.h"
+#include "defaults.h"
+#include "byte-order.h"
+#include "statedump.h"
+
+#define AFR_XATTR_PREFIX "trusted.afr."
+
+typedef struct {
+        gf_boolean_t     found;
+        gf_boolean_t     dirty;
+} index_changelog_t;
+
+/* returns 0, or -errno on failure */
+static int
+index_mkdir_p (xlator_t *this, const char *path)
+{
+        char            dir[PATH_MAX] = {0,};
+        char           *slash = NULL;
+        int             ret = 0;
+
+        ret = snprintf (dir, sizeof (dir), "%s", path);
+        if ((ret < 0) || (ret >= sizeof (dir))) {
+                gf_log (this->name, GF_LOG_ERROR, "index path %s is too "
+                        "long", path);
+                return -ENAMETOOLONG;
+        }
+
+        slash = dir;
+        while ((slash = strchr (slash + 1, '/'))) {
+                *slash = '\0';
+                ret = mkdir (dir, 0700);
+                *slash = '/';
+                if (ret && (errno != EEXIST))
+                        goto err;
+        }
+
+        ret = mkdir (dir, 0700);
+        if (ret && (errno != EEXIST))
+                goto err;
+
+        return 0;
+err:
+        ret = -errno;
+        gf_log (this->name, GF_LOG_ERROR, "mkdir of %s failed: %s", dir,
+                strerror (errno));
+        return ret;
+}
+
+static void
+index_entry_path (index_priv_t *priv, uuid_t gfid, char *buf, size_t len)
+{
+        char    gfid_str[64] = {0,};
+
+        snprintf (buf, len, "%s/%s", priv->xattrop_path,
+                  uuid_utoa_r (gfid, gfid_str));
+}
+
+/* Replaces the path recorded in an existing entry. The new path goes to
+ * a temporary file which is renamed over the entry, so that the self-heal
+ * daemon never reads a partial path. Its name is not a gfid, so listings
+ * of the index skip it.
+ */
+static int
+index_rewrite (xlator_t *this, const char *entry, const char *path)
+{
+        char             tmp[PATH_MAX] = {0,};
+        int              fd = -1;
+        int              ret = -1;
+
+        ret = snprintf (tmp, sizeof (tmp), "%s.%lx", entry,
+                        (unsigned long) pthread_self ());
+        if ((ret < 0) || (ret >= sizeof (tmp)))
+                return -1;
+
+        fd = open (tmp, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+        if (fd == -1)
+                goto err;
+
+        ret = write (fd, path, strlen (path));
+        close (fd);
+        if (ret == -1)
+                goto err;
+
+        ret = rename (tmp, entry);
+        if (ret == -1)
+                goto err;
+
+        return 0;
+err:
+        gf_log (this->name, GF_LOG_WARNING, "failed to record new path %s "
+                "in the index: %s", path, strerror (errno));
+        unlink (tmp);
+        return -1;
+}
+
+/* Adds the entry of @gfid; when it is there already and @rewrite is set,
+ * the entry gets @path instead of the one it was added with, so that a
+ * rename while the inode is dirty does not leave the self-heal daemon a
+ * path it cannot look up.
+ */
+static int
+index_add (xlator_t *this, uuid_t gfid, const char *path,
+           gf_boolean_t rewrite)
+{
+        index_priv_t    *priv = NULL;
+        char             entry[PATH_MAX] = {0,};
+        int              fd = -1;
+        int              ret = 0;
+
+        priv = this->private;
+        index_entry_path (priv, gfid, entry, sizeof (entry));
+
+        fd = open (entry, O_CREAT | O_EXCL | O_WRONLY, 0600);
+        if (fd == -1) {
+                if (errno == EEXIST) {
+                        if (rewrite && path)
+                                index_rewrite (this, entry, path);
+                        return 0;
+                }
+                gf_log (this->name, GF_LOG_ERROR, "failed to add %s (%s) "
+                        "to the index: %s", uuid_utoa (gfid),
+                        path ? path : "<nul>", strerror (errno));
+                return -1;
+        }
+
+        if (path) {
+                ret = write (fd, path, strlen (path));
+                if (ret == -1)
+                        gf_log (this->name, GF_LOG_WARNING, "failed to "
+                                "record path of %s in the index: %s",
+                                path, strerror (errno));
+        }
+        close (fd);
+
+        LOCK (&priv->lock);
+        {
+                priv->added++;
+        }
+        UNLOCK (&priv->lock);
+
+        return 0;
+}
+
+static int
+index_del (xlator_t *this, uuid_t gfid)
+{
+        index_priv_t    *priv = NULL;
+        char             entry[PATH_MAX] = {0,};
+        int              ret = 0;
+
+        priv = this->private;
+        index_entry_path (priv, gfid, entry, sizeof (entry));
+
+        ret = unlink (entry);
+        if (ret == -1) {
+                if (errno == ENOENT)
+                        return 0;
+                gf_log (this->name, GF_LOG_ERROR, "failed to remove %s "
+                        "from the index: %s", uuid_utoa (gfid),
+                        strerror (errno));
+                return -1;
+        }
+
+        LOCK (&priv->lock);
+        {
+                priv->removed++;
+        }
+        UNLOCK (&priv->lock);
+
+        return 0;
+}
+
+/* For an xattrop request "dirty" means some counter is being
+ * incremented; for a reply it means some counter is still non-zero.
+ */
+static void
+index_check_changelog (dict_t *dict, gf_boolean_t delta,
+                       index_changelog_t *changelog)
+{
+        data_pair_t     *trav   = NULL;
+        int32_t         *counts = NULL;
+        int32_t          count  = 0;
+        int              i      = 0;
+
+        memset (changelog, 0, sizeof (*changelog));
+        if (!dict)
+                return;
+
+        for (trav = dict->members_list; trav; trav = trav->next) {
+                if (strncmp (trav->key, AFR_XATTR_PREFIX,
+                             strlen (AFR_XATTR_PREFIX)))
+                        continue;
+                changelog->found = _gf_true;
+                counts = (int32_t *) trav->value->data;
+                for (i = 0; i < trav->value->len / sizeof (int32_t); i++) {
+                        count = ntoh32 (counts[i]);
+                        if ((delta && (count > 0)) || (!delta && count))
+                                changelog->dirty = _gf_true;
+                }
+        }
+}
+
+static index_inode_ctx_t *
+__index_inode_ctx_get (xlator_t *this, inode_t *inode)
+{
+        index_inode_ctx_t *ctx = NULL;
+        uint64_t           tmp = 0;
+        int                ret = 0;
+
+        ret = __inode_ctx_get (inode, this, &tmp);
+        if (!ret)
+                return (index_inode_ctx_t *)(long) tmp;
+
+        ctx = GF_CALLOC (1, sizeof (*ctx), gf_index_mt_inode_ctx_t);
+        if (!ctx)
+                return NULL;
+
+        ret = __inode_ctx_put (inode, this, (uint64_t)(long) ctx);
+        if (ret) {
+                GF_FREE (ctx);
+                return NULL;
+        }
+
+        return ctx;
+}
+
+static void
+index_local_free (index_local_t *local)
+{
+        if (!local)
+                return;
+        if (local->inode)
+                inode_unref (local->inode);
+        GF_FREE (local);
+}
+
+/* Called before a fop that may clear the changelog is wound.  The
+ * returned local remembers how many increments had completed.
+ */
+static index_local_t *
+index_local_clean_get (xlator_t *this, inode_t *inode, uuid_t gfid)
+{
+        index_local_t     *local = NULL;
+        index_inode_ctx_t *ctx = NULL;
+
+        local = GF_CALLOC (1, sizeof (*local), gf_index_mt_local_t);
+        if (!local)
+                return NULL;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __index_inode_ctx_get (this, inode);
+                if (ctx)
+                        local->gen = ctx->done_gen;
+        }
+        UNLOCK (&inode->lock);
+
+        if (!ctx) {
+                GF_FREE (local);
+                return NULL;
+        }
+
+        local->inode = inode_ref (inode);
+        uuid_copy (local->gfid, gfid);
+
+        return local;
+}
+
+static void
+index_clean (xlator_t *this, index_local_t *local)
+{
+        index_inode_ctx_t *ctx = NULL;
+        inode_t           *inode = local->inode;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __index_inode_ctx_get (this, inode);
+                if (ctx && !ctx->pending && (ctx->done_gen == local->gen))
+                        index_del (this, local->gfid);
+        }
+        UNLOCK (&inode->lock);
+}
+
+static int32_t
+index_xattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, dict_t *xattr)
+{
+        index_local_t     *local = NULL;
+        index_inode_ctx_t *ctx = NULL;
+        index_changelog_t  changelog = {0,};
+
+        local = frame->local;
+        frame->local = NULL;
+        if (!local)
+                goto out;
+
+        if (local->dirty) {
+                LOCK (&local->inode->lock);
+                {
+                        ctx = __index_inode_ctx_get (this, local->inode);
+                        if (ctx) {
+                                ctx->pending--;
+                                ctx->done_gen++;
+                        }
+                }
+                UNLOCK (&local->inode->lock);
+                goto out;
+        }
+
+        if (op_ret)
+                goto out;
+
+        index_check_changelog (xattr, _gf_false, &changelog);
+        if (changelog.found && !changelog.dirty)
+                index_clean (this, local);
+out:
+        index_local_free (local);
+        STACK_UNWIND_STRICT (xattrop, frame, op_ret, op_errno, xattr);
+        return 0;
+}
+
+static int32_t
+index_fxattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, dict_t *xattr)
+{
+        return index_xattrop_cbk (frame, cookie, this, op_ret, op_errno,
+                                  xattr);
+}
+
+static index_local_t *
+index_xattrop_prepare (xlator_t *this, inode_t *inode, const char *path,
+                       dict_t *xattr)
+{
+        index_local_t     *local = NULL;
+        index_inode_ctx_t *ctx = NULL;
+        index_changelog_t  changelog = {0,};
+        char              *inode_path_buf = NULL;
+        gf_boolean_t       rewrite = _gf_false;
+
+        if (!inode || uuid_is_null (inode->gfid))
+                return NULL;
+
+        index_check_changelog (xattr, _gf_true, &changelog);
+        if (!changelog.found)
+                return NULL;
+
+        if (!changelog.dirty)
+                return index_local_clean_get (this, inode, inode->gfid);
+
+        local = GF_CALLOC (1, sizeof (*local), gf_index_mt_local_t);
+        if (!local)
+                return NULL;
+
+        if (!path && (inode_path (inode, NULL, &inode_path_buf) >= 0))
+                path = inode_path_buf;
+
+        LOCK (&inode->lock);
+        {
+                ctx = __index_inode_ctx_get (this, inode);
+                if (ctx) {
+                        ctx->pending++;
+                        /* the inode may have been renamed since its entry
+                           was written */
+                        if (path && (!ctx->path || strcmp (ctx->path, path))) {
+                                if (ctx->path)
+                                        GF_FREE (ctx->path);
+                                ctx->path = gf_strdup (path);
+                                rewrite = _gf_true;
+                        }
+                }
+        }
+        UNLOCK (&inode->lock);
+
+        if (!ctx) {
+                GF_FREE (local);
+                if (inode_path_buf)
+                        GF_FREE (inode_path_buf);
+                return NULL;
+        }
+
+        local->inode = inode_ref (inode);
+        uuid_copy (local->gfid, inode->gfid);
+        local->dirty = _gf_true;
+
+        index_add (this, inode->gfid, path, rewrite);
+
+        if (inode_path_buf)
+                GF_FREE (inode_path_buf);
+
+        return local;
+}
+
+int32_t
+index_xattrop (call_frame_t *frame, xlator_t *this, loc_t *loc,
+               gf_xattrop_flags_t flags, dict_t *dict)
+{
+        if (flags == GF_XATTROP_ADD_ARRAY)
+                frame->local = index_xattrop_prepare (this, loc->inode,
+                                                      loc->path, dict);
+
+        STACK_WIND (frame, index_xattrop_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->xattrop, loc, flags, dict);
+        return 0;
+}
+
+int32_t
+index_fxattrop (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                gf_xattrop_flags_t flags, dict_t *dict)
+{
+        if (flags == GF_XATTROP_ADD_ARRAY)
+                frame->local = index_xattrop_prepare (this, fd->inode,
+                                                      NULL, dict);
+
+        STACK_WIND (frame, index_fxattrop_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->fxattrop, fd, flags, dict);
+        return 0;
+}
+
+/* The self-heal daemon asks for GF_XATTROP_INDEX_CHECK_KEY on the
+ * lookups it sends for index entries.  If the changelog turns out to
+ * be clean the entry is stale (the fop that added it failed, or the
+ * post-op never reached this brick) and is dropped here.
+ */
+static int32_t
+index_lookup_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, inode_t *inode,
+                  struct iatt *buf, dict_t *xattr, struct iatt *postparent)
+{
+        index_local_t     *local = NULL;
+        index_changelog_t  changelog = {0,};
+
+        local = frame->local;
+        frame->local = NULL;
+
+        if (local && (op_ret == 0)) {
+                index_check_changelog (xattr, _gf_false, &changelog);
+                if (changelog.found && !changelog.dirty &&
+                    !uuid_compare (local->gfid, buf->ia_gfid))
+                        index_clean (this, local);
+        }
+
+        index_local_free (local);
+        STACK_UNWIND_STRICT (lookup, frame, op_ret, op_errno, inode, buf,
+                             xattr, postparent);
+        return 0;
+}
+
+int32_t
+index_lookup (call_frame_t *frame, xlator_t *this, loc_t *loc,
+              dict_t *xattr_req)
+{
+        if (xattr_req && loc->inode && !uuid_is_null (loc->inode->gfid) &&
+            dict_get (xattr_req, GF_XATTROP_INDEX_CHECK_KEY))
+                frame->local = index_local_clean_get (this, loc->inode,
+                                                      loc->inode->gfid);
+
+        STACK_WIND (frame, index_lookup_cbk, FIRST_CHILD (this),
+                    FIRST_CHILD (this)->fops->lookup, loc, xattr_req);
+        return 0;
+}
+
+static int
+index_read_entry_path (index_priv_t *priv, const char *name, char **path)
+{
+        char     entry[PATH_MAX] = {0,};
+        char     buf[PATH_MAX] = {0,};
+        int      fd = -1;
+        ssize_t  len = 0;
+
+        snprintf (entry, sizeof (entry), "%s/%s", priv->xattrop_path, name);
+        fd = open (entry, O_RDONLY);
+        if (fd == -1)
+                return -1;
+
+        len = read (fd, buf, sizeof (buf) - 1);
+        close (fd);
+        if (len <= 0)
+                return -1;
+
+        buf[len] = '\0';
+        *path = gf_strdup (buf);
+        if (!*path)
+                return -1;
+
+        return 0;
+}
+
+/* Fills @dict with up to INDEX_DEFAULT_BATCH entries starting at the
+ * directory offset @offset. Entries whose path is unknown are still
+ * listed (with an empty path) so that they show up in heal info.
+ */
+static int
+index_fill_batch (xlator_t *this, off_t offset, dict_t *dict, int *op_errno)
+{
+        index_priv_t    *priv = NULL;
+        DIR             *dir = NULL;
+        struct dirent   *entry = NULL;
+        char             key[64] = {0,};
+        char            *path = NULL;
+        uuid_t           gfid = {0,};
+        int              count = 0;
+        int              eof = 1;
+        int              ret = -1;
+
+        priv = this->private;
+
+        dir = opendir (priv->xattrop_path);
+        if (!dir) {
+                *op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR, "opendir of %s failed: %s",
+                        priv->xattrop_path, strerror (errno));
+                goto out;
+        }
+
+        if (offset)
+                seekdir (dir, offset);
+
+        while (count < INDEX_DEFAULT_BATCH) {
+                errno = 0;
+                entry = readdir (dir);
+                if (!entry)
+                        break;
+
+                if (uuid_parse (entry->d_name, gfid))
+                        continue;
+
+                path = NULL;
+                if (index_read_entry_path (priv, entry->d_name, &path))
+                        path = gf_strdup ("");
+                if (!path) {
+                        *op_errno = ENOMEM;
+                        goto out;
+                }
+
+                snprintf (key, sizeof (key), "%s-%d", GF_INDEX_PATH_KEY,
+                          count);
+                ret = dict_set_dynstr (dict, key, path);
+                if (ret) {
+                        GF_FREE (path);
+                        *op_errno = ENOMEM;
+                        goto out;
+                }
+
+                snprintf (key, sizeof (key), "%s-%d", GF_INDEX_GFID_KEY,
+                          count);
+                ret = dict_set_dynstr (dict, key, gf_strdup (entry->d_name));
+                if (ret) {
+                        *op_errno = ENOMEM;
+                        goto out;
+                }
+                count++;
+        }
+
+        if (count == INDEX_DEFAULT_BATCH)
+                eof = 0;
+
+        ret = dict_set_int32 (dict, GF_INDEX_COUNT_KEY, count);
+        if (!ret)
+                ret = dict_set_int64 (dict, GF_INDEX_OFFSET_KEY,
+                                      telldir (dir));
+        if (!ret)
+                ret = dict_set_int32 (dict, GF_INDEX_EOF_KEY, eof);
+        if (ret)
+                *op_errno = ENOMEM;
+out:
+        if (dir)
+                closedir (dir);
+        return ret;
+}
+
+int32_t
+index_getxattr (call_frame_t *frame, xlator_t *this, loc_t *loc,
+                const char *name)
+{
+        dict_t          *dict = NULL;
+        size_t           len = strlen (GF_XATTROP_INDEX_KEY);
+        int64_t          offset = 0;
+        int32_t          op_ret = -1;
+        int32_t          op_errno = EINVAL;
+
+        if (!name || strncmp (name, GF_XATTROP_INDEX_KEY, len) ||
+            ((name[len] != '\0') && (name[len] != '.'))) {
+                STACK_WIND (frame, default_getxattr_cbk, FIRST_CHILD (this),
+                            FIRST_CHILD (this)->fops->getxattr, loc, name);
+                return 0;
+        }
+
+        if ((name[len] == '.') && gf_string2int64 (name + len + 1, &offset))
+                goto out;
+
+        dict = dict_new ();
+        if (!dict) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        if (index_fill_batch (this, offset, dict, &op_errno))
+                goto out;
+
+        op_ret = 0;
+out:
+        STACK_UNWIND_STRICT (getxattr, frame, op_ret, op_errno, dict);
+        if (dict)
+                dict_unref (dict);
+        return 0;
+}
+
+int32_t
+index_forget (xlator_t *this, inode_t *inode)
+{
+        index_inode_ctx_t *ctx = NULL;
+        uint64_t           tmp = 0;
+
+        inode_ctx_del (inode, this, &tmp);
+        ctx = (index_inode_ctx_t *)(long) tmp;
+        if (ctx) {
+                if (ctx->path)
+                        GF_FREE (ctx->path);
+                GF_FREE (ctx);
+        }
+
+        return 0;
+}
+
+int32_t
+index_priv_dump (xlator_t *this)
+{
+        index_priv_t    *priv = NULL;
+        char             key_prefix[GF_DUMP_MAX_BUF_LEN];
+
+        priv = this->private;
+        if (!priv)
+                return 0;
+
+        snprintf (key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.%s", this->type,
+                  this->name);
+        gf_proc_dump_add_section (key_prefix);
+
+        gf_proc_dump_write ("index_base", "%s", priv->index_basepath);
+        LOCK (&priv->lock);
+        {
+                gf_proc_dump_write ("added", "%"PRIu64, priv->added);
+                gf_proc_dump_write ("removed", "%"PRIu64, priv->removed);
+        }
+        UNLOCK (&priv->lock);
+
+        return 0;
+}
+
+int32_t
+mem_acct_init (xlator_t *this)
+{
+        int     ret = -1;
+
+        ret = xlator_mem_acct_init (this, gf_index_mt_end + 1);
+
+        return ret;
+}
+
+int32_t
+init (xlator_t *this)
+{
+        index_priv_t    *priv = NULL;
+        char            *index_base = NULL;
+        char             path[PATH_MAX] = {0,};
+        int              ret = -1;
+
+        if (!this->children || this->children->next) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "'index' not configured with exactly one child");
+                goto out;
+        }
+
+        if (!this->parents) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "dangling volume. check volfile ");
+        }
+
+        ret = dict_get_str (this->options, "index-base", &index_base);
+        if (ret) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "'index-base' option is not specified");
+                goto out;
+        }
+
+        snprintf (path, sizeof (path), "%s/%s", index_base, XATTROP_SUBDIR);
+        ret = index_mkdir_p (this, path);
+        if (ret)
+                goto out;
+
+        ret = -1;
+        priv = GF_CALLOC (1, sizeof (*priv), gf_index_mt_priv_t);
+        if (!priv)
+                goto out;
+
+        LOCK_INIT (&priv->lock);
+        priv->index_basepath = gf_strdup (index_base);
+        priv->xattrop_path = gf_strdup (path);
+        if (!priv->index_basepath || !priv->xattrop_path)
+                goto out;
+
+        this->private = priv;
+        ret = 0;
+out:
+        if (ret && priv) {
+                if (priv->index_basepath)
+                        GF_FREE (priv->index_basepath);
+                if (priv->xattrop_path)
+                        GF_FREE (priv->xattrop_path);
+                LOCK_DESTROY (&priv->lock);
+                GF_FREE (priv);
+        }
+        return ret;
+}
+
+void
+fini (xlator_t *this)
+{
+        index_priv_t    *priv = NULL;
+
+        priv = this->private;
+        if (!priv)
+                return;
+        this->private = NULL;
+
+        GF_FREE (priv->index_basepath);
+        GF_FREE (priv->xattrop_path);
+        LOCK_DESTROY (&priv->lock);
+        GF_FREE (priv);
+}
+
+struct xlator_fops fops = {
+        .lookup      = index_lookup,
+        .xattrop     = index_xattrop,
+        .fxattrop    = index_fxattrop,
+        .getxattr    = index_getxattr,
+};
+
+struct xlator_dumpops dumpops = {
+        .priv        = index_priv_dump,
+};
+
+struct xlator_cbks cbks = {
+        .forget      = index_forget,
+};
+
+struct volume_options options[] = {
+        { .key  = {"index-base" },
+          .type = GF_OPTION_TYPE_PATH,
+          .description = "path where the index files need to be stored",
+        },
+        { .key  = {NULL} },
+};
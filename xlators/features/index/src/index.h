@@ -0,0 +1,60 @@
+/*
+   Copyright (c) 2012 Gluster, Inc. <http://www.gluster.com>
+   This file is part of GlusterFS.
+
+   GlusterFS is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published
+   by the Free Software Foundation; either version 3 of the License,
+   or (at your option) any later version.
+
+   GlusterFS is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see
+   <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef __INDEX_H__
+#define __INDEX_H__
+
+#include "xlator.h"
+#include "index-mem-types.h"
+
+#define XATTROP_SUBDIR           "xattrop"
+#define INDEX_DEFAULT_BATCH      512
+
+/* Every inode with a non-zero AFR changelog has an entry named after
+ * its gfid in <index-base>/xattrop.  The entry holds the path the
+ * inode was known by when it was added, so that the self-heal daemon
+ * can look it up without crawling the namespace.
+ */
+typedef struct index_priv {
+        char            *index_basepath;
+        char            *xattrop_path;
+        gf_lock_t        lock;
+        uint64_t         added;
+        uint64_t         removed;
+} index_priv_t;
+
+/* Ordering between a changelog increment and the post-op that clears
+ * it: an entry is only removed when no increment was in flight and
+ * none completed since the clearing fop was wound.
+ */
+typedef struct index_inode_ctx {
+        int32_t          pending;
+        uint64_t         done_gen;
+        char            *path;     /* last path written to the entry */
+} index_inode_ctx_t;
+
+typedef struct index_local {
+        inode_t         *inode;
+        uuid_t           gfid;
+        gf_boolean_t     dirty;
+        uint64_t         gen;
+} index_local_t;
+
+#endif /* __INDEX_H__ */
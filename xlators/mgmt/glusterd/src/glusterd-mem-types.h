@@ -71,7 +71,9 @@ typedef enum gf_gld_mem_types_ {
         gf_gld_mt_mount_component               = gf_common_mt_end + 45,
         gf_gld_mt_mount_spec                    = gf_common_mt_end + 46,
         gf_gld_mt_nodesrv_t                     = gf_common_mt_end + 47,
-        gf_gld_mt_end                           = gf_common_mt_end + 48,
+        gf_gld_mt_defrag_file_t                 = gf_common_mt_end + 48,
+        gf_gld_mt_defrag_thread_t               = gf_common_mt_end + 49,
+        gf_gld_mt_end                           = gf_common_mt_end + 50,
 } gf_gld_mem_types_t;
 #endif
 
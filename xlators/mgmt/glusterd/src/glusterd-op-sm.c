@@ -2463,6 +2463,12 @@ glusterd_handle_brick_rsp (glusterd_brickinfo_t *brickinfo,
                                                          op_ctx, op_errstr);
         break;
 
+        case GD_OP_HEAL_VOLUME:
+                /* only the self-heal daemon answers a heal brick-op */
+                if (rsp_dict && op_ctx)
+                        dict_copy (rsp_dict, op_ctx);
+        break;
+
         default:
                 break;
         }
@@ -2743,6 +2749,7 @@ glusterd_bricks_select_heal_volume (dict_t *dict, char **op_errstr)
         int                                     rxlator_count = 0;
         uuid_t                                  candidate = {0};
         glusterd_pending_node_t                 *pending_node = NULL;
+        int32_t                                 heal_op = GF_AFR_OP_HEAL_INDEX;
 
         this = THIS;
         GF_ASSERT (this);
@@ -2767,6 +2774,13 @@ glusterd_bricks_select_heal_volume (dict_t *dict, char **op_errstr)
 
         replica_count = volinfo->replica_count;
 
+        /* The local self-heal daemon is connected to every brick, so it
+         * can report the index of all replica sets, not only of those it
+         * is responsible for healing. */
+        ret = dict_get_int32 (dict, "heal-op", &heal_op);
+        if (ret)
+                heal_op = GF_AFR_OP_HEAL_INDEX;
+
         index = 1;
         list_for_each_entry (brickinfo, &volinfo->bricks, brick_list) {
                 if (uuid_is_null (brickinfo->uuid))
@@ -2776,7 +2790,8 @@ glusterd_bricks_select_heal_volume (dict_t *dict, char **op_errstr)
                         uuid_copy (candidate, brickinfo->uuid);
 
                 if (index % replica_count == 0) {
-                        if (!uuid_compare (priv->uuid, candidate)) {
+                        if ((heal_op == GF_AFR_OP_INDEX_SUMMARY) ||
+                            !uuid_compare (priv->uuid, candidate)) {
                                 _add_rxlator_to_dict (dict, volname,
                                                       (index-1)/replica_count,
                                                       rxlator_count);
@@ -40,12 +40,288 @@
 #include "glusterd-op-sm.h"
 #include "glusterd-utils.h"
 #include "glusterd-store.h"
+#include "glusterd-volgen.h"
 #include "run.h"
 
 #include "syscall.h"
 #include "cli1-xdr.h"
 #include "xdr-generic.h"
 
+#define GF_DEFRAG_SMALL_FILE        (1 * GF_UNIT_MB)
+#define GF_DEFRAG_MEDIUM_FILE       (64 * GF_UNIT_MB)
+#define GF_DEFRAG_QUEUE_PER_THREAD  64
+#define GF_DEFRAG_LAYOUT_FIXED_KEY  "trusted.glusterfs.rebalance.layout-fixed"
+#define GF_DEFRAG_LINKFILES_KEY     "trusted.glusterfs.dht.linkfiles"
+#define GF_DEFRAG_LAYOUT_FAILED     ":failed"
+#define GF_DEFRAG_POLL_INTERVAL     5
+#define GF_DEFRAG_LAYOUT_FIX_WAIT   (24 * 3600)
+
+/* return values - 0: go on, 1: the rebalance failed */
+static int
+gf_glusterd_rebalance_migrate_file (glusterd_volinfo_t *volinfo,
+                                    const char *full_path, uint64_t size)
+{
+        int                     ret                    = -1;
+        glusterd_defrag_info_t *defrag                 = NULL;
+        char                    linkinfo[PATH_MAX]     = {0,};
+        char                   *force_string           = NULL;
+
+        defrag = volinfo->defrag;
+
+        if ((defrag->cmd == GF_DEFRAG_CMD_START_MIGRATE_DATA_FORCE) ||
+            (defrag->cmd == GF_DEFRAG_CMD_START_FORCE)) {
+                force_string = "force";
+        } else {
+                force_string = "not-force";
+        }
+
+        /* if distribute is present, it will honor this key.
+           -1 is returned if distribute is not present or file doesn't
+           have a link-file. If file has link-file, the path of
+           link-file will be the value, and also that guarantees
+           that file has to be mostly migrated */
+        ret = sys_lgetxattr (full_path, GF_XATTR_LINKINFO_KEY,
+                             &linkinfo, PATH_MAX);
+        if (ret <= 0)
+                return 0;
+
+        ret = sys_lsetxattr (full_path, "distribute.migrate-data",
+                             force_string, strlen (force_string), 0);
+
+        /* if errno is not ENOSPC or ENOTCONN, we can still continue
+           with rebalance process */
+        if ((ret == -1) && ((errno != ENOSPC) ||
+                            (errno != ENOTCONN)))
+                return 0;
+
+        if ((ret == -1) && (errno == ENOTCONN)) {
+                /* Most probably mount point went missing (mostly due
+                   to a brick down), say rebalance failure to user,
+                   let him restart it if everything is fine */
+                volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
+                return 1;
+        }
+
+        if ((ret == -1) && (errno == ENOSPC)) {
+                /* rebalance process itself failed, may be
+                   remote brick went down, or write failed due to
+                   disk full etc etc.. */
+                volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
+                return 1;
+        }
+
+        LOCK (&defrag->lock);
+        {
+                defrag->total_files += 1;
+                defrag->total_data += size;
+        }
+        UNLOCK (&defrag->lock);
+
+        return 0;
+}
+
+static int
+gf_defrag_size_class (uint64_t size)
+{
+        if (size < GF_DEFRAG_SMALL_FILE)
+                return 0;
+        if (size < GF_DEFRAG_MEDIUM_FILE)
+                return 1;
+        return 2;
+}
+
+/* hands @full_path to the migration workers, waiting for room in the
+   queue so that the crawl does not run away from them */
+static int
+gf_defrag_queue_file (glusterd_defrag_info_t *defrag, const char *full_path,
+                      uint64_t size)
+{
+        gf_defrag_file_t *file = NULL;
+
+        file = GF_CALLOC (1, sizeof (*file), gf_gld_mt_defrag_file_t);
+        if (!file)
+                return -1;
+
+        file->path = gf_strdup (full_path);
+        if (!file->path) {
+                GF_FREE (file);
+                return -1;
+        }
+        file->size = size;
+
+        pthread_mutex_lock (&defrag->queue_mutex);
+        {
+                while (defrag->queued >= (GF_DEFRAG_QUEUE_PER_THREAD *
+                                          defrag->thread_count))
+                        pthread_cond_wait (&defrag->space_cond,
+                                           &defrag->queue_mutex);
+
+                list_add_tail (&file->list,
+                               &defrag->queue[gf_defrag_size_class (size)]);
+                defrag->queued++;
+                pthread_cond_signal (&defrag->queue_cond);
+        }
+        pthread_mutex_unlock (&defrag->queue_mutex);
+
+        return 0;
+}
+
+/* Migrates the queued files, the small ones first: they are most of the
+   files and the cheapest to move, so the linkfiles left behind by a layout
+   change go away sooner. Once the rebalance is stopped or has failed, the
+   rest of the queue is only drained. */
+static void *
+gf_defrag_worker (void *data)
+{
+        glusterd_volinfo_t     *volinfo = data;
+        glusterd_defrag_info_t *defrag  = NULL;
+        gf_defrag_file_t       *file    = NULL;
+        int                     i       = 0;
+
+        defrag = volinfo->defrag;
+        THIS = volinfo->xl;
+
+        for (;;) {
+                file = NULL;
+
+                pthread_mutex_lock (&defrag->queue_mutex);
+                {
+                        while (!defrag->queued && !defrag->crawl_done)
+                                pthread_cond_wait (&defrag->queue_cond,
+                                                   &defrag->queue_mutex);
+
+                        for (i = 0; i < GF_DEFRAG_SIZE_CLASSES; i++) {
+                                if (list_empty (&defrag->queue[i]))
+                                        continue;
+                                file = list_entry (defrag->queue[i].next,
+                                                   gf_defrag_file_t, list);
+                                list_del_init (&file->list);
+                                defrag->queued--;
+                                pthread_cond_signal (&defrag->space_cond);
+                                break;
+                        }
+                }
+                pthread_mutex_unlock (&defrag->queue_mutex);
+
+                if (!file)
+                        break;
+
+                if (volinfo->defrag_status ==
+                    GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED)
+                        gf_glusterd_rebalance_migrate_file (volinfo,
+                                                            file->path,
+                                                            file->size);
+
+                GF_FREE (file->path);
+                GF_FREE (file);
+        }
+
+        return NULL;
+}
+
+static int
+gf_defrag_workers_start (glusterd_volinfo_t *volinfo)
+{
+        glusterd_defrag_info_t *defrag = NULL;
+        char                   *value  = NULL;
+        int                     count  = 1;
+        int                     ret    = 0;
+        int                     i      = 0;
+
+        defrag = volinfo->defrag;
+
+        ret = glusterd_volinfo_get (volinfo, VKEY_REBAL_THREADS, &value);
+        if (!ret && value && gf_string2int (value, &count)) {
+                gf_log ("rebalance", GF_LOG_WARNING,
+                        "invalid value %s for "VKEY_REBAL_THREADS, value);
+                count = 1;
+        }
+        if (count < 1)
+                count = 1;
+        if (count > GF_DEFRAG_MAX_THREADS)
+                count = GF_DEFRAG_MAX_THREADS;
+
+        /* one thread migrates inline with the crawl */
+        defrag->thread_count = 0;
+        if (count == 1)
+                return 0;
+
+        defrag->threads = GF_CALLOC (count, sizeof (pthread_t),
+                                     gf_gld_mt_defrag_thread_t);
+        if (!defrag->threads)
+                return -1;
+
+        pthread_mutex_init (&defrag->queue_mutex, NULL);
+        pthread_cond_init (&defrag->queue_cond, NULL);
+        pthread_cond_init (&defrag->space_cond, NULL);
+        for (i = 0; i < GF_DEFRAG_SIZE_CLASSES; i++)
+                INIT_LIST_HEAD (&defrag->queue[i]);
+        defrag->queued = 0;
+        defrag->crawl_done = _gf_false;
+
+        for (i = 0; i < count; i++) {
+                ret = pthread_create (&defrag->threads[i], NULL,
+                                      gf_defrag_worker, volinfo);
+                if (ret)
+                        break;
+                defrag->thread_count++;
+        }
+
+        if (!defrag->thread_count) {
+                GF_FREE (defrag->threads);
+                defrag->threads = NULL;
+        }
+
+        gf_log ("rebalance", GF_LOG_INFO, "%s: migrating files with %d "
+                "threads", volinfo->volname, defrag->thread_count);
+
+        return 0;
+}
+
+/* lets the workers finish the queue and waits for them */
+static void
+gf_defrag_workers_stop (glusterd_volinfo_t *volinfo)
+{
+        glusterd_defrag_info_t *defrag = NULL;
+        int                     i      = 0;
+
+        defrag = volinfo->defrag;
+        if (!defrag->thread_count)
+                return;
+
+        pthread_mutex_lock (&defrag->queue_mutex);
+        {
+                defrag->crawl_done = _gf_true;
+                pthread_cond_broadcast (&defrag->queue_cond);
+        }
+        pthread_mutex_unlock (&defrag->queue_mutex);
+
+        for (i = 0; i < defrag->thread_count; i++)
+                pthread_join (defrag->threads[i], NULL);
+
+        GF_FREE (defrag->threads);
+        defrag->threads = NULL;
+        defrag->thread_count = 0;
+
+        pthread_cond_destroy (&defrag->space_cond);
+        pthread_cond_destroy (&defrag->queue_cond);
+        pthread_mutex_destroy (&defrag->queue_mutex);
+}
+
+/* The count distribute keeps of the linkfiles renames left in @dir, which
+   tells where they pile up; the files of @dir are about to be migrated. */
+static void
+gf_defrag_reset_linkfiles (const char *dir)
+{
+        int32_t zero = 0;
+
+        if (sys_lsetxattr (dir, GF_DEFRAG_LINKFILES_KEY, &zero,
+                           sizeof (zero), 0) == -1)
+                gf_log ("rebalance", GF_LOG_DEBUG,
+                        "%s: failed to reset the linkfile count (%s)",
+                        dir, strerror (errno));
+}
+
 /* return values - 0: success, +ve: stopped, -ve: failure */
 int
 gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
@@ -56,8 +332,6 @@ gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
         struct dirent          *entry                  = NULL;
         struct stat             stbuf                  = {0,};
         char                    full_path[PATH_MAX]    = {0,};
-        char                    linkinfo[PATH_MAX]     = {0,};
-        char                    force_string[64]       = {0,};
 
         if (!volinfo->defrag)
                 goto out;
@@ -68,12 +342,7 @@ gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
         if (!fd)
                 goto out;
 
-        if ((defrag->cmd == GF_DEFRAG_CMD_START_MIGRATE_DATA_FORCE) ||
-            (defrag->cmd == GF_DEFRAG_CMD_START_FORCE)) {
-                strcpy (force_string, "force");
-        } else {
-                strcpy (force_string, "not-force");
-        }
+        gf_defrag_reset_linkfiles (dir);
 
         while ((entry = readdir (fd))) {
                 if (!entry)
@@ -107,47 +376,20 @@ gf_glusterd_rebalance_move_data (glusterd_volinfo_t *volinfo, const char *dir)
                 if (stbuf.st_nlink > 1)
                         continue;
 
-                /* if distribute is present, it will honor this key.
-                   -1 is returned if distribute is not present or file doesn't
-                   have a link-file. If file has link-file, the path of
-                   link-file will be the value, and also that guarantees
-                   that file has to be mostly migrated */
-                ret = sys_lgetxattr (full_path, GF_XATTR_LINKINFO_KEY,
-                                     &linkinfo, PATH_MAX);
-                if (ret <= 0)
-                        continue;
-
-                ret = sys_lsetxattr (full_path, "distribute.migrate-data",
-                                     force_string, strlen (force_string), 0);
-
-                /* if errno is not ENOSPC or ENOTCONN, we can still continue
-                   with rebalance process */
-                if ((ret == -1) && ((errno != ENOSPC) ||
-                                    (errno != ENOTCONN)))
+                if (defrag->thread_count) {
+                        ret = gf_defrag_queue_file (defrag, full_path,
+                                                    stbuf.st_size);
+                        if (ret)
+                                gf_log ("rebalance", GF_LOG_WARNING,
+                                        "%s: failed to queue for migration",
+                                        full_path);
                         continue;
-
-                if ((ret == -1) && (errno == ENOTCONN)) {
-                        /* Most probably mount point went missing (mostly due
-                           to a brick down), say rebalance failure to user,
-                           let him restart it if everything is fine */
-                        volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
-                        break;
                 }
 
-                if ((ret == -1) && (errno == ENOSPC)) {
-                        /* rebalance process itself failed, may be
-                           remote brick went down, or write failed due to
-                           disk full etc etc.. */
-                        volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
+                ret = gf_glusterd_rebalance_migrate_file (volinfo, full_path,
+                                                          stbuf.st_size);
+                if (ret)
                         break;
-                }
-
-                LOCK (&defrag->lock);
-                {
-                        defrag->total_files += 1;
-                        defrag->total_data += stbuf.st_size;
-                }
-                UNLOCK (&defrag->lock);
         }
         closedir (fd);
 
@@ -256,6 +498,271 @@ out:
         return ret;
 }
 
+/* Whether the data of the file with @pathinfo is for this node to move.
+   Every replica of a file is on some node's brick: the file goes to the
+   node whose host name sorts first among those of the bricks holding it,
+   so all the nodes come to the same answer. */
+static gf_boolean_t
+gf_defrag_pathinfo_is_local (const char *pathinfo, const char *localhost)
+{
+        const char *entry = NULL;
+        const char *host  = NULL;
+        const char *end   = NULL;
+        const char *first = NULL;
+        size_t      len   = 0;
+        size_t      first_len = 0;
+
+        for (entry = strstr (pathinfo, "<POSIX:"); entry;
+             entry = strstr (end, "<POSIX:")) {
+                host = entry + strlen ("<POSIX:");
+                end = strchr (host, ':');
+                if (!end)
+                        break;
+                len = end - host;
+
+                if (!first || (strncmp (host, first, min (len, first_len)) < 0)
+                    || (!strncmp (host, first, min (len, first_len))
+                        && (len < first_len))) {
+                        first = host;
+                        first_len = len;
+                }
+        }
+
+        if (!first)
+                return _gf_false;
+
+        return ((first_len == strlen (localhost))
+                && !strncmp (first, localhost, first_len));
+}
+
+/* Migrates the files of the directory @relpath of the local brick at
+   @brick_path, which are the ones this node has to move. The crawl goes
+   over the brick itself, the migration through the mount.
+   return values - 0: success, +ve: stopped, -ve: failure */
+static int
+gf_glusterd_rebalance_move_local (glusterd_volinfo_t *volinfo,
+                                  const char *brick_path, const char *relpath,
+                                  const char *localhost)
+{
+        int                     ret                    = 0;
+        DIR                    *fd                     = NULL;
+        glusterd_defrag_info_t *defrag                 = NULL;
+        struct dirent          *entry                  = NULL;
+        struct stat             stbuf                  = {0,};
+        char                    brick_dir[PATH_MAX]    = {0,};
+        char                    entry_path[PATH_MAX]   = {0,};
+        char                    sub_path[PATH_MAX]     = {0,};
+        char                    full_path[PATH_MAX]    = {0,};
+        char                    pathinfo[4096]         = {0,};
+
+        defrag = volinfo->defrag;
+
+        snprintf (brick_dir, PATH_MAX, "%s%s", brick_path, relpath);
+        fd = opendir (brick_dir);
+        if (!fd)
+                return -1;
+
+        snprintf (full_path, PATH_MAX, "%s%s", defrag->mount, relpath);
+        gf_defrag_reset_linkfiles (full_path);
+
+        while ((entry = readdir (fd))) {
+                /* We have to honor 'stop' (or 'pause'|'commit') as early
+                   as possible */
+                if (volinfo->defrag_status !=
+                    GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED) {
+                        ret = 1;
+                        break;
+                }
+
+                if (!strcmp (entry->d_name, ".") ||
+                    !strcmp (entry->d_name, ".."))
+                        continue;
+
+                /* the brick's own housekeeping */
+                if (!relpath[0] && gf_is_brick_private_name (entry->d_name))
+                        continue;
+
+                snprintf (entry_path, PATH_MAX, "%s/%s", brick_dir,
+                          entry->d_name);
+                snprintf (sub_path, PATH_MAX, "%s/%s", relpath,
+                          entry->d_name);
+
+                ret = lstat (entry_path, &stbuf);
+                if (ret == -1)
+                        continue;
+
+                if (S_ISDIR (stbuf.st_mode)) {
+                        ret = gf_glusterd_rebalance_move_local (volinfo,
+                                                                brick_path,
+                                                                sub_path,
+                                                                localhost);
+                        if (ret)
+                                break;
+                        continue;
+                }
+
+                /* a linkfile: the data is on another brick */
+                if (S_ISREG (stbuf.st_mode) && !stbuf.st_size &&
+                    ((stbuf.st_mode & ~S_IFMT) == S_ISVTX))
+                        continue;
+
+                snprintf (full_path, PATH_MAX, "%s%s", defrag->mount,
+                          sub_path);
+
+                ret = lstat (full_path, &stbuf);
+                if (ret == -1)
+                        continue;
+
+                if (S_ISDIR (stbuf.st_mode))
+                        continue;
+
+                ret = sys_lgetxattr (full_path, GF_XATTR_PATHINFO_KEY,
+                                     pathinfo, sizeof (pathinfo) - 1);
+                if (ret <= 0)
+                        continue;
+                pathinfo[ret] = '\0';
+
+                if (!gf_defrag_pathinfo_is_local (pathinfo, localhost))
+                        continue;
+
+                defrag->num_files_lookedup += 1;
+
+                /* TODO: bring in feature to support hardlink rebalance */
+                if (stbuf.st_nlink > 1)
+                        continue;
+
+                if (defrag->thread_count) {
+                        ret = gf_defrag_queue_file (defrag, full_path,
+                                                    stbuf.st_size);
+                        if (ret)
+                                gf_log ("rebalance", GF_LOG_WARNING,
+                                        "%s: failed to queue for migration",
+                                        full_path);
+                        continue;
+                }
+
+                ret = gf_glusterd_rebalance_migrate_file (volinfo, full_path,
+                                                          stbuf.st_size);
+                if (ret)
+                        break;
+        }
+        closedir (fd);
+
+        if (!entry)
+                ret = 0;
+
+        return ret;
+}
+
+/* the data migration of a distributed rebalance: the local bricks only */
+static int
+gf_glusterd_rebalance_move_bricks (glusterd_volinfo_t *volinfo)
+{
+        glusterd_brickinfo_t *brickinfo = NULL;
+        char                  localhost[1024] = {0,};
+        int                   ret       = 0;
+
+        ret = gethostname (localhost, sizeof (localhost));
+        if (ret) {
+                gf_log ("rebalance", GF_LOG_ERROR, "gethostname() failed, "
+                        "reason: %s", strerror (errno));
+                return -1;
+        }
+
+        list_for_each_entry (brickinfo, &volinfo->bricks, brick_list) {
+                if (!glusterd_is_local_brick (brickinfo))
+                        continue;
+
+                gf_log ("rebalance", GF_LOG_INFO, "%s: migrating the files "
+                        "of brick %s", volinfo->volname, brickinfo->path);
+
+                ret = gf_glusterd_rebalance_move_local (volinfo,
+                                                        brickinfo->path, "",
+                                                        localhost);
+                if (ret)
+                        break;
+        }
+
+        return ret;
+}
+
+/* tells the other nodes of a distributed rebalance that the layout will
+   not get fixed */
+static void
+gf_defrag_mark_layout_failed (glusterd_volinfo_t *volinfo)
+{
+        glusterd_defrag_info_t *defrag      = NULL;
+        char                    failed[128] = {0,};
+
+        defrag = volinfo->defrag;
+        snprintf (failed, sizeof (failed), "%s"GF_DEFRAG_LAYOUT_FAILED,
+                  defrag->rebalance_id);
+
+        if (sys_lsetxattr (defrag->mount, GF_DEFRAG_LAYOUT_FIXED_KEY,
+                           failed, strlen (failed), 0))
+                gf_log ("rebalance", GF_LOG_ERROR,
+                        "%s: failed to mark the layout fix failed (%s)",
+                        volinfo->volname, strerror (errno));
+}
+
+/* holds a distributed rebalance back until the source node has fixed the
+   layout; return values - 0: fixed, -ve: the fix failed or the source
+   node went away, +ve: stopped */
+static int
+gf_defrag_wait_layout_fix (glusterd_volinfo_t *volinfo)
+{
+        glusterd_defrag_info_t *defrag     = NULL;
+        char                    value[128]  = {0,};
+        char                    failed[128] = {0,};
+        int                     waited      = 0;
+        int                     ret         = 0;
+
+        defrag = volinfo->defrag;
+        snprintf (failed, sizeof (failed), "%s"GF_DEFRAG_LAYOUT_FAILED,
+                  defrag->rebalance_id);
+
+        while (volinfo->defrag_status == GF_DEFRAG_STATUS_LAYOUT_FIX_STARTED) {
+                ret = sys_lgetxattr (defrag->mount, GF_DEFRAG_LAYOUT_FIXED_KEY,
+                                     value, sizeof (value) - 1);
+                if (ret > 0) {
+                        value[ret] = '\0';
+                        if (!strcmp (value, defrag->rebalance_id))
+                                return 0;
+                        if (!strcmp (value, failed)) {
+                                gf_log ("rebalance", GF_LOG_ERROR,
+                                        "%s: the layout fix failed on the "
+                                        "source node", volinfo->volname);
+                                return -1;
+                        }
+                }
+
+                if (waited >= GF_DEFRAG_LAYOUT_FIX_WAIT) {
+                        gf_log ("rebalance", GF_LOG_ERROR,
+                                "%s: no layout fix from the source node in "
+                                "%d secs", volinfo->volname, waited);
+                        return -1;
+                }
+
+                sleep (GF_DEFRAG_POLL_INTERVAL);
+                waited += GF_DEFRAG_POLL_INTERVAL;
+        }
+
+        return 1;
+}
+
+/* seconds the rebalance has been running for */
+static uint64_t
+gf_defrag_run_time (glusterd_defrag_info_t *defrag)
+{
+        struct timeval now = {0,};
+
+        gettimeofday (&now, NULL);
+        if (now.tv_sec < defrag->start_time.tv_sec)
+                return 0;
+
+        return now.tv_sec - defrag->start_time.tv_sec;
+}
+
 void *
 glusterd_defrag_start (void *data)
 {
@@ -269,6 +776,9 @@ glusterd_defrag_start (void *data)
         if (!defrag)
                 goto out;
 
+        gettimeofday (&defrag->start_time, NULL);
+        volinfo->rebalance_time = 0;
+
         sleep (1);
         ret = lstat (defrag->mount, &stbuf);
         if ((ret == -1) && (errno == ENOTCONN)) {
@@ -284,6 +794,19 @@ glusterd_defrag_start (void *data)
                 }
         }
 
+        if (defrag->distributed && !defrag->source) {
+                /* only 'start' has the source fix the layout first */
+                if (defrag->cmd == GF_DEFRAG_CMD_START) {
+                        ret = gf_defrag_wait_layout_fix (volinfo);
+                        if (ret < 0)
+                                volinfo->defrag_status =
+                                        GF_DEFRAG_STATUS_FAILED;
+                        if (ret)
+                                goto out;
+                }
+                goto migrate;
+        }
+
         /* Fix the root ('/') first */
         sys_lsetxattr (defrag->mount, "trusted.distribute.fix.layout",
                        "yes", 3, 0);
@@ -299,13 +822,26 @@ glusterd_defrag_start (void *data)
                         volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
                 /* in both 'stopped' or 'failure' cases goto out */
                 if (ret) {
+                        /* the other nodes stop waiting for the layout */
+                        if ((ret < 0) && defrag->distributed)
+                                gf_defrag_mark_layout_failed (volinfo);
                         goto out;
                 }
 
                 /* Completed first step */
                 volinfo->defrag_status = GF_DEFRAG_STATUS_LAYOUT_FIX_COMPLETE;
+
+                /* let the other nodes go on with their data */
+                if (defrag->distributed &&
+                    sys_lsetxattr (defrag->mount, GF_DEFRAG_LAYOUT_FIXED_KEY,
+                                   defrag->rebalance_id,
+                                   strlen (defrag->rebalance_id), 0))
+                        gf_log ("rebalance", GF_LOG_ERROR,
+                                "%s: failed to mark the layout fixed (%s)",
+                                volinfo->volname, strerror (errno));
         }
 
+migrate:
         if (defrag->cmd != GF_DEFRAG_CMD_START_LAYOUT_FIX) {
                 /* It was used by number of layout fixes on directories */
                 defrag->total_files = 0;
@@ -313,7 +849,19 @@ glusterd_defrag_start (void *data)
                 volinfo->defrag_status = GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED;
 
                 /* Step 2: Iterate over directories to move data */
-                ret = gf_glusterd_rebalance_move_data (volinfo, defrag->mount);
+                ret = gf_defrag_workers_start (volinfo);
+                if (!ret && defrag->distributed) {
+                        ret = gf_glusterd_rebalance_move_bricks (volinfo);
+                        gf_defrag_workers_stop (volinfo);
+                } else if (!ret) {
+                        ret = gf_glusterd_rebalance_move_data (volinfo,
+                                                               defrag->mount);
+                        gf_defrag_workers_stop (volinfo);
+                }
+                /* a worker may have failed while the queue drained */
+                if (!ret &&
+                    (volinfo->defrag_status == GF_DEFRAG_STATUS_FAILED))
+                        ret = -1;
                 if (ret < 0)
                         volinfo->defrag_status = GF_DEFRAG_STATUS_FAILED;
                 /* in both 'stopped' or 'failure' cases goto out */
@@ -336,6 +884,9 @@ glusterd_defrag_start (void *data)
 out:
         volinfo->defrag = NULL;
         if (defrag) {
+                volinfo->rebalance_time = gf_defrag_run_time (defrag);
+                strcpy (volinfo->rebalance_id, defrag->rebalance_id);
+
                 gf_log ("rebalance", GF_LOG_INFO, "rebalance on %s complete",
                         defrag->mount);
 
@@ -418,6 +969,8 @@ glusterd_defrag_status_get_v2 (glusterd_volinfo_t *volinfo,
         uint64_t files  = 0;
         uint64_t size   = 0;
         uint64_t lookup = 0;
+        uint64_t run_time = 0;
+        char    *rebalance_id = NULL;
 
         if (!volinfo || !dict)
                 goto out;
@@ -434,10 +987,23 @@ glusterd_defrag_status_get_v2 (glusterd_volinfo_t *volinfo,
                         lookup = volinfo->defrag->num_files_lookedup;
                 }
                 UNLOCK (&volinfo->defrag->lock);
+                run_time = gf_defrag_run_time (volinfo->defrag);
+                rebalance_id = volinfo->defrag->rebalance_id;
         } else {
                 files  = volinfo->rebalance_files;
                 size   = volinfo->rebalance_data;
                 lookup = volinfo->lookedup_files;
+                run_time = volinfo->rebalance_time;
+                rebalance_id = volinfo->rebalance_id;
+        }
+
+        /* the nodes of one distributed rebalance add up their figures */
+        if (rebalance_id[0]) {
+                ret = dict_set_dynstr (dict, "rebalance-id",
+                                       gf_strdup (rebalance_id));
+                if (ret)
+                        gf_log (THIS->name, GF_LOG_WARNING,
+                                "failed to set rebalance id");
         }
 
         ret = dict_set_uint64 (dict, "files", files);
@@ -455,6 +1021,11 @@ glusterd_defrag_status_get_v2 (glusterd_volinfo_t *volinfo,
                 gf_log (THIS->name, GF_LOG_WARNING,
                         "failed to set lookedup file count");
 
+        ret = dict_set_uint64 (dict, "run-time", run_time);
+        if (ret)
+                gf_log (THIS->name, GF_LOG_WARNING,
+                        "failed to set run time");
+
         ret = dict_set_int32 (dict, "status", volinfo->defrag_status);
         if (ret)
                 gf_log (THIS->name, GF_LOG_WARNING,
@@ -564,6 +1135,20 @@ out:
 int
 glusterd_handle_defrag_start (glusterd_volinfo_t *volinfo, char *op_errstr,
                               size_t len, int cmd, defrag_cbk_fn_t cbk)
+{
+        return glusterd_handle_defrag_start_v2 (volinfo, op_errstr, len, cmd,
+                                                cbk, NULL, _gf_true);
+}
+
+/* @rebalance_id is set for a distributed rebalance, which runs on every
+   node with a brick of the volume; @source tells the node the command was
+   given to */
+int
+glusterd_handle_defrag_start_v2 (glusterd_volinfo_t *volinfo,
+                                 char *op_errstr, size_t len, int cmd,
+                                 defrag_cbk_fn_t cbk,
+                                 const char *rebalance_id,
+                                 gf_boolean_t source)
 {
         int                    ret = -1;
         glusterd_defrag_info_t *defrag =  NULL;
@@ -587,6 +1172,12 @@ glusterd_handle_defrag_start (glusterd_volinfo_t *volinfo, char *op_errstr,
         defrag = volinfo->defrag;
 
         defrag->cmd = cmd;
+        defrag->source = source;
+        defrag->distributed = (rebalance_id != NULL);
+        defrag->rebalance_id[0] = '\0';
+        if (rebalance_id)
+                strncpy (defrag->rebalance_id, rebalance_id,
+                         sizeof (defrag->rebalance_id) - 1);
 
         LOCK_INIT (&defrag->lock);
         snprintf (defrag->mount, 1024, "%s/mount/%s",
@@ -758,6 +1349,7 @@ glusterd_handle_defrag_volume_v2 (rpcsvc_request_t *req)
         glusterd_conf_t        *priv    = NULL;
         dict_t                 *dict    = NULL;
         char                   *volname = NULL;
+        uuid_t                  rebalance_id;
 
         GF_ASSERT (req);
 
@@ -793,6 +1385,13 @@ glusterd_handle_defrag_volume_v2 (rpcsvc_request_t *req)
         if (ret)
                 goto out;
 
+        /* names this run for the nodes of a distributed rebalance */
+        uuid_generate (rebalance_id);
+        ret = dict_set_dynstr (dict, "rebalance-id",
+                               gf_strdup (uuid_utoa (rebalance_id)));
+        if (ret)
+                goto out;
+
         ret = glusterd_op_begin (req, GD_OP_REBALANCE, dict);
 
 out:
@@ -878,6 +1477,8 @@ glusterd_op_rebalance (dict_t *dict, char **op_errstr, dict_t *rsp_dict)
         void               *node_uuid = NULL;
         glusterd_conf_t    *priv      = NULL;
         dict_t             *tmp_dict  = NULL;
+        char               *rebalance_id = NULL;
+        gf_boolean_t        source    = _gf_true;
 
         priv = THIS->private;
 
@@ -908,9 +1509,26 @@ glusterd_op_rebalance (dict_t *dict, char **op_errstr, dict_t *rsp_dict)
                         goto out;
                 }
 
+                source = !uuid_compare (node_uuid, priv->uuid);
+
+                /* a distributed rebalance also runs on the nodes with
+                   bricks of the volume, to move the data of those */
+                if ((cmd != GF_DEFRAG_CMD_START_LAYOUT_FIX) &&
+                    (glusterd_volinfo_get_boolean (volinfo,
+                                                   VKEY_REBAL_DISTRIBUTED) > 0)
+                    && (source || glusterd_volinfo_has_local_brick (volinfo))) {
+                        ret = dict_get_str (dict, "rebalance-id",
+                                            &rebalance_id);
+                        if (ret) {
+                                /* the source node is of an older version */
+                                rebalance_id = NULL;
+                                ret = 0;
+                        }
+                }
+
                 /* perform this on only the node which has
                    issued the command */
-                if (uuid_compare (node_uuid, priv->uuid)) {
+                if (!source && !rebalance_id) {
                         gf_log (THIS->name, GF_LOG_DEBUG,
                                 "not the source node %s", uuid_utoa (priv->uuid));
                         goto out;
@@ -922,8 +1540,9 @@ glusterd_op_rebalance (dict_t *dict, char **op_errstr, dict_t *rsp_dict)
         case GF_DEFRAG_CMD_START_LAYOUT_FIX:
         case GF_DEFRAG_CMD_START_MIGRATE_DATA:
         case GF_DEFRAG_CMD_START_MIGRATE_DATA_FORCE:
-                ret = glusterd_handle_defrag_start (volinfo, msg, sizeof (msg),
-                                                    cmd, NULL);
+                ret = glusterd_handle_defrag_start_v2 (volinfo, msg,
+                                                       sizeof (msg), cmd, NULL,
+                                                       rebalance_id, source);
                  break;
          case GF_DEFRAG_CMD_STOP:
                  ret = glusterd_defrag_stop (volinfo, &files, &size,
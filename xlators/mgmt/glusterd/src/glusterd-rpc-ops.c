@@ -414,6 +414,8 @@ glusterd_op_send_cli_response (glusterd_op_t op, int32_t op_ret,
         {
                 gf2_cli_defrag_vol_rsp rsp = {0,};
                 int32_t                status = 0;
+                uint64_t               run_time = 0;
+                char                   rate[256] = {0,};
 
                 ctx = op_ctx;
                 rsp.op_ret = op_ret;
@@ -440,6 +442,11 @@ glusterd_op_send_cli_response (glusterd_op_t op, int32_t op_ret,
                                 gf_log (THIS->name, GF_LOG_DEBUG,
                                         "failed to get lookuped file count");
                         }
+                        ret = dict_get_uint64 (ctx, "run-time", &run_time);
+                        if (ret) {
+                                gf_log (THIS->name, GF_LOG_DEBUG,
+                                        "failed to get the run time");
+                        }
 
                         ret = dict_get_int32 (ctx, "status", &status);
                         if (ret) {
@@ -451,6 +458,18 @@ glusterd_op_send_cli_response (glusterd_op_t op, int32_t op_ret,
                 if (status)
                         rsp.op_errno = status;
 
+                /* the response has no field for the run time; older clis
+                   do not print op_errstr of a 'rebalance status' that
+                   succeeded */
+                if (!op_ret && rsp.files && run_time &&
+                    !strcmp (rsp.op_errstr, "")) {
+                        snprintf (rate, sizeof (rate), "run time %"PRIu64
+                                  " secs, %"PRIu64" files/sec, %"PRIu64
+                                  " bytes/sec", run_time,
+                                  rsp.files / run_time, rsp.size / run_time);
+                        rsp.op_errstr = rate;
+                }
+
                 cli_rsp = &rsp;
                 xdrproc = (xdrproc_t)xdr_gf2_cli_defrag_vol_rsp;
                 break;
@@ -465,6 +484,12 @@ glusterd_op_send_cli_response (glusterd_op_t op, int32_t op_ret,
                         rsp.op_errstr = op_errstr;
                 else
                         rsp.op_errstr = "";
+                ctx = op_ctx;
+                if (ctx)
+                        dict_allocate_and_serialize (ctx,
+                                     &rsp.dict.dict_val,
+                                (size_t*)&rsp.dict.dict_len);
+                free_ptr = rsp.dict.dict_val;
                 cli_rsp = &rsp;
                 xdrproc = (xdrproc_t) xdr_gf1_cli_heal_vol_rsp;
                 break;
@@ -1358,6 +1383,46 @@ out:
         return ret;
 }
 
+/* adds @key of @rsp_dict to that of @ctx_dict if @sum, else replaces it */
+static void
+glusterd_rebalance_merge_uint64 (dict_t *ctx_dict, dict_t *rsp_dict,
+                                 char *key, gf_boolean_t sum)
+{
+        int      ret   = 0;
+        uint64_t value = 0;
+        uint64_t total = 0;
+
+        ret = dict_get_uint64 (rsp_dict, key, &value);
+        if (ret)
+                return;
+
+        if (sum && !dict_get_uint64 (ctx_dict, key, &total))
+                value += total;
+
+        ret = dict_set_uint64 (ctx_dict, key, value);
+        if (ret)
+                gf_log (THIS->name, GF_LOG_DEBUG, "failed to set %s", key);
+}
+
+/* which status of the nodes of one run the run reports: a failure on
+   any node fails the run, then the run is in progress while any node is
+   at it, and it is stopped if any node was stopped */
+static int
+glusterd_rebalance_status_rank (int32_t status)
+{
+        switch (status) {
+        case GF_DEFRAG_STATUS_FAILED:
+                return 3;
+        case GF_DEFRAG_STATUS_LAYOUT_FIX_STARTED:
+        case GF_DEFRAG_STATUS_MIGRATE_DATA_STARTED:
+                return 2;
+        case GF_DEFRAG_STATUS_STOPPED:
+                return 1;
+        default:
+                return 0;
+        }
+}
+
 int
 glusterd_volume_rebalance_use_rsp_dict (dict_t *rsp_dict)
 {
@@ -1365,7 +1430,12 @@ glusterd_volume_rebalance_use_rsp_dict (dict_t *rsp_dict)
         dict_t        *ctx_dict = NULL;
         glusterd_op_t  op       = GD_OP_NONE;
         uint64_t       value    = 0;
+        uint64_t       run_time = 0;
         int32_t        value32  = 0;
+        int32_t        status   = 0;
+        char          *rsp_id   = NULL;
+        char          *ctx_id   = NULL;
+        gf_boolean_t   same_run = _gf_false;
 
         GF_ASSERT (rsp_dict);
 
@@ -1377,42 +1447,57 @@ glusterd_volume_rebalance_use_rsp_dict (dict_t *rsp_dict)
         if (!ctx_dict)
                 goto out;
 
-        ret = dict_get_uint64 (rsp_dict, "files", &value);
+        /* the nodes of a distributed rebalance each report their own
+           share, which add up */
+        if (!dict_get_str (rsp_dict, "rebalance-id", &rsp_id) &&
+            !dict_get_str (ctx_dict, "rebalance-id", &ctx_id) &&
+            !strcmp (rsp_id, ctx_id))
+                same_run = _gf_true;
+
+        glusterd_rebalance_merge_uint64 (ctx_dict, rsp_dict, "files",
+                                         same_run);
+        glusterd_rebalance_merge_uint64 (ctx_dict, rsp_dict, "size",
+                                         same_run);
+        glusterd_rebalance_merge_uint64 (ctx_dict, rsp_dict, "lookups",
+                                         same_run);
+
+        ret = dict_get_uint64 (rsp_dict, "run-time", &value);
         if (!ret) {
-                ret = dict_set_uint64 (ctx_dict, "files", value);
-                if (ret) {
-                        gf_log (THIS->name, GF_LOG_DEBUG,
-                                "failed to set the file count");
+                if (!same_run ||
+                    dict_get_uint64 (ctx_dict, "run-time", &run_time) ||
+                    (value > run_time)) {
+                        ret = dict_set_uint64 (ctx_dict, "run-time", value);
+                        if (ret) {
+                                gf_log (THIS->name, GF_LOG_DEBUG,
+                                        "failed to set the run time");
+                        }
                 }
         }
 
-        ret = dict_get_uint64 (rsp_dict, "size", &value);
+        ret = dict_get_int32 (rsp_dict, "status", &value32);
         if (!ret) {
-                ret = dict_set_uint64 (ctx_dict, "size", value);
-                if (ret) {
-                        gf_log (THIS->name, GF_LOG_DEBUG,
-                                "failed to set the size of migration");
-                }
-        }
+                if (same_run && !dict_get_int32 (ctx_dict, "status", &status)
+                    && (glusterd_rebalance_status_rank (status) >=
+                        glusterd_rebalance_status_rank (value32)))
+                        value32 = status;
 
-        ret = dict_get_uint64 (rsp_dict, "lookups", &value);
-        if (!ret) {
-                ret = dict_set_uint64 (ctx_dict, "lookups", value);
+                ret = dict_set_int32 (ctx_dict, "status", value32);
                 if (ret) {
                         gf_log (THIS->name, GF_LOG_DEBUG,
-                                "failed to set lookuped file count");
+                                "failed to set status");
                 }
         }
 
-        ret = dict_get_int32 (rsp_dict, "status", &value32);
-        if (!ret) {
-                ret = dict_set_int32 (ctx_dict, "status", value32);
+        if (rsp_id && !same_run) {
+                ret = dict_set_dynstr (ctx_dict, "rebalance-id",
+                                       gf_strdup (rsp_id));
                 if (ret) {
                         gf_log (THIS->name, GF_LOG_DEBUG,
-                                "failed to set status");
+                                "failed to set rebalance id");
                 }
         }
 
+        ret = 0;
 out:
         return ret;
 }
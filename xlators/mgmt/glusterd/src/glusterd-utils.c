@@ -664,6 +664,33 @@ glusterd_resolve_brick (glusterd_brickinfo_t *brickinfo)
         return ret;
 }
 
+gf_boolean_t
+glusterd_is_local_brick (glusterd_brickinfo_t *brickinfo)
+{
+        glusterd_conf_t *priv = NULL;
+
+        priv = THIS->private;
+
+        if (uuid_is_null (brickinfo->uuid) &&
+            glusterd_resolve_brick (brickinfo))
+                return _gf_false;
+
+        return !uuid_compare (brickinfo->uuid, priv->uuid);
+}
+
+gf_boolean_t
+glusterd_volinfo_has_local_brick (glusterd_volinfo_t *volinfo)
+{
+        glusterd_brickinfo_t *brickinfo = NULL;
+
+        list_for_each_entry (brickinfo, &volinfo->bricks, brick_list) {
+                if (glusterd_is_local_brick (brickinfo))
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
 int32_t
 glusterd_brickinfo_from_brick (char *brick,
                                glusterd_brickinfo_t **brickinfo)
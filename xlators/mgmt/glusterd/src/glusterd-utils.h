@@ -140,6 +140,12 @@ glusterd_volume_brickinfo_get_by_brick (char *brick,
 int32_t
 glusterd_is_local_addr (char *hostname);
 
+gf_boolean_t
+glusterd_is_local_brick (glusterd_brickinfo_t *brickinfo);
+
+gf_boolean_t
+glusterd_volinfo_has_local_brick (glusterd_volinfo_t *volinfo);
+
 int32_t
 glusterd_build_volume_dict (dict_t **vols);
 
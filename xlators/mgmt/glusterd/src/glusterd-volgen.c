@@ -109,19 +109,53 @@ static struct volopt_map_entry glusterd_volopt_map[] = {
 
         {"cluster.lookup-unhashed",              "cluster/distribute", NULL, NULL, NO_DOC, 0    },
         {"cluster.min-free-disk",                "cluster/distribute", NULL, NULL, NO_DOC, 0    },
+        {"cluster.readdir-prefetch",             "cluster/distribute", NULL, NULL, DOC, 0       },
+        {"cluster.negative-lookup-cache-size",   "cluster/distribute", NULL, NULL, DOC, 0       },
+        {"cluster.negative-lookup-cache-timeout", "cluster/distribute", NULL, NULL, DOC, 0      },
+        {"cluster.layout-type",                  "cluster/distribute", NULL, NULL, DOC, 0       },
+        {"cluster.weighted-layout",              "cluster/distribute", NULL, NULL, DOC, 0       },
+        {"cluster.layout-gen-revalidate",        "cluster/distribute", NULL, NULL, DOC, 0       },
+        {"cluster.rename-migrate-size",          "cluster/distribute", NULL, NULL, DOC, 0       },
+        {"cluster.rebalance-bandwidth",          "cluster/distribute", NULL, NULL, DOC, 0       },
+        {VKEY_REBAL_THREADS,                     "cluster/distribute", "!rebalance-threads", "1", DOC, 0},
+        {VKEY_REBAL_DISTRIBUTED,                 "cluster/distribute", "!rebalance-distributed", "off", DOC, 0},
+        {VKEY_CLUSTER_NUFA,                      "cluster/distribute", "!nufa", "off", DOC, 0},
+        {"cluster.lookup-unhashed",              "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.min-free-disk",                "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.nufa-prefer-nearest",          "cluster/nufa", "prefer-nearest", NULL, DOC, 0 },
+        {"cluster.readdir-prefetch",             "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.negative-lookup-cache-size",   "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.negative-lookup-cache-timeout", "cluster/nufa", NULL, NULL, NO_DOC, 0         },
+        {"cluster.layout-type",                  "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.weighted-layout",              "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.layout-gen-revalidate",        "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.rename-migrate-size",          "cluster/nufa", NULL, NULL, NO_DOC, 0          },
+        {"cluster.rebalance-bandwidth",          "cluster/nufa", NULL, NULL, NO_DOC, 0          },
 
         {"cluster.entry-change-log",             "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.read-subvolume",               "cluster/replicate",  NULL, NULL, NO_DOC, 0    },
+        {"cluster.read-policy",                  "cluster/replicate",  NULL, NULL, DOC, 0       },
+        {"cluster.read-stripe-size",             "cluster/replicate",  NULL, NULL, DOC, 0       },
+        {"cluster.quorum-type",                  "cluster/replicate",  NULL, NULL, DOC, 0       },
+        {"cluster.quorum-count",                 "cluster/replicate",  NULL, NULL, DOC, 0       },
         {"cluster.background-self-heal-count",   "cluster/replicate",  NULL, NULL, NO_DOC, 0    },
         {"cluster.metadata-self-heal",           "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.data-self-heal",               "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.entry-self-heal",              "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.self-heal-daemon",             "cluster/replicate",  "!self-heal-daemon" , NULL, NO_DOC, 0     },
         {"cluster.strict-readdir",               "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
+        {"cluster.lookup-cached-changelog",      "cluster/replicate",  NULL, NULL, DOC, 0     },
         {"cluster.self-heal-window-size",        "cluster/replicate",         "data-self-heal-window-size", NULL, DOC, 0},
         {"cluster.data-change-log",              "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.metadata-change-log",          "cluster/replicate",  NULL, NULL, NO_DOC, 0     },
         {"cluster.data-self-heal-algorithm",     "cluster/replicate",         "data-self-heal-algorithm", NULL,DOC, 0},
+        {"cluster.eager-lock",                   "cluster/replicate",  NULL, NULL, DOC, 0     },
+        {"cluster.post-op-delay-secs",           "cluster/replicate",  NULL, NULL, DOC, 0     },
+        {"cluster.shd-max-heals",                "cluster/replicate",  NULL, NULL, DOC, 0     },
+        {"cluster.self-heal-bandwidth",          "cluster/replicate",  NULL, NULL, DOC, 0     },
+        {"cluster.replace-brick-copy-window",    "cluster/pump",       "copy-window", NULL, DOC, 0},
+        {"cluster.replace-brick-block-window",   "cluster/pump",       "data-self-heal-window-size", NULL, DOC, 0},
+        {"cluster.replace-brick-bandwidth",      "cluster/pump",       "self-heal-bandwidth", NULL, DOC, 0},
 
         {"cluster.stripe-block-size",            "cluster/stripe",            "block-size", NULL, DOC, 0},
 
@@ -1432,6 +1466,7 @@ server_graph_builder (volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
         char     *ptranst               = NULL;
         char      volume_id[64]         = {0,};
         char      tstamp_file[PATH_MAX] = {0,};
+        char      index_basepath[PATH_MAX] = {0,};
         int       ret                   = 0;
         char     *xlator                = NULL;
         char     *loglevel              = NULL;
@@ -1473,6 +1508,16 @@ server_graph_builder (volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
         if (!xl)
                 return -1;
 
+        xl = volgen_graph_add (graph, "features/index", volname);
+        if (!xl)
+                return -1;
+
+        snprintf (index_basepath, sizeof (index_basepath), "%s/%s",
+                  path, ".glusterfs/indices");
+        ret = xlator_set_option (xl, "index-base", index_basepath);
+        if (ret)
+                return -1;
+
         xl = volgen_graph_add (graph, "performance/io-threads", volname);
         if (!xl)
                 return -1;
@@ -2068,10 +2113,18 @@ volgen_graph_build_dht_cluster (volgen_graph_t *graph,
         int                     ret                      = -1;
         char                    *decommissioned_children = NULL;
         xlator_t                *dht                     = NULL;
+        char                    *dht_type                = NULL;
 
         GF_ASSERT (child_count > 1);
+
+        /* nufa creates files on the bricks of the client's own host */
+        ret = glusterd_volinfo_get_boolean (volinfo, VKEY_CLUSTER_NUFA);
+        if (ret == -1)
+                goto out;
+        dht_type = ret ? "cluster/nufa" : "cluster/distribute";
+
         clusters = volgen_graph_build_clusters (graph,  volinfo,
-                                                "cluster/distribute", "%s-dht",
+                                                dht_type, "%s-dht",
                                                 child_count, child_count);
         if (clusters < 0)
                 goto out;
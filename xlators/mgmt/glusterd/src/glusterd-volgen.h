@@ -35,6 +35,9 @@
 #define VKEY_MARKER_XTIME         GEOREP".indexing"
 #define VKEY_FEATURES_QUOTA       "features.quota"
 #define VKEY_PERF_STAT_PREFETCH   "performance.stat-prefetch"
+#define VKEY_REBAL_THREADS        "cluster.rebalance-threads"
+#define VKEY_REBAL_DISTRIBUTED    "cluster.rebalance-distributed"
+#define VKEY_CLUSTER_NUFA         "cluster.nufa"
 
 #define COMPLETE_OPTION(key, completion, ret)                           \
         do {                                                            \
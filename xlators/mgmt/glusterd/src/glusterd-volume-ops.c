@@ -396,18 +396,30 @@ int
 glusterd_handle_cli_heal_volume (rpcsvc_request_t *req)
 {
         int32_t                         ret = -1;
-        gf1_cli_heal_vol_req           cli_req = {0,};
+        gf2_cli_heal_vol_req           cli_req = {0,};
+        gf1_cli_heal_vol_req           cli_req_v1 = {0,};
         char                            *dup_volname = NULL;
         dict_t                          *dict = NULL;
         glusterd_op_t                   cli_op = GD_OP_HEAL_VOLUME;
 
         GF_ASSERT (req);
 
-        if (!xdr_to_generic (req->msg[0], &cli_req,
-                             (xdrproc_t)xdr_gf1_cli_heal_vol_req)) {
-                //failed to decode msg;
-                req->rpc_err = GARBAGE_ARGS;
-                goto out;
+        /* older clis send no dict, and so ask for an index heal */
+        if (xdr_to_generic (req->msg[0], &cli_req,
+                            (xdrproc_t)xdr_gf2_cli_heal_vol_req) < 0) {
+                if (cli_req.volname)
+                        free (cli_req.volname);
+                if (cli_req.dict.dict_val)
+                        free (cli_req.dict.dict_val);
+                memset (&cli_req, 0, sizeof (cli_req));
+
+                if (xdr_to_generic (req->msg[0], &cli_req_v1,
+                                    (xdrproc_t)xdr_gf1_cli_heal_vol_req) < 0) {
+                        //failed to decode msg;
+                        req->rpc_err = GARBAGE_ARGS;
+                        goto out;
+                }
+                cli_req.volname = cli_req_v1.volname;
         }
 
         gf_log ("glusterd", GF_LOG_INFO, "Received heal vol req"
@@ -418,6 +430,18 @@ glusterd_handle_cli_heal_volume (rpcsvc_request_t *req)
         if (!dict)
                 goto out;
 
+        if (cli_req.dict.dict_len) {
+                ret = dict_unserialize (cli_req.dict.dict_val,
+                                        cli_req.dict.dict_len, &dict);
+                if (ret < 0) {
+                        gf_log ("glusterd", GF_LOG_ERROR, "failed to "
+                                "unserialize req-buffer to dictionary");
+                        goto out;
+                }
+                dict->extra_stdfree = cli_req.dict.dict_val;
+                cli_req.dict.dict_val = NULL;
+        }
+
         dup_volname = gf_strdup (cli_req.volname);
         if (!dup_volname)
                 goto out;
@@ -426,6 +450,12 @@ glusterd_handle_cli_heal_volume (rpcsvc_request_t *req)
         if (ret)
                 goto out;
 
+        if (!dict_get (dict, "heal-op")) {
+                ret = dict_set_int32 (dict, "heal-op", GF_AFR_OP_HEAL_INDEX);
+                if (ret)
+                        goto out;
+        }
+
         ret = glusterd_op_begin (req, GD_OP_HEAL_VOLUME, dict);
 
         gf_cmd_log ("volume heal","on volname: %s %s", cli_req.volname,
@@ -436,6 +466,8 @@ out:
                 dict_unref (dict);
         if (cli_req.volname)
                 free (cli_req.volname); //its malloced by xdr
+        if (cli_req.dict.dict_val)
+                free (cli_req.dict.dict_val);
 
         glusterd_friend_sm ();
         glusterd_op_sm ();
@@ -153,6 +153,17 @@ struct gf_defrag_brickinfo_ {
         int   size;
 };
 
+/* files waiting for a rebalance worker, smallest size class first */
+#define GF_DEFRAG_SIZE_CLASSES     3
+#define GF_DEFRAG_MAX_THREADS      64
+
+struct gf_defrag_file_ {
+        struct list_head  list;
+        char             *path;
+        uint64_t          size;
+};
+typedef struct gf_defrag_file_ gf_defrag_file_t;
+
 struct glusterd_volinfo_;
 typedef struct glusterd_volinfo_ glusterd_volinfo_t;
 
@@ -171,6 +182,26 @@ struct glusterd_defrag_info_ {
         struct gf_defrag_brickinfo_ *bricks; /* volinfo->brick_count */
 
         defrag_cbk_fn_t              cbk_fn;
+
+        struct timeval               start_time;
+
+        /* files queued by the crawl for the migration workers */
+        int                          thread_count;
+        pthread_t                   *threads;
+        pthread_mutex_t              queue_mutex;
+        pthread_cond_t               queue_cond;   /* a file queued, or
+                                                      the crawl is over */
+        pthread_cond_t               space_cond;   /* a file dequeued */
+        struct list_head             queue[GF_DEFRAG_SIZE_CLASSES];
+        int                          queued;
+        gf_boolean_t                 crawl_done;
+
+        /* with cluster.rebalance-distributed, every node with a brick of
+           the volume migrates the files of its bricks, after the node the
+           command came to (the source) has fixed the layout */
+        gf_boolean_t                 distributed;
+        gf_boolean_t                 source;
+        char                         rebalance_id[64];
 };
 
 
@@ -211,6 +242,8 @@ struct glusterd_volinfo_ {
         uint64_t                rebalance_files;
         uint64_t                rebalance_data;
         uint64_t                lookedup_files;
+        uint64_t                rebalance_time;   /* seconds */
+        char                    rebalance_id[64];
         glusterd_defrag_info_t  *defrag;
 
         /* Replace brick status */
@@ -545,6 +578,11 @@ int32_t glusterd_op_begin (rpcsvc_request_t *req, glusterd_op_t op, void *ctx);
 
 int glusterd_handle_cli_statedump_volume (rpcsvc_request_t *req);
 
+int glusterd_handle_defrag_start_v2 (glusterd_volinfo_t *volinfo,
+                                     char *op_errstr, size_t len, int cmd,
+                                     defrag_cbk_fn_t cbk,
+                                     const char *rebalance_id,
+                                     gf_boolean_t source);
 int glusterd_handle_defrag_start (glusterd_volinfo_t *volinfo, char *op_errstr,
                                   size_t len, int cmd, defrag_cbk_fn_t cbk);
 int glusterd_handle_cli_heal_volume (rpcsvc_request_t *req);
@@ -868,6 +868,17 @@ fuse_fsync_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+#ifndef GF_DARWIN_HOST_OS
+static int
+fuse_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                    struct iatt *postbuf)
+{
+        return fuse_err_cbk (frame, cookie, this, op_ret, op_errno);
+}
+#endif
+
+
 static int
 fuse_setxattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                    int32_t op_ret, int32_t op_errno)
@@ -1996,6 +2007,65 @@ fuse_fsync (xlator_t *this, fuse_in_header_t *finh, void *msg)
         return;
 }
 
+#ifndef GF_DARWIN_HOST_OS
+void
+fuse_fallocate_resume (fuse_state_t *state)
+{
+        /* PUNCH_HOLE is only valid together with KEEP_SIZE and
+         * ZERO_RANGE only without it, which fuse_fallocate () has
+         * already checked.
+         */
+        if (state->flags & FALLOC_FL_PUNCH_HOLE)
+                FUSE_FOP (state, fuse_fallocate_cbk, GF_FOP_DISCARD,
+                          discard, state->fd, state->off, state->size);
+        else if (state->flags & FALLOC_FL_ZERO_RANGE)
+                FUSE_FOP (state, fuse_fallocate_cbk, GF_FOP_ZEROFILL,
+                          zerofill, state->fd, state->off, state->size);
+        else
+                FUSE_FOP (state, fuse_fallocate_cbk, GF_FOP_FALLOCATE,
+                          fallocate, state->fd,
+                          (state->flags & FALLOC_FL_KEEP_SIZE),
+                          state->off, state->size);
+}
+
+static void
+fuse_fallocate (xlator_t *this, fuse_in_header_t *finh, void *msg)
+{
+        struct fuse_fallocate_in *ffi = msg;
+
+        fuse_state_t *state = NULL;
+        fd_t         *fd = NULL;
+
+        GET_STATE (this, finh, state);
+        fd = FH_TO_FD (ffi->fh);
+        state->fd = fd;
+
+        gf_log ("glusterfs-fuse", GF_LOG_TRACE,
+                "%"PRIu64": FALLOCATE %p (mode=%"PRIu32", %"PRIu64"+%"PRIu64")",
+                finh->unique, fd, ffi->mode, ffi->offset, ffi->length);
+
+        if ((ffi->mode & ~(FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE |
+                           FALLOC_FL_ZERO_RANGE)) ||
+            ((ffi->mode & FALLOC_FL_PUNCH_HOLE) &&
+             (!(ffi->mode & FALLOC_FL_KEEP_SIZE) ||
+              (ffi->mode & FALLOC_FL_ZERO_RANGE))) ||
+            /* zerofill may extend the file, it has no KEEP_SIZE */
+            ((ffi->mode & FALLOC_FL_ZERO_RANGE) &&
+             (ffi->mode & FALLOC_FL_KEEP_SIZE))) {
+                send_fuse_err (this, finh, EOPNOTSUPP);
+                free_fuse_state (state);
+                return;
+        }
+
+        state->flags = ffi->mode;
+        state->off   = ffi->offset;
+        state->size  = ffi->length;
+
+        fuse_resolve_and_resume (state, fuse_fallocate_resume);
+        return;
+}
+#endif /* !GF_DARWIN_HOST_OS */
+
 void
 fuse_opendir_resume (fuse_state_t *state)
 {
@@ -3495,6 +3565,9 @@ static fuse_handler_t *fuse_std_ops[FUSE_OP_HIGH] = {
         [FUSE_GETLK]       = fuse_getlk,
         [FUSE_SETLK]       = fuse_setlk,
         [FUSE_SETLKW]      = fuse_setlk,
+#ifndef GF_DARWIN_HOST_OS
+        [FUSE_FALLOCATE]   = fuse_fallocate,
+#endif
 };
 
 
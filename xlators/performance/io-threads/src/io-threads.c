@@ -216,6 +216,7 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_STATFS:
         case GF_FOP_READDIR:
         case GF_FOP_READDIRP:
+        case GF_FOP_SEEK:
                 pri = IOT_PRI_HI;
                 break;
 
@@ -248,6 +249,9 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
         case GF_FOP_FSYNC:
         case GF_FOP_TRUNCATE:
         case GF_FOP_FTRUNCATE:
+        case GF_FOP_FALLOCATE:
+        case GF_FOP_DISCARD:
+        case GF_FOP_ZEROFILL:
         case GF_FOP_FSYNCDIR:
         case GF_FOP_XATTROP:
         case GF_FOP_FXATTROP:
@@ -255,6 +259,7 @@ iot_schedule (call_frame_t *frame, xlator_t *this, call_stub_t *stub)
                 break;
 
         case GF_FOP_RCHECKSUM:
+        case GF_FOP_RCHECKSUMV:
                 pri = IOT_PRI_LEAST;
                 break;
 
@@ -1351,6 +1356,212 @@ out:
 }
 
 
+int
+iot_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *preop,
+               struct iatt *postop)
+{
+	STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, preop,
+                             postop);
+	return 0;
+}
+
+
+int
+iot_fallocate_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       int32_t keep_size, off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_fallocate_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->fallocate,
+		    fd, keep_size, offset, len);
+	return 0;
+}
+
+
+int
+iot_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+               int32_t keep_size, off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_fallocate_stub (frame, iot_fallocate_wrapper, fd, keep_size, offset, len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_fallocate call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (fallocate, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+             int32_t op_ret, int32_t op_errno, struct iatt *preop,
+             struct iatt *postop)
+{
+	STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, preop,
+                             postop);
+	return 0;
+}
+
+
+int
+iot_discard_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_discard_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->discard,
+		    fd, offset, len);
+	return 0;
+}
+
+
+int
+iot_discard (call_frame_t *frame, xlator_t *this, fd_t *fd,
+             off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_discard_stub (frame, iot_discard_wrapper, fd, offset, len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_discard call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (discard, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *preop,
+              struct iatt *postop)
+{
+	STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, preop,
+                             postop);
+	return 0;
+}
+
+
+int
+iot_zerofill_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      off_t offset, size_t len)
+{
+	STACK_WIND (frame, iot_zerofill_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->zerofill,
+		    fd, offset, len);
+	return 0;
+}
+
+
+int
+iot_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd,
+              off_t offset, size_t len)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_zerofill_stub (frame, iot_zerofill_wrapper, fd, offset, len);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_zerofill call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (zerofill, frame, -1, -ret, NULL, NULL);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
+int
+iot_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, off_t offset)
+{
+	STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset);
+	return 0;
+}
+
+
+int
+iot_seek_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  off_t offset, gf_seek_what_t what)
+{
+	STACK_WIND (frame, iot_seek_cbk,
+		    FIRST_CHILD(this),
+		    FIRST_CHILD(this)->fops->seek,
+		    fd, offset, what);
+	return 0;
+}
+
+
+int
+iot_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+          gf_seek_what_t what)
+{
+	call_stub_t *stub = NULL;
+        int         ret = -1;
+
+	stub = fop_seek_stub (frame, iot_seek_wrapper, fd, offset, what);
+	if (!stub) {
+		gf_log (this->name, GF_LOG_ERROR,
+                        "cannot create fop_seek call stub"
+                        "(out of memory)");
+                ret = -ENOMEM;
+                goto out;
+	}
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+		STACK_UNWIND_STRICT (seek, frame, -1, -ret, 0);
+
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+	return 0;
+}
+
+
 
 int
 iot_unlink_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
@@ -2261,6 +2472,59 @@ out:
 }
 
 
+int32_t
+iot_rchecksumv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno, int32_t algo,
+                    int32_t count, uint8_t *strong_checksums)
+{
+        STACK_UNWIND_STRICT (rchecksumv, frame, op_ret, op_errno, algo,
+                             count, strong_checksums);
+        return 0;
+}
+
+
+int32_t
+iot_rchecksumv_wrapper (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        off_t offset, int32_t block_size, int32_t count,
+                        int32_t algo)
+{
+        STACK_WIND (frame, iot_rchecksumv_cbk, FIRST_CHILD(this),
+                    FIRST_CHILD(this)->fops->rchecksumv, fd, offset,
+                    block_size, count, algo);
+        return 0;
+}
+
+
+int32_t
+iot_rchecksumv (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                int32_t block_size, int32_t count, int32_t algo)
+{
+        call_stub_t     *stub = NULL;
+        int             ret = -1;
+
+        stub = fop_rchecksumv_stub (frame, iot_rchecksumv_wrapper, fd, offset,
+                                    block_size, count, algo);
+        if (!stub) {
+                gf_log (this->name, GF_LOG_ERROR, "cannot create rchecksumv "
+                        "stub (out of memory)");
+                ret = -ENOMEM;
+                goto out;
+        }
+
+        ret = iot_schedule (frame, this, stub);
+out:
+        if (ret < 0) {
+                STACK_UNWIND_STRICT (rchecksumv, frame, -1, -ret, algo, 0,
+                                     NULL);
+                if (stub != NULL) {
+                        call_stub_destroy (stub);
+                }
+        }
+
+        return 0;
+}
+
+
 int
 __iot_workers_scale (iot_conf_t *conf)
 {
@@ -2492,6 +2756,10 @@ struct xlator_fops fops = {
 	.fstat       = iot_fstat,
 	.truncate    = iot_truncate,
 	.ftruncate   = iot_ftruncate,
+	.fallocate   = iot_fallocate,
+	.discard     = iot_discard,
+	.zerofill    = iot_zerofill,
+	.seek        = iot_seek,
 	.unlink      = iot_unlink,
         .lookup      = iot_lookup,
         .setattr     = iot_setattr,
@@ -2521,6 +2789,7 @@ struct xlator_fops fops = {
         .xattrop     = iot_xattrop,
 	.fxattrop    = iot_fxattrop,
         .rchecksum   = iot_rchecksum,
+        .rchecksumv  = iot_rchecksumv,
 };
 
 struct xlator_cbks cbks = {
@@ -1769,6 +1769,178 @@ out:
 	return 0;
 }
 
+int32_t
+client_fallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t keep_size, off_t offset, size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.flags  = keep_size;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_FALLOCATE];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_FALLOCATE]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (fallocate, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+int32_t
+client_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_DISCARD];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_DISCARD]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (discard, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+int32_t
+client_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                 size_t len)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.size   = len;
+
+        proc = &conf->fops->proctable[GF_FOP_ZEROFILL];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_ZEROFILL]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (zerofill, frame, -1, ENOTCONN, NULL, NULL);
+
+	return 0;
+}
+
+
+int32_t
+client_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             gf_seek_what_t what)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.flags  = what;
+
+        proc = &conf->fops->proctable[GF_FOP_SEEK];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_SEEK]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (seek, frame, -1, ENOTCONN, 0);
+
+        return 0;
+}
+
+
+int32_t
+client_rchecksumv (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   off_t offset, int32_t block_size, int32_t count,
+                   int32_t algo)
+{
+        int          ret  = -1;
+        clnt_conf_t *conf = NULL;
+        rpc_clnt_procedure_t *proc = NULL;
+        clnt_args_t  args = {0,};
+
+        conf = this->private;
+        if (!conf || !conf->fops)
+                goto out;
+
+        args.fd     = fd;
+        args.offset = offset;
+        args.len    = block_size;
+        args.count  = count;
+        args.flags  = algo;
+
+        proc = &conf->fops->proctable[GF_FOP_RCHECKSUMV];
+        if (!proc) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "rpc procedure not found for %s",
+                        gf_fop_list[GF_FOP_RCHECKSUMV]);
+                goto out;
+        }
+        if (proc->fn)
+                ret = proc->fn (frame, this, &args);
+out:
+        if (ret)
+                STACK_UNWIND_STRICT (rchecksumv, frame, -1, ENOTCONN, 0, 0,
+                                     NULL);
+
+        return 0;
+}
+
 
 int32_t
 client_getspec (call_frame_t *frame, xlator_t *this, const char *key,
@@ -2322,6 +2494,11 @@ struct xlator_fops fops = {
         .setattr     = client_setattr,
         .fsetattr    = client_fsetattr,
         .getspec     = client_getspec,
+        .fallocate   = client_fallocate,
+        .discard     = client_discard,
+        .zerofill    = client_zerofill,
+        .seek        = client_seek,
+        .rchecksumv  = client_rchecksumv,
 };
 
 
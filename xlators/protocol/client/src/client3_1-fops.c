@@ -26,6 +26,7 @@
 #include "glusterfs3-xdr.h"
 #include "glusterfs3.h"
 #include "compat-errno.h"
+#include "checksum.h"
 
 int32_t client3_getspec (call_frame_t *frame, xlator_t *this, void *data);
 void client_start_ping (void *data);
@@ -1159,6 +1160,180 @@ out:
         return 0;
 }
 
+int
+client3_1_fallocate_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                         void *myframe)
+{
+        gfs3_fallocate_rsp  rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        struct iatt     prestat  = {0,};
+        struct iatt     poststat = {0,};
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_fallocate_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (fallocate, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_discard_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                       void *myframe)
+{
+        gfs3_discard_rsp  rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        struct iatt     prestat  = {0,};
+        struct iatt     poststat = {0,};
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_discard_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (discard, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_zerofill_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                        void *myframe)
+{
+        gfs3_zerofill_rsp  rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        struct iatt     prestat  = {0,};
+        struct iatt     poststat = {0,};
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_zerofill_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if (-1 != rsp.op_ret) {
+                gf_stat_to_iatt (&rsp.statpre, &prestat);
+                gf_stat_to_iatt (&rsp.statpost, &poststat);
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (zerofill, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), &prestat,
+                             &poststat);
+
+        return 0;
+}
+
+int
+client3_1_seek_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                    void *myframe)
+{
+        gfs3_seek_rsp   rsp      = {0,};
+        call_frame_t   *frame    = NULL;
+        int             ret      = 0;
+        xlator_t       *this     = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_seek_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+out:
+        /* ENXIO is the regular answer past the last data extent */
+        if ((rsp.op_ret == -1) &&
+            (gf_error_to_errno (rsp.op_errno) != ENXIO)) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (seek, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), rsp.offset);
+
+        return 0;
+}
+
 int
 client3_1_fstat_cbk (struct rpc_req *req, struct iovec *iov, int count,
                      void *myframe)
@@ -1790,6 +1965,62 @@ out:
         return 0;
 }
 
+int
+client3_1_rchecksumv_cbk (struct rpc_req *req, struct iovec *iov, int count,
+                          void *myframe)
+{
+        call_frame_t        *frame = NULL;
+        gfs3_rchecksumv_rsp  rsp   = {0,};
+        int                  ret   = 0;
+        xlator_t            *this  = NULL;
+
+        this = THIS;
+
+        frame = myframe;
+
+        if (-1 == req->rpc_status) {
+                rsp.op_ret   = -1;
+                rsp.op_errno = ENOTCONN;
+                goto out;
+        }
+
+        ret = xdr_to_generic (*iov, &rsp, (xdrproc_t)xdr_gfs3_rchecksumv_rsp);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_ERROR, "XDR decoding failed");
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+                goto out;
+        }
+
+        if ((rsp.op_ret >= 0) &&
+            (rsp.strong_checksums.strong_checksums_len !=
+             (rsp.count * GF_RCHECKSUM_LEN))) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "checksum count %u does not match reply size %u",
+                        rsp.count, rsp.strong_checksums.strong_checksums_len);
+                rsp.op_ret   = -1;
+                rsp.op_errno = EINVAL;
+        }
+
+out:
+        if (rsp.op_ret == -1) {
+                gf_log (this->name, GF_LOG_WARNING, "remote operation failed: %s",
+                        strerror (gf_error_to_errno (rsp.op_errno)));
+        }
+        STACK_UNWIND_STRICT (rchecksumv, frame, rsp.op_ret,
+                             gf_error_to_errno (rsp.op_errno), rsp.algo,
+                             rsp.count,
+                             (uint8_t *)rsp.strong_checksums.strong_checksums_val);
+
+        if (rsp.strong_checksums.strong_checksums_val) {
+                /* This is allocated by the libc while decoding RPC msg */
+                /* Hence no 'GF_FREE', but just 'free' */
+                free (rsp.strong_checksums.strong_checksums_val);
+        }
+
+        return 0;
+}
+
 int
 client3_1_lk_cbk (struct rpc_req *req, struct iovec *iov, int count,
                   void *myframe)
@@ -5149,6 +5380,204 @@ unwind:
 }
 
 
+int32_t
+client3_1_fallocate (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_fallocate_req  req      = {{0,},};
+        int                 op_errno = ESTALE;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        req.fd     = fdctx->remote_fd;
+        req.flags  = args->flags;
+        req.offset = args->offset;
+        req.size   = args->size;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_FALLOCATE,
+                                     client3_1_fallocate_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_fallocate_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (fallocate, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+int32_t
+client3_1_discard (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_discard_req    req      = {{0,},};
+        int                 op_errno = ESTALE;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        req.fd     = fdctx->remote_fd;
+        req.offset = args->offset;
+        req.size   = args->size;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_DISCARD,
+                                     client3_1_discard_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_discard_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (discard, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+int32_t
+client3_1_zerofill (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_zerofill_req   req      = {{0,},};
+        int                 op_errno = ESTALE;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        req.fd     = fdctx->remote_fd;
+        req.offset = args->offset;
+        req.size   = args->size;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_ZEROFILL,
+                                     client3_1_zerofill_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_zerofill_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (zerofill, frame, -1, op_errno, NULL, NULL);
+        return 0;
+}
+
+int32_t
+client3_1_seek (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t        *args     = NULL;
+        clnt_fd_ctx_t      *fdctx    = NULL;
+        clnt_conf_t        *conf     = NULL;
+        gfs3_seek_req       req      = {{0,},};
+        int                 op_errno = ESTALE;
+        int                 ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        req.fd     = fdctx->remote_fd;
+        req.offset = args->offset;
+        req.what   = args->flags;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_SEEK,
+                                     client3_1_seek_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_seek_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (seek, frame, -1, op_errno, 0);
+        return 0;
+}
+
+int32_t
+client3_1_rchecksumv (call_frame_t *frame, xlator_t *this, void *data)
+{
+        clnt_args_t         *args     = NULL;
+        clnt_fd_ctx_t       *fdctx    = NULL;
+        clnt_conf_t         *conf     = NULL;
+        gfs3_rchecksumv_req  req      = {0,};
+        int                  op_errno = ESTALE;
+        int                  ret      = 0;
+
+        if (!frame || !this || !data)
+                goto unwind;
+
+        args = data;
+        conf = this->private;
+
+        CLIENT_GET_FD_CTX(conf, args, fdctx, op_errno, unwind);
+
+        req.fd         = fdctx->remote_fd;
+        req.offset     = args->offset;
+        req.block_size = args->len;
+        req.count      = args->count;
+        req.algo       = args->flags;
+
+        ret = client_submit_request (this, &req, frame, conf->fops,
+                                     GFS3_OP_RCHECKSUMV,
+                                     client3_1_rchecksumv_cbk, NULL,
+                                     NULL, 0, NULL, 0,
+                                     NULL, (xdrproc_t)xdr_gfs3_rchecksumv_req);
+        if (ret) {
+                op_errno = ENOTCONN;
+                goto unwind;
+        }
+
+        return 0;
+unwind:
+        gf_log (this->name, GF_LOG_WARNING, "failed to send the fop: %s", strerror (op_errno));
+        STACK_UNWIND_STRICT (rchecksumv, frame, -1, op_errno, 0, 0, NULL);
+        return 0;
+}
+
 
 /* Table Specific to FOPS */
 
@@ -5198,6 +5627,11 @@ rpc_clnt_procedure_t clnt3_1_fop_actors[GF_FOP_MAXVALUE] = {
         [GF_FOP_RELEASE]     = { "RELEASE",     client3_1_release },
         [GF_FOP_RELEASEDIR]  = { "RELEASEDIR",  client3_1_releasedir },
         [GF_FOP_GETSPEC]     = { "GETSPEC",     client3_getspec },
+        [GF_FOP_FALLOCATE]   = { "FALLOCATE",   client3_1_fallocate },
+        [GF_FOP_DISCARD]     = { "DISCARD",     client3_1_discard },
+        [GF_FOP_ZEROFILL]    = { "ZEROFILL",    client3_1_zerofill },
+        [GF_FOP_SEEK]        = { "SEEK",        client3_1_seek },
+        [GF_FOP_RCHECKSUMV]  = { "RCHECKSUMV",  client3_1_rchecksumv },
 };
 
 /* Used From RPC-CLNT library to log proper name of procedure based on number */
@@ -5245,6 +5679,11 @@ char *clnt3_1_fop_names[GFS3_OP_MAXVALUE] = {
         [GFS3_OP_READDIRP]    = "READDIRP",
         [GFS3_OP_RELEASE]     = "RELEASE",
         [GFS3_OP_RELEASEDIR]  = "RELEASEDIR",
+        [GFS3_OP_FALLOCATE]   = "FALLOCATE",
+        [GFS3_OP_DISCARD]     = "DISCARD",
+        [GFS3_OP_ZEROFILL]    = "ZEROFILL",
+        [GFS3_OP_SEEK]        = "SEEK",
+        [GFS3_OP_RCHECKSUMV]  = "RCHECKSUMV",
 };
 
 rpc_clnt_prog_t clnt3_1_fop_prog = {
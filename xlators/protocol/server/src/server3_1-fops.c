@@ -30,6 +30,7 @@
 #include "compat-errno.h"
 
 #include "md5.h"
+#include "checksum.h"
 #include "xdr-nfs3.h"
 
 
@@ -1316,6 +1317,44 @@ server_rchecksum_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+int
+server_rchecksumv_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                       int32_t op_ret, int32_t op_errno, int32_t algo,
+                       int32_t count, uint8_t *strong_checksums)
+{
+        gfs3_rchecksumv_rsp  rsp   = {0,};
+        rpcsvc_request_t    *req   = NULL;
+        server_state_t      *state = NULL;
+
+        req           = frame->local;
+
+        state = CALL_STATE(frame);
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        if ((op_ret >= 0) && (count > 0)) {
+                rsp.algo  = algo;
+                rsp.count = count;
+
+                rsp.strong_checksums.strong_checksums_val =
+                        (char *)strong_checksums;
+                rsp.strong_checksums.strong_checksums_len =
+                        count * GF_RCHECKSUM_LEN;
+        }
+        if (op_ret == -1)
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": RCHECKSUMV %"PRId64" (%"PRId64") ==> %"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0, op_ret,
+                        strerror (op_errno));
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_rchecksumv_rsp);
+
+        return 0;
+}
+
+
 int
 server_open_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                  int32_t op_ret, int32_t op_errno, fd_t *fd)
@@ -1568,6 +1607,140 @@ server_fsetattr_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
 }
 
 
+int
+server_fallocate_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                      int32_t op_ret, int32_t op_errno,
+                      struct iatt *statpre, struct iatt *statpost)
+{
+        gfs3_fallocate_rsp  rsp   = {0,};
+        server_state_t    *state = NULL;
+        rpcsvc_request_t  *req   = NULL;
+
+        state  = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, statpre);
+                gf_stat_from_iatt (&rsp.statpost, statpost);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": FALLOCATE %"PRId64" (%"PRId64") ==> "
+                        "%"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0,
+                        op_ret, strerror (op_errno));
+        }
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_fallocate_rsp);
+
+        return 0;
+}
+
+int
+server_discard_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                    int32_t op_ret, int32_t op_errno,
+                    struct iatt *statpre, struct iatt *statpost)
+{
+        gfs3_discard_rsp  rsp   = {0,};
+        server_state_t    *state = NULL;
+        rpcsvc_request_t  *req   = NULL;
+
+        state  = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, statpre);
+                gf_stat_from_iatt (&rsp.statpost, statpost);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": DISCARD %"PRId64" (%"PRId64") ==> "
+                        "%"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0,
+                        op_ret, strerror (op_errno));
+        }
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_discard_rsp);
+
+        return 0;
+}
+
+int
+server_zerofill_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno,
+                     struct iatt *statpre, struct iatt *statpost)
+{
+        gfs3_zerofill_rsp  rsp   = {0,};
+        server_state_t    *state = NULL;
+        rpcsvc_request_t  *req   = NULL;
+
+        state  = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                gf_stat_from_iatt (&rsp.statpre, statpre);
+                gf_stat_from_iatt (&rsp.statpost, statpost);
+        } else {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": ZEROFILL %"PRId64" (%"PRId64") ==> "
+                        "%"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0,
+                        op_ret, strerror (op_errno));
+        }
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_zerofill_rsp);
+
+        return 0;
+}
+
+int
+server_seek_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, off_t offset)
+{
+        gfs3_seek_rsp      rsp   = {0,};
+        server_state_t    *state = NULL;
+        rpcsvc_request_t  *req   = NULL;
+
+        state  = CALL_STATE (frame);
+
+        if (op_ret == 0) {
+                rsp.offset = offset;
+        } else if (op_errno != ENXIO) {
+                gf_log (this->name, GF_LOG_INFO,
+                        "%"PRId64": SEEK %"PRId64" (%"PRId64") ==> "
+                        "%"PRId32" (%s)",
+                        frame->root->unique, state->resolve.fd_no,
+                        state->fd ? state->fd->inode->ino : 0,
+                        op_ret, strerror (op_errno));
+        }
+
+        req           = frame->local;
+
+        rsp.op_ret    = op_ret;
+        rsp.op_errno  = gf_errno_to_error (op_errno);
+
+        server_submit_reply (frame, req, &rsp, NULL, 0, NULL,
+                             (xdrproc_t)xdr_gfs3_seek_rsp);
+
+        return 0;
+}
+
 int
 server_xattrop_cbk (call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno, dict_t *dict)
@@ -1785,6 +1958,35 @@ err:
 
 }
 
+int
+server_rchecksumv_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state    = NULL;
+        int             op_ret   = 0;
+        int             op_errno = EINVAL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0) {
+                op_ret   = state->resolve.op_ret;
+                op_errno = state->resolve.op_errno;
+                goto err;
+        }
+
+        STACK_WIND (frame, server_rchecksumv_cbk, bound_xl,
+                    bound_xl->fops->rchecksumv, state->fd,
+                    state->offset, state->size, state->nr_count,
+                    state->flags);
+
+        return 0;
+err:
+        server_rchecksumv_cbk (frame, NULL, frame->this, op_ret, op_errno, 0,
+                               0, NULL);
+
+        return 0;
+
+}
+
 int
 server_lk_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
@@ -2606,6 +2808,94 @@ err:
 }
 
 
+int
+server_fallocate_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_fallocate_cbk,
+                    bound_xl, bound_xl->fops->fallocate,
+                    state->fd, state->flags, state->offset,
+                    state->size);
+        return 0;
+err:
+        server_fallocate_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                              state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_discard_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_discard_cbk,
+                    bound_xl, bound_xl->fops->discard,
+                    state->fd, state->offset, state->size);
+        return 0;
+err:
+        server_discard_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                            state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+
+int
+server_zerofill_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_zerofill_cbk,
+                    bound_xl, bound_xl->fops->zerofill,
+                    state->fd, state->offset, state->size);
+        return 0;
+err:
+        server_zerofill_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                             state->resolve.op_errno, NULL, NULL);
+
+        return 0;
+}
+
+int
+server_seek_resume (call_frame_t *frame, xlator_t *bound_xl)
+{
+        server_state_t *state = NULL;
+
+        state = CALL_STATE (frame);
+
+        if (state->resolve.op_ret != 0)
+                goto err;
+
+        STACK_WIND (frame, server_seek_cbk,
+                    bound_xl, bound_xl->fops->seek,
+                    state->fd, state->offset, state->flags);
+        return 0;
+err:
+        server_seek_cbk (frame, NULL, frame->this, state->resolve.op_ret,
+                         state->resolve.op_errno, 0);
+
+        return 0;
+}
+
+
 int
 server_setattr_resume (call_frame_t *frame, xlator_t *bound_xl)
 {
@@ -2817,6 +3107,184 @@ out:
         return ret;
 }
 
+int
+server_fallocate (rpcsvc_request_t *req)
+{
+        server_state_t    *state = NULL;
+        call_frame_t      *frame = NULL;
+        gfs3_fallocate_req  args  = {{0,},};
+        int                ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_fallocate_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_FALLOCATE;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+
+        state->flags  = args.flags;
+        state->offset = args.offset;
+        state->size   = args.size;
+
+        ret = 0;
+        resolve_and_resume (frame, server_fallocate_resume);
+out:
+        return ret;
+}
+
+int
+server_discard (rpcsvc_request_t *req)
+{
+        server_state_t    *state = NULL;
+        call_frame_t      *frame = NULL;
+        gfs3_discard_req  args  = {{0,},};
+        int                ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_discard_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_DISCARD;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+
+        state->offset = args.offset;
+        state->size   = args.size;
+
+        ret = 0;
+        resolve_and_resume (frame, server_discard_resume);
+out:
+        return ret;
+}
+
+int
+server_zerofill (rpcsvc_request_t *req)
+{
+        server_state_t    *state = NULL;
+        call_frame_t      *frame = NULL;
+        gfs3_zerofill_req  args  = {{0,},};
+        int                ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_zerofill_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_ZEROFILL;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+
+        state->offset = args.offset;
+        state->size   = args.size;
+
+        ret = 0;
+        resolve_and_resume (frame, server_zerofill_resume);
+out:
+        return ret;
+}
+
+
+int
+server_seek (rpcsvc_request_t *req)
+{
+        server_state_t    *state = NULL;
+        call_frame_t      *frame = NULL;
+        gfs3_seek_req      args  = {{0,},};
+        int                ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_seek_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_SEEK;
+
+        state = CALL_STATE (frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type   = RESOLVE_MUST;
+        state->resolve.fd_no  = args.fd;
+
+        state->offset = args.offset;
+        state->flags  = args.what;
+
+        ret = 0;
+        resolve_and_resume (frame, server_seek_resume);
+out:
+        return ret;
+}
+
 
 int
 server_readlink (rpcsvc_request_t *req)
@@ -5021,6 +5489,51 @@ out:
         return ret;
 }
 
+int
+server_rchecksumv (rpcsvc_request_t *req)
+{
+        server_state_t       *state = NULL;
+        call_frame_t         *frame = NULL;
+        gfs3_rchecksumv_req   args  = {0,};
+        int                   ret   = -1;
+
+        if (!req)
+                return ret;
+
+        if (!xdr_to_generic (req->msg[0], &args, (xdrproc_t)xdr_gfs3_rchecksumv_req)) {
+                //failed to decode msg;
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        frame = get_frame_from_request (req);
+        if (!frame) {
+                // something wrong, mostly insufficient memory
+                req->rpc_err = GARBAGE_ARGS; /* TODO */
+                goto out;
+        }
+        frame->root->op = GF_FOP_RCHECKSUMV;
+
+        state = CALL_STATE(frame);
+        if (!state->conn->bound_xl) {
+                /* auth failure, request on subvolume without setvolume */
+                req->rpc_err = GARBAGE_ARGS;
+                goto out;
+        }
+
+        state->resolve.type  = RESOLVE_MAY;
+        state->resolve.fd_no = args.fd;
+        state->offset        = args.offset;
+        state->size          = args.block_size;
+        state->nr_count      = args.count;
+        state->flags         = args.algo;
+
+        ret = 0;
+        resolve_and_resume (frame, server_rchecksumv_resume);
+out:
+        return ret;
+}
+
 int
 server_null (rpcsvc_request_t *req)
 {
@@ -5222,6 +5735,11 @@ rpcsvc_actor_t glusterfs3_1_fop_actors[] = {
         [GFS3_OP_READDIRP]    = { "READDIRP",   GFS3_OP_READDIRP, server_readdirp, NULL, NULL },
         [GFS3_OP_RELEASE]     = { "RELEASE",    GFS3_OP_RELEASE, server_release, NULL, NULL },
         [GFS3_OP_RELEASEDIR]  = { "RELEASEDIR", GFS3_OP_RELEASEDIR, server_releasedir, NULL, NULL },
+        [GFS3_OP_FALLOCATE]   = { "FALLOCATE",  GFS3_OP_FALLOCATE, server_fallocate, NULL, NULL },
+        [GFS3_OP_DISCARD]     = { "DISCARD",    GFS3_OP_DISCARD, server_discard, NULL, NULL },
+        [GFS3_OP_ZEROFILL]    = { "ZEROFILL",   GFS3_OP_ZEROFILL, server_zerofill, NULL, NULL },
+        [GFS3_OP_SEEK]        = { "SEEK",       GFS3_OP_SEEK, server_seek, NULL, NULL },
+        [GFS3_OP_RCHECKSUMV]  = { "RCHECKSUMV", GFS3_OP_RCHECKSUMV, server_rchecksumv, NULL, NULL },
 };
 
 
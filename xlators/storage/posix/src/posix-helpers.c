@@ -809,6 +809,313 @@ unlock:
         UNLOCK (&priv->lock);
 }
 
+
+/* shrink the file by chunk_size bytes at a time, so that the filesystem
+   never has to free more than that many bytes worth of blocks in one go */
+int
+posix_chunked_truncate (xlator_t *this, int fd, off_t size, off_t offset)
+{
+        struct posix_private *priv  = NULL;
+        off_t                 chunk = 0;
+        int                   ret   = 0;
+
+        priv  = this->private;
+        chunk = priv->reclaim_chunk_size;
+
+        while (size - offset > chunk) {
+                size -= chunk;
+                ret = ftruncate (fd, size);
+                if (ret == -1)
+                        goto out;
+        }
+
+        ret = ftruncate (fd, offset);
+out:
+        return ret;
+}
+
+
+static void
+posix_reclaim_enqueue (xlator_t *this, char *path, off_t size)
+{
+        struct posix_private       *priv  = NULL;
+        struct posix_reclaim_entry *entry = NULL;
+
+        priv = this->private;
+
+        entry = GF_CALLOC (1, sizeof (*entry), gf_posix_mt_reclaim_entry);
+        if (!entry) {
+                /* leftovers are picked up again on the next start */
+                GF_FREE (path);
+                return;
+        }
+
+        INIT_LIST_HEAD (&entry->list);
+        entry->path = path;
+        entry->size = size;
+
+        pthread_mutex_lock (&priv->reclaim_lock);
+        {
+                list_add_tail (&entry->list, &priv->reclaim_list);
+                priv->reclaim_pending_files++;
+                priv->reclaim_pending_bytes += size;
+                pthread_cond_signal (&priv->reclaim_cond);
+        }
+        pthread_mutex_unlock (&priv->reclaim_lock);
+}
+
+
+/*
+  Unlink a large file by renaming it into the reclaim dir and leaving the
+  freeing of its blocks to the reclaim thread. Returns 1 if the file was
+  taken care of, 0 if the caller has to unlink it by itself.
+*/
+int
+posix_reclaim_unlink (xlator_t *this, inode_t *inode, const char *real_path)
+{
+        struct posix_private *priv      = NULL;
+        struct stat           stbuf     = {0, };
+        char                 *path      = NULL;
+        uint64_t              gen       = 0;
+        gf_boolean_t          busy      = _gf_false;
+        int                   ret       = 0;
+
+        priv = this->private;
+
+        if (!priv->reclaim_present || !priv->reclaim_threshold)
+                goto out;
+
+        ret = lstat (real_path, &stbuf);
+        if (ret == -1)
+                goto out;
+
+        /* unlinking one of many links frees nothing */
+        if (!S_ISREG (stbuf.st_mode) || (stbuf.st_nlink != 1) ||
+            ((uint64_t) stbuf.st_blocks * 512 < priv->reclaim_threshold))
+                goto out;
+
+        /* open files have to keep their data till they are closed */
+        if (inode) {
+                LOCK (&inode->lock);
+                {
+                        busy = !list_empty (&inode->fd_list);
+                }
+                UNLOCK (&inode->lock);
+        }
+        if (busy)
+                goto out;
+
+        pthread_mutex_lock (&priv->reclaim_lock);
+        {
+                gen = priv->reclaim_gen++;
+        }
+        pthread_mutex_unlock (&priv->reclaim_lock);
+
+        ret = gf_asprintf (&path, "%s/%"PRIu64".%"PRIu64, priv->reclaim_path,
+                           (uint64_t) stbuf.st_ino, gen);
+        if (ret < 0) {
+                path = NULL;
+                goto out;
+        }
+
+        ret = rename (real_path, path);
+        if (ret == -1) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "rename of %s to %s failed: %s", real_path, path,
+                        strerror (errno));
+                GF_FREE (path);
+                goto out;
+        }
+
+        gf_log (this->name, GF_LOG_TRACE, "%s (%"PRId64" bytes) moved to %s",
+                real_path, (int64_t) stbuf.st_size, path);
+
+        posix_reclaim_enqueue (this, path, stbuf.st_size);
+
+        return 1;
+out:
+        return 0;
+}
+
+
+/* queue files left over in the reclaim dir by an earlier run */
+int
+posix_reclaim_requeue (xlator_t *this)
+{
+        struct posix_private *priv   = NULL;
+        DIR                  *dir    = NULL;
+        struct dirent        *entry  = NULL;
+        struct stat           stbuf  = {0, };
+        char                 *path   = NULL;
+        int                   count  = 0;
+        int                   ret    = 0;
+
+        priv = this->private;
+
+        dir = opendir (priv->reclaim_path);
+        if (!dir)
+                goto out;
+
+        while ((entry = readdir (dir)) != NULL) {
+                if (!strcmp (entry->d_name, ".") ||
+                    !strcmp (entry->d_name, ".."))
+                        continue;
+
+                ret = gf_asprintf (&path, "%s/%s", priv->reclaim_path,
+                                   entry->d_name);
+                if (ret < 0)
+                        break;
+
+                if ((lstat (path, &stbuf) == -1) || !S_ISREG (stbuf.st_mode)) {
+                        GF_FREE (path);
+                        continue;
+                }
+
+                posix_reclaim_enqueue (this, path, stbuf.st_size);
+                count++;
+        }
+
+        closedir (dir);
+
+        if (count)
+                gf_log (this->name, GF_LOG_INFO,
+                        "%d files left in %s queued for reclaim", count,
+                        priv->reclaim_path);
+out:
+        return count;
+}
+
+
+static void
+posix_reclaim_file (xlator_t *this, struct posix_reclaim_entry *entry)
+{
+        struct posix_private *priv     = NULL;
+        off_t                 size     = 0;
+        off_t                 freed    = 0;
+        int                   fd       = -1;
+
+        priv = this->private;
+
+        fd = open (entry->path, O_WRONLY);
+        if (fd == -1) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "open of %s failed: %s", entry->path,
+                        strerror (errno));
+                goto unlink;
+        }
+
+        size = entry->size;
+        while (size > 0) {
+                freed = min (size, (off_t) priv->reclaim_chunk_size);
+
+                if (ftruncate (fd, size - freed) == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "ftruncate of %s failed: %s", entry->path,
+                                strerror (errno));
+                        break;
+                }
+                size -= freed;
+
+                pthread_mutex_lock (&priv->reclaim_lock);
+                {
+                        entry->size = size;
+                        priv->reclaim_pending_bytes -= freed;
+                        priv->reclaim_done_bytes += freed;
+                }
+                pthread_mutex_unlock (&priv->reclaim_lock);
+
+                /* stay within the I/O budget */
+                if (priv->reclaim_rate)
+                        usleep ((freed * 1000000ULL) / priv->reclaim_rate);
+        }
+
+        close (fd);
+unlink:
+        if (unlink (entry->path) == -1 && errno != ENOENT)
+                gf_log (this->name, GF_LOG_WARNING,
+                        "unlink of %s failed: %s", entry->path,
+                        strerror (errno));
+
+        pthread_mutex_lock (&priv->reclaim_lock);
+        {
+                priv->reclaim_pending_bytes -= entry->size;
+                priv->reclaim_pending_files--;
+                priv->reclaim_done_files++;
+        }
+        pthread_mutex_unlock (&priv->reclaim_lock);
+}
+
+
+static void *
+posix_reclaim_thread_proc (void *data)
+{
+        xlator_t                   *this  = NULL;
+        struct posix_private       *priv  = NULL;
+        struct posix_reclaim_entry *entry = NULL;
+
+        this = data;
+        priv = this->private;
+
+        THIS = this;
+
+        while (1) {
+                pthread_mutex_lock (&priv->reclaim_lock);
+                {
+                        while (list_empty (&priv->reclaim_list))
+                                pthread_cond_wait (&priv->reclaim_cond,
+                                                   &priv->reclaim_lock);
+
+                        /* stays on the list while being reclaimed, so that
+                           statedump can show it */
+                        entry = list_entry (priv->reclaim_list.next,
+                                            struct posix_reclaim_entry, list);
+                }
+                pthread_mutex_unlock (&priv->reclaim_lock);
+
+                posix_reclaim_file (this, entry);
+
+                pthread_mutex_lock (&priv->reclaim_lock);
+                {
+                        list_del_init (&entry->list);
+                }
+                pthread_mutex_unlock (&priv->reclaim_lock);
+
+                GF_FREE (entry->path);
+                GF_FREE (entry);
+        }
+
+        return NULL;
+}
+
+
+void
+posix_spawn_reclaim_thread (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int ret = 0;
+
+        priv = this->private;
+
+        LOCK (&priv->lock);
+        {
+                if (!priv->reclaim_present) {
+                        ret = pthread_create (&priv->reclaim, NULL,
+                                              posix_reclaim_thread_proc, this);
+
+                        if (ret != 0) {
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "spawning reclaim thread failed: %s",
+                                        strerror (ret));
+                                goto unlock;
+                        }
+
+                        priv->reclaim_present = _gf_true;
+                }
+        }
+unlock:
+        UNLOCK (&priv->lock);
+}
+
 int
 posix_acl_xattr_set (xlator_t *this, const char *path, dict_t *xattr_req)
 {
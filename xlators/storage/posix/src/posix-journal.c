@@ -0,0 +1,1358 @@
+/*
+  Copyright (c) 2011 Gluster, Inc. <http://www.gluster.com>
+  This file is part of GlusterFS.
+
+  GlusterFS is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; either version 3 of the License,
+  or (at your option) any later version.
+
+  GlusterFS is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include "config.h"
+#endif
+
+/*
+  Journal of the xattrops done on the AFR changelog xattrs.
+
+  An AFR write transaction increments the changelog counters in its
+  pre-op and decrements them again in its post-op, so most of the time
+  the counters are back to what is stored in the xattrs once the
+  transaction is done. With the journal turned on the counters of an
+  inode are kept in memory and every xattrop appends the resulting
+  values to the journal file at the root of the brick instead of doing
+  a getxattr and a setxattr. Records of concurrent xattrops are written
+  to the file with a single write (group commit).
+
+  A fold thread periodically writes the counters which differ from the
+  xattrs back to the files and compacts the journal to the records of
+  the counters which still differ. Records carry the absolute values of
+  the counters, so replaying the journal at startup is idempotent.
+  getxattr and lookup return the in-memory values of the counters.
+*/
+
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include "glusterfs.h"
+#include "xlator.h"
+#include "logging.h"
+#include "dict.h"
+#include "common-utils.h"
+#include "byte-order.h"
+#include "syscall.h"
+#include "compat-errno.h"
+#include "posix.h"
+
+#define POSIX_JOURNAL_MAGIC         0x58415452  /* "XATR" */
+#define POSIX_JOURNAL_XATTR_PREFIX  "trusted.afr."
+
+struct posix_journal_rec {
+        uint32_t magic;
+        uint32_t path_len;      /* including the '\0' */
+        uint32_t key_len;       /* including the '\0' */
+        uint32_t value_len;
+        uuid_t   gfid;
+        /* followed by path, key and value */
+};
+
+struct posix_journal_entry {
+        struct list_head  list;
+        char             *key;
+        int32_t           len;
+        gf_boolean_t      ondisk;  /* the xattr exists */
+        char             *disk;    /* value in the xattr */
+        char             *value;   /* value given out by the last xattrop */
+};
+
+struct posix_journal_ctx {
+        struct list_head  entries;
+        struct list_head  dirty;   /* in priv->journal_dirty */
+        inode_t          *inode;
+        char             *path;    /* real path of the last xattrop */
+        uuid_t            gfid;
+};
+
+/* copy of the counters of an inode to be written by a fold */
+struct posix_journal_fold {
+        struct list_head  list;
+        uuid_t            gfid;
+        char             *path;       /* by the dentry, if there is one */
+        char             *last_path;  /* of the last xattrop */
+        dict_t           *xattr;
+        gf_boolean_t      gone;
+};
+
+
+static void
+__posix_journal_add (char *dest, char *src, int32_t len,
+                     gf_xattrop_flags_t optype)
+{
+        int       i   = 0;
+        int32_t  *d32 = NULL;
+        int32_t  *s32 = NULL;
+        int64_t  *d64 = NULL;
+        int64_t  *s64 = NULL;
+
+        if (optype == GF_XATTROP_ADD_ARRAY) {
+                d32 = (int32_t *) dest;
+                s32 = (int32_t *) src;
+                for (i = 0; i < len / 4; i++)
+                        d32[i] = hton32 (ntoh32 (d32[i]) + ntoh32 (s32[i]));
+        } else {
+                d64 = (int64_t *) dest;
+                s64 = (int64_t *) src;
+                for (i = 0; i < len / 8; i++)
+                        d64[i] = hton64 (ntoh64 (d64[i]) + ntoh64 (s64[i]));
+        }
+}
+
+
+static struct posix_journal_ctx *
+__posix_journal_ctx_get (xlator_t *this, inode_t *inode, gf_boolean_t create)
+{
+        struct posix_journal_ctx *ctx   = NULL;
+        uint64_t                  value = 0;
+        int                       ret   = 0;
+
+        ret = inode_ctx_get (inode, this, &value);
+        if (ret == 0)
+                return (struct posix_journal_ctx *)(long) value;
+
+        if (!create)
+                return NULL;
+
+        ctx = GF_CALLOC (1, sizeof (*ctx), gf_posix_mt_journal_ctx);
+        if (!ctx)
+                return NULL;
+
+        INIT_LIST_HEAD (&ctx->entries);
+        INIT_LIST_HEAD (&ctx->dirty);
+        ctx->inode = inode;
+        uuid_copy (ctx->gfid, inode->gfid);
+
+        ret = inode_ctx_put (inode, this, (uint64_t)(long) ctx);
+        if (ret) {
+                GF_FREE (ctx);
+                return NULL;
+        }
+
+        return ctx;
+}
+
+
+static struct posix_journal_entry *
+__posix_journal_entry_get (struct posix_journal_ctx *ctx, const char *key)
+{
+        struct posix_journal_entry *entry = NULL;
+
+        list_for_each_entry (entry, &ctx->entries, list) {
+                if (!strcmp (entry->key, key))
+                        return entry;
+        }
+
+        return NULL;
+}
+
+
+/* the counter has to be written to the xattr. An xattr which does not
+   exist yet is created even if the counter is back to zero, just as the
+   xattrop would have done. */
+static gf_boolean_t
+__posix_journal_entry_dirty (struct posix_journal_entry *entry)
+{
+        if (!entry->ondisk)
+                return _gf_true;
+
+        return memcmp (entry->value, entry->disk, entry->len) ? _gf_true
+                                                             : _gf_false;
+}
+
+
+static gf_boolean_t
+__posix_journal_ctx_dirty (struct posix_journal_ctx *ctx)
+{
+        struct posix_journal_entry *entry = NULL;
+
+        list_for_each_entry (entry, &ctx->entries, list) {
+                if (__posix_journal_entry_dirty (entry))
+                        return _gf_true;
+        }
+
+        return _gf_false;
+}
+
+
+static void
+posix_journal_entry_destroy (struct posix_journal_entry *entry)
+{
+        list_del_init (&entry->list);
+
+        if (entry->key)
+                GF_FREE (entry->key);
+        if (entry->disk)
+                GF_FREE (entry->disk);
+        if (entry->value)
+                GF_FREE (entry->value);
+
+        GF_FREE (entry);
+}
+
+
+/* append a record of the value of key to the buffer. A record without a
+   value tells the replay to leave the xattr alone. */
+static int
+__posix_journal_append (xlator_t *this, struct posix_journal_ctx *ctx,
+                        const char *key, const char *value, int32_t value_len)
+{
+        struct posix_private     *priv = NULL;
+        struct posix_journal_rec  rec  = {0, };
+        const char               *path = NULL;
+        char                     *buf  = NULL;
+        size_t                    len  = 0;
+        size_t                    size = 0;
+
+        priv = this->private;
+
+        path = ctx->path ? ctx->path : "";
+
+        rec.magic     = POSIX_JOURNAL_MAGIC;
+        rec.path_len  = strlen (path) + 1;
+        rec.key_len   = strlen (key) + 1;
+        rec.value_len = value_len;
+        uuid_copy (rec.gfid, ctx->gfid);
+
+        len = sizeof (rec) + rec.path_len + rec.key_len + rec.value_len;
+
+        if (priv->journal_buf_len + len > priv->journal_buf_size) {
+                size = max (priv->journal_buf_size * 2,
+                            priv->journal_buf_len + len);
+                if (priv->journal_buf)
+                        buf = GF_REALLOC (priv->journal_buf, size);
+                else
+                        buf = GF_CALLOC (1, size, gf_posix_mt_char);
+                if (!buf)
+                        return -1;
+                priv->journal_buf = buf;
+                priv->journal_buf_size = size;
+        }
+
+        buf = priv->journal_buf + priv->journal_buf_len;
+        memcpy (buf, &rec, sizeof (rec));
+        buf += sizeof (rec);
+        memcpy (buf, path, rec.path_len);
+        buf += rec.path_len;
+        memcpy (buf, key, rec.key_len);
+        buf += rec.key_len;
+        if (value_len)
+                memcpy (buf, value, rec.value_len);
+
+        priv->journal_buf_len += len;
+        priv->journal_seq++;
+
+        return 0;
+}
+
+
+/* write out the buffered records, called with journal_lock held. Failing
+   to write them is not fatal, the values still make it to the xattrs
+   when the journal is folded, they just won't survive a crash. */
+static int
+__posix_journal_write (xlator_t *this)
+{
+        struct posix_private *priv    = NULL;
+        char                 *buf     = NULL;
+        size_t                len     = 0;
+        ssize_t               ret     = 0;
+        uint64_t              seq     = 0;
+
+        priv = this->private;
+
+        buf = priv->journal_buf;
+        len = priv->journal_buf_len;
+        seq = priv->journal_seq;
+
+        priv->journal_buf = NULL;
+        priv->journal_buf_len = 0;
+        priv->journal_buf_size = 0;
+
+        /* records coming in meanwhile form the next batch */
+        priv->journal_writing = _gf_true;
+        pthread_mutex_unlock (&priv->journal_lock);
+        {
+                if (len)
+                        ret = write (priv->journal_fd, buf, len);
+        }
+        pthread_mutex_lock (&priv->journal_lock);
+        priv->journal_writing = _gf_false;
+
+        if (buf)
+                GF_FREE (buf);
+
+        if (ret != len)
+                gf_log (this->name, GF_LOG_ERROR,
+                        "write to xattrop journal %s failed: %s",
+                        priv->journal_path,
+                        (ret < 0) ? strerror (errno) : "short write");
+        else
+                priv->journal_batches++;
+
+        if (priv->journal_written < seq)
+                priv->journal_written = seq;
+        pthread_cond_broadcast (&priv->journal_cond);
+
+        return (ret == len) ? 0 : -1;
+}
+
+
+/* wait till the records up to seq are in the journal, writing them out
+   together with those of the other waiters if nobody else is */
+static void
+posix_journal_commit (xlator_t *this, uint64_t seq)
+{
+        struct posix_private *priv = NULL;
+
+        priv = this->private;
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                while (priv->journal_written < seq) {
+                        if (priv->journal_writing) {
+                                pthread_cond_wait (&priv->journal_cond,
+                                                   &priv->journal_lock);
+                                continue;
+                        }
+
+                        __posix_journal_write (this);
+                }
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+}
+
+
+static int
+posix_journal_gfid_check (const char *path, uuid_t gfid)
+{
+        uuid_t  ondisk = {0, };
+        ssize_t size   = 0;
+
+        size = sys_lgetxattr (path, GFID_XATTR_KEY, ondisk, 16);
+        if (size != 16)
+                return -1;
+
+        return uuid_compare (ondisk, gfid) ? -1 : 0;
+}
+
+
+static void
+posix_journal_fold_destroy (struct posix_journal_fold *fold)
+{
+        if (fold->xattr)
+                dict_unref (fold->xattr);
+        if (fold->path)
+                GF_FREE (fold->path);
+        if (fold->last_path)
+                GF_FREE (fold->last_path);
+
+        GF_FREE (fold);
+}
+
+
+/* take a copy of the counters of ctx which have to be written to the
+   xattrs, called with journal_lock held */
+static struct posix_journal_fold *
+__posix_journal_fold_get (xlator_t *this, struct posix_journal_ctx *ctx,
+                          gf_boolean_t use_dentry)
+{
+        struct posix_journal_fold  *fold     = NULL;
+        struct posix_journal_entry *entry    = NULL;
+        char                       *rel_path = NULL;
+        char                       *value    = NULL;
+        int                         ret      = 0;
+
+        fold = GF_CALLOC (1, sizeof (*fold), gf_posix_mt_journal_fold);
+        if (!fold)
+                return NULL;
+
+        INIT_LIST_HEAD (&fold->list);
+        uuid_copy (fold->gfid, ctx->gfid);
+
+        fold->xattr = dict_new ();
+        if (!fold->xattr)
+                goto err;
+
+        if (ctx->path) {
+                fold->last_path = gf_strdup (ctx->path);
+                if (!fold->last_path)
+                        goto err;
+        }
+
+        /* the file might have been renamed since the last xattrop */
+        if (use_dentry && (inode_path (ctx->inode, NULL, &rel_path) > 0)) {
+                ret = gf_asprintf (&fold->path, "%s%s", POSIX_BASE_PATH (this),
+                                   rel_path);
+                GF_FREE (rel_path);
+                if (ret < 0) {
+                        fold->path = NULL;
+                        goto err;
+                }
+        }
+
+        list_for_each_entry (entry, &ctx->entries, list) {
+                if (!__posix_journal_entry_dirty (entry))
+                        continue;
+
+                value = memdup (entry->value, entry->len);
+                if (!value)
+                        goto err;
+
+                ret = dict_set_bin (fold->xattr, entry->key, value,
+                                    entry->len);
+                if (ret) {
+                        GF_FREE (value);
+                        goto err;
+                }
+        }
+
+        return fold;
+err:
+        posix_journal_fold_destroy (fold);
+        return NULL;
+}
+
+
+/* write the counters of fold to the xattrs of the file, without holding
+   journal_lock. The counters which could not be written are dropped from
+   fold and stay dirty. */
+static void
+posix_journal_fold_write (xlator_t *this, struct posix_journal_fold *fold)
+{
+        data_pair_t *trav = NULL;
+        data_pair_t *next = NULL;
+        char        *path = NULL;
+        int          ret  = 0;
+
+        if (fold->path && (posix_journal_gfid_check (fold->path,
+                                                     fold->gfid) == 0))
+                path = fold->path;
+        else if (fold->last_path &&
+                 (posix_journal_gfid_check (fold->last_path,
+                                            fold->gfid) == 0))
+                path = fold->last_path;
+
+        if (!path) {
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "%s is gone, dropping its journaled xattrops",
+                        fold->last_path ? fold->last_path
+                                        : uuid_utoa (fold->gfid));
+                fold->gone = _gf_true;
+                return;
+        }
+
+        for (trav = fold->xattr->members_list; trav; trav = next) {
+                next = trav->next;
+
+                ret = sys_lsetxattr (path, trav->key, trav->value->data,
+                                     trav->value->len, 0);
+                if (ret == -1) {
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "setxattr of %s on %s failed while folding "
+                                "the xattrop journal (%s)", trav->key, path,
+                                strerror (errno));
+                        dict_del (fold->xattr, trav->key);
+                }
+        }
+}
+
+
+/* take note of the values fold wrote to the xattrs, called with
+   journal_lock held */
+static void
+__posix_journal_fold_done (xlator_t *this, struct posix_journal_fold *fold)
+{
+        struct posix_private       *priv  = NULL;
+        struct posix_journal_ctx   *ctx   = NULL;
+        struct posix_journal_ctx   *tmp   = NULL;
+        struct posix_journal_entry *entry = NULL;
+        data_pair_t                *trav  = NULL;
+
+        priv = this->private;
+
+        /* the inode might have been forgotten meanwhile */
+        list_for_each_entry (tmp, &priv->journal_dirty, dirty) {
+                if (!uuid_compare (tmp->gfid, fold->gfid)) {
+                        ctx = tmp;
+                        break;
+                }
+        }
+
+        if (!ctx)
+                return;
+
+        for (trav = fold->xattr->members_list; trav; trav = trav->next) {
+                entry = __posix_journal_entry_get (ctx, trav->key);
+                if (!entry || (entry->len != trav->value->len))
+                        continue;
+
+                /* a newer value keeps the counter dirty */
+                memcpy (entry->disk, trav->value->data, entry->len);
+                entry->ondisk = _gf_true;
+
+                if (!fold->gone)
+                        priv->journal_folds++;
+        }
+
+        if (!__posix_journal_ctx_dirty (ctx))
+                list_del_init (&ctx->dirty);
+}
+
+
+/* rewrite the journal with just the records of the counters still to be
+   folded. The records go to a new file which replaces the journal once
+   it is on disk, so a crash meanwhile leaves the old journal in place. */
+static int
+posix_journal_compact (xlator_t *this)
+{
+        struct posix_private       *priv     = NULL;
+        struct posix_journal_ctx   *ctx      = NULL;
+        struct posix_journal_entry *entry    = NULL;
+        char                       *tmp_path = NULL;
+        char                       *buf      = NULL;
+        size_t                      len      = 0;
+        uint64_t                    seq      = 0;
+        gf_boolean_t                failed   = _gf_false;
+        int                         fd       = -1;
+        int                         ret      = -1;
+
+        priv = this->private;
+
+        ret = gf_asprintf (&tmp_path, "%s.tmp", priv->journal_path);
+        if (ret < 0)
+                return -1;
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                /* the old journal has to be complete in case the new one
+                   does not make it */
+                while (priv->journal_writing || priv->journal_buf_len) {
+                        if (priv->journal_writing) {
+                                pthread_cond_wait (&priv->journal_cond,
+                                                   &priv->journal_lock);
+                                continue;
+                        }
+
+                        __posix_journal_write (this);
+                }
+
+                list_for_each_entry (ctx, &priv->journal_dirty, dirty) {
+                        list_for_each_entry (entry, &ctx->entries, list) {
+                                if (!__posix_journal_entry_dirty (entry))
+                                        continue;
+                                if (__posix_journal_append (this, ctx,
+                                                            entry->key,
+                                                            entry->value,
+                                                            entry->len))
+                                        failed = _gf_true;
+                        }
+                }
+
+                buf = priv->journal_buf;
+                len = priv->journal_buf_len;
+                seq = priv->journal_seq;
+
+                priv->journal_buf = NULL;
+                priv->journal_buf_len = 0;
+                priv->journal_buf_size = 0;
+
+                /* records coming in meanwhile go to the new journal */
+                priv->journal_writing = _gf_true;
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        ret = -1;
+
+        if (failed)
+                goto out;
+
+        fd = open (tmp_path, O_CREAT | O_TRUNC | O_RDWR | O_APPEND, 0600);
+        if (fd == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "creating xattrop journal %s failed: %s",
+                        tmp_path, strerror (errno));
+                goto out;
+        }
+
+        if (len && (write (fd, buf, len) != len)) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "write to xattrop journal %s failed: %s",
+                        tmp_path, strerror (errno));
+                goto out;
+        }
+
+        if (fsync (fd) == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "fsync of xattrop journal %s failed: %s",
+                        tmp_path, strerror (errno));
+                goto out;
+        }
+
+        if (rename (tmp_path, priv->journal_path) == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "renaming %s to %s failed: %s", tmp_path,
+                        priv->journal_path, strerror (errno));
+                goto out;
+        }
+
+        ret = 0;
+out:
+        if (ret && (fd != -1)) {
+                close (fd);
+                unlink (tmp_path);
+                fd = -1;
+        }
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                if (ret == 0) {
+                        close (priv->journal_fd);
+                        priv->journal_fd = fd;
+                }
+
+                /* the records appended for the compaction are in the
+                   old journal already if the new one failed */
+                priv->journal_writing = _gf_false;
+                if (priv->journal_written < seq)
+                        priv->journal_written = seq;
+                pthread_cond_broadcast (&priv->journal_cond);
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        if (buf)
+                GF_FREE (buf);
+        GF_FREE (tmp_path);
+
+        return ret;
+}
+
+
+int
+posix_journal_fold (xlator_t *this)
+{
+        struct posix_private      *priv  = NULL;
+        struct posix_journal_ctx  *ctx   = NULL;
+        struct posix_journal_fold *fold  = NULL;
+        struct posix_journal_fold *tmp   = NULL;
+        struct list_head           folds;
+
+        priv = this->private;
+
+        INIT_LIST_HEAD (&folds);
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                list_for_each_entry (ctx, &priv->journal_dirty, dirty) {
+                        fold = __posix_journal_fold_get (this, ctx, _gf_true);
+                        if (fold)
+                                list_add_tail (&fold->list, &folds);
+                }
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        /* xattrops go on while the xattrs are written */
+        list_for_each_entry (fold, &folds, list) {
+                posix_journal_fold_write (this, fold);
+        }
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                list_for_each_entry (fold, &folds, list) {
+                        __posix_journal_fold_done (this, fold);
+                }
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        list_for_each_entry_safe (fold, tmp, &folds, list) {
+                list_del_init (&fold->list);
+                posix_journal_fold_destroy (fold);
+        }
+
+        return posix_journal_compact (this);
+}
+
+
+/*
+  Do the xattrop through the journal. Returns 0 if it was done (or failed,
+  with op_errno set), -1 if the caller has to do it on the xattrs.
+*/
+int
+posix_journal_xattrop (xlator_t *this, inode_t *inode, const char *real_path,
+                       gf_xattrop_flags_t optype, dict_t *xattr,
+                       int32_t *op_ret, int32_t *op_errno)
+{
+        struct posix_private       *priv     = NULL;
+        struct posix_journal_ctx   *ctx      = NULL;
+        struct posix_journal_entry *entry    = NULL;
+        data_pair_t                *trav     = NULL;
+        char                       *rel_path = NULL;
+        char                       *path     = NULL;
+        char                       *array    = NULL;
+        char                       *old      = NULL;
+        ssize_t                     size     = 0;
+        uint64_t                    seq      = 0;
+        int                         ret      = -1;
+
+        priv = this->private;
+
+        if (!priv->xattrop_journal || !inode || uuid_is_null (inode->gfid))
+                goto out;
+
+        if ((optype != GF_XATTROP_ADD_ARRAY) &&
+            (optype != GF_XATTROP_ADD_ARRAY64))
+                goto out;
+
+        for (trav = xattr->members_list; trav; trav = trav->next) {
+                if (strncmp (trav->key, POSIX_JOURNAL_XATTR_PREFIX,
+                             strlen (POSIX_JOURNAL_XATTR_PREFIX)))
+                        goto out;
+        }
+
+        if (!real_path && (inode_path (inode, NULL, &rel_path) > 0)) {
+                MAKE_REAL_PATH (path, this, rel_path);
+                real_path = path;
+        }
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                ctx = __posix_journal_ctx_get (this, inode, _gf_false);
+                if (!real_path && ctx && ctx->path) {
+                        path = alloca (strlen (ctx->path) + 1);
+                        strcpy (path, ctx->path);
+                        real_path = path;
+                }
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        /* nothing is cached for the inode without a path, so the xattrs
+           are still the truth */
+        if (!real_path)
+                goto out;
+
+        /* from here on the xattrop is done by the journal */
+        ret = 0;
+        *op_ret = -1;
+
+        /* read in the counters seen for the first time */
+        for (trav = xattr->members_list; trav; trav = trav->next) {
+                pthread_mutex_lock (&priv->journal_lock);
+                {
+                        ctx = __posix_journal_ctx_get (this, inode, _gf_false);
+                        entry = NULL;
+                        if (ctx)
+                                entry = __posix_journal_entry_get (ctx,
+                                                                   trav->key);
+                }
+                pthread_mutex_unlock (&priv->journal_lock);
+
+                if (entry)
+                        continue;
+
+                *op_errno = ENOMEM;
+                array = GF_CALLOC (1, trav->value->len, gf_posix_mt_char);
+                if (!array)
+                        goto out;
+
+                size = sys_lgetxattr (real_path, trav->key, array,
+                                      trav->value->len);
+                if ((size == -1) && (errno != ENODATA) &&
+                    (errno != ENOATTR)) {
+                        *op_errno = errno;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "getxattr failed on %s while doing "
+                                "xattrop: Key:%s (%s)", real_path,
+                                trav->key, strerror (errno));
+                        GF_FREE (array);
+                        goto out;
+                }
+
+                entry = GF_CALLOC (1, sizeof (*entry),
+                                   gf_posix_mt_journal_entry);
+                if (!entry) {
+                        GF_FREE (array);
+                        goto out;
+                }
+                INIT_LIST_HEAD (&entry->list);
+                entry->len    = trav->value->len;
+                entry->ondisk = (size != -1);
+                entry->disk   = array;
+                entry->key    = gf_strdup (trav->key);
+                entry->value  = memdup (array, entry->len);
+                if (!entry->key || !entry->value) {
+                        posix_journal_entry_destroy (entry);
+                        goto out;
+                }
+
+                pthread_mutex_lock (&priv->journal_lock);
+                {
+                        ctx = __posix_journal_ctx_get (this, inode, _gf_true);
+                        if (ctx && !__posix_journal_entry_get (ctx,
+                                                               trav->key)) {
+                                list_add_tail (&entry->list, &ctx->entries);
+                                entry = NULL;
+                        }
+                }
+                pthread_mutex_unlock (&priv->journal_lock);
+
+                if (entry) {
+                        posix_journal_entry_destroy (entry);
+                        if (!ctx)
+                                goto out;
+                }
+        }
+
+        *op_ret = 0;
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                ctx = __posix_journal_ctx_get (this, inode, _gf_false);
+                if (!ctx) {
+                        *op_ret = -1;
+                        *op_errno = ENOMEM;
+                        goto unlock;
+                }
+
+                if (!ctx->path || strcmp (ctx->path, real_path)) {
+                        if (ctx->path)
+                                GF_FREE (ctx->path);
+                        ctx->path = gf_strdup (real_path);
+                        if (!ctx->path) {
+                                *op_ret = -1;
+                                *op_errno = ENOMEM;
+                                goto unlock;
+                        }
+                }
+
+                for (trav = xattr->members_list; trav; trav = trav->next) {
+                        entry = __posix_journal_entry_get (ctx, trav->key);
+                        if (!entry || (entry->len != trav->value->len)) {
+                                *op_ret = -1;
+                                *op_errno = EINVAL;
+                                goto unlock;
+                        }
+
+                        array = memdup (entry->value, entry->len);
+                        if (!array) {
+                                *op_ret = -1;
+                                *op_errno = ENOMEM;
+                                goto unlock;
+                        }
+                        __posix_journal_add (array, trav->value->data,
+                                             entry->len, optype);
+
+                        old = entry->value;
+                        entry->value = array;
+                        if (__posix_journal_append (this, ctx, entry->key,
+                                                    entry->value,
+                                                    entry->len) != 0) {
+                                entry->value = old;
+                                GF_FREE (array);
+                                *op_ret = -1;
+                                *op_errno = ENOMEM;
+                                goto unlock;
+                        }
+                        GF_FREE (old);
+
+                        if (__posix_journal_entry_dirty (entry) &&
+                            list_empty (&ctx->dirty))
+                                list_add_tail (&ctx->dirty,
+                                               &priv->journal_dirty);
+
+                        array = memdup (entry->value, entry->len);
+                        if (!array) {
+                                *op_ret = -1;
+                                *op_errno = ENOMEM;
+                                goto unlock;
+                        }
+                        size = dict_set_bin (xattr, trav->key, array,
+                                             entry->len);
+                        if (size != 0) {
+                                GF_FREE (array);
+                                *op_ret = -1;
+                                *op_errno = EINVAL;
+                                goto unlock;
+                        }
+                }
+
+                priv->journal_hits++;
+                seq = priv->journal_seq;
+        }
+unlock:
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        if (*op_ret == 0)
+                posix_journal_commit (this, seq);
+out:
+        if (rel_path)
+                GF_FREE (rel_path);
+
+        return ret;
+}
+
+
+/* replace the values in xattr by those of the counters of inode which
+   are not yet in the xattrs; just name if given, else those in req if
+   given, else all of them. Returns the number of values replaced. */
+int
+posix_journal_overlay (xlator_t *this, inode_t *inode, const char *name,
+                       dict_t *req, dict_t *xattr)
+{
+        struct posix_private       *priv  = NULL;
+        struct posix_journal_ctx   *ctx   = NULL;
+        struct posix_journal_entry *entry = NULL;
+        char                       *array = NULL;
+        int                         count = 0;
+
+        priv = this->private;
+
+        if (!priv->xattrop_journal || !inode || !xattr)
+                return 0;
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                ctx = __posix_journal_ctx_get (this, inode, _gf_false);
+                if (!ctx || list_empty (&ctx->dirty))
+                        goto unlock;
+
+                list_for_each_entry (entry, &ctx->entries, list) {
+                        if (!__posix_journal_entry_dirty (entry))
+                                continue;
+                        if (name && strcmp (name, entry->key))
+                                continue;
+                        if (!name && req && !dict_get (req, entry->key))
+                                continue;
+
+                        array = memdup (entry->value, entry->len);
+                        if (!array)
+                                break;
+                        if (dict_set_bin (xattr, entry->key, array,
+                                          entry->len) != 0) {
+                                GF_FREE (array);
+                                continue;
+                        }
+                        count++;
+                }
+        }
+unlock:
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        return count;
+}
+
+
+/* the xattr key of inode was set or removed by other means, stop
+   tracking it */
+void
+posix_journal_invalidate (xlator_t *this, inode_t *inode, const char *key)
+{
+        struct posix_private       *priv  = NULL;
+        struct posix_journal_ctx   *ctx   = NULL;
+        struct posix_journal_entry *entry = NULL;
+        uint64_t                    seq   = 0;
+
+        priv = this->private;
+
+        if (!priv->xattrop_journal || !inode)
+                return;
+
+        if (key && strncmp (key, POSIX_JOURNAL_XATTR_PREFIX,
+                            strlen (POSIX_JOURNAL_XATTR_PREFIX)))
+                return;
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                ctx = __posix_journal_ctx_get (this, inode, _gf_false);
+                if (ctx) {
+                        entry = __posix_journal_entry_get (ctx, key);
+                }
+
+                if (entry) {
+                        posix_journal_entry_destroy (entry);
+                        if (!__posix_journal_ctx_dirty (ctx))
+                                list_del_init (&ctx->dirty);
+
+                        /* keep the replay from putting back the old
+                           value of the xattr */
+                        if (__posix_journal_append (this, ctx, key,
+                                                    NULL, 0) == 0)
+                                seq = priv->journal_seq;
+                }
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        if (seq)
+                posix_journal_commit (this, seq);
+}
+
+
+void
+posix_journal_forget (xlator_t *this, inode_t *inode)
+{
+        struct posix_private       *priv  = NULL;
+        struct posix_journal_ctx   *ctx   = NULL;
+        struct posix_journal_entry *entry = NULL;
+        struct posix_journal_entry *tmp   = NULL;
+        struct posix_journal_fold  *fold  = NULL;
+        uint64_t                    value = 0;
+
+        priv = this->private;
+
+        if (inode_ctx_del (inode, this, &value) != 0)
+                return;
+
+        ctx = (struct posix_journal_ctx *)(long) value;
+
+        /* the dentries are gone by now, go by the last path. ctx stays
+           dirty till the xattrs are written, so that its records are
+           not compacted away meanwhile. */
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                if (!list_empty (&ctx->dirty))
+                        fold = __posix_journal_fold_get (this, ctx,
+                                                         _gf_false);
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        if (fold) {
+                posix_journal_fold_write (this, fold);
+                posix_journal_fold_destroy (fold);
+        }
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                list_del_init (&ctx->dirty);
+
+                list_for_each_entry_safe (entry, tmp, &ctx->entries, list) {
+                        posix_journal_entry_destroy (entry);
+                }
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        if (ctx->path)
+                GF_FREE (ctx->path);
+        GF_FREE (ctx);
+}
+
+
+/* oldpath was renamed to newpath. The records of the counters not yet in
+   the xattrs name the file by its path, so the files at or below oldpath
+   get them again under the new path; a replay would not find them by
+   the old one. */
+void
+posix_journal_rename (xlator_t *this, const char *oldpath,
+                      const char *newpath)
+{
+        struct posix_private       *priv  = NULL;
+        struct posix_journal_ctx   *ctx   = NULL;
+        struct posix_journal_entry *entry = NULL;
+        char                       *path  = NULL;
+        size_t                      len   = 0;
+        uint64_t                    seq   = 0;
+        int                         ret   = 0;
+
+        priv = this->private;
+
+        if (!priv->xattrop_journal)
+                return;
+
+        len = strlen (oldpath);
+
+        pthread_mutex_lock (&priv->journal_lock);
+        {
+                list_for_each_entry (ctx, &priv->journal_dirty, dirty) {
+                        if (!ctx->path || strncmp (ctx->path, oldpath, len) ||
+                            ((ctx->path[len] != '\0') &&
+                             (ctx->path[len] != '/')))
+                                continue;
+
+                        ret = gf_asprintf (&path, "%s%s", newpath,
+                                           ctx->path + len);
+                        if (ret < 0) {
+                                gf_log (this->name, GF_LOG_ERROR,
+                                        "journaled xattrops of %s stay "
+                                        "under its old path", ctx->path);
+                                continue;
+                        }
+                        GF_FREE (ctx->path);
+                        ctx->path = path;
+
+                        list_for_each_entry (entry, &ctx->entries, list) {
+                                if (!__posix_journal_entry_dirty (entry))
+                                        continue;
+                                if (__posix_journal_append (this, ctx,
+                                                            entry->key,
+                                                            entry->value,
+                                                            entry->len) != 0) {
+                                        gf_log (this->name, GF_LOG_ERROR,
+                                                "journaling %s of %s under "
+                                                "its new path failed",
+                                                entry->key, ctx->path);
+                                        continue;
+                                }
+                                seq = priv->journal_seq;
+                        }
+                }
+        }
+        pthread_mutex_unlock (&priv->journal_lock);
+
+        if (seq)
+                posix_journal_commit (this, seq);
+}
+
+
+static void *
+posix_journal_thread_proc (void *data)
+{
+        xlator_t             *this = NULL;
+        struct posix_private *priv = NULL;
+        uint64_t              seq  = 0;
+
+        this = data;
+        priv = this->private;
+
+        THIS = this;
+
+        while (1) {
+                sleep (priv->journal_fold_interval);
+
+                /* nothing to do unless xattrops came in since the last
+                   fold */
+                if (seq != priv->journal_seq) {
+                        posix_journal_fold (this);
+                        seq = priv->journal_seq;
+                }
+        }
+
+        return NULL;
+}
+
+
+/* set the xattrs to the last values recorded in the journal */
+static int
+posix_journal_replay (xlator_t *this, int fd)
+{
+        struct posix_journal_rec  rec     = {0, };
+        struct stat               stbuf   = {0, };
+        dict_t                   *seen    = NULL;
+        char                    **recs    = NULL;
+        char                     *buf     = NULL;
+        char                     *ptr     = NULL;
+        char                     *end     = NULL;
+        char                     *path    = NULL;
+        char                     *key     = NULL;
+        char                     *name    = NULL;
+        uint64_t                  left    = 0;
+        int                       count   = 0;
+        int                       applied = 0;
+        int                       lost    = 0;
+        int                       i       = 0;
+        int                       ret     = -1;
+
+        if (fstat (fd, &stbuf) == -1)
+                goto out;
+
+        if (stbuf.st_size == 0) {
+                ret = 0;
+                goto out;
+        }
+
+        buf = GF_CALLOC (1, stbuf.st_size, gf_posix_mt_char);
+        if (!buf)
+                goto out;
+
+        if (pread (fd, buf, stbuf.st_size, 0) != stbuf.st_size)
+                goto out;
+
+        /* no record is smaller than its header */
+        recs = GF_CALLOC (stbuf.st_size / sizeof (rec) + 1, sizeof (*recs),
+                          gf_posix_mt_char);
+        if (!recs)
+                goto out;
+
+        ptr = buf;
+        end = buf + stbuf.st_size;
+
+        while (ptr + sizeof (rec) <= end) {
+                memcpy (&rec, ptr, sizeof (rec));
+                left = end - ptr - sizeof (rec);
+                if ((rec.magic != POSIX_JOURNAL_MAGIC) ||
+                    !rec.path_len || !rec.key_len ||
+                    ((uint64_t) rec.path_len + rec.key_len +
+                     rec.value_len > left)) {
+                        /* torn write at the tail */
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "xattrop journal is damaged after %d "
+                                "records", count);
+                        break;
+                }
+
+                recs[count++] = ptr;
+                ptr += sizeof (rec) + rec.path_len + rec.key_len +
+                        rec.value_len;
+        }
+
+        seen = get_new_dict_full (count + 1);
+        if (!seen)
+                goto out;
+
+        /* only the last record of a counter counts, one without a value
+           means the xattr was set by other means since */
+        for (i = count - 1; i >= 0; i--) {
+                memcpy (&rec, recs[i], sizeof (rec));
+
+                path = recs[i] + sizeof (rec);
+                key  = path + rec.path_len;
+                path[rec.path_len - 1] = '\0';
+                key[rec.key_len - 1] = '\0';
+
+                ret = gf_asprintf (&name, "%s/%s", uuid_utoa (rec.gfid), key);
+                if (ret < 0) {
+                        ret = -1;
+                        goto out;
+                }
+
+                if (dict_get (seen, name)) {
+                        GF_FREE (name);
+                        continue;
+                }
+
+                ret = dict_set_int32 (seen, name, 1);
+                GF_FREE (name);
+                if (ret)
+                        goto out;
+
+                if (!rec.value_len)
+                        continue;
+
+                /* an unlinked file, or one renamed after its record
+                   was appended and before the rename was journaled */
+                if (posix_journal_gfid_check (path, rec.gfid) != 0) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "cannot replay %s of %s: %s is not that "
+                                "file any more", key, uuid_utoa (rec.gfid),
+                                path);
+                        lost++;
+                        continue;
+                }
+
+                if (sys_lsetxattr (path, key, key + rec.key_len,
+                                   rec.value_len, 0) == -1) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "replaying %s on %s failed: %s",
+                                key, path, strerror (errno));
+                        lost++;
+                } else {
+                        applied++;
+                }
+        }
+
+        if (lost)
+                gf_log (this->name, GF_LOG_WARNING,
+                        "replayed %d of %d records of the xattrop journal, "
+                        "%d could not be applied", applied, count, lost);
+        else
+                gf_log (this->name, GF_LOG_INFO,
+                        "replayed %d of %d records of the xattrop journal",
+                        applied, count);
+
+        ret = ftruncate (fd, 0);
+out:
+        if (seen)
+                dict_destroy (seen);
+        if (recs)
+                GF_FREE (recs);
+        if (buf)
+                GF_FREE (buf);
+
+        return ret;
+}
+
+
+int
+posix_journal_init (xlator_t *this)
+{
+        struct posix_private *priv = NULL;
+        int                   ret  = -1;
+
+        priv = this->private;
+
+        pthread_mutex_init (&priv->journal_lock, NULL);
+        pthread_cond_init (&priv->journal_cond, NULL);
+        INIT_LIST_HEAD (&priv->journal_dirty);
+        priv->journal_fd = -1;
+
+        if (!priv->xattrop_journal) {
+                ret = 0;
+                goto out;
+        }
+
+        ret = gf_asprintf (&priv->journal_path, "%s/%s", priv->base_path,
+                           POSIX_XATTROP_JOURNAL);
+        if (ret < 0) {
+                priv->journal_path = NULL;
+                goto disable;
+        }
+
+        priv->journal_fd = open (priv->journal_path,
+                                 O_CREAT | O_RDWR | O_APPEND, 0600);
+        if (priv->journal_fd == -1) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "opening xattrop journal %s failed: %s",
+                        priv->journal_path, strerror (errno));
+                goto disable;
+        }
+
+        ret = posix_journal_replay (this, priv->journal_fd);
+        if (ret) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "replaying xattrop journal %s failed",
+                        priv->journal_path);
+                close (priv->journal_fd);
+                priv->journal_fd = -1;
+                goto disable;
+        }
+
+        ret = pthread_create (&priv->journal_folder, NULL,
+                              posix_journal_thread_proc, this);
+        if (ret != 0) {
+                gf_log (this->name, GF_LOG_ERROR,
+                        "spawning xattrop journal thread failed: %s",
+                        strerror (ret));
+                close (priv->journal_fd);
+                priv->journal_fd = -1;
+                goto disable;
+        }
+
+        gf_log (this->name, GF_LOG_INFO, "xattrops are journaled in %s",
+                priv->journal_path);
+        ret = 0;
+        goto out;
+
+disable:
+        /* the xattrs are still the truth, work without the journal */
+        priv->xattrop_journal = _gf_false;
+        ret = 0;
+out:
+        return ret;
+}
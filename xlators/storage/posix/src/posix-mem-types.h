@@ -30,6 +30,10 @@ enum gf_posix_mem_types_ {
         gf_posix_mt_int32_t,
         gf_posix_mt_posix_dev_t,
         gf_posix_mt_trash_path,
+        gf_posix_mt_reclaim_entry,
+        gf_posix_mt_journal_ctx,
+        gf_posix_mt_journal_entry,
+        gf_posix_mt_journal_fold,
         gf_posix_mt_end
 };
 #endif
@@ -87,9 +87,7 @@
 int
 posix_forget (xlator_t *this, inode_t *inode)
 {
-        uint64_t tmp_cache = 0;
-        if (!inode_ctx_del (inode, this, &tmp_cache))
-                dict_destroy ((dict_t *)(long)tmp_cache);
+        posix_journal_forget (this, inode);
 
         return 0;
 }
@@ -136,6 +134,8 @@ posix_lookup (call_frame_t *frame, xlator_t *this,
         if (xattr_req && (op_ret == 0)) {
                 xattr = posix_lookup_xattr_fill (this, real_path, loc,
                                                  xattr_req, &buf);
+                posix_journal_overlay (this, loc->inode, NULL, xattr_req,
+                                       xattr);
         }
 
 parent:
@@ -1052,6 +1052,10 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
         }
 
         priv = this->private;
+        if (IA_ISREG (loc->inode->ia_type) &&
+            posix_reclaim_unlink (this, loc->inode, real_path))
+                goto unlinked;
+
         if (priv->background_unlink) {
                 if (IA_ISREG (loc->inode->ia_type)) {
                         fd = open (real_path, O_RDONLY);
@@ -1075,6 +1079,7 @@ posix_unlink (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+unlinked:
         op_ret = posix_lstat_with_gfid (this, parentpath, &postparent);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1434,6 +1439,8 @@ posix_rename (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
+        posix_journal_rename (this, real_oldpath, real_newpath);
+
         op_ret = posix_lstat_with_gfid (this, real_newpath, &stbuf);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -1596,6 +1603,7 @@ posix_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
 {
         int32_t               op_ret    = -1;
         int32_t               op_errno  = 0;
+        int                   fd        = -1;
         char                 *real_path = 0;
         struct posix_private *priv      = NULL;
         struct iatt           prebuf    = {0,};
@@ -1622,7 +1630,28 @@ posix_truncate (call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset)
                 goto out;
         }
 
-        op_ret = truncate (real_path, offset);
+        if (priv->reclaim_threshold &&
+            (prebuf.ia_size > offset + priv->reclaim_threshold)) {
+                fd = open (real_path, O_WRONLY);
+                if (fd == -1) {
+                        op_ret = -1;
+                        op_errno = errno;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "open of %s failed: %s",
+                                loc->path, strerror (op_errno));
+                        goto out;
+                }
+
+                op_ret = posix_chunked_truncate (this, fd, prebuf.ia_size,
+                                                 offset);
+                LOCK (&priv->lock);
+                {
+                        priv->chunked_truncates++;
+                }
+                UNLOCK (&priv->lock);
+        } else {
+                op_ret = truncate (real_path, offset);
+        }
         if (op_ret == -1) {
                 op_errno = errno;
                 gf_log (this->name, GF_LOG_ERROR,
@@ -1647,6 +1676,9 @@ out:
         STACK_UNWIND_STRICT (truncate, frame, op_ret, op_errno,
                              &prebuf, &postbuf);
 
+        if (fd != -1)
+                close (fd);
+
         return 0;
 }
 
@@ -2462,6 +2494,7 @@ posix_setxattr (call_frame_t *frame, xlator_t *this,
                         op_errno = -ret;
                         goto out;
                 }
+                posix_journal_invalidate (this, loc->inode, trav->key);
                 trav = trav->next;
         }
 
@@ -2560,6 +2593,12 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
                 goto done;
         }
 
+        if (name && posix_journal_overlay (this, loc->inode, name, NULL,
+                                           dict)) {
+                size = dict_get (dict, (char *)name)->len;
+                goto done;
+        }
+
         if (name) {
                 strcpy (key, name);
 
@@ -2646,6 +2685,8 @@ posix_getxattr (call_frame_t *frame, xlator_t *this,
 
         } /* while (remaining_size > 0) */
 
+        posix_journal_overlay (this, loc->inode, NULL, NULL, dict);
+
 done:
         op_ret = size;
 
@@ -2718,6 +2759,12 @@ posix_fgetxattr (call_frame_t *frame, xlator_t *this,
                 goto done;
         }
 
+        if (name && posix_journal_overlay (this, fd->inode, name, NULL,
+                                           dict)) {
+                size = dict_get (dict, (char *)name)->len;
+                goto done;
+        }
+
         if (name) {
                 strcpy (key, name);
 
@@ -2800,6 +2847,8 @@ posix_fgetxattr (call_frame_t *frame, xlator_t *this,
 
         } /* while (remaining_size > 0) */
 
+        posix_journal_overlay (this, fd->inode, NULL, NULL, dict);
+
 done:
         op_ret = size;
 
@@ -2860,6 +2909,7 @@ posix_fsetxattr (call_frame_t *frame, xlator_t *this,
                         op_errno = -ret;
                         goto out;
                 }
+                posix_journal_invalidate (this, fd->inode, trav->key);
                 trav = trav->next;
         }
 
@@ -2894,6 +2944,8 @@ posix_removexattr (call_frame_t *frame, xlator_t *this,
 
         SET_FS_ID (frame->root->uid, frame->root->gid);
 
+        posix_journal_invalidate (this, loc->inode, name);
+
         op_ret = sys_lremovexattr (real_path, name);
         if (op_ret == -1) {
                 op_errno = errno;
@@ -2980,11 +3032,23 @@ __add_long_array (int64_t *dest, int64_t *src, int count)
         }
 }
 
+static void
+__or_array (char *dest, char *src, int count)
+{
+        int i = 0;
+        for (i = 0; i < count; i++) {
+                dest[i] |= src[i];
+        }
+}
+
 /**
  * xattrop - xattr operations - for internal use by GlusterFS
  * @optype: ADD_ARRAY:
  *            dict should contain:
  *               "key" ==> array of 32-bit numbers
+ *          OR_ARRAY:
+ *            dict should contain:
+ *               "key" ==> array of bytes, ORed into the stored ones
  */
 
 int
@@ -3039,6 +3103,10 @@ do_xattrop (call_frame_t *frame, xlator_t *this,
                 inode = fd->inode;
         }
 
+        if (posix_journal_xattrop (this, inode, real_path, optype, xattr,
+                                   &op_ret, &op_errno) == 0)
+                goto out;
+
         while (trav && inode) {
                 count = trav->value->len;
                 array = GF_CALLOC (count, sizeof (char),
@@ -3091,6 +3159,11 @@ do_xattrop (call_frame_t *frame, xlator_t *this,
                                                   trav->value->len / 8);
                                 break;
 
+                        case GF_XATTROP_OR_ARRAY:
+                                __or_array (array, trav->value->data,
+                                            trav->value->len);
+                                break;
+
                         default:
                                 gf_log (this->name, GF_LOG_ERROR,
                                         "Unknown xattrop type (%d) on %s. Please send "
@@ -3265,7 +3338,18 @@ posix_ftruncate (call_frame_t *frame, xlator_t *this,
                 goto out;
         }
 
-        op_ret = ftruncate (_fd, offset);
+        if (priv->reclaim_threshold &&
+            (preop.ia_size > offset + priv->reclaim_threshold)) {
+                op_ret = posix_chunked_truncate (this, _fd, preop.ia_size,
+                                                 offset);
+                LOCK (&priv->lock);
+                {
+                        priv->chunked_truncates++;
+                }
+                UNLOCK (&priv->lock);
+        } else {
+                op_ret = ftruncate (_fd, offset);
+        }
 
         if (op_ret == -1) {
                 op_errno = errno;
@@ -3295,6 +3379,325 @@ out:
 }
 
 
+/* Block size used when zero-filling by hand, on filesystems which support
+ * neither FALLOC_FL_ZERO_RANGE nor FALLOC_FL_PUNCH_HOLE.
+ */
+#define POSIX_ZEROFILL_BLOCK (128 * GF_UNIT_KB)
+
+static int
+posix_fd_to_fd (xlator_t *this, fd_t *fd, int *_fd)
+{
+        struct posix_fd *pfd     = NULL;
+        uint64_t         tmp_pfd = 0;
+        int              ret     = -1;
+
+        ret = fd_ctx_get (fd, this, &tmp_pfd);
+        if (ret < 0) {
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pfd is NULL, fd=%p", fd);
+                return -EBADF;
+        }
+        pfd = (struct posix_fd *)(long)tmp_pfd;
+
+        *_fd = pfd->fd;
+
+        return 0;
+}
+
+
+static int
+posix_zerofill_by_write (int _fd, off_t offset, size_t len)
+{
+        char    *zeros = NULL;
+        size_t   chunk = 0;
+        ssize_t  ret   = 0;
+
+        zeros = GF_CALLOC (1, POSIX_ZEROFILL_BLOCK, gf_posix_mt_char);
+        if (!zeros) {
+                errno = ENOMEM;
+                return -1;
+        }
+
+        while (len > 0) {
+                chunk = min (len, POSIX_ZEROFILL_BLOCK);
+
+                ret = pwrite (_fd, zeros, chunk, offset);
+                if (ret <= 0) {
+                        if (ret == 0)
+                                errno = EIO;
+                        break;
+                }
+
+                offset += ret;
+                len    -= ret;
+        }
+
+        GF_FREE (zeros);
+
+        return (len == 0) ? 0 : -1;
+}
+
+
+static int
+posix_do_zerofill (int _fd, off_t offset, size_t len)
+{
+        int ret = -1;
+
+        /* Zeroing converts the range into unwritten extents without
+         * touching the data blocks. Like a write, it extends the file
+         * if the range ends beyond EOF.
+         */
+        ret = sys_fallocate (_fd, FALLOC_FL_ZERO_RANGE, offset, len);
+        if ((ret == 0) || ((errno != EOPNOTSUPP) && (errno != ENOSYS)))
+                return ret;
+
+        /* Punching the hole and allocating it again leaves the same
+         * on-disk state behind, on filesystems without ZERO_RANGE.
+         */
+        ret = sys_fallocate (_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                             offset, len);
+        if (ret == 0)
+                return sys_fallocate (_fd, 0, offset, len);
+        if ((errno != EOPNOTSUPP) && (errno != ENOSYS))
+                return ret;
+
+        return posix_zerofill_by_write (_fd, offset, len);
+}
+
+
+static int32_t
+posix_do_fallocate (xlator_t *this, glusterfs_fop_t fop, fd_t *fd,
+                    int32_t flags, off_t offset, size_t len,
+                    struct iatt *preop, struct iatt *postop)
+{
+        int32_t               op_ret   = -1;
+        int32_t               op_errno = 0;
+        int                   _fd      = -1;
+        struct posix_private *priv     = NULL;
+
+        priv = this->private;
+        VALIDATE_OR_GOTO (priv, out);
+
+        op_ret = posix_fd_to_fd (this, fd, &_fd);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+                goto out;
+        }
+
+        op_ret = posix_fstat_with_gfid (this, _fd, preop);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "pre-operation fstat failed on fd=%p: %s", fd,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        switch (fop) {
+        case GF_FOP_FALLOCATE:
+                op_ret = sys_fallocate (_fd, flags, offset, len);
+                break;
+        case GF_FOP_DISCARD:
+                op_ret = sys_fallocate (_fd, (FALLOC_FL_PUNCH_HOLE |
+                                              FALLOC_FL_KEEP_SIZE),
+                                        offset, len);
+                break;
+        case GF_FOP_ZEROFILL:
+                op_ret = posix_do_zerofill (_fd, offset, len);
+                break;
+        default:
+                op_ret = -1;
+                errno = EINVAL;
+                break;
+        }
+
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "%s failed on fd=%p (%"PRId64", %"GF_PRI_SIZET"): %s",
+                        gf_fop_list[fop], fd, offset, len,
+                        strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = posix_fstat_with_gfid (this, _fd, postop);
+        if (op_ret == -1) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "post-operation fstat failed on fd=%p: %s",
+                        fd, strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+out:
+        return (op_ret == 0) ? 0 : -op_errno;
+}
+
+
+/* not posix_fallocate(), which belongs to libc */
+int32_t
+posix_glfallocate (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                   int32_t keep_size, off_t offset, size_t len)
+{
+        int32_t     op_ret   = -1;
+        int32_t     op_errno = 0;
+        int32_t     flags    = 0;
+        struct iatt preop    = {0,};
+        struct iatt postop   = {0,};
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        if (keep_size)
+                flags = FALLOC_FL_KEEP_SIZE;
+
+        op_ret = posix_do_fallocate (this, GF_FOP_FALLOCATE, fd, flags,
+                                     offset, len, &preop, &postop);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+        }
+
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (fallocate, frame, op_ret, op_errno, &preop,
+                             &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_discard (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+               size_t len)
+{
+        int32_t     op_ret   = -1;
+        int32_t     op_errno = 0;
+        struct iatt preop    = {0,};
+        struct iatt postop   = {0,};
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_do_fallocate (this, GF_FOP_DISCARD, fd, 0, offset,
+                                     len, &preop, &postop);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+        }
+
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (discard, frame, op_ret, op_errno, &preop,
+                             &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_zerofill (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+                size_t len)
+{
+        int32_t     op_ret   = -1;
+        int32_t     op_errno = 0;
+        struct iatt preop    = {0,};
+        struct iatt postop   = {0,};
+
+        DECLARE_OLD_FS_ID_VAR;
+        SET_FS_ID (frame->root->uid, frame->root->gid);
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_do_fallocate (this, GF_FOP_ZEROFILL, fd, 0, offset,
+                                     len, &preop, &postop);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+        }
+
+out:
+        SET_TO_OLD_FS_ID ();
+
+        STACK_UNWIND_STRICT (zerofill, frame, op_ret, op_errno, &preop,
+                             &postop);
+
+        return 0;
+}
+
+
+int32_t
+posix_seek (call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            gf_seek_what_t what)
+{
+        int          _fd      = -1;
+        int32_t      op_ret   = -1;
+        int32_t      op_errno = 0;
+        off_t        ret      = -1;
+        struct stat  stbuf    = {0,};
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        op_ret = posix_fd_to_fd (this, fd, &_fd);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+                goto out;
+        }
+
+#if defined(SEEK_DATA) && defined(SEEK_HOLE)
+        ret = lseek (_fd, offset,
+                     (what == GF_SEEK_DATA) ? SEEK_DATA : SEEK_HOLE);
+        if ((ret != -1) || (errno != EINVAL))
+                goto done;
+        /* the backend filesystem does not know SEEK_DATA/SEEK_HOLE,
+           fall back to treating the whole file as data */
+#endif
+        if (fstat (_fd, &stbuf) == -1)
+                goto done;
+
+        if (offset >= stbuf.st_size) {
+                errno = ENXIO;
+                goto done;
+        }
+
+        ret = (what == GF_SEEK_DATA) ? offset : stbuf.st_size;
+done:
+        if (ret == -1) {
+                op_errno = errno;
+                op_ret = -1;
+                if (op_errno != ENXIO)
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "seek on fd=%p failed: %s", fd,
+                                strerror (op_errno));
+                goto out;
+        }
+
+        op_ret = 0;
+        offset = ret;
+out:
+        STACK_UNWIND_STRICT (seek, frame, op_ret, op_errno, offset);
+
+        return 0;
+}
+
+
 int32_t
 posix_fstat (call_frame_t *frame, xlator_t *this,
              fd_t *fd)
@@ -3466,6 +3869,14 @@ __posix_fill_readdir (DIR *dir, off_t off, size_t size, gf_dirent_t *entries,
                     && (!strcmp (entry->d_name, GF_REPLICATE_TRASH_DIR)))
                         continue;
 
+                if ((!strcmp (real_path, base_path))
+                    && (!strcmp (entry->d_name, POSIX_RECLAIM_DIR)))
+                        continue;
+
+                if ((!strcmp (real_path, base_path))
+                    && (!strcmp (entry->d_name, POSIX_XATTROP_JOURNAL)))
+                        continue;
+
 #ifdef __NetBSD__
 	       /*
 		* NetBSD with UFS1 backend uses backing files for
@@ -3647,7 +4058,8 @@ posix_readdirp (call_frame_t *frame, xlator_t *this,
 int32_t
 posix_priv (xlator_t *this)
 {
-        struct posix_private *priv = NULL;
+        struct posix_private       *priv  = NULL;
+        struct posix_reclaim_entry *entry = NULL;
         char  key_prefix[GF_DUMP_MAX_BUF_LEN];
 
         snprintf(key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.%s", this->type,
@@ -3667,6 +4079,37 @@ posix_priv (xlator_t *this)
         gf_proc_dump_write("max_read","%d", priv->read_value);
         gf_proc_dump_write("max_write","%d", priv->write_value);
         gf_proc_dump_write("nr_files","%ld", priv->nr_files);
+        gf_proc_dump_write("chunked_truncates","%"PRIu64,
+                           priv->chunked_truncates);
+
+        pthread_mutex_lock (&priv->reclaim_lock);
+        {
+                gf_proc_dump_write("reclaim_pending_files","%"PRIu64,
+                                   priv->reclaim_pending_files);
+                gf_proc_dump_write("reclaim_pending_bytes","%"PRIu64,
+                                   priv->reclaim_pending_bytes);
+                gf_proc_dump_write("reclaim_done_files","%"PRIu64,
+                                   priv->reclaim_done_files);
+                gf_proc_dump_write("reclaim_done_bytes","%"PRIu64,
+                                   priv->reclaim_done_bytes);
+                if (!list_empty (&priv->reclaim_list)) {
+                        entry = list_entry (priv->reclaim_list.next,
+                                            struct posix_reclaim_entry, list);
+                        gf_proc_dump_write("reclaim_current","%s "
+                                           "(%"PRId64" bytes left)",
+                                           entry->path, (int64_t) entry->size);
+                }
+        }
+        pthread_mutex_unlock (&priv->reclaim_lock);
+
+        if (priv->xattrop_journal) {
+                gf_proc_dump_write("xattrop_journal_hits","%"PRIu64,
+                                   priv->journal_hits);
+                gf_proc_dump_write("xattrop_journal_batches","%"PRIu64,
+                                   priv->journal_batches);
+                gf_proc_dump_write("xattrop_journal_folds","%"PRIu64,
+                                   priv->journal_folds);
+        }
 
         return 0;
 }
@@ -3743,6 +4186,92 @@ out:
 }
 
 
+/* largest amount of data one rchecksumv call may read */
+#define POSIX_RCHECKSUMV_MAX_BYTES (16 * GF_UNIT_MB)
+
+int32_t
+posix_rchecksumv (call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  off_t offset, int32_t block_size, int32_t count,
+                  int32_t algo)
+{
+        char     *buf       = NULL;
+        uint8_t  *checksums = NULL;
+        int       _fd       = -1;
+        int       op_ret    = -1;
+        int       op_errno  = 0;
+        int       i         = 0;
+        int       blocks    = 0;
+        size_t    len       = 0;
+        ssize_t   ret       = 0;
+        ssize_t   block_len = 0;
+
+        VALIDATE_OR_GOTO (frame, out);
+        VALIDATE_OR_GOTO (this, out);
+        VALIDATE_OR_GOTO (fd, out);
+
+        if ((block_size <= 0) || (count <= 0) ||
+            (count > GF_RCHECKSUM_MAX_BLOCKS) ||
+            (((size_t) block_size * count) > POSIX_RCHECKSUMV_MAX_BYTES)) {
+                op_errno = EINVAL;
+                goto out;
+        }
+
+        op_ret = posix_fd_to_fd (this, fd, &_fd);
+        if (op_ret < 0) {
+                op_errno = -op_ret;
+                op_ret = -1;
+                goto out;
+        }
+        op_ret = -1;
+
+        len = (size_t) block_size * count;
+
+        buf = GF_CALLOC (1, len, gf_posix_mt_char);
+        checksums = GF_CALLOC (count, GF_RCHECKSUM_LEN, gf_posix_mt_char);
+        if (!buf || !checksums) {
+                op_errno = ENOMEM;
+                goto out;
+        }
+
+        /* one read for the whole batch instead of one per block */
+        ret = pread (_fd, buf, len, offset);
+        if (ret < 0) {
+                op_errno = errno;
+                gf_log (this->name, GF_LOG_WARNING,
+                        "pread of %"GF_PRI_SIZET" bytes returned %zd (%s)",
+                        len, ret, strerror (op_errno));
+                goto out;
+        }
+
+#ifdef HAVE_POSIX_FADVISE
+        /* self-heal asks for the next batch right after this one */
+        if (ret == len)
+                posix_fadvise (_fd, offset + len, len, POSIX_FADV_WILLNEED);
+#endif
+
+        for (i = 0; (i < count) && (ret > 0); i++) {
+                block_len = min (ret, block_size);
+                algo = gf_rchecksum_compute (algo, buf + (i * block_size),
+                                             block_len,
+                                             checksums + (i * GF_RCHECKSUM_LEN));
+                ret -= block_len;
+                blocks++;
+        }
+
+        op_ret = 0;
+out:
+        STACK_UNWIND_STRICT (rchecksumv, frame, op_ret, op_errno, algo,
+                             blocks, checksums);
+
+        if (buf)
+                GF_FREE (buf);
+        if (checksums)
+                GF_FREE (checksums);
+
+        return 0;
+}
+
+
 /**
  * notify - when parent sends PARENT_UP, send CHILD_UP event from here
  */
@@ -3977,6 +4506,15 @@ init (xlator_t *this)
         strncpy (_private->trash_path, _private->base_path, _private->base_path_length);
         strcat (_private->trash_path, "/" GF_REPLICATE_TRASH_DIR);
 
+        ret = gf_asprintf (&_private->reclaim_path, "%s/%s",
+                           _private->base_path, POSIX_RECLAIM_DIR);
+        if (ret < 0) {
+                _private->reclaim_path = NULL;
+                ret = -1;
+                goto out;
+        }
+        ret = 0;
+
         LOCK_INIT (&_private->lock);
 
         ret = dict_get_str (this->options, "hostname", &_private->hostname);
@@ -4052,6 +4590,75 @@ init (xlator_t *this)
 
                 _private->janitor_sleep_duration = janitor_sleep;
         }
+
+        _private->reclaim_threshold  = POSIX_DEFAULT_RECLAIM_THRESHOLD;
+        _private->reclaim_chunk_size = POSIX_DEFAULT_RECLAIM_CHUNK_SIZE;
+
+        tmp_data = dict_get (this->options, "reclaim-threshold");
+        if (tmp_data) {
+                if (gf_string2bytesize (tmp_data->data,
+                                        &_private->reclaim_threshold) != 0) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "wrong option provided for "
+                                "'reclaim-threshold'");
+                        goto out;
+                }
+        }
+
+        tmp_data = dict_get (this->options, "reclaim-chunk-size");
+        if (tmp_data) {
+                if ((gf_string2bytesize (tmp_data->data,
+                                         &_private->reclaim_chunk_size) != 0)
+                    || !_private->reclaim_chunk_size) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "wrong option provided for "
+                                "'reclaim-chunk-size'");
+                        goto out;
+                }
+        }
+
+        tmp_data = dict_get (this->options, "reclaim-rate");
+        if (tmp_data) {
+                if (gf_string2bytesize (tmp_data->data,
+                                        &_private->reclaim_rate) != 0) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "wrong option provided for 'reclaim-rate'");
+                        goto out;
+                }
+        }
+
+        tmp_data = dict_get (this->options, "xattrop-journal");
+        if (tmp_data) {
+                if (gf_string2boolean (tmp_data->data,
+                                       &_private->xattrop_journal) == -1) {
+                        ret = -1;
+                        gf_log (this->name, GF_LOG_ERROR,
+                                "'xattrop-journal' takes only boolean "
+                                "options");
+                        goto out;
+                }
+        }
+
+        _private->journal_fold_interval = 5;
+        dict_ret = dict_get_uint32 (this->options,
+                                    "xattrop-journal-fold-interval",
+                                    &_private->journal_fold_interval);
+        if ((dict_ret == 0) && !_private->journal_fold_interval) {
+                ret = -1;
+                gf_log (this->name, GF_LOG_ERROR,
+                        "'xattrop-journal-fold-interval' has to be more "
+                        "than 0");
+                goto out;
+        }
+
+        if (_private->reclaim_threshold)
+                gf_log (this->name, GF_LOG_DEBUG,
+                        "files over %"PRIu64" bytes are reclaimed in chunks "
+                        "of %"PRIu64" bytes", _private->reclaim_threshold,
+                        _private->reclaim_chunk_size);
         /* performing open dir on brick dir locks the brick dir
          * and prevents it from being unmounted
          */
@@ -4096,6 +4703,28 @@ init (xlator_t *this)
         INIT_LIST_HEAD (&_private->janitor_fds);
 
         posix_spawn_janitor_thread (this);
+
+        pthread_mutex_init (&_private->reclaim_lock, NULL);
+        pthread_cond_init (&_private->reclaim_cond, NULL);
+        INIT_LIST_HEAD (&_private->reclaim_list);
+
+        if (_private->reclaim_threshold) {
+                /* unlinks rename into it with the fsuid of the caller */
+                if ((mkdir (_private->reclaim_path, 01777) == -1) &&
+                    (errno != EEXIST)) {
+                        gf_log (this->name, GF_LOG_WARNING,
+                                "creating %s failed (%s), large files will be "
+                                "unlinked inline", _private->reclaim_path,
+                                strerror (errno));
+                } else {
+                        posix_spawn_reclaim_thread (this);
+                }
+        }
+
+        if (_private->reclaim_present)
+                posix_reclaim_requeue (this);
+
+        ret = posix_journal_init (this);
 out:
         return ret;
 }
@@ -4156,10 +4785,15 @@ struct xlator_fops fops = {
         .entrylk     = posix_entrylk,
         .fentrylk    = posix_fentrylk,
         .rchecksum   = posix_rchecksum,
+        .rchecksumv  = posix_rchecksumv,
         .xattrop     = posix_xattrop,
         .fxattrop    = posix_fxattrop,
         .setattr     = posix_setattr,
         .fsetattr    = posix_fsetattr,
+        .fallocate   = posix_glfallocate,
+        .discard     = posix_discard,
+        .zerofill    = posix_zerofill,
+        .seek        = posix_seek,
 };
 
 struct xlator_cbks cbks = {
@@ -4183,6 +4817,16 @@ struct volume_options options[] = {
           .type = GF_OPTION_TYPE_BOOL },
         { .key  = {"janitor-sleep-duration"},
           .type = GF_OPTION_TYPE_INT },
+        { .key  = {"reclaim-threshold"},
+          .type = GF_OPTION_TYPE_SIZET },
+        { .key  = {"reclaim-chunk-size"},
+          .type = GF_OPTION_TYPE_SIZET },
+        { .key  = {"reclaim-rate"},
+          .type = GF_OPTION_TYPE_SIZET },
+        { .key  = {"xattrop-journal"},
+          .type = GF_OPTION_TYPE_BOOL },
+        { .key  = {"xattrop-journal-fold-interval"},
+          .type = GF_OPTION_TYPE_INT },
         { .key  = {"volume-id"},
           .type = GF_OPTION_TYPE_ANY },
         { .key  = {NULL} }
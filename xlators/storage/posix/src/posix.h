@@ -66,6 +66,22 @@ struct posix_fd {
         struct list_head list; /* to add to the janitor list */
 };
 
+/* hidden directory where unlinked large files wait for their blocks
+   to be freed */
+#define POSIX_RECLAIM_DIR GF_RECLAIM_DIR
+
+/* journal of xattrops on the AFR changelog, see posix-journal.c */
+#define POSIX_XATTROP_JOURNAL GF_XATTROP_JOURNAL
+
+#define POSIX_DEFAULT_RECLAIM_THRESHOLD  (1 * GF_UNIT_GB)
+#define POSIX_DEFAULT_RECLAIM_CHUNK_SIZE (64 * GF_UNIT_MB)
+
+struct posix_reclaim_entry {
+        struct list_head list;
+        char            *path;  /* in the reclaim dir */
+        off_t            size;  /* bytes left to be freed */
+};
+
 
 struct posix_private {
 	char   *base_path;
@@ -114,6 +130,45 @@ struct posix_private {
         pthread_t       janitor;
         gf_boolean_t    janitor_present;
         char *          trash_path;
+
+/* reclaim thread which frees the blocks of large unlinked files in
+   chunks of reclaim_chunk_size, at most reclaim_rate bytes a second.
+   truncates which free more than reclaim_threshold bytes are done in
+   chunks too. */
+        char *          reclaim_path;
+        uint64_t        reclaim_threshold;
+        uint64_t        reclaim_chunk_size;
+        uint64_t        reclaim_rate;
+        pthread_t       reclaim;
+        gf_boolean_t    reclaim_present;
+        pthread_mutex_t reclaim_lock;
+        pthread_cond_t  reclaim_cond;
+        struct list_head reclaim_list;
+        uint64_t        reclaim_gen;
+        uint64_t        reclaim_pending_files;
+        uint64_t        reclaim_pending_bytes;
+        uint64_t        reclaim_done_files;
+        uint64_t        reclaim_done_bytes;
+        uint64_t        chunked_truncates;
+
+/* journal of the xattrops on the AFR changelog */
+        gf_boolean_t    xattrop_journal;
+        uint32_t        journal_fold_interval;
+        char *          journal_path;
+        int             journal_fd;
+        pthread_t       journal_folder;
+        pthread_mutex_t journal_lock;
+        pthread_cond_t  journal_cond;
+        struct list_head journal_dirty;   /* inodes with unfolded values */
+        char *          journal_buf;      /* records not yet written */
+        size_t          journal_buf_len;
+        size_t          journal_buf_size;
+        gf_boolean_t    journal_writing;
+        uint64_t        journal_seq;      /* records appended */
+        uint64_t        journal_written;  /* records written out */
+        uint64_t        journal_hits;
+        uint64_t        journal_batches;
+        uint64_t        journal_folds;
 /* lock for brick dir */
         DIR     *mount_lock;
 };
@@ -140,6 +195,24 @@ int posix_handle_pair (xlator_t *this, const char *real_path,
                        data_pair_t *trav, int flags);
 int posix_fhandle_pair (xlator_t *this, int fd, data_pair_t *trav, int flags);
 void posix_spawn_janitor_thread (xlator_t *this);
+void posix_spawn_reclaim_thread (xlator_t *this);
+int posix_reclaim_unlink (xlator_t *this, inode_t *inode,
+                          const char *real_path);
+int posix_reclaim_requeue (xlator_t *this);
+int posix_chunked_truncate (xlator_t *this, int fd, off_t size,
+                            off_t offset);
+int posix_journal_init (xlator_t *this);
+int posix_journal_fold (xlator_t *this);
+int posix_journal_xattrop (xlator_t *this, inode_t *inode,
+                           const char *real_path, gf_xattrop_flags_t optype,
+                           dict_t *xattr, int32_t *op_ret, int32_t *op_errno);
+int posix_journal_overlay (xlator_t *this, inode_t *inode, const char *name,
+                           dict_t *req, dict_t *xattr);
+void posix_journal_invalidate (xlator_t *this, inode_t *inode,
+                               const char *key);
+void posix_journal_forget (xlator_t *this, inode_t *inode);
+void posix_journal_rename (xlator_t *this, const char *oldpath,
+                           const char *newpath);
 int posix_get_file_contents (xlator_t *this, const char *path,
                              const char *name, char **contents);
 int posix_set_file_contents (xlator_t *this, const char *path,